@@ -0,0 +1,148 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  bench.h
+ *
+ * Header file for the micro-benchmark framework, which times batches
+ * of work with nvwa#cycle_clock.  Using this file requires a
+ * C++11-compliant compiler.
+ *
+ * @date  2026-10-15
+ */
+
+#ifndef NVWA_BENCH_H
+#define NVWA_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "nvwa/cycle_clock.h"
+#include "nvwa/latency_histogram.h"
+
+namespace bench {
+
+/**
+ * State of a running benchmark.  A benchmark function does its set-up,
+ * and then runs one batch of work per iteration of
+ * <code>while (state.next_batch())</code>.  The first batch is a warm-up
+ * and is not measured; the others are timed with nvwa#cycle_clock until
+ * the minimum running time is reached.
+ */
+class state {
+public:
+    explicit state(double min_time) noexcept;
+    state(const state&) = delete;
+    state& operator=(const state&) = delete;
+
+    bool next_batch() noexcept
+    {
+        nvwa::cycle_clock::tick_t now = nvwa::cycle_clock::now();
+        if (_M_batches > 1) {
+            nvwa::cycle_clock::tick_t elapsed = now - _M_batch_start;
+            _M_total_ticks += elapsed;
+            _M_latencies.record(nvwa::cycle_clock::to_nanoseconds(elapsed));
+            if (_M_total_ticks >= _M_min_ticks) {
+                return false;
+            }
+        }
+        ++_M_batches;
+        _M_batch_start = nvwa::cycle_clock::now();
+        return true;
+    }
+
+    /** Adds the number of items processed in the current batch. */
+    void add_items(uint64_t items) noexcept
+    {
+        if (_M_batches > 1) {
+            _M_items += items;
+        }
+    }
+
+    uint64_t batches() const noexcept
+    {
+        return _M_batches > 1 ? _M_batches - 1 : 0;
+    }
+    uint64_t items() const noexcept
+    {
+        return _M_items;
+    }
+    double seconds() const
+    {
+        return nvwa::cycle_clock::to_seconds(_M_total_ticks);
+    }
+    const nvwa::latency_histogram& latencies() const noexcept
+    {
+        return _M_latencies;
+    }
+
+private:
+    nvwa::cycle_clock::tick_t _M_min_ticks;
+    nvwa::cycle_clock::tick_t _M_total_ticks{};
+    nvwa::cycle_clock::tick_t _M_batch_start{};
+    uint64_t                  _M_batches{};
+    uint64_t                  _M_items{};
+    nvwa::latency_histogram   _M_latencies;
+};
+
+typedef void (*function)(state&);
+
+/** Registers a benchmark at static initialization time. */
+struct registrar {
+    registrar(const char* group, const char* impl, function fn);
+};
+
+/** Gets the path of a text file of lines shared by the benchmarks. */
+const char* line_file_path();
+
+/** Prevents the compiler from optimizing away a value. */
+template <typename _Tp>
+inline void do_not_optimize(const _Tp& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+} /* namespace bench */
+
+#define NVWA_BENCH_CAT_(_X, _Y) _X##_Y
+#define NVWA_BENCH_CAT(_X, _Y) NVWA_BENCH_CAT_(_X, _Y)
+
+/**
+ * Registers a benchmark function.  Benchmarks in the same group measure
+ * the same work, so that an implementation can be compared against the
+ * others (the baselines).
+ */
+#define NVWA_BENCH(_Group, _Impl, _Fn)                                  \
+    static bench::registrar NVWA_BENCH_CAT(bench_registrar_, __LINE__)( \
+        _Group, _Impl, _Fn)
+
+#endif // NVWA_BENCH_H
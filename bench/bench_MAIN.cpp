@@ -0,0 +1,173 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  bench_MAIN.cpp
+ *
+ * Main program of the micro-benchmarks, which runs the registered
+ * benchmarks and reports their throughput and batch latencies.
+ *
+ * @date  2026-10-15
+ */
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "nvwa/cycle_clock.h"
+#include "nvwa/latency_histogram.h"
+
+namespace /* unnamed */ {
+
+const int line_count = 200000;
+
+struct bench_info {
+    const char*     group;
+    const char*     impl;
+    bench::function fn;
+};
+
+std::vector<bench_info>& registry()
+{
+    static std::vector<bench_info> benches;
+    return benches;
+}
+
+std::string line_file;
+
+void remove_line_file()
+{
+    if (!line_file.empty()) {
+        remove(line_file.c_str());
+    }
+}
+
+void usage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--min-time=SECONDS] [--list] [FILTER...]\n"
+            "Runs the benchmarks whose \"group/impl\" names contain any of\n"
+            "the FILTERs (all by default), and writes CSV to stdout.\n",
+            program);
+}
+
+} /* unnamed namespace */
+
+namespace bench {
+
+state::state(double min_time) noexcept
+    : _M_min_ticks(static_cast<nvwa::cycle_clock::tick_t>(
+          min_time * nvwa::cycle_clock::ticks_per_second()))
+{
+}
+
+registrar::registrar(const char* group, const char* impl, function fn)
+{
+    registry().push_back(bench_info{group, impl, fn});
+}
+
+const char* line_file_path()
+{
+    if (line_file.empty()) {
+        line_file = "bench_lines.txt";
+        FILE* fp = fopen(line_file.c_str(), "w");
+        if (fp == nullptr) {
+            perror("Cannot create bench_lines.txt");
+            exit(1);
+        }
+        atexit(remove_line_file);
+        for (int i = 0; i < line_count; ++i) {
+            // Lines of varying length, 16 comma-separated fields each
+            for (int j = 0; j < 16; ++j) {
+                fprintf(fp, j == 0 ? "%d" : ",%d", i * (j + 1) % 100000);
+            }
+            fputc('\n', fp);
+        }
+        fclose(fp);
+    }
+    return line_file.c_str();
+}
+
+} /* namespace bench */
+
+int main(int argc, char* argv[])
+{
+    double min_time = 0.2;
+    bool list_only = false;
+    std::vector<const char*> filters;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--min-time=", 11) == 0) {
+            min_time = atof(argv[i] + 11);
+        } else if (strcmp(argv[i], "--list") == 0) {
+            list_only = true;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            filters.push_back(argv[i]);
+        }
+    }
+
+    if (!list_only) {
+        printf("group,impl,batches,items,seconds,items_per_second,"
+               "ns_per_item,p50_batch_ns,p99_batch_ns\n");
+    }
+    for (const bench_info& info : registry()) {
+        std::string name = std::string(info.group) + '/' + info.impl;
+        bool selected = filters.empty();
+        for (const char* filter : filters) {
+            if (name.find(filter) != std::string::npos) {
+                selected = true;
+                break;
+            }
+        }
+        if (!selected) {
+            continue;
+        }
+        if (list_only) {
+            printf("%s\n", name.c_str());
+            continue;
+        }
+        bench::state state(min_time);
+        info.fn(state);
+        double seconds = state.seconds();
+        double items = static_cast<double>(state.items());
+        printf("%s,%s,%llu,%llu,%.6f,%.6g,%.3f,%llu,%llu\n", info.group,
+               info.impl, static_cast<unsigned long long>(state.batches()),
+               static_cast<unsigned long long>(state.items()), seconds,
+               seconds > 0 ? items / seconds : 0.0,
+               items > 0 ? seconds * 1e9 / items : 0.0,
+               static_cast<unsigned long long>(
+                   state.latencies().percentile(50)),
+               static_cast<unsigned long long>(
+                   state.latencies().percentile(99)));
+        fflush(stdout);
+    }
+}
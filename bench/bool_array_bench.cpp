@@ -0,0 +1,145 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  bool_array_bench.cpp
+ *
+ * Micro-benchmarks of bool_array against std::vector<bool>.
+ *
+ * @date  2026-10-15
+ */
+
+#include "nvwa/bool_array.h"
+#include <algorithm>
+#include <stddef.h>
+#include <vector>
+#include "bench.h"
+
+namespace /* unnamed */ {
+
+const size_t bit_count = 1 << 20;
+
+// Sets every third bit; clears the array first
+void set_bool_array(bench::state& state)
+{
+    nvwa::bool_array array(bit_count);
+    while (state.next_batch()) {
+        array.initialize(false);
+        for (size_t i = 0; i < bit_count; i += 3) {
+            array.set(i);
+        }
+        bench::do_not_optimize(array);
+        state.add_items(bit_count);
+    }
+}
+
+void set_vector_bool(bench::state& state)
+{
+    std::vector<bool> array(bit_count);
+    while (state.next_batch()) {
+        std::fill(array.begin(), array.end(), false);
+        for (size_t i = 0; i < bit_count; i += 3) {
+            array[i] = true;
+        }
+        bench::do_not_optimize(array);
+        state.add_items(bit_count);
+    }
+}
+
+template <typename _Array>
+void prepare(_Array& array)
+{
+    for (size_t i = 0; i < bit_count; i += 37) {
+        array[i] = true;
+    }
+}
+
+void count_bool_array(bench::state& state)
+{
+    nvwa::bool_array array(bit_count);
+    array.initialize(false);
+    prepare(array);
+    while (state.next_batch()) {
+        size_t result = array.count();
+        bench::do_not_optimize(result);
+        state.add_items(bit_count);
+    }
+}
+
+void count_vector_bool(bench::state& state)
+{
+    std::vector<bool> array(bit_count);
+    prepare(array);
+    while (state.next_batch()) {
+        size_t result = static_cast<size_t>(
+            std::count(array.begin(), array.end(), true));
+        bench::do_not_optimize(result);
+        state.add_items(bit_count);
+    }
+}
+
+// Visits all set bits
+void find_bool_array(bench::state& state)
+{
+    nvwa::bool_array array(bit_count);
+    array.initialize(false);
+    prepare(array);
+    while (state.next_batch()) {
+        size_t found = 0;
+        for (size_t pos = array.find(true); pos != nvwa::bool_array::npos;
+             pos = array.find(true, pos + 1)) {
+            ++found;
+        }
+        bench::do_not_optimize(found);
+        state.add_items(bit_count);
+    }
+}
+
+void find_vector_bool(bench::state& state)
+{
+    std::vector<bool> array(bit_count);
+    prepare(array);
+    while (state.next_batch()) {
+        size_t found = 0;
+        for (auto it = std::find(array.begin(), array.end(), true);
+             it != array.end(); it = std::find(it + 1, array.end(), true)) {
+            ++found;
+        }
+        bench::do_not_optimize(found);
+        state.add_items(bit_count);
+    }
+}
+
+} /* unnamed namespace */
+
+NVWA_BENCH("bits/set", "nvwa::bool_array", set_bool_array);
+NVWA_BENCH("bits/set", "std::vector<bool>", set_vector_bool);
+NVWA_BENCH("bits/count", "nvwa::bool_array", count_bool_array);
+NVWA_BENCH("bits/count", "std::vector<bool>", count_vector_bool);
+NVWA_BENCH("bits/find", "nvwa::bool_array", find_bool_array);
+NVWA_BENCH("bits/find", "std::vector<bool>", find_vector_bool);
@@ -0,0 +1,148 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  fc_queue_bench.cpp
+ *
+ * Micro-benchmarks of fc_queue against std::deque and
+ * boost::lockfree::spsc_queue.
+ *
+ * @date  2026-10-15
+ */
+
+#include "nvwa/fc_queue.h"
+#include <deque>
+#include <thread>
+#include <boost/lockfree/spsc_queue.hpp>
+#include "bench.h"
+
+namespace /* unnamed */ {
+
+const int queue_capacity = 1024;
+const int batch_size = 256;
+const int transfer_count = 100000;
+
+struct nvwa_queue {
+    nvwa::fc_queue<int> queue{queue_capacity};
+
+    bool write(int value)
+    {
+        return queue.write(value);
+    }
+    bool read(int& value)
+    {
+        return queue.read(value);
+    }
+};
+
+struct boost_queue {
+    boost::lockfree::spsc_queue<int> queue{queue_capacity};
+
+    bool write(int value)
+    {
+        return queue.push(value);
+    }
+    bool read(int& value)
+    {
+        return queue.pop(value);
+    }
+};
+
+struct deque_queue {
+    std::deque<int> queue;
+
+    bool write(int value)
+    {
+        queue.push_back(value);
+        return true;
+    }
+    bool read(int& value)
+    {
+        if (queue.empty()) {
+            return false;
+        }
+        value = queue.front();
+        queue.pop_front();
+        return true;
+    }
+};
+
+// Writes and then reads a batch of elements in one thread
+template <typename _Queue>
+void write_read(bench::state& state)
+{
+    _Queue queue;
+    int value = 0;
+    while (state.next_batch()) {
+        for (int i = 0; i < batch_size; ++i) {
+            queue.write(i);
+        }
+        for (int i = 0; i < batch_size; ++i) {
+            queue.read(value);
+        }
+        bench::do_not_optimize(value);
+        state.add_items(batch_size);
+    }
+}
+
+// Transfers elements from a producer thread to the consumer
+template <typename _Queue>
+void transfer(bench::state& state)
+{
+    _Queue queue;
+    while (state.next_batch()) {
+        std::thread producer([&queue] {
+            for (int i = 0; i < transfer_count; ++i) {
+                while (!queue.write(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        long long sum = 0;
+        int value;
+        for (int i = 0; i < transfer_count; ++i) {
+            while (!queue.read(value)) {
+                std::this_thread::yield();
+            }
+            sum += value;
+        }
+        producer.join();
+        bench::do_not_optimize(sum);
+        state.add_items(transfer_count);
+    }
+}
+
+} /* unnamed namespace */
+
+NVWA_BENCH("queue/write_read", "nvwa::fc_queue", write_read<nvwa_queue>);
+NVWA_BENCH("queue/write_read", "boost::lockfree::spsc_queue",
+           write_read<boost_queue>);
+NVWA_BENCH("queue/write_read", "std::deque", write_read<deque_queue>);
+NVWA_BENCH("queue/spsc_transfer", "nvwa::fc_queue", transfer<nvwa_queue>);
+NVWA_BENCH("queue/spsc_transfer", "boost::lockfree::spsc_queue",
+           transfer<boost_queue>);
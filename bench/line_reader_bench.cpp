@@ -0,0 +1,138 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  line_reader_bench.cpp
+ *
+ * Micro-benchmarks of the line readers against std::getline.
+ *
+ * @date  2026-10-15
+ */
+
+#include "nvwa/file_line_reader.h"
+#include "nvwa/istream_line_reader.h"
+#include "nvwa/mmap_line_reader.h"
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "bench.h"
+
+namespace /* unnamed */ {
+
+// Reads all lines of the file, adding up their lengths
+void file_line_reader_lines(bench::state& state)
+{
+    while (state.next_batch()) {
+        FILE* fp = fopen(bench::line_file_path(), "r");
+        nvwa::file_line_reader reader(fp);
+        size_t lines = 0;
+        size_t total = 0;
+        for (const char* line : reader) {
+            total += strlen(line);
+            ++lines;
+        }
+        fclose(fp);
+        bench::do_not_optimize(total);
+        state.add_items(lines);
+    }
+}
+
+void file_line_reader_views(bench::state& state)
+{
+    while (state.next_batch()) {
+        FILE* fp = fopen(bench::line_file_path(), "r");
+        nvwa::file_line_reader reader(fp);
+        size_t lines = 0;
+        size_t total = 0;
+        for (auto line : reader.views()) {
+            total += line.size();
+            ++lines;
+        }
+        fclose(fp);
+        bench::do_not_optimize(total);
+        state.add_items(lines);
+    }
+}
+
+void mmap_line_reader_views(bench::state& state)
+{
+    while (state.next_batch()) {
+        nvwa::mmap_line_reader_sv reader(bench::line_file_path());
+        size_t lines = 0;
+        size_t total = 0;
+        for (const auto& line : reader) {
+            total += line.size();
+            ++lines;
+        }
+        bench::do_not_optimize(total);
+        state.add_items(lines);
+    }
+}
+
+void istream_line_reader_lines(bench::state& state)
+{
+    while (state.next_batch()) {
+        std::ifstream ifs(bench::line_file_path());
+        size_t lines = 0;
+        size_t total = 0;
+        for (const auto& line : nvwa::istream_line_reader(ifs)) {
+            total += line.size();
+            ++lines;
+        }
+        bench::do_not_optimize(total);
+        state.add_items(lines);
+    }
+}
+
+void getline_lines(bench::state& state)
+{
+    std::string line;
+    while (state.next_batch()) {
+        std::ifstream ifs(bench::line_file_path());
+        size_t lines = 0;
+        size_t total = 0;
+        while (std::getline(ifs, line)) {
+            total += line.size();
+            ++lines;
+        }
+        bench::do_not_optimize(total);
+        state.add_items(lines);
+    }
+}
+
+} /* unnamed namespace */
+
+NVWA_BENCH("lines/read", "nvwa::file_line_reader", file_line_reader_lines);
+NVWA_BENCH("lines/read", "nvwa::file_line_reader::views",
+           file_line_reader_views);
+NVWA_BENCH("lines/read", "nvwa::mmap_line_reader_sv",
+           mmap_line_reader_views);
+NVWA_BENCH("lines/read", "nvwa::istream_line_reader",
+           istream_line_reader_lines);
+NVWA_BENCH("lines/read", "std::getline", getline_lines);
@@ -0,0 +1,111 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  mem_pool_bench.cpp
+ *
+ * Micro-benchmarks of the memory pools against malloc and operator
+ * new.
+ *
+ * @date  2026-10-15
+ */
+
+#include "nvwa/fixed_mem_pool.h"
+#include "nvwa/static_mem_pool.h"
+#include <new>
+#include <stddef.h>
+#include <stdlib.h>
+#include "bench.h"
+
+namespace /* unnamed */ {
+
+const int block_count = 256;
+const size_t block_size = 64;
+
+struct block {
+    char data[block_size];
+};
+
+// Allocates a batch of blocks and frees them in reverse order
+template <typename _Alloc, typename _Free>
+void alloc_free(bench::state& state, _Alloc alloc, _Free free_block)
+{
+    void* blocks[block_count];
+    while (state.next_batch()) {
+        for (int i = 0; i < block_count; ++i) {
+            blocks[i] = alloc();
+        }
+        bench::do_not_optimize(blocks);
+        for (int i = block_count - 1; i >= 0; --i) {
+            free_block(blocks[i]);
+        }
+        state.add_items(block_count);
+    }
+}
+
+void static_mem_pool_alloc_free(bench::state& state)
+{
+    auto& pool = nvwa::static_mem_pool<block_size>::instance();
+    alloc_free(
+        state, [&pool] { return pool.allocate(); },
+        [&pool](void* ptr) { pool.deallocate(ptr); });
+}
+
+void fixed_mem_pool_alloc_free(bench::state& state)
+{
+    typedef nvwa::fixed_mem_pool<block> pool;
+    if (!pool::is_initialized()) {
+        pool::initialize(block_count);
+    }
+    alloc_free(
+        state, [] { return pool::allocate(); },
+        [](void* ptr) { pool::deallocate(ptr); });
+}
+
+void malloc_alloc_free(bench::state& state)
+{
+    alloc_free(
+        state, [] { return malloc(block_size); },
+        [](void* ptr) { free(ptr); });
+}
+
+void new_alloc_free(bench::state& state)
+{
+    alloc_free(
+        state, [] { return ::operator new(block_size); },
+        [](void* ptr) { ::operator delete(ptr); });
+}
+
+} /* unnamed namespace */
+
+NVWA_BENCH("pool/alloc_free", "nvwa::static_mem_pool",
+           static_mem_pool_alloc_free);
+NVWA_BENCH("pool/alloc_free", "nvwa::fixed_mem_pool",
+           fixed_mem_pool_alloc_free);
+NVWA_BENCH("pool/alloc_free", "malloc", malloc_alloc_free);
+NVWA_BENCH("pool/alloc_free", "operator new", new_alloc_free);
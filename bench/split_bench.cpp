@@ -0,0 +1,139 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  split_bench.cpp
+ *
+ * Micro-benchmarks of the split functions against std::getline and
+ * std::string::find.
+ *
+ * @date  2026-10-15
+ */
+
+#include "nvwa/split.h"
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "bench.h"
+
+namespace /* unnamed */ {
+
+const int line_count = 1000;
+const std::string line =
+    "1024,alpha,3.14159,beta,65536,gamma,,delta,42,epsilon,"
+    "2.71828,zeta,eta,99999,theta,iota";
+
+// Splits a line into fields, touching each field
+void split_views(bench::state& state)
+{
+    while (state.next_batch()) {
+        size_t total = 0;
+        for (int i = 0; i < line_count; ++i) {
+            for (std::string_view field : nvwa::split(line, ',')) {
+                total += field.size();
+            }
+        }
+        bench::do_not_optimize(total);
+        state.add_items(line_count);
+    }
+}
+
+void split_into_vector(bench::state& state)
+{
+    std::vector<std::string_view> fields;
+    while (state.next_batch()) {
+        size_t total = 0;
+        for (int i = 0; i < line_count; ++i) {
+            nvwa::split(line, ',').split_into(fields);
+            total += fields.size();
+        }
+        bench::do_not_optimize(total);
+        state.add_items(line_count);
+    }
+}
+
+void split_n_array(bench::state& state)
+{
+    while (state.next_batch()) {
+        size_t total = 0;
+        for (int i = 0; i < line_count; ++i) {
+            auto fields = nvwa::split_n<16>(line, ',');
+            total += fields.size();
+        }
+        bench::do_not_optimize(total);
+        state.add_items(line_count);
+    }
+}
+
+void getline_strings(bench::state& state)
+{
+    std::string field;
+    while (state.next_batch()) {
+        size_t total = 0;
+        for (int i = 0; i < line_count; ++i) {
+            std::istringstream is(line);
+            while (std::getline(is, field, ',')) {
+                total += field.size();
+            }
+        }
+        bench::do_not_optimize(total);
+        state.add_items(line_count);
+    }
+}
+
+void find_substr(bench::state& state)
+{
+    std::vector<std::string> fields;
+    while (state.next_batch()) {
+        size_t total = 0;
+        for (int i = 0; i < line_count; ++i) {
+            fields.clear();
+            size_t pos = 0;
+            for (;;) {
+                size_t next = line.find(',', pos);
+                fields.push_back(line.substr(pos, next - pos));
+                if (next == std::string::npos) {
+                    break;
+                }
+                pos = next + 1;
+            }
+            total += fields.size();
+        }
+        bench::do_not_optimize(total);
+        state.add_items(line_count);
+    }
+}
+
+} /* unnamed namespace */
+
+NVWA_BENCH("split/fields", "nvwa::split", split_views);
+NVWA_BENCH("split/fields", "nvwa::split_into", split_into_vector);
+NVWA_BENCH("split/fields", "nvwa::split_n", split_n_array);
+NVWA_BENCH("split/fields", "std::getline", getline_strings);
+NVWA_BENCH("split/fields", "std::string::find", find_substr);
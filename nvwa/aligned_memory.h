@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2022 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2022-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -29,9 +29,10 @@
 /**
  * @file  aligned_memory.h
  *
- * Header file for aligned memory allocation/deallocation.
+ * Header file for aligned memory allocation/deallocation, and for
+ * allocation backed by huge (large) pages.
  *
- * @date  2022-01-03
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_ALIGNED_MEMORY_H
@@ -45,6 +46,10 @@ NVWA_NAMESPACE_BEGIN
 void* aligned_malloc(size_t size, size_t alignment);
 void aligned_free(void* ptr);
 
+size_t huge_page_size();
+void* huge_page_malloc(size_t size);
+void huge_page_free(void* ptr, size_t size);
+
 NVWA_NAMESPACE_END
 
 #endif // NVWA_ALIGNED_MEMORY_H
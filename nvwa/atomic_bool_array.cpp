@@ -0,0 +1,248 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  atomic_bool_array.cpp
+ *
+ * Code for class atomic_bool_array (packed boolean array that allows
+ * concurrent access).  The current code requires a C++17-compliant
+ * compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#include "atomic_bool_array.h"  // atomic_bool_array
+#include <assert.h>             // assert
+#include <bitset>               // std::bitset
+#include <new>                  // std::bad_alloc/placement new
+#include <stdexcept>            // std::out_of_range
+#include <thread>               // std::thread
+#include <vector>               // std::vector
+#include "_nvwa.h"              // NVWA macros
+#include "aligned_memory.h"     // nvwa::aligned_malloc/aligned_free
+
+#ifndef NVWA_ATOMIC_BOOL_ARRAY_WORDS_PER_THREAD
+/**
+ * Minimum number of words a thread shall count, below which starting a
+ * thread costs more than it saves.
+ */
+#define NVWA_ATOMIC_BOOL_ARRAY_WORDS_PER_THREAD (64 * 1024)
+#endif
+
+NVWA_NAMESPACE_BEGIN
+
+namespace {
+
+/** Alignment of the storage, which is a cache line on most processors. */
+constexpr size_t storage_alignment = 64;
+
+/**
+ * Counts the 1-bits in atomic words with relaxed loads.
+ *
+ * @param ptr       pointer to the first word
+ * @param word_cnt  number of words to count
+ * @return          the count of 1-bits
+ */
+size_t count_bits_in_words(const std::atomic<uint64_t>* ptr,
+                           size_t word_cnt) noexcept
+{
+    size_t true_cnt = 0;
+    for (size_t i = 0; i < word_cnt; ++i) {
+        true_cnt += std::bitset<64>(ptr[i].load(std::memory_order_relaxed))
+                        .count();
+    }
+    return true_cnt;
+}
+
+} /* unnamed namespace */
+
+/**
+ * Constructs an atomic_bool_array with a specific size.  All elements
+ * are \c false.
+ *
+ * @param size          size of the array
+ * @throw out_of_range  \a size equals \c 0
+ * @throw bad_alloc     memory is insufficient
+ */
+atomic_bool_array::atomic_bool_array(size_type size)
+{
+    if (size == 0) {
+        throw std::out_of_range("invalid atomic_bool_array size");
+    }
+    if (!create(size)) {
+        throw std::bad_alloc();
+    }
+}
+
+/**
+ * Destroys the atomic_bool_array and releases memory.
+ */
+atomic_bool_array::~atomic_bool_array()
+{
+    aligned_free(_M_word_ptr);
+}
+
+/**
+ * Creates the packed boolean array with a specific size.  All elements
+ * are \c false.  It shall not be called when other threads are
+ * accessing the array.
+ *
+ * @param size  size of the array
+ * @return      \c false if \a size equals \c 0 or is too big, or if
+ *              memory is insufficient; \c true if \a size has a
+ *              suitable value and memory allocation is successful.
+ */
+bool atomic_bool_array::create(size_type size) noexcept
+{
+    static_assert(std::atomic<word>::is_always_lock_free,
+                  "atomic_bool_array requires lock-free 64-bit atomics");
+    if (size == 0 || size > size_type(-1) - 63) {
+        return false;
+    }
+    size_t word_cnt = bool_array::get_num_words_from_bits(size);
+    if (word_cnt > size_t(-1) / sizeof(word) - storage_alignment) {
+        return false;
+    }
+    // Whole cache lines are allocated, as aligned_alloc requires
+    size_t alloc_size = (word_cnt * sizeof(word) + storage_alignment - 1) &
+                        ~(storage_alignment - 1);
+    void* ptr = aligned_malloc(alloc_size, storage_alignment);
+    if (ptr == nullptr) {
+        return false;
+    }
+    auto word_ptr = static_cast<atomic_word*>(ptr);
+    for (size_t i = 0; i < word_cnt; ++i) {
+        new (word_ptr + i) atomic_word(0);
+    }
+
+    aligned_free(_M_word_ptr);
+
+    _M_word_ptr = word_ptr;
+    _M_length = size;
+    return true;
+}
+
+/**
+ * Initializes all array elements to a specific value.  It shall not be
+ * called when other threads are accessing the array.
+ *
+ * @param value  the boolean value to assign to all elements
+ */
+void atomic_bool_array::initialize(bool value) noexcept
+{
+    assert(_M_word_ptr);
+    size_t word_cnt = bool_array::get_num_words_from_bits(_M_length);
+    for (size_t i = 0; i < word_cnt; ++i) {
+        _M_word_ptr[i].store(value ? ~word(0) : 0, std::memory_order_relaxed);
+    }
+    unsigned valid_bits_in_last_word = _M_length % 64;
+    if (value && valid_bits_in_last_word != 0) {
+        _M_word_ptr[word_cnt - 1].store(
+            ~(~word(0) << valid_bits_in_last_word), std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Counts elements with a \c true value.  Large arrays are split among
+ * multiple threads.  The result is exact if no other threads are
+ * modifying the array; otherwise each element is counted according to
+ * its value at some point during the call.
+ *
+ * @param max_threads   maximum number of threads to use (including the
+ *                      calling thread); \c 0 means the number of
+ *                      hardware threads
+ * @return              the count of \c true elements
+ * @throw system_error  a thread cannot be started
+ */
+atomic_bool_array::size_type atomic_bool_array::count(
+        unsigned max_threads) const
+{
+    assert(_M_word_ptr);
+    size_t word_cnt = bool_array::get_num_words_from_bits(_M_length);
+    if (max_threads == 0) {
+        max_threads = std::thread::hardware_concurrency();
+    }
+    size_t thread_cnt = word_cnt / NVWA_ATOMIC_BOOL_ARRAY_WORDS_PER_THREAD;
+    if (thread_cnt > max_threads) {
+        thread_cnt = max_threads;
+    }
+    if (thread_cnt <= 1) {
+        return count_bits_in_words(_M_word_ptr, word_cnt);
+    }
+
+    // Chunks are rounded to cache lines to avoid false sharing
+    size_t words_per_cache_line = storage_alignment / sizeof(word);
+    size_t chunk_size = (word_cnt / thread_cnt + words_per_cache_line - 1) &
+                        ~(words_per_cache_line - 1);
+    std::vector<size_t> results(thread_cnt - 1);
+    std::vector<std::thread> threads;
+    threads.reserve(thread_cnt - 1);
+    try {
+        for (size_t i = 0; i < thread_cnt - 1; ++i) {
+            threads.emplace_back([this, i, chunk_size, &results] {
+                results[i] =
+                    count_bits_in_words(_M_word_ptr + i * chunk_size,
+                                        chunk_size);
+            });
+        }
+    } catch (...) {
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        throw;
+    }
+    size_t begin = (thread_cnt - 1) * chunk_size;
+    assert(begin <= word_cnt);
+    size_type true_cnt =
+        count_bits_in_words(_M_word_ptr + begin, word_cnt - begin);
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+        true_cnt += results[i];
+    }
+    return true_cnt;
+}
+
+/**
+ * Copies the elements to a bool_array.  Each element is copied
+ * according to its value at some point during the call.
+ *
+ * @return           a bool_array of the same size and elements
+ * @throw bad_alloc  memory is insufficient
+ */
+bool_array atomic_bool_array::snapshot() const
+{
+    assert(_M_word_ptr);
+    bool_array result(_M_length);
+    size_t word_cnt = bool_array::get_num_words_from_bits(_M_length);
+    for (size_t i = 0; i < word_cnt; ++i) {
+        result._M_word_ptr[i] = _M_word_ptr[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+NVWA_NAMESPACE_END
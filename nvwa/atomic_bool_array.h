@@ -0,0 +1,276 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  atomic_bool_array.h
+ *
+ * Header file for class atomic_bool_array (packed boolean array that
+ * allows concurrent access).  Using this file requires a C++17-compliant
+ * compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_ATOMIC_BOOL_ARRAY_H
+#define NVWA_ATOMIC_BOOL_ARRAY_H
+
+#include <assert.h>             // assert
+#include <atomic>               // std::atomic/memory_order
+#include <stdexcept>            // std::out_of_range
+#include <stddef.h>             // size_t
+#include <stdint.h>             // uint64_t
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "bool_array.h"         // nvwa::bool_array
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class to represent a packed boolean array whose elements can be set,
+ * reset, and tested by multiple threads at the same time without a
+ * lock.  The bits are stored in atomic 64-bit words aligned to a cache
+ * line, like bool_array.  Creation, #initialize, and destruction shall
+ * not be concurrent with other operations.
+ *
+ * The element operations use relaxed memory order by default, which is
+ * sufficient for a shared visited set, where only the bit itself
+ * matters.  A stronger order can be specified when a bit is used to
+ * publish other data.
+ */
+class atomic_bool_array {
+public:
+    typedef bool_array::size_type size_type;    ///< Type of array indices
+
+    /** Constant representing `not found'. */
+    static constexpr auto npos = size_type(-1);
+
+    atomic_bool_array() noexcept;
+    explicit atomic_bool_array(size_type size);
+    ~atomic_bool_array();
+
+    atomic_bool_array(const atomic_bool_array&) = delete;
+    atomic_bool_array& operator=(const atomic_bool_array&) = delete;
+
+    bool create(size_type size) noexcept;
+    void initialize(bool value) noexcept;
+
+    bool operator[](size_type pos) const noexcept;
+    bool at(size_type pos) const;
+    bool test(size_type pos,
+              std::memory_order order = std::memory_order_relaxed) const;
+    void set(size_type pos,
+             std::memory_order order = std::memory_order_relaxed);
+    void reset(size_type pos,
+               std::memory_order order = std::memory_order_relaxed);
+    bool test_and_set(size_type pos,
+                      std::memory_order order = std::memory_order_relaxed);
+    bool test_and_reset(size_type pos,
+                        std::memory_order order = std::memory_order_relaxed);
+
+    size_type size() const noexcept;
+    size_type count(unsigned max_threads = 0) const;
+    bool_array snapshot() const;
+
+private:
+    typedef uint64_t             word;
+    typedef std::atomic<word>    atomic_word;
+
+    static std::memory_order load_order(std::memory_order order) noexcept;
+    void check_pos(size_type pos) const;
+
+    atomic_word* _M_word_ptr{};
+    size_type    _M_length{};
+};
+
+
+/* Inline functions */
+
+/**
+ * Constructs an empty atomic_bool_array.
+ */
+inline atomic_bool_array::atomic_bool_array() noexcept = default;
+
+/**
+ * Reads the boolean value of an array element, with relaxed memory
+ * order.
+ *
+ * @param pos  position of the array element to access
+ * @return     the boolean value of the accessed array element
+ */
+inline bool atomic_bool_array::operator[](size_type pos) const noexcept
+{
+    assert(_M_word_ptr);
+    assert(pos < _M_length);
+    return bool(_M_word_ptr[pos / 64].load(std::memory_order_relaxed) &
+                (word(1) << (pos % 64)));
+}
+
+/**
+ * Reads the boolean value of an array element at a specified position,
+ * with relaxed memory order.
+ *
+ * @param pos           position of the array element to access
+ * @return              the boolean value of the accessed array element
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+inline bool atomic_bool_array::at(size_type pos) const
+{
+    return test(pos);
+}
+
+/**
+ * Reads the boolean value of an array element at a specified position.
+ *
+ * @param pos           position of the array element to access
+ * @param order         memory order of the load
+ * @return              the boolean value of the accessed array element
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+inline bool atomic_bool_array::test(size_type pos,
+                                    std::memory_order order) const
+{
+    check_pos(pos);
+    return bool(_M_word_ptr[pos / 64].load(load_order(order)) &
+                (word(1) << (pos % 64)));
+}
+
+/**
+ * Sets an array element to \c true at a specified position.
+ *
+ * @param pos           position of the array element to access
+ * @param order         memory order of the atomic operation
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+inline void atomic_bool_array::set(size_type pos, std::memory_order order)
+{
+    check_pos(pos);
+    _M_word_ptr[pos / 64].fetch_or(word(1) << (pos % 64), order);
+}
+
+/**
+ * Resets an array element to \c false at a specified position.
+ *
+ * @param pos           position of the array element to access
+ * @param order         memory order of the atomic operation
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+inline void atomic_bool_array::reset(size_type pos, std::memory_order order)
+{
+    check_pos(pos);
+    _M_word_ptr[pos / 64].fetch_and(~(word(1) << (pos % 64)), order);
+}
+
+/**
+ * Sets an array element to \c true and returns its previous value.
+ * Exactly one of the threads setting the same element concurrently
+ * gets \c false.  An element already \c true is detected with a plain
+ * load, so that testing visited elements does not cause contention on
+ * the cache line.
+ *
+ * @param pos           position of the array element to access
+ * @param order         memory order of the atomic operation
+ * @return              the value of the element before the operation
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+inline bool atomic_bool_array::test_and_set(size_type pos,
+                                            std::memory_order order)
+{
+    check_pos(pos);
+    atomic_word& target = _M_word_ptr[pos / 64];
+    word mask = word(1) << (pos % 64);
+    if (target.load(load_order(order)) & mask) {
+        return true;
+    }
+    return bool(target.fetch_or(mask, order) & mask);
+}
+
+/**
+ * Resets an array element to \c false and returns its previous value.
+ *
+ * @param pos           position of the array element to access
+ * @param order         memory order of the atomic operation
+ * @return              the value of the element before the operation
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+inline bool atomic_bool_array::test_and_reset(size_type pos,
+                                              std::memory_order order)
+{
+    check_pos(pos);
+    atomic_word& target = _M_word_ptr[pos / 64];
+    word mask = word(1) << (pos % 64);
+    if (!(target.load(load_order(order)) & mask)) {
+        return false;
+    }
+    return bool(target.fetch_and(~mask, order) & mask);
+}
+
+/**
+ * Gets the size of the atomic_bool_array.
+ *
+ * @return  the number of bits of the atomic_bool_array
+ */
+inline atomic_bool_array::size_type atomic_bool_array::size() const noexcept
+{
+    return _M_length;
+}
+
+/**
+ * Gets the memory order usable for a load that corresponds to the
+ * order of a read-modify-write operation.
+ *
+ * @param order  memory order of the read-modify-write operation
+ * @return       memory order for the load
+ */
+inline std::memory_order
+atomic_bool_array::load_order(std::memory_order order) noexcept
+{
+    switch (order) {
+    case std::memory_order_release:
+        return std::memory_order_relaxed;
+    case std::memory_order_acq_rel:
+        return std::memory_order_acquire;
+    default:
+        return order;
+    }
+}
+
+/**
+ * Checks whether a position is within the array.
+ *
+ * @param pos           position of the array element to access
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+inline void atomic_bool_array::check_pos(size_type pos) const
+{
+    if (pos >= _M_length) {
+        throw std::out_of_range("invalid atomic_bool_array position");
+    }
+}
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_ATOMIC_BOOL_ARRAY_H
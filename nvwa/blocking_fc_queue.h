@@ -0,0 +1,279 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  blocking_fc_queue.h
+ *
+ * Definition of a blocking front-end of the fixed-capacity queues.
+ * Using this file requires a C++17-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_BLOCKING_FC_QUEUE_H
+#define NVWA_BLOCKING_FC_QUEUE_H
+
+#include <atomic>               // std::atomic/atomic_thread_fence
+#include <chrono>               // std::chrono::duration/steady_clock
+#include <condition_variable>   // std::condition_variable
+#include <mutex>                // std::mutex/lock_guard/unique_lock
+#include <utility>              // std::forward/move
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "fc_queue.h"           // nvwa::fc_queue/mpmc_fc_queue
+
+#ifndef NVWA_BLOCKING_FC_QUEUE_SPIN_COUNT
+/**
+ * Number of times a blocking operation retries before the thread is
+ * parked.
+ */
+#define NVWA_BLOCKING_FC_QUEUE_SPIN_COUNT 100
+#endif
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class to add blocking operations to a fixed-capacity queue.  A
+ * blocking operation first retries the non-blocking one for a while,
+ * and then parks the thread until the queue changes or the timeout
+ * expires.  The non-blocking operations wake up parked threads, which
+ * costs only an atomic load when no threads are parked.  Operations of
+ * the underlying queue shall not be called directly, as they would not
+ * wake up parked threads.
+ *
+ * @param _Queue  the underlying queue type, fc_queue (for one producer
+ *                and one consumer) or mpmc_fc_queue
+ */
+template <class _Queue>
+class blocking_fc_queue {
+public:
+    typedef _Queue                                    queue_type;
+    typedef typename queue_type::value_type           value_type;
+    typedef typename queue_type::size_type            size_type;
+    typedef typename queue_type::reference            reference;
+    typedef std::chrono::steady_clock                 clock_type;
+
+    /**
+     * Constructor that creates the underlying queue.
+     *
+     * @param args  arguments to construct the underlying queue, usually
+     *              the capacity and the allocator
+     */
+    template <typename... _Targs>
+    explicit blocking_fc_queue(_Targs&&... args)
+        : _M_queue(std::forward<_Targs>(args)...)
+    {
+    }
+
+    blocking_fc_queue(const blocking_fc_queue&) = delete;
+    blocking_fc_queue& operator=(const blocking_fc_queue&) = delete;
+
+    /** Checks whether the queue is empty. */
+    bool empty() const noexcept
+    {
+        return _M_queue.empty();
+    }
+    /** Checks whether the queue is full. */
+    bool full() const noexcept
+    {
+        return _M_queue.full();
+    }
+    /** Gets the maximum number of allowed elements. */
+    size_type capacity() const noexcept
+    {
+        return _M_queue.capacity();
+    }
+    /** Gets the number of existing elements. */
+    size_type size() const noexcept
+    {
+        return _M_queue.size();
+    }
+
+    /**
+     * Inserts a new element at the end of the queue, if it is not full.
+     *
+     * @param args  arguments to construct a new element
+     * @return      \c true if the new element is successfully inserted;
+     *              \c false if the queue is full
+     */
+    template <typename... _Targs>
+    bool write(_Targs&&... args)
+    {
+        if (!_M_queue.write(std::forward<_Targs>(args)...)) {
+            return false;
+        }
+        notify(_M_readers_waiting, _M_not_empty);
+        return true;
+    }
+
+    /**
+     * Moves the first element in the queue to the destination, if the
+     * queue is not empty.
+     *
+     * @param[out] dest  destination to store the element
+     * @return           \c true if an element is moved out of the
+     *                   queue; \c false if the queue is empty
+     */
+    bool read(reference dest)
+    {
+        if (!_M_queue.read(dest)) {
+            return false;
+        }
+        notify(_M_writers_waiting, _M_not_full);
+        return true;
+    }
+
+    /**
+     * Inserts a new element at the end of the queue, waiting while the
+     * queue is full.
+     *
+     * @param value  the element to insert
+     */
+    void push_wait(value_type value)
+    {
+        wait_until(
+            [&] { return _M_queue.write(std::move(value)); },
+            _M_writers_waiting, _M_not_full, nullptr);
+        notify(_M_readers_waiting, _M_not_empty);
+    }
+
+    /**
+     * Inserts a new element at the end of the queue, waiting while the
+     * queue is full, but not longer than the specified duration.
+     *
+     * @param value    the element to insert
+     * @param timeout  maximum time to wait
+     * @return         \c true if the new element is successfully
+     *                 inserted; \c false if the queue remains full
+     */
+    template <class _Rep, class _Period>
+    bool push_wait_for(value_type value,
+                       const std::chrono::duration<_Rep, _Period>& timeout)
+    {
+        auto deadline = clock_type::now() + timeout;
+        if (!wait_until(
+                [&] { return _M_queue.write(std::move(value)); },
+                _M_writers_waiting, _M_not_full, &deadline)) {
+            return false;
+        }
+        notify(_M_readers_waiting, _M_not_empty);
+        return true;
+    }
+
+    /**
+     * Moves the first element in the queue to the destination, waiting
+     * while the queue is empty.
+     *
+     * @param[out] dest  destination to store the element
+     */
+    void pop_wait(reference dest)
+    {
+        wait_until([&] { return _M_queue.read(dest); },
+                   _M_readers_waiting, _M_not_empty, nullptr);
+        notify(_M_writers_waiting, _M_not_full);
+    }
+
+    /**
+     * Moves the first element in the queue to the destination, waiting
+     * while the queue is empty, but not longer than the specified
+     * duration.
+     *
+     * @param[out] dest     destination to store the element
+     * @param      timeout  maximum time to wait
+     * @return              \c true if an element is moved out of the
+     *                      queue; \c false if the queue remains empty
+     */
+    template <class _Rep, class _Period>
+    bool pop_wait_for(reference dest,
+                      const std::chrono::duration<_Rep, _Period>& timeout)
+    {
+        auto deadline = clock_type::now() + timeout;
+        if (!wait_until([&] { return _M_queue.read(dest); },
+                        _M_readers_waiting, _M_not_empty, &deadline)) {
+            return false;
+        }
+        notify(_M_writers_waiting, _M_not_full);
+        return true;
+    }
+
+private:
+    template <typename _Op>
+    bool wait_until(_Op op, std::atomic<unsigned>& waiting,
+                    std::condition_variable& cond,
+                    const clock_type::time_point* deadline)
+    {
+        for (int i = 0; i < NVWA_BLOCKING_FC_QUEUE_SPIN_COUNT; ++i) {
+            if (op()) {
+                return true;
+            }
+        }
+        std::unique_lock<std::mutex> guard(_M_lock);
+        waiting.fetch_add(1);
+        // Pairs with the fence in notify: either op sees the change, or
+        // the notifier sees the waiting count
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool result;
+        for (;;) {
+            if (op()) {
+                result = true;
+                break;
+            }
+            if (deadline == nullptr) {
+                cond.wait(guard);
+            } else if (cond.wait_until(guard, *deadline) ==
+                       std::cv_status::timeout) {
+                result = op();
+                break;
+            }
+        }
+        waiting.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    void notify(std::atomic<unsigned>& waiting,
+                std::condition_variable& cond)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) != 0) {
+            // A waiter holds the lock from its last check until it
+            // waits, so taking the lock here prevents a lost wake-up
+            { std::lock_guard<std::mutex> guard(_M_lock); }
+            cond.notify_one();
+        }
+    }
+
+    queue_type              _M_queue;
+    std::atomic<unsigned>   _M_readers_waiting{};
+    std::atomic<unsigned>   _M_writers_waiting{};
+    std::mutex              _M_lock;
+    std::condition_variable _M_not_empty;
+    std::condition_variable _M_not_full;
+};
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_BLOCKING_FC_QUEUE_H
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -32,19 +32,21 @@
  * Code for class bool_array (packed boolean array).  The current code
  * requires a C++14-compliant compiler.
  *
- * @date  2024-05-20
+ * @date  2026-10-14
  */
 
 #include "bool_array.h"         // bool_array
 #include "assert.h"             // assert
 #include <limits.h>             // UINT_MAX, ULONG_MAX
+#include <stdint.h>             // uint64_t
 #include <string.h>             // memset/memcpy/size_t
-#include <array>                // std::array
-#include <new>                  // std::bad_alloc/nothrow
+#include <algorithm>            // std::min
+#include <new>                  // std::bad_alloc
 #include <ostream>              // std::ostream
 #include <stdexcept>            // std::out_of_range
-#include <utility>              // std::index_sequence/swap
+#include <utility>              // std::swap
 #include "_nvwa.h"              // NVWA macros
+#include "aligned_memory.h"     // nvwa::aligned_malloc/aligned_free
 #include "c++_features.h"       // NVWA_USES_CXX20
 #include "static_assert.h"      // STATIC_ASSERT
 
@@ -105,58 +107,202 @@ popcount(unsigned long long x)
 #endif
 #endif
 
+// Word-wide kernels for specific instruction sets are selected at run
+// time, so that they can be used without compiling the whole program
+// for the newest processors.
+#ifndef NVWA_USES_SIMD_DISPATCH
+#if (NVWA_GCC || NVWA_CLANG) && (defined(__x86_64__) || defined(__i386__))
+#define NVWA_USES_SIMD_DISPATCH 1
+#else
+#define NVWA_USES_SIMD_DISPATCH 0
+#endif
+#endif
+
+#if NVWA_USES_SIMD_DISPATCH
+#include <immintrin.h>          // AVX2/AVX-512 intrinsics
+#endif
+
 NVWA_NAMESPACE_BEGIN
 
 namespace {
 
-// Calculates how many 1-bits there are in a given byte.
-constexpr int count_bits(unsigned char value)
+/** Alignment of the storage, which is a cache line on most processors. */
+constexpr size_t storage_alignment = 64;
+
+/**
+ * Loads 64 bits from a possibly unaligned byte address, so that bit \e n
+ * of the result is the bit at offset \e n of the bitmap.
+ */
+inline uint64_t load_word(const unsigned char* ptr)
 {
-    if (value == 0) {
-        return 0;
-    } else {
-        return (value & 1) + count_bits(value >> 1);
+    uint64_t value;
+    memcpy(&value, ptr, sizeof value);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+/** Stores 64 bits in the layout used by load_word. */
+inline void store_word(unsigned char* ptr, uint64_t value)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    memcpy(ptr, &value, sizeof value);
+}
+
+/** Calculates how many 1-bits there are in a 64-bit word. */
+inline int count_bits_in_word(uint64_t value)
+{
+#if NVWA_USES_POPCOUNT
+    if (sizeof(size_t) >= sizeof(uint64_t)) {
+        return popcount(static_cast<size_t>(value));
     }
+    return popcount(static_cast<size_t>(value)) +
+           popcount(static_cast<size_t>(value >> 32));
+#else
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) +
+            ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((value * 0x0101010101010101ULL) >> 56);
+#endif
 }
 
-// Calculates at which offset the first 1-bit is for a given byte.
-// The value for 0 indicates it is invalid (all bits are 0s).
-constexpr int first_bit_one_offset(unsigned char value)
+/** Calculates at which offset the first 1-bit is in a non-zero word. */
+inline int first_bit_one_offset(uint64_t value)
 {
-    if (value == 0) {
-        return 9;
-    } else if (value & 1) {
-        return 0;
-    } else {
-        return 1 + first_bit_one_offset(value >> 1);
+    assert(value != 0);
+#if NVWA_GCC || NVWA_CLANG
+    return __builtin_ctzll(value);
+#else
+    int offset = 0;
+    while ((value & 0xFF) == 0) {
+        value >>= 8;
+        offset += 8;
     }
+    while ((value & 1) == 0) {
+        value >>= 1;
+        ++offset;
+    }
+    return offset;
+#endif
 }
 
-template <size_t... _V>
-constexpr auto get_bit_count(std::index_sequence<_V...>)
+/** Counts the 1-bits in 64-bit words, without special instructions. */
+size_t count_bits_in_words_generic(const uint64_t* ptr, size_t word_cnt)
 {
-    return std::array<unsigned char, sizeof...(_V)>{
-        static_cast<unsigned char>(count_bits(_V))...};
+    size_t true_cnt = 0;
+    for (size_t i = 0; i < word_cnt; ++i) {
+        true_cnt += count_bits_in_word(ptr[i]);
+    }
+    return true_cnt;
 }
 
-template <size_t... _V>
-constexpr auto get_bit_ordinal(std::index_sequence<_V...>)
+#if NVWA_USES_SIMD_DISPATCH
+__attribute__((target("popcnt")))
+size_t count_bits_in_words_popcnt(const uint64_t* ptr, size_t word_cnt)
 {
-    return std::array<unsigned char, sizeof...(_V)>{
-        static_cast<unsigned char>(first_bit_one_offset(_V))...};
+    size_t true_cnt = 0;
+    for (size_t i = 0; i < word_cnt; ++i) {
+        true_cnt += __builtin_popcountll(ptr[i]);
+    }
+    return true_cnt;
 }
 
-/**
- * Object that contains pre-calculated values how many 1-bits there are
- * in a given byte.
- */
-auto _S_bit_count = get_bit_count(std::make_index_sequence<256>());
+// Counts with byte-wise nibble lookups (the Mula method)
+__attribute__((target("avx2,popcnt")))
+size_t count_bits_in_words_avx2(const uint64_t* ptr, size_t word_cnt)
+{
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i total = zero;
+    size_t i = 0;
+    while (i + 4 <= word_cnt) {
+        // Byte counters would overflow after 31 rounds
+        __m256i partial = zero;
+        for (int round = 0; round < 31 && i + 4 <= word_cnt;
+             ++round, i += 4) {
+            __m256i value = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(ptr + i));
+            __m256i low = _mm256_and_si256(value, low_mask);
+            __m256i high =
+                _mm256_and_si256(_mm256_srli_epi16(value, 4), low_mask);
+            partial = _mm256_add_epi8(
+                partial,
+                _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                _mm256_shuffle_epi8(lookup, high)));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(partial, zero));
+    }
+    size_t true_cnt = static_cast<size_t>(_mm256_extract_epi64(total, 0)) +
+                      static_cast<size_t>(_mm256_extract_epi64(total, 1)) +
+                      static_cast<size_t>(_mm256_extract_epi64(total, 2)) +
+                      static_cast<size_t>(_mm256_extract_epi64(total, 3));
+    for (; i < word_cnt; ++i) {
+        true_cnt += __builtin_popcountll(ptr[i]);
+    }
+    return true_cnt;
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+size_t count_bits_in_words_avx512(const uint64_t* ptr, size_t word_cnt)
+{
+    __m512i total = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= word_cnt; i += 8) {
+        __m512i value = _mm512_loadu_si512(ptr + i);
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(value));
+    }
+    uint64_t lanes[8];
+    _mm512_storeu_si512(lanes, total);
+    size_t true_cnt = 0;
+    for (auto lane : lanes) {
+        true_cnt += static_cast<size_t>(lane);
+    }
+    for (; i < word_cnt; ++i) {
+        true_cnt += __builtin_popcountll(ptr[i]);
+    }
+    return true_cnt;
+}
+#endif
+
+using count_bits_func = size_t (*)(const uint64_t*, size_t);
+
+count_bits_func get_count_bits_func()
+{
+#if NVWA_USES_SIMD_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vpopcntdq")) {
+        return count_bits_in_words_avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return count_bits_in_words_avx2;
+    }
+    if (__builtin_cpu_supports("popcnt")) {
+        return count_bits_in_words_popcnt;
+    }
+#endif
+    return count_bits_in_words_generic;
+}
 
 /**
- * Object that contains pre-calculated values at which offset the first
- * 1-bit is for a given byte.
+ * Counts the 1-bits in 64-bit words, using the fastest kernel available
+ * on the processor.
+ *
+ * @param ptr       pointer to the first word
+ * @param word_cnt  number of words to count
+ * @return          the count of 1-bits
  */
-auto _S_bit_ordinal = get_bit_ordinal(std::make_index_sequence<256>());
+size_t count_bits_in_words(const uint64_t* ptr, size_t word_cnt)
+{
+    static const count_bits_func count_words = get_count_bits_func();
+    return count_words(ptr, word_cnt);
+}
 
 /**
  * Outputs the bits in a byte.
@@ -215,10 +361,20 @@ bool_array::bool_array(const void* ptr, size_type size)
         throw std::bad_alloc();
     }
 
+    auto byte_ptr = static_cast<const byte*>(ptr);
     size_t byte_cnt = get_num_bytes_from_bits(_M_length);
-    memcpy(_M_byte_ptr, ptr, byte_cnt);
-    unsigned valid_bits_in_last_byte = (_M_length - 1) % 8 + 1;
-    _M_byte_ptr[byte_cnt - 1] &= ~(~0U << valid_bits_in_last_byte);
+    size_t i = 0;
+    for (; i + 8 <= byte_cnt; i += 8) {
+        _M_word_ptr[i / 8] = load_word(byte_ptr + i);
+    }
+    if (i < byte_cnt) {
+        word value = 0;
+        for (unsigned j = 0; i + j < byte_cnt; ++j) {
+            value |= word(byte_ptr[i + j]) << (j * 8);
+        }
+        _M_word_ptr[i / 8] = value;
+    }
+    clear_unused_bits();
 }
 
 /**
@@ -235,7 +391,8 @@ bool_array::bool_array(const bool_array& rhs)
     if (!create(rhs.size())) {
         throw std::bad_alloc();
     }
-    memcpy(_M_byte_ptr, rhs._M_byte_ptr, (_M_length - 1) / 8 + 1);
+    memcpy(_M_word_ptr, rhs._M_word_ptr,
+           get_num_words_from_bits(_M_length) * sizeof(word));
 }
 
 /**
@@ -252,7 +409,8 @@ bool_array& bool_array::operator=(const bool_array& rhs)
 }
 
 /**
- * Creates the packed boolean array with a specific size.
+ * Creates the packed boolean array with a specific size.  The storage
+ * is made of 64-bit words aligned to a cache line.
  *
  * @param size  size of the array
  * @return      \c false if \a size equals \c 0 or is too big, or if
@@ -278,15 +436,21 @@ bool bool_array::create(size_type size) noexcept
     }
 #endif
 
-    size_t byte_cnt = get_num_bytes_from_bits(size);
-    byte*  byte_ptr = new (std::nothrow) byte[byte_cnt];
-    if (byte_ptr == nullptr) {
+    // Whole cache lines are allocated, as aligned_alloc requires
+    size_t word_cnt = get_num_words_from_bits(size);
+    size_t alloc_size = (word_cnt * sizeof(word) + storage_alignment - 1) &
+                        ~(storage_alignment - 1);
+    auto word_ptr = static_cast<word*>(
+        aligned_malloc(alloc_size, storage_alignment));
+    if (word_ptr == nullptr) {
         return false;
     }
+    // Keeps the bits beyond the size clear
+    word_ptr[word_cnt - 1] = 0;
 
-    delete[] _M_byte_ptr;
+    aligned_free(_M_word_ptr);
 
-    _M_byte_ptr = byte_ptr;
+    _M_word_ptr = word_ptr;
     _M_length = size;
     return true;
 }
@@ -298,12 +462,11 @@ bool bool_array::create(size_type size) noexcept
  */
 void bool_array::initialize(bool value) noexcept
 {
-    assert(_M_byte_ptr);
-    size_t byte_cnt = get_num_bytes_from_bits(_M_length);
-    memset(_M_byte_ptr, value ? ~0 : 0, byte_cnt);
+    assert(_M_word_ptr);
+    memset(_M_word_ptr, value ? ~0 : 0,
+           get_num_words_from_bits(_M_length) * sizeof(word));
     if (value) {
-        unsigned valid_bits_in_last_byte = (_M_length - 1) % 8 + 1;
-        _M_byte_ptr[byte_cnt - 1] &= ~(~0U << valid_bits_in_last_byte);
+        clear_unused_bits();
     }
 }
 
@@ -314,24 +477,9 @@ void bool_array::initialize(bool value) noexcept
  */
 bool_array::size_type bool_array::count() const noexcept
 {
-    assert(_M_byte_ptr);
-    size_type true_cnt = 0;
-    size_t byte_cnt = get_num_bytes_from_bits(_M_length);
-    size_t i = 0;
-#if NVWA_USES_POPCOUNT
-    if (byte_cnt >= sizeof(size_t)) {
-        auto ptr = reinterpret_cast<size_t*>(_M_byte_ptr);
-        while (i <= byte_cnt - sizeof(size_t)) {
-            true_cnt += popcount(*ptr);
-            ++ptr;
-            i += sizeof(size_t);
-        }
-    }
-#endif
-    for (; i < byte_cnt; ++i) {
-        true_cnt += _S_bit_count[_M_byte_ptr[i]];
-    }
-    return true_cnt;
+    assert(_M_word_ptr);
+    return count_bits_in_words(_M_word_ptr,
+                               get_num_words_from_bits(_M_length));
 }
 
 /**
@@ -344,7 +492,7 @@ bool_array::size_type bool_array::count() const noexcept
  */
 bool_array::size_type bool_array::count(size_type begin, size_type end) const
 {
-    assert(_M_byte_ptr);
+    assert(_M_word_ptr);
     if (end == npos) {
         end = _M_length;
     }
@@ -355,50 +503,19 @@ bool_array::size_type bool_array::count(size_type begin, size_type end) const
         throw std::out_of_range("invalid bool_array range");
     }
 
-    size_type true_cnt = 0;
-    size_t byte_pos_beg = begin / 8;
-    size_t byte_pos_end = (end - 1) / 8;
-    unsigned valid_bits_in_last_byte = (end - 1) % 8 + 1;
-    if (begin % 8 != 0) {
-        byte byte_val = _M_byte_ptr[byte_pos_beg];
-        byte_val &= ~0U << (begin % 8);
-        if (byte_pos_beg == byte_pos_end) {
-            byte_val &= ~(~0U << valid_bits_in_last_byte);
-            true_cnt = _S_bit_count[byte_val];
-            return true_cnt;
-        } else {  // byte_pos_beg < byte_pos_end
-            true_cnt = _S_bit_count[byte_val];
-            ++byte_pos_beg;
-        }
-    }
-    if (valid_bits_in_last_byte != 8) {
-        byte byte_val = _M_byte_ptr[byte_pos_end];
-        byte_val &= ~(~0U << valid_bits_in_last_byte);
-        true_cnt += _S_bit_count[byte_val];
-    } else {
-        ++byte_pos_end;
-    }
-    // [byte_pos_beg, byte_pos_end) is now the byte range we need to count
-
-#if NVWA_USES_POPCOUNT
-    constexpr auto pc_unit = sizeof(size_t);
-    if ((byte_pos_beg + pc_unit - 1) / pc_unit * pc_unit + pc_unit <=
-        byte_pos_end) {
-        while (byte_pos_beg % pc_unit != 0) {
-            true_cnt += _S_bit_count[_M_byte_ptr[byte_pos_beg]];
-            ++byte_pos_beg;
-        }
-        auto ptr = reinterpret_cast<size_t*>(&_M_byte_ptr[byte_pos_beg]);
-        while (byte_pos_beg <= byte_pos_end - pc_unit) {
-            true_cnt += popcount(*ptr);
-            ++ptr;
-            byte_pos_beg += pc_unit;
-        }
-    }
-#endif
-    for (; byte_pos_beg < byte_pos_end; ++byte_pos_beg) {
-        true_cnt += _S_bit_count[_M_byte_ptr[byte_pos_beg]];
+    size_t word_pos_beg = begin / 64;
+    size_t word_pos_end = (end - 1) / 64;
+    word first_mask = ~word(0) << (begin % 64);
+    word last_mask = ~word(0) >> (63 - (end - 1) % 64);
+    if (word_pos_beg == word_pos_end) {
+        return count_bits_in_word(_M_word_ptr[word_pos_beg] & first_mask &
+                                  last_mask);
     }
+    size_type true_cnt =
+        count_bits_in_word(_M_word_ptr[word_pos_beg] & first_mask) +
+        count_bits_in_word(_M_word_ptr[word_pos_end] & last_mask);
+    true_cnt += count_bits_in_words(_M_word_ptr + word_pos_beg + 1,
+                                    word_pos_end - word_pos_beg - 1);
     return true_cnt;
 }
 
@@ -418,7 +535,7 @@ bool_array::size_type bool_array::find_until(
         size_type begin,
         size_type end) const
 {
-    assert(_M_byte_ptr);
+    assert(_M_word_ptr);
     if (begin == end) {
         return npos;
     }
@@ -430,34 +547,22 @@ bool_array::size_type bool_array::find_until(
     }
     --end;
 
-    size_t byte_pos_beg = begin / 8;
-    size_t byte_pos_end = end / 8;
-    byte byte_val = _M_byte_ptr[byte_pos_beg];
+    size_t word_pos_beg = begin / 64;
+    size_t word_pos_end = end / 64;
 
-    if (value) {
-        byte_val &= ~0U << (begin % 8);
-        for (size_t i = byte_pos_beg; i < byte_pos_end;) {
-            if (byte_val != 0) {
-                return i * 8 + _S_bit_ordinal[byte_val];
-            }
-            byte_val = _M_byte_ptr[++i];
-        }
-        byte_val &= ~(~0U << (end % 8 + 1));
-        if (byte_val != 0) {
-            return byte_pos_end * 8 + _S_bit_ordinal[byte_val];
-        }
-    } else {
-        byte_val |= ~(~0U << (begin % 8));
-        for (size_t i = byte_pos_beg; i < byte_pos_end;) {
-            if (byte_val != 0xFF) {
-                return i * 8 + _S_bit_ordinal[(byte)~byte_val];
-            }
-            byte_val = _M_byte_ptr[++i];
-        }
-        byte_val |= ~0U << (end % 8 + 1);
-        if (byte_val != 0xFF) {
-            return byte_pos_end * 8 + _S_bit_ordinal[(byte)~byte_val];
+    // Searching for false is searching for true in the inverted bits
+    word mask = value ? 0 : ~word(0);
+    word word_val = (_M_word_ptr[word_pos_beg] ^ mask) &
+                    (~word(0) << (begin % 64));
+    for (size_t i = word_pos_beg; i < word_pos_end;) {
+        if (word_val != 0) {
+            return i * 64 + first_bit_one_offset(word_val);
         }
+        word_val = _M_word_ptr[++i] ^ mask;
+    }
+    word_val &= ~word(0) >> (63 - end % 64);
+    if (word_val != 0) {
+        return word_pos_end * 64 + first_bit_one_offset(word_val);
     }
 
     return npos;
@@ -468,13 +573,12 @@ bool_array::size_type bool_array::find_until(
  */
 void bool_array::flip() noexcept
 {
-    assert(_M_byte_ptr);
-    size_t byte_cnt = get_num_bytes_from_bits(_M_length);
-    for (size_t i = 0; i < byte_cnt; ++i) {
-        _M_byte_ptr[i] = ~_M_byte_ptr[i];
+    assert(_M_word_ptr);
+    size_t word_cnt = get_num_words_from_bits(_M_length);
+    for (size_t i = 0; i < word_cnt; ++i) {
+        _M_word_ptr[i] = ~_M_word_ptr[i];
     }
-    unsigned valid_bits_in_last_byte = (_M_length - 1) % 8 + 1;
-    _M_byte_ptr[byte_cnt - 1] &= ~(~0U << valid_bits_in_last_byte);
+    clear_unused_bits();
 }
 
 /**
@@ -484,26 +588,32 @@ void bool_array::flip() noexcept
  */
 void bool_array::swap(bool_array& rhs) noexcept
 {
-    std::swap(_M_byte_ptr, rhs._M_byte_ptr);
+    std::swap(_M_word_ptr, rhs._M_word_ptr);
     std::swap(_M_length,   rhs._M_length);
 }
 
 /**
- * Merges elements of another bool_array with a logical AND.
+ * Merges elements of another bool_array with a bitwise operation.  The
+ * bits are processed a destination word at a time.  When the source
+ * and destination words are aligned with each other, they are
+ * processed in a plain loop that the compiler can vectorize.
  *
  * @param rhs           another bool_array to merge
  * @param begin         beginning of the range in \a rhs
  * @param end           end of the range (exclusive) in \a rhs
  * @param offset        position to merge in this bool_array
+ * @param op            the bitwise operation on two words
  * @throw out_of_range  bad range for the source or the destination
  */
-void bool_array::merge_and(
+template <typename _Op>
+void bool_array::merge_bits(
         const bool_array& rhs,
         size_type begin,
         size_type end,
-        size_type offset)
+        size_type offset,
+        _Op op)
 {
-    assert(_M_byte_ptr);
+    assert(_M_word_ptr);
     if (begin == end) {
         return;
     }
@@ -517,37 +627,51 @@ void bool_array::merge_and(
         throw std::out_of_range("destination overflown");
     }
 
-    size_t byte_offset = offset / 8;
-    size_t bit_offset = offset % 8;
-    byte value{};
-    if (bit_offset != 0 && begin + 8 - bit_offset <= end) {
-        // Merge the first byte (in destination), if it is partial and
-        // there are remaining bits
-        value = rhs.get_8bits(begin, end);
-        value = ~(~value << bit_offset);
-        _M_byte_ptr[byte_offset] &= value;
-        begin += 8 - bit_offset;
-        byte_offset++;
-        bit_offset = 0;
-    }
-    while (begin + 8 <= end) {
-        // Merge all the full bytes
-        value = rhs.get_8bits(begin, end);
-        _M_byte_ptr[byte_offset++] &= value;
-        begin += 8;
-    }
-    if (begin < end) {
-        // Merge the remaining bits
-        assert(end - begin < 8);
-        value = rhs.get_8bits(begin, end);
-        value |= ~0U << (end - begin);
-        if (bit_offset != 0) {
-            value = ~(~value << bit_offset);
+    while (begin < end) {
+        size_t word_pos = offset / 64;
+        unsigned bit_pos = offset % 64;
+        if (bit_pos == 0 && begin % 64 == 0 && end - begin >= 64) {
+            // Merge aligned words in a vectorizable loop
+            size_t word_cnt = (end - begin) / 64;
+            word* dest = _M_word_ptr + word_pos;
+            const word* src = rhs._M_word_ptr + begin / 64;
+            for (size_t i = 0; i < word_cnt; ++i) {
+                dest[i] = op(dest[i], src[i]);
+            }
+            begin += word_cnt * 64;
+            offset += word_cnt * 64;
+            continue;
         }
-        _M_byte_ptr[byte_offset] &= value;
+        // Merge a partial or unaligned word
+        size_type bits = std::min<size_type>(64 - bit_pos, end - begin);
+        word value = rhs.get_64bits(begin) << bit_pos;
+        word mask = bits == 64 ? ~word(0) : ~(~word(0) << bits) << bit_pos;
+        word& target = _M_word_ptr[word_pos];
+        target = (target & ~mask) | (op(target, value) & mask);
+        begin += bits;
+        offset += bits;
     }
 }
 
+/**
+ * Merges elements of another bool_array with a logical AND.
+ *
+ * @param rhs           another bool_array to merge
+ * @param begin         beginning of the range in \a rhs
+ * @param end           end of the range (exclusive) in \a rhs
+ * @param offset        position to merge in this bool_array
+ * @throw out_of_range  bad range for the source or the destination
+ */
+void bool_array::merge_and(
+        const bool_array& rhs,
+        size_type begin,
+        size_type end,
+        size_type offset)
+{
+    merge_bits(rhs, begin, end, offset,
+               [](word lhs, word rhs) { return lhs & rhs; });
+}
+
 /**
  * Merges elements of another bool_array with a logical OR.
  *
@@ -563,9 +687,70 @@ void bool_array::merge_or(
         size_type end,
         size_type offset)
 {
-    assert(_M_byte_ptr);
+    merge_bits(rhs, begin, end, offset,
+               [](word lhs, word rhs) { return lhs | rhs; });
+}
+
+/**
+ * Merges elements of another bool_array with a logical XOR.
+ *
+ * @param rhs           another bool_array to merge
+ * @param begin         beginning of the range in \a rhs
+ * @param end           end of the range (exclusive) in \a rhs
+ * @param offset        position to merge in this bool_array
+ * @throw out_of_range  bad range for the source or the destination
+ */
+void bool_array::merge_xor(
+        const bool_array& rhs,
+        size_type begin,
+        size_type end,
+        size_type offset)
+{
+    merge_bits(rhs, begin, end, offset,
+               [](word lhs, word rhs) { return lhs ^ rhs; });
+}
+
+/**
+ * Clears the elements that are \c true in another bool_array, i.e.,
+ * merges with a logical AND of the negated elements.
+ *
+ * @param rhs           another bool_array to merge
+ * @param begin         beginning of the range in \a rhs
+ * @param end           end of the range (exclusive) in \a rhs
+ * @param offset        position to merge in this bool_array
+ * @throw out_of_range  bad range for the source or the destination
+ */
+void bool_array::merge_andnot(
+        const bool_array& rhs,
+        size_type begin,
+        size_type end,
+        size_type offset)
+{
+    merge_bits(rhs, begin, end, offset,
+               [](word lhs, word rhs) { return lhs & ~rhs; });
+}
+
+/**
+ * Counts the elements that are \c true both in this bool_array and in
+ * another, without materializing the logical AND.
+ *
+ * @param rhs           another bool_array to count with
+ * @param begin         beginning of the range in \a rhs
+ * @param end           end of the range (exclusive) in \a rhs
+ * @param offset        position in this bool_array corresponding to
+ *                      \a begin
+ * @return              the count of elements \c true in both
+ * @throw out_of_range  bad range for the source or this bool_array
+ */
+bool_array::size_type bool_array::count_and(
+        const bool_array& rhs,
+        size_type begin,
+        size_type end,
+        size_type offset) const
+{
+    assert(_M_word_ptr);
     if (begin == end) {
-        return;
+        return 0;
     }
     if (end == npos) {
         end = rhs._M_length;
@@ -577,35 +762,17 @@ void bool_array::merge_or(
         throw std::out_of_range("destination overflown");
     }
 
-    size_t byte_offset = offset / 8;
-    size_t bit_offset = offset % 8;
-    byte value{};
-    if (bit_offset != 0 && begin + 8 - bit_offset <= end) {
-        // Merge the first byte (in destination), if it is partial and
-        // there are remaining bits
-        value = rhs.get_8bits(begin, end);
-        value = value << bit_offset;
-        _M_byte_ptr[byte_offset] |= value;
-        begin += 8 - bit_offset;
-        byte_offset++;
-        bit_offset = 0;
-    }
-    while (begin + 8 <= end) {
-        // Merge all the full bytes
-        value = rhs.get_8bits(begin, end);
-        _M_byte_ptr[byte_offset++] |= value;
-        begin += 8;
-    }
-    if (begin < end) {
-        // Merge the remaining bits
-        assert(end - begin < 8);
-        value = rhs.get_8bits(begin, end);
-        value &= ~(~0U << (end - begin));
-        if (bit_offset != 0) {
-            value = value << bit_offset;
+    size_type true_cnt = 0;
+    while (begin < end) {
+        word value = get_64bits(offset) & rhs.get_64bits(begin);
+        if (end - begin < 64) {
+            value &= ~(~word(0) << (end - begin));
         }
-        _M_byte_ptr[byte_offset] |= value;
+        true_cnt += count_bits_in_word(value);
+        begin += 64;
+        offset += 64;
     }
+    return true_cnt;
 }
 
 /**
@@ -619,7 +786,7 @@ void bool_array::merge_or(
  */
 void bool_array::copy_to_bitmap(void* dest, size_type begin, size_type end)
 {
-    assert(_M_byte_ptr);
+    assert(_M_word_ptr);
     if (begin == end) {
         return;
     }
@@ -630,41 +797,51 @@ void bool_array::copy_to_bitmap(void* dest, size_type begin, size_type end)
         throw std::out_of_range("invalid bool_array range");
     }
 
-    if (begin % 8 == 0) {
-        memcpy(dest, _M_byte_ptr + begin / 8,
-               get_num_bytes_from_bits(end - begin));
-    } else {
-        byte* byte_ptr = static_cast<byte*>(dest);
-        size_type offset = begin;
-        while (offset < end) {
-            *byte_ptr++ = get_8bits(offset, end);
-            offset += 8;
+    byte* byte_ptr = static_cast<byte*>(dest);
+    size_t byte_cnt = get_num_bytes_from_bits(end - begin);
+    size_t i = 0;
+    for (; i + 8 <= byte_cnt; i += 8) {
+        store_word(byte_ptr + i, get_64bits(begin + i * 8));
+    }
+    if (i < byte_cnt) {
+        word value = get_64bits(begin + i * 8);
+        for (; i < byte_cnt; ++i) {
+            byte_ptr[i] = static_cast<byte>(value);
+            value >>= 8;
         }
     }
 
     if (unsigned extra_bits = (end - begin) % 8) {
-        byte* last_byte_ptr = static_cast<byte*>(dest) +
-                              get_num_bytes_from_bits(end - begin) - 1;
-        *last_byte_ptr &= ~(~0U << extra_bits);
+        byte_ptr[byte_cnt - 1] &= ~(~0U << extra_bits);
     }
 }
 
 /**
- * Retreive contiguous 8 bits from the bool_array.  If fewer than 8 bits
- * are available, the extra bits are undefined.
+ * Retrieves 64 contiguous bits from the bool_array.  The bits beyond
+ * the end of the array are undefined.
  *
  * @param offset  beginning position to retrieve the bits
- * @param end     end position beyond whose byte no bits will be taken
  */
-bool_array::byte bool_array::get_8bits(size_type offset, size_type end) const
+bool_array::word bool_array::get_64bits(size_type offset) const
+{
+    size_t word_pos = offset / 64;
+    unsigned bit_pos = offset % 64;
+    word value = _M_word_ptr[word_pos] >> bit_pos;
+    if (bit_pos != 0 && word_pos + 1 < get_num_words_from_bits(_M_length)) {
+        value |= _M_word_ptr[word_pos + 1] << (64 - bit_pos);
+    }
+    return value;
+}
+
+/**
+ * Clears the bits in the last word that are beyond the size.
+ */
+void bool_array::clear_unused_bits() noexcept
 {
-    size_t byte_offset = offset / 8;
-    size_t bit_offset = offset % 8;
-    byte retval = _M_byte_ptr[byte_offset] >> bit_offset;
-    if (bit_offset != 0 && byte_offset < (end - 1) / 8) {
-        retval |= _M_byte_ptr[byte_offset + 1] << (8 - bit_offset);
+    if (unsigned valid_bits_in_last_word = _M_length % 64) {
+        _M_word_ptr[(_M_length - 1) / 64] &=
+            ~(~word(0) << valid_bits_in_last_word);
     }
-    return retval;
 }
 
 std::ostream& operator<<(std::ostream& os, const bool_array& ba)
@@ -673,11 +850,15 @@ std::ostream& operator<<(std::ostream& os, const bool_array& ba)
     if (byte_cnt == 0) {
         return os;
     }
+    auto get_byte = [&ba](size_t i) {
+        return static_cast<unsigned char>(ba._M_word_ptr[i / 8] >>
+                                          (i % 8 * 8));
+    };
     size_t i = 0;
     for (; i < byte_cnt - 1; ++i) {
-        output_bits(os, ba._M_byte_ptr[i]);
+        output_bits(os, get_byte(i));
     }
-    output_bits(os, ba._M_byte_ptr[i], ba.size() - (byte_cnt - 1) * 8);
+    output_bits(os, get_byte(i), ba.size() - (byte_cnt - 1) * 8);
     return os;
 }
 
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -31,7 +31,7 @@
  *
  * Header file for class bool_array (packed boolean array).
  *
- * @date  2024-05-20
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_BOOL_ARRAY_H
@@ -40,7 +40,10 @@
 #include <assert.h>             // assert
 #include <iosfwd>               // std::ostream fwd declaration
 #include <stdexcept>            // std::out_of_range
+#include <stddef.h>             // size_t
+#include <stdint.h>             // uint64_t
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "aligned_memory.h"     // nvwa::aligned_free
 
 NVWA_NAMESPACE_BEGIN
 
@@ -78,23 +81,25 @@ public:
 private:
     /** Private definition of byte. */
     typedef unsigned char       byte;
+    /** Type of the storage unit. */
+    typedef uint64_t            word;
 
     /** Class to represent a reference to an array element. */
-    template <typename _Byte_type>
+    template <typename _Word_type>
     class _Element {
     public:
-        _Element(_Byte_type* ptr, size_type pos);
+        _Element(_Word_type* ptr, size_type pos);
         bool operator=(bool value);  // NOLINT
         operator bool() const;
     private:
-        _Byte_type* _M_byte_ptr;
-        size_t      _M_byte_pos;
+        _Word_type* _M_word_ptr;
+        size_t      _M_word_pos;
         size_t      _M_bit_pos;
     };
 
 public:
-    typedef _Element<byte> reference;              ///< Type of reference
-    typedef _Element<const byte> const_reference;  ///< Type of const reference
+    typedef _Element<word> reference;              ///< Type of reference
+    typedef _Element<const word> const_reference;  ///< Type of const reference
 
     /** Constant representing `not found'. */
     static constexpr auto npos = size_type(-1);
@@ -134,16 +139,37 @@ public:
                    size_type begin = 0,
                    size_type end = npos,
                    size_type offset = 0);
+    void merge_xor(const bool_array& rhs,
+                   size_type begin = 0,
+                   size_type end = npos,
+                   size_type offset = 0);
+    void merge_andnot(const bool_array& rhs,
+                      size_type begin = 0,
+                      size_type end = npos,
+                      size_type offset = 0);
+    size_type count_and(const bool_array& rhs,
+                        size_type begin = 0,
+                        size_type end = npos,
+                        size_type offset = 0) const;
     void copy_to_bitmap(void* dest, size_type begin = 0, size_type end = npos);
 
     static size_t get_num_bytes_from_bits(size_type num_bits);
+    static size_t get_num_words_from_bits(size_type num_bits);
 
     friend std::ostream& operator<<(std::ostream& os, const bool_array& ba);
+    friend class atomic_bool_array;
+    friend class compressed_bool_array;
+    friend class mmap_bool_array;
+    friend class rank_select_index;
 
 private:
-    byte get_8bits(size_type offset, size_type end) const;
+    word get_64bits(size_type offset) const;
+    void clear_unused_bits() noexcept;
+    template <typename _Op>
+    void merge_bits(const bool_array& rhs, size_type begin, size_type end,
+                    size_type offset, _Op op);
 
-    byte*      _M_byte_ptr{};
+    word*      _M_word_ptr{};
     size_type  _M_length{};
 };
 
@@ -156,11 +182,11 @@ private:
  * @param ptr  ptr to the interal boolean data
  * @param pos  position of the array element to access
  */
-template <typename _Byte_type>
-inline bool_array::_Element<_Byte_type>::_Element(
-        _Byte_type* ptr,
+template <typename _Word_type>
+inline bool_array::_Element<_Word_type>::_Element(
+        _Word_type* ptr,
         size_type pos)
-    : _M_byte_ptr(ptr), _M_byte_pos(pos / 8), _M_bit_pos(pos % 8)
+    : _M_word_ptr(ptr), _M_word_pos(pos / 64), _M_bit_pos(pos % 64)
 {
 }
 
@@ -170,13 +196,13 @@ inline bool_array::_Element<_Byte_type>::_Element(
  * @param value  the new boolean value
  * @return       the assigned boolean value
  */
-template <typename _Byte_type>  // NOLINT
-inline bool bool_array::_Element<_Byte_type>::operator=(bool value)  // NOLINT
+template <typename _Word_type>  // NOLINT
+inline bool bool_array::_Element<_Word_type>::operator=(bool value)  // NOLINT
 {
     if (value) {
-        *(_M_byte_ptr + _M_byte_pos) |= 1 << _M_bit_pos;
+        *(_M_word_ptr + _M_word_pos) |= word(1) << _M_bit_pos;
     } else {
-        *(_M_byte_ptr + _M_byte_pos) &= ~(1 << _M_bit_pos);
+        *(_M_word_ptr + _M_word_pos) &= ~(word(1) << _M_bit_pos);
     }
     return value;
 }
@@ -186,10 +212,10 @@ inline bool bool_array::_Element<_Byte_type>::operator=(bool value)  // NOLINT
  *
  * @return  the boolean value of the accessed array element
  */
-template <typename _Byte_type>
-inline bool_array::_Element<_Byte_type>::operator bool() const
+template <typename _Word_type>
+inline bool_array::_Element<_Word_type>::operator bool() const
 {
-    return bool(*(_M_byte_ptr + _M_byte_pos) & (1 << _M_bit_pos));
+    return bool(*(_M_word_ptr + _M_word_pos) & (word(1) << _M_bit_pos));
 }
 
 /**
@@ -202,7 +228,7 @@ inline bool_array::bool_array() noexcept = default;
  */
 inline bool_array::~bool_array()
 {
-    delete[] _M_byte_ptr;
+    aligned_free(_M_word_ptr);
 }
 
 /**
@@ -213,9 +239,9 @@ inline bool_array::~bool_array()
  */
 inline bool_array::reference bool_array::operator[](size_type pos)
 {
-    assert(_M_byte_ptr);
+    assert(_M_word_ptr);
     assert(pos < _M_length);
-    return reference(_M_byte_ptr, pos);
+    return reference(_M_word_ptr, pos);
 }
 
 /**
@@ -226,9 +252,9 @@ inline bool_array::reference bool_array::operator[](size_type pos)
  */
 inline bool_array::const_reference bool_array::operator[](size_type pos) const
 {
-    assert(_M_byte_ptr);
+    assert(_M_word_ptr);
     assert(pos < _M_length);
-    return const_reference(_M_byte_ptr, pos);
+    return const_reference(_M_word_ptr, pos);
 }
 
 /**
@@ -243,9 +269,9 @@ inline bool bool_array::at(size_type pos) const
     if (pos >= _M_length) {
         throw std::out_of_range("invalid bool_array position");
     }
-    size_t byte_pos = pos / 8;
-    size_t bit_pos  = pos % 8;
-    return bool(*(_M_byte_ptr + byte_pos) & (1 << bit_pos));
+    size_t word_pos = pos / 64;
+    size_t bit_pos  = pos % 64;
+    return bool(*(_M_word_ptr + word_pos) & (word(1) << bit_pos));
 }
 
 /**
@@ -259,9 +285,9 @@ inline void bool_array::reset(size_type pos)
     if (pos >= _M_length) {
         throw std::out_of_range("invalid bool_array position");
     }
-    size_t byte_pos = pos / 8;
-    size_t bit_pos  = pos % 8;
-    *(_M_byte_ptr + byte_pos) &= ~(1 << bit_pos);
+    size_t word_pos = pos / 64;
+    size_t bit_pos  = pos % 64;
+    *(_M_word_ptr + word_pos) &= ~(word(1) << bit_pos);
 }
 
 /**
@@ -275,9 +301,9 @@ inline void bool_array::set(size_type pos)
     if (pos >= _M_length) {
         throw std::out_of_range("invalid bool_array position");
     }
-    size_t byte_pos = pos / 8;
-    size_t bit_pos  = pos % 8;
-    *(_M_byte_ptr + byte_pos) |= 1 << bit_pos;
+    size_t word_pos = pos / 64;
+    size_t bit_pos  = pos % 64;
+    *(_M_word_ptr + word_pos) |= word(1) << bit_pos;
 }
 
 /**
@@ -336,6 +362,17 @@ inline size_t bool_array::get_num_bytes_from_bits(size_type num_bits)
     return (num_bits + 7) / 8;
 }
 
+/**
+ * Converts the number of bits to number of storage words.
+ *
+ * @param num_bits  number of bits
+ * @return          number of 64-bit words needed to store \a num_bits bits
+ */
+inline size_t bool_array::get_num_words_from_bits(size_type num_bits)
+{
+    return (num_bits + 63) / 64;
+}
+
 /**
  * Exchanges the content of two bool_arrays.
  *
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2021 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -31,15 +31,21 @@
  *
  * In essence Loki ClassLevelLockable re-engineered to use a fast_mutex class.
  *
- * @date  2021-08-06
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_CLASS_LEVEL_LOCK_H
 #define NVWA_CLASS_LEVEL_LOCK_H
 
-#include "fast_mutex.h"         // nvwa::fast_mutex/_NOTHREADS
+#include "fast_mutex.h"         // nvwa::fast_mutex/_NOTHREADS/...
+#include "lock_stats.h"         // _LOCK_STATS/nvwa::lock_stats_counter
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
 
+#if _LOCK_STATS && !defined(_NOTHREADS)
+#include <typeinfo>             // typeid
+#include "pctimer.h"            // nvwa::pctimer
+#endif
+
 NVWA_NAMESPACE_BEGIN
 
 # ifdef _NOTHREADS
@@ -47,13 +53,21 @@ NVWA_NAMESPACE_BEGIN
      * Helper class for class-level locking.  This is the
      * single-threaded implementation.
      */
-    template <class _Host, bool _RealLock = false>
+    template <class _Host, bool _RealLock = false,
+              class _Mutex = fast_mutex>
     class class_level_lock {
     public:
         /** Type that provides locking/unlocking semantics. */
         class lock {
         public:
-            lock() = default;
+            lock() {}
+            template <typename _Counter>
+            explicit lock(_Counter&) {}
+        };
+        /** Type that provides shared locking/unlocking semantics. */
+        class shared_lock {
+        public:
+            shared_lock() {}
         };
 
         typedef _Host volatile_type;
@@ -64,11 +78,45 @@ NVWA_NAMESPACE_BEGIN
      * implementation.  The main departure from Loki ClassLevelLockable
      * is that there is an additional template parameter which can make
      * the lock not %lock at all even in multi-threaded environments.
-     * See static_mem_pool.h for real usage.
+     * See static_mem_pool.h for real usage.  The mutex type may also be
+     * specified, say, adaptive_fast_mutex for short critical sections,
+     * or fast_shared_mutex to allow #shared_lock.  When #_LOCK_STATS
+     * is non-zero, the acquisitions and contentions are counted per
+     * host type (see nvwa#print_lock_stats).
      */
-    template <class _Host, bool _RealLock = true>
+    template <class _Host, bool _RealLock = true,
+              class _Mutex = fast_mutex>
     class class_level_lock {
-        static fast_mutex _S_mtx;
+        static _Mutex _S_mtx;
+#   if _LOCK_STATS
+        static lock_stats_counter _S_stats;
+
+        static const char* host_name()
+        {
+            return typeid(_Host).name();
+        }
+#   endif
+
+        static bool try_acquire()
+        {
+            if (!_S_mtx.try_lock()) {
+                return false;
+            }
+#   if _LOCK_STATS
+            _S_stats.on_acquire(false, 0);
+#   endif
+            return true;
+        }
+        static void wait_acquire()
+        {
+#   if _LOCK_STATS
+            pctimer_t start = pctimer();
+            _S_mtx.lock();
+            _S_stats.on_acquire(true, pctimer() - start);
+#   else
+            _S_mtx.lock();
+#   endif
+        }
 
     public:
         // The C++ 1998 Standard required the use of `friend' here, but
@@ -76,7 +124,9 @@ NVWA_NAMESPACE_BEGIN
         // changed.  It is still used here for compatibility with older
         // compilers.
         class lock;
+        class shared_lock;
         friend class lock;
+        friend class shared_lock;
 
         /** Type that provides locking/unlocking semantics. */
         class lock {
@@ -84,7 +134,25 @@ NVWA_NAMESPACE_BEGIN
             lock()
             {
                 if (_RealLock) {
+#   if _LOCK_STATS
+                    if (!try_acquire()) {
+                        wait_acquire();
+                    }
+#   else
                     _S_mtx.lock();
+#   endif
+                }
+            }
+            /**
+             * Acquires the lock, counting in \a contention_cnt the cases
+             * where it has to wait for another thread.
+             */
+            template <typename _Counter>
+            explicit lock(_Counter& contention_cnt)
+            {
+                if (_RealLock && !try_acquire()) {
+                    ++contention_cnt;
+                    wait_acquire();
                 }
             }
             lock(const lock&) = delete;
@@ -97,24 +165,69 @@ NVWA_NAMESPACE_BEGIN
             }
         };
 
+        /**
+         * Type that provides shared locking/unlocking semantics.  It
+         * requires a mutex type like fast_shared_mutex.
+         */
+        class shared_lock {
+        public:
+            shared_lock()
+            {
+                if (_RealLock) {
+#   if _LOCK_STATS
+                    if (_S_mtx.try_lock_shared()) {
+                        _S_stats.on_acquire(false, 0);
+                    } else {
+                        pctimer_t start = pctimer();
+                        _S_mtx.lock_shared();
+                        _S_stats.on_acquire(true, pctimer() - start);
+                    }
+#   else
+                    _S_mtx.lock_shared();
+#   endif
+                }
+            }
+            shared_lock(const shared_lock&) = delete;
+            shared_lock& operator=(const shared_lock&) = delete;
+            ~shared_lock()
+            {
+                if (_RealLock) {
+                    _S_mtx.unlock_shared();
+                }
+            }
+        };
+
         typedef volatile _Host volatile_type;
     };
 
     /** Partial specialization that makes null locking. */
-    template <class _Host>
-    class class_level_lock<_Host, false> {
+    template <class _Host, class _Mutex>
+    class class_level_lock<_Host, false, _Mutex> {
     public:
         /** Type that provides locking/unlocking semantics. */
         class lock {
         public:
-            lock() = default;
+            lock() {}
+            template <typename _Counter>
+            explicit lock(_Counter&) {}
+        };
+        /** Type that provides shared locking/unlocking semantics. */
+        class shared_lock {
+        public:
+            shared_lock() {}
         };
 
         typedef _Host volatile_type;
     };
 
-    template <class _Host, bool _RealLock>
-    fast_mutex class_level_lock<_Host, _RealLock>::_S_mtx;
+    template <class _Host, bool _RealLock, class _Mutex>
+    _Mutex class_level_lock<_Host, _RealLock, _Mutex>::_S_mtx;
+#   if _LOCK_STATS
+    template <class _Host, bool _RealLock, class _Mutex>
+    lock_stats_counter class_level_lock<_Host, _RealLock, _Mutex>::_S_stats(
+        "class_level_lock",
+        &class_level_lock<_Host, _RealLock, _Mutex>::host_name);
+#   endif
 # endif // _NOTHREADS
 
 NVWA_NAMESPACE_END
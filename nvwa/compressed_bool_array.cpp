@@ -0,0 +1,972 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  compressed_bool_array.cpp
+ *
+ * Code for class compressed_bool_array (compressed boolean array for
+ * sparse or clustered data).  The current code requires a
+ * C++17-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#include "compressed_bool_array.h"  // compressed_bool_array
+#include <assert.h>             // assert
+#include <string.h>             // memcpy
+#include <algorithm>            // std::lower_bound/min/set_union/...
+#include <bitset>               // std::bitset
+#include <iterator>             // std::back_inserter
+#include <stdexcept>            // std::out_of_range
+#include "_nvwa.h"              // NVWA macros
+
+NVWA_NAMESPACE_BEGIN
+
+namespace {
+
+/** Number of elements in a chunk. */
+constexpr uint32_t chunk_bits = 65536;
+
+/** Number of 64-bit words in a bitmap container. */
+constexpr size_t chunk_words = chunk_bits / 64;
+
+/** Maximum number of elements in an array container. */
+constexpr uint32_t max_array_size = 4096;
+
+/** Calculates how many 1-bits there are in a 64-bit word. */
+inline uint32_t count_bits_in_word(uint64_t value)
+{
+    return static_cast<uint32_t>(std::bitset<64>(value).count());
+}
+
+/** Calculates at which offset the first 1-bit is in a non-zero word. */
+inline uint32_t first_bit_one_offset(uint64_t value)
+{
+    assert(value != 0);
+#if NVWA_GCC || NVWA_CLANG
+    return static_cast<uint32_t>(__builtin_ctzll(value));
+#else
+    uint32_t offset = 0;
+    while ((value & 1) == 0) {
+        value >>= 1;
+        ++offset;
+    }
+    return offset;
+#endif
+}
+
+/**
+ * Sets the bits in the range [first, last] in an array of words.
+ *
+ * @param words  pointer to the words
+ * @param first  offset of the first bit to set
+ * @param last   offset of the last bit to set
+ */
+void set_bit_range(uint64_t* words, uint32_t first, uint32_t last)
+{
+    uint32_t first_word = first / 64;
+    uint32_t last_word = last / 64;
+    uint64_t first_mask = ~uint64_t(0) << (first % 64);
+    uint64_t last_mask = ~uint64_t(0) >> (63 - last % 64);
+    if (first_word == last_word) {
+        words[first_word] |= first_mask & last_mask;
+        return;
+    }
+    words[first_word] |= first_mask;
+    for (uint32_t i = first_word + 1; i < last_word; ++i) {
+        words[i] = ~uint64_t(0);
+    }
+    words[last_word] |= last_mask;
+}
+
+/** Function object to compare a chunk with a key. */
+struct chunk_key_less {
+    template <typename _Chunk>
+    bool operator()(const _Chunk& chunk,
+                    compressed_bool_array::size_type key) const
+    {
+        return chunk._M_key < key;
+    }
+};
+
+} /* unnamed namespace */
+
+/**
+ * Finds the run that starts at or before a specified offset.  It shall
+ * be called only on a run container.
+ *
+ * @param low  offset in the chunk
+ * @return     index of the run if found; \c -1 otherwise
+ */
+ptrdiff_t compressed_bool_array::_Container::find_run(uint32_t low) const
+{
+    assert(_M_kind == run_kind);
+    ptrdiff_t first = 0;
+    ptrdiff_t last = static_cast<ptrdiff_t>(_M_values.size() / 2);
+    while (first < last) {
+        ptrdiff_t mid = first + (last - first) / 2;
+        if (_M_values[mid * 2] <= low) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first - 1;
+}
+
+/**
+ * Checks whether an element in the chunk is \c true.
+ *
+ * @param low  offset in the chunk
+ * @return     the boolean value of the element
+ */
+bool compressed_bool_array::_Container::contains(uint32_t low) const
+{
+    switch (_M_kind) {
+    case array_kind:
+        return std::binary_search(_M_values.begin(), _M_values.end(), low);
+    case bitmap_kind:
+        return (_M_words[low / 64] >> (low % 64)) & 1;
+    case run_kind: {
+        ptrdiff_t idx = find_run(low);
+        return idx >= 0 && _M_values[idx * 2 + 1] >= low;
+    }
+    }
+    return false;
+}
+
+/**
+ * Sets an element in the chunk to \c true.  An array container grows
+ * into a bitmap one when it becomes too big.
+ *
+ * @param low  offset in the chunk
+ * @return     \c true if the element was \c false; \c false otherwise
+ */
+bool compressed_bool_array::_Container::add(uint32_t low)
+{
+    switch (_M_kind) {
+    case array_kind: {
+        auto it = std::lower_bound(_M_values.begin(), _M_values.end(), low);
+        if (it != _M_values.end() && *it == low) {
+            return false;
+        }
+        if (_M_cardinality == max_array_size) {
+            to_bitmap();
+            return add(low);
+        }
+        _M_values.insert(it, static_cast<uint16_t>(low));
+        break;
+    }
+    case bitmap_kind: {
+        uint64_t mask = uint64_t(1) << (low % 64);
+        if (_M_words[low / 64] & mask) {
+            return false;
+        }
+        _M_words[low / 64] |= mask;
+        break;
+    }
+    case run_kind:
+        if (contains(low)) {
+            return false;
+        }
+        to_natural();
+        return add(low);
+    }
+    ++_M_cardinality;
+    return true;
+}
+
+/**
+ * Sets an element in the chunk to \c false.  A bitmap container shrinks
+ * into an array one when it becomes small enough.
+ *
+ * @param low  offset in the chunk
+ * @return     \c true if the element was \c true; \c false otherwise
+ */
+bool compressed_bool_array::_Container::remove(uint32_t low)
+{
+    switch (_M_kind) {
+    case array_kind: {
+        auto it = std::lower_bound(_M_values.begin(), _M_values.end(), low);
+        if (it == _M_values.end() || *it != low) {
+            return false;
+        }
+        _M_values.erase(it);
+        break;
+    }
+    case bitmap_kind: {
+        uint64_t mask = uint64_t(1) << (low % 64);
+        if (!(_M_words[low / 64] & mask)) {
+            return false;
+        }
+        _M_words[low / 64] &= ~mask;
+        if (--_M_cardinality <= max_array_size) {
+            to_array();
+        }
+        return true;
+    }
+    case run_kind:
+        if (!contains(low)) {
+            return false;
+        }
+        to_natural();
+        return remove(low);
+    }
+    --_M_cardinality;
+    return true;
+}
+
+/**
+ * Counts the \c true elements before a specified offset in the chunk.
+ *
+ * @param low  offset in the chunk (up to #chunk_bits)
+ * @return     the count of \c true elements in [0, low)
+ */
+uint32_t compressed_bool_array::_Container::count_below(uint32_t low) const
+{
+    switch (_M_kind) {
+    case array_kind:
+        return static_cast<uint32_t>(
+            std::lower_bound(_M_values.begin(), _M_values.end(), low) -
+            _M_values.begin());
+    case bitmap_kind: {
+        uint32_t true_cnt = 0;
+        for (uint32_t i = 0; i < low / 64; ++i) {
+            true_cnt += count_bits_in_word(_M_words[i]);
+        }
+        if (low % 64 != 0) {
+            true_cnt += count_bits_in_word(_M_words[low / 64] &
+                                           ~(~uint64_t(0) << (low % 64)));
+        }
+        return true_cnt;
+    }
+    case run_kind: {
+        uint32_t true_cnt = 0;
+        for (size_t i = 0; i < _M_values.size(); i += 2) {
+            uint32_t first = _M_values[i];
+            if (first >= low) {
+                break;
+            }
+            true_cnt += std::min<uint32_t>(_M_values[i + 1] + 1, low) - first;
+        }
+        return true_cnt;
+    }
+    }
+    return 0;
+}
+
+/**
+ * Finds the first \c true element at or after an offset in the chunk.
+ *
+ * @param low  offset in the chunk
+ * @return     offset of the element if found; #chunk_bits otherwise
+ */
+uint32_t compressed_bool_array::_Container::next_set(uint32_t low) const
+{
+    assert(low < chunk_bits);
+    switch (_M_kind) {
+    case array_kind: {
+        auto it = std::lower_bound(_M_values.begin(), _M_values.end(), low);
+        return it == _M_values.end() ? chunk_bits : *it;
+    }
+    case bitmap_kind: {
+        size_t i = low / 64;
+        uint64_t value = _M_words[i] & (~uint64_t(0) << (low % 64));
+        for (;;) {
+            if (value != 0) {
+                return static_cast<uint32_t>(i * 64) +
+                       first_bit_one_offset(value);
+            }
+            if (++i == chunk_words) {
+                return chunk_bits;
+            }
+            value = _M_words[i];
+        }
+    }
+    case run_kind: {
+        ptrdiff_t idx = find_run(low);
+        if (idx >= 0 && _M_values[idx * 2 + 1] >= low) {
+            return low;
+        }
+        size_t next = static_cast<size_t>(idx + 1) * 2;
+        return next < _M_values.size() ? _M_values[next] : chunk_bits;
+    }
+    }
+    return chunk_bits;
+}
+
+/**
+ * Finds the first \c false element at or after an offset in the chunk.
+ *
+ * @param low  offset in the chunk
+ * @return     offset of the element if found; #chunk_bits otherwise
+ */
+uint32_t compressed_bool_array::_Container::next_clear(uint32_t low) const
+{
+    assert(low < chunk_bits);
+    switch (_M_kind) {
+    case array_kind: {
+        auto it = std::lower_bound(_M_values.begin(), _M_values.end(), low);
+        while (it != _M_values.end() && *it == low) {
+            ++it;
+            ++low;
+        }
+        return low;
+    }
+    case bitmap_kind: {
+        size_t i = low / 64;
+        uint64_t value = ~_M_words[i] & (~uint64_t(0) << (low % 64));
+        for (;;) {
+            if (value != 0) {
+                return static_cast<uint32_t>(i * 64) +
+                       first_bit_one_offset(value);
+            }
+            if (++i == chunk_words) {
+                return chunk_bits;
+            }
+            value = ~_M_words[i];
+        }
+    }
+    case run_kind: {
+        // Runs are never adjacent, so the element after a run is false
+        ptrdiff_t idx = find_run(low);
+        if (idx >= 0 && _M_values[idx * 2 + 1] >= low) {
+            return _M_values[idx * 2 + 1] + 1U;
+        }
+        return low;
+    }
+    }
+    return low;
+}
+
+/**
+ * Sets the bits of the \c true elements in an array of words.
+ *
+ * @param words  pointer to #chunk_words words
+ */
+void compressed_bool_array::_Container::fill_words(uint64_t* words) const
+{
+    switch (_M_kind) {
+    case array_kind:
+        for (uint32_t low : _M_values) {
+            words[low / 64] |= uint64_t(1) << (low % 64);
+        }
+        break;
+    case bitmap_kind:
+        for (size_t i = 0; i < chunk_words; ++i) {
+            words[i] |= _M_words[i];
+        }
+        break;
+    case run_kind:
+        for (size_t i = 0; i < _M_values.size(); i += 2) {
+            set_bit_range(words, _M_values[i], _M_values[i + 1]);
+        }
+        break;
+    }
+}
+
+/**
+ * Replaces the content of the chunk with bits in an array of words.
+ * The container becomes an array or bitmap one, according to the
+ * number of \c true elements.
+ *
+ * @param words  pointer to #chunk_words words
+ */
+void compressed_bool_array::_Container::assign_words(const uint64_t* words)
+{
+    _M_kind = bitmap_kind;
+    _M_words.assign(words, words + chunk_words);
+    _M_values.clear();
+    _M_cardinality = 0;
+    for (size_t i = 0; i < chunk_words; ++i) {
+        _M_cardinality += count_bits_in_word(words[i]);
+    }
+    if (_M_cardinality <= max_array_size) {
+        to_array();
+    }
+}
+
+/**
+ * Converts the chunk to an array container.
+ */
+void compressed_bool_array::_Container::to_array()
+{
+    if (_M_kind == array_kind) {
+        return;
+    }
+    std::vector<uint16_t> values;
+    values.reserve(_M_cardinality);
+    if (_M_kind == bitmap_kind) {
+        for (size_t i = 0; i < chunk_words; ++i) {
+            uint64_t value = _M_words[i];
+            while (value != 0) {
+                values.push_back(static_cast<uint16_t>(
+                    i * 64 + first_bit_one_offset(value)));
+                value &= value - 1;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < _M_values.size(); i += 2) {
+            for (uint32_t low = _M_values[i]; low <= _M_values[i + 1];
+                 ++low) {
+                values.push_back(static_cast<uint16_t>(low));
+            }
+        }
+    }
+    _M_values.swap(values);
+    _M_words = std::vector<uint64_t>();
+    _M_kind = array_kind;
+}
+
+/**
+ * Converts the chunk to a bitmap container.
+ */
+void compressed_bool_array::_Container::to_bitmap()
+{
+    if (_M_kind == bitmap_kind) {
+        return;
+    }
+    _M_words.assign(chunk_words, 0);
+    fill_words(_M_words.data());
+    _M_values = std::vector<uint16_t>();
+    _M_kind = bitmap_kind;
+}
+
+/**
+ * Converts the chunk to an array or bitmap container, according to the
+ * number of \c true elements.
+ */
+void compressed_bool_array::_Container::to_natural()
+{
+    if (_M_cardinality <= max_array_size) {
+        to_array();
+    } else {
+        to_bitmap();
+    }
+}
+
+/**
+ * Converts the chunk to the smallest kind of container.
+ */
+void compressed_bool_array::_Container::optimize()
+{
+    std::vector<uint16_t> runs;
+    uint32_t first = next_set(0);
+    while (first < chunk_bits) {
+        uint32_t end = next_clear(first);
+        runs.push_back(static_cast<uint16_t>(first));
+        runs.push_back(static_cast<uint16_t>(end - 1));
+        // Stops early if runs are not going to win
+        if (runs.size() >= std::min(_M_cardinality, chunk_bits / 16)) {
+            to_natural();
+            return;
+        }
+        first = end < chunk_bits ? next_set(end) : chunk_bits;
+    }
+    runs.shrink_to_fit();
+    _M_values.swap(runs);
+    _M_words = std::vector<uint64_t>();
+    _M_kind = run_kind;
+}
+
+/**
+ * Constructs a compressed_bool_array with a specific size.  All
+ * elements are \c false.
+ *
+ * @param size          size of the array
+ * @throw out_of_range  \a size equals \c 0
+ */
+compressed_bool_array::compressed_bool_array(size_type size)
+{
+    if (!create(size)) {
+        throw std::out_of_range("invalid compressed_bool_array size");
+    }
+}
+
+/**
+ * Constructs a compressed_bool_array from a bool_array.  Each chunk is
+ * stored in the smallest kind of container.
+ *
+ * @param ba            the bool_array to copy from
+ * @throw out_of_range  \a ba is empty
+ * @throw bad_alloc     memory is insufficient
+ */
+compressed_bool_array::compressed_bool_array(const bool_array& ba)
+{
+    if (!create(ba.size())) {
+        throw std::out_of_range("invalid compressed_bool_array size");
+    }
+    size_t word_cnt = bool_array::get_num_words_from_bits(_M_length);
+    std::vector<uint64_t> words(chunk_words);
+    for (size_t i = 0; i < word_cnt; i += chunk_words) {
+        size_t cnt = std::min(chunk_words, word_cnt - i);
+        const uint64_t* ptr = ba._M_word_ptr + i;
+        if (std::all_of(ptr, ptr + cnt, [](uint64_t w) { return w == 0; })) {
+            continue;
+        }
+        std::fill(std::copy(ptr, ptr + cnt, words.begin()), words.end(), 0);
+        _M_chunks.emplace_back(i / chunk_words);
+        _M_chunks.back().assign_words(words.data());
+        _M_chunks.back().optimize();
+    }
+}
+
+/**
+ * Creates the compressed boolean array with a specific size.  All
+ * elements are \c false.
+ *
+ * @param size  size of the array
+ * @return      \c false if \a size equals \c 0; \c true otherwise
+ */
+bool compressed_bool_array::create(size_type size) noexcept
+{
+    if (size == 0) {
+        return false;
+    }
+    _M_chunks.clear();
+    _M_length = size;
+    return true;
+}
+
+/**
+ * Initializes all array elements to a specific value.  The value \c
+ * true is stored in run containers.
+ *
+ * @param value      the boolean value to assign to all elements
+ * @throw bad_alloc  memory is insufficient
+ */
+void compressed_bool_array::initialize(bool value)
+{
+    assert(_M_length != 0);
+    std::vector<_Container> chunks;
+    if (value) {
+        size_type chunk_cnt = (_M_length - 1) / chunk_bits + 1;
+        chunks.reserve(chunk_cnt);
+        for (size_type key = 0; key < chunk_cnt; ++key) {
+            auto bits = static_cast<uint32_t>(
+                std::min<size_type>(chunk_bits, _M_length - key * chunk_bits));
+            chunks.emplace_back(key);
+            chunks.back()._M_kind = _Container::run_kind;
+            chunks.back()._M_cardinality = bits;
+            chunks.back()._M_values = {0, static_cast<uint16_t>(bits - 1)};
+        }
+    }
+    _M_chunks.swap(chunks);
+}
+
+/**
+ * Reads the boolean value of an array element.
+ *
+ * @param pos  position of the array element to access
+ * @return     the boolean value of the accessed array element
+ */
+bool compressed_bool_array::operator[](size_type pos) const
+{
+    assert(pos < _M_length);
+    auto it = find_chunk(pos / chunk_bits);
+    return it != _M_chunks.end() && it->contains(pos % chunk_bits);
+}
+
+/**
+ * Reads the boolean value of an array element at a specified position.
+ *
+ * @param pos           position of the array element to access
+ * @return              the boolean value of the accessed array element
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+bool compressed_bool_array::at(size_type pos) const
+{
+    if (pos >= _M_length) {
+        throw std::out_of_range("invalid compressed_bool_array position");
+    }
+    return (*this)[pos];
+}
+
+/**
+ * Resets an array element to \c false at a specified position.
+ *
+ * @param pos           position of the array element to access
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+void compressed_bool_array::reset(size_type pos)
+{
+    if (pos >= _M_length) {
+        throw std::out_of_range("invalid compressed_bool_array position");
+    }
+    auto it = find_chunk(pos / chunk_bits);
+    if (it != _M_chunks.end() && it->remove(pos % chunk_bits) &&
+            it->_M_cardinality == 0) {
+        _M_chunks.erase(it);
+    }
+}
+
+/**
+ * Sets an array element to \c true at a specified position.
+ *
+ * @param pos           position of the array element to access
+ * @throw out_of_range  \a pos is greater than the size of the array
+ * @throw bad_alloc     memory is insufficient
+ */
+void compressed_bool_array::set(size_type pos)
+{
+    if (pos >= _M_length) {
+        throw std::out_of_range("invalid compressed_bool_array position");
+    }
+    size_type key = pos / chunk_bits;
+    auto it = std::lower_bound(_M_chunks.begin(), _M_chunks.end(), key,
+                               chunk_key_less());
+    if (it == _M_chunks.end() || it->_M_key != key) {
+        it = _M_chunks.emplace(it, key);
+    }
+    it->add(pos % chunk_bits);
+}
+
+/**
+ * Counts elements with a \c true value.
+ *
+ * @return  the count of \c true elements
+ */
+compressed_bool_array::size_type
+compressed_bool_array::count() const noexcept
+{
+    size_type true_cnt = 0;
+    for (const auto& chunk : _M_chunks) {
+        true_cnt += chunk._M_cardinality;
+    }
+    return true_cnt;
+}
+
+/**
+ * Counts elements with a \c true value in a specified range.
+ *
+ * @param begin         beginning of the range
+ * @param end           end of the range (exclusive)
+ * @return              the count of \c true elements
+ * @throw out_of_range  the range [begin, end) is invalid
+ */
+compressed_bool_array::size_type
+compressed_bool_array::count(size_type begin, size_type end) const
+{
+    if (end == npos) {
+        end = _M_length;
+    }
+    if (begin == end) {
+        return 0;
+    }
+    if (begin > end || end > _M_length) {
+        throw std::out_of_range("invalid compressed_bool_array range");
+    }
+
+    size_type true_cnt = 0;
+    auto it = std::lower_bound(_M_chunks.begin(), _M_chunks.end(),
+                               begin / chunk_bits, chunk_key_less());
+    for (; it != _M_chunks.end(); ++it) {
+        size_type chunk_begin = it->_M_key * chunk_bits;
+        if (chunk_begin >= end) {
+            break;
+        }
+        auto low = static_cast<uint32_t>(
+            begin > chunk_begin ? begin - chunk_begin : 0);
+        auto high = static_cast<uint32_t>(
+            std::min<size_type>(end - chunk_begin, chunk_bits));
+        if (low == 0 && high == chunk_bits) {
+            true_cnt += it->_M_cardinality;
+        } else {
+            true_cnt += it->count_below(high) - it->count_below(low);
+        }
+    }
+    return true_cnt;
+}
+
+/**
+ * Searches for the specified boolean value.  This function accepts a
+ * range expressed in [begin, end).
+ *
+ * @param begin         the position at which the search is to begin
+ * @param end           the end position (exclusive) to stop searching
+ * @param value         the boolean value to find
+ * @return              position of the first value found if successful;
+ *                      \c #npos otherwise
+ * @throw out_of_range  the range [begin, end) is invalid
+ */
+compressed_bool_array::size_type compressed_bool_array::find_until(
+        bool value,
+        size_type begin,
+        size_type end) const
+{
+    if (begin == end) {
+        return npos;
+    }
+    if (end == npos) {
+        end = _M_length;
+    }
+    if (begin > end || end > _M_length) {
+        throw std::out_of_range("invalid compressed_bool_array range");
+    }
+
+    auto it = std::lower_bound(_M_chunks.begin(), _M_chunks.end(),
+                               begin / chunk_bits, chunk_key_less());
+    size_type pos = begin;
+    for (; pos < end; ++it) {
+        size_type key = pos / chunk_bits;
+        if (it == _M_chunks.end() || it->_M_key != key) {
+            if (!value) {
+                // A missing chunk has only false elements
+                return pos;
+            }
+            if (it == _M_chunks.end()) {
+                break;
+            }
+            key = it->_M_key;
+            pos = key * chunk_bits;
+            if (pos >= end) {
+                break;
+            }
+        }
+        auto low = static_cast<uint32_t>(pos % chunk_bits);
+        uint32_t found = value ? it->next_set(low) : it->next_clear(low);
+        if (found < chunk_bits) {
+            pos = key * chunk_bits + found;
+            return pos < end ? pos : npos;
+        }
+        pos = (key + 1) * chunk_bits;
+    }
+    return npos;
+}
+
+/**
+ * Merges elements of another compressed_bool_array with a logical AND.
+ * Elements at and beyond the size of \a rhs are not changed.
+ *
+ * @param rhs           another compressed_bool_array to merge
+ * @throw out_of_range  \a rhs is bigger than this array
+ * @throw bad_alloc     memory is insufficient
+ */
+void compressed_bool_array::merge_and(const compressed_bool_array& rhs)
+{
+    if (rhs._M_length > _M_length) {
+        throw std::out_of_range("destination overflown");
+    }
+
+    // Bits of the last chunk of rhs that are beyond its size
+    auto tail_low = static_cast<uint32_t>(rhs._M_length % chunk_bits);
+    size_type tail_key = tail_low != 0 ? rhs._M_length / chunk_bits : npos;
+
+    std::vector<_Container> chunks;
+    std::vector<uint64_t> words;
+    std::vector<uint64_t> rhs_words;
+    auto rhs_it = rhs._M_chunks.begin();
+    for (const auto& chunk : _M_chunks) {
+        size_type key = chunk._M_key;
+        if (key * chunk_bits >= rhs._M_length) {
+            chunks.push_back(chunk);
+            continue;
+        }
+        while (rhs_it != rhs._M_chunks.end() && rhs_it->_M_key < key) {
+            ++rhs_it;
+        }
+        bool rhs_found =
+            rhs_it != rhs._M_chunks.end() && rhs_it->_M_key == key;
+        if (!rhs_found && key != tail_key) {
+            continue;
+        }
+
+        _Container result(key);
+        if (key != tail_key && (chunk._M_kind == _Container::array_kind ||
+                                rhs_it->_M_kind == _Container::array_kind)) {
+            // Filters the values of the array container
+            const _Container& array = chunk._M_kind == _Container::array_kind
+                                          ? chunk
+                                          : *rhs_it;
+            const _Container& other = &array == &chunk ? *rhs_it : chunk;
+            for (uint16_t low : array._M_values) {
+                if (other.contains(low)) {
+                    result._M_values.push_back(low);
+                }
+            }
+            result._M_cardinality =
+                static_cast<uint32_t>(result._M_values.size());
+        } else {
+            words.assign(chunk_words, 0);
+            rhs_words.assign(chunk_words, 0);
+            chunk.fill_words(words.data());
+            if (rhs_found) {
+                rhs_it->fill_words(rhs_words.data());
+            }
+            if (key == tail_key) {
+                set_bit_range(rhs_words.data(), tail_low, chunk_bits - 1);
+            }
+            for (size_t i = 0; i < chunk_words; ++i) {
+                words[i] &= rhs_words[i];
+            }
+            result.assign_words(words.data());
+        }
+        if (result._M_cardinality != 0) {
+            chunks.push_back(std::move(result));
+        }
+    }
+    _M_chunks.swap(chunks);
+}
+
+/**
+ * Merges elements of another compressed_bool_array with a logical OR.
+ *
+ * @param rhs           another compressed_bool_array to merge
+ * @throw out_of_range  \a rhs is bigger than this array
+ * @throw bad_alloc     memory is insufficient
+ */
+void compressed_bool_array::merge_or(const compressed_bool_array& rhs)
+{
+    if (rhs._M_length > _M_length) {
+        throw std::out_of_range("destination overflown");
+    }
+
+    std::vector<_Container> chunks;
+    std::vector<uint64_t> words;
+    auto it = _M_chunks.begin();
+    auto rhs_it = rhs._M_chunks.begin();
+    while (it != _M_chunks.end() || rhs_it != rhs._M_chunks.end()) {
+        if (rhs_it == rhs._M_chunks.end() ||
+                (it != _M_chunks.end() && it->_M_key < rhs_it->_M_key)) {
+            chunks.push_back(std::move(*it++));
+            continue;
+        }
+        if (it == _M_chunks.end() || rhs_it->_M_key < it->_M_key) {
+            chunks.push_back(*rhs_it++);
+            continue;
+        }
+        _Container result(it->_M_key);
+        if (it->_M_kind == _Container::array_kind &&
+                rhs_it->_M_kind == _Container::array_kind &&
+                it->_M_cardinality + rhs_it->_M_cardinality <=
+                    max_array_size) {
+            std::set_union(it->_M_values.begin(), it->_M_values.end(),
+                           rhs_it->_M_values.begin(), rhs_it->_M_values.end(),
+                           std::back_inserter(result._M_values));
+            result._M_cardinality =
+                static_cast<uint32_t>(result._M_values.size());
+        } else {
+            words.assign(chunk_words, 0);
+            it->fill_words(words.data());
+            rhs_it->fill_words(words.data());
+            result.assign_words(words.data());
+        }
+        chunks.push_back(std::move(result));
+        ++it;
+        ++rhs_it;
+    }
+    _M_chunks.swap(chunks);
+}
+
+/**
+ * Converts each chunk to the smallest kind of container.  It is useful
+ * after many elements are set or reset, especially in clusters.
+ *
+ * @throw bad_alloc  memory is insufficient
+ */
+void compressed_bool_array::optimize()
+{
+    for (auto& chunk : _M_chunks) {
+        chunk.optimize();
+    }
+    _M_chunks.shrink_to_fit();
+}
+
+/**
+ * Gets the approximate number of bytes of memory used.
+ *
+ * @return  the number of bytes used by this object and its containers
+ */
+size_t compressed_bool_array::memory_usage() const noexcept
+{
+    size_t total = sizeof *this + _M_chunks.capacity() * sizeof(_Container);
+    for (const auto& chunk : _M_chunks) {
+        total += chunk._M_values.capacity() * sizeof(uint16_t) +
+                 chunk._M_words.capacity() * sizeof(uint64_t);
+    }
+    return total;
+}
+
+/**
+ * Converts the compressed_bool_array to a bool_array.
+ *
+ * @return           a bool_array of the same size and elements
+ * @throw bad_alloc  memory is insufficient
+ */
+bool_array compressed_bool_array::to_bool_array() const
+{
+    assert(_M_length != 0);
+    bool_array result(_M_length);
+    result.initialize(false);
+    size_t word_cnt = bool_array::get_num_words_from_bits(_M_length);
+    std::vector<uint64_t> words;
+    for (const auto& chunk : _M_chunks) {
+        size_t offset = chunk._M_key * chunk_words;
+        words.assign(chunk_words, 0);
+        chunk.fill_words(words.data());
+        memcpy(result._M_word_ptr + offset, words.data(),
+               std::min(chunk_words, word_cnt - offset) * sizeof(uint64_t));
+    }
+    return result;
+}
+
+/**
+ * Finds the chunk with a specified key.
+ *
+ * @param key  index of the chunk
+ * @return     iterator to the chunk if found; end iterator otherwise
+ */
+std::vector<compressed_bool_array::_Container>::iterator
+compressed_bool_array::find_chunk(size_type key)
+{
+    auto it = std::lower_bound(_M_chunks.begin(), _M_chunks.end(), key,
+                               chunk_key_less());
+    if (it != _M_chunks.end() && it->_M_key != key) {
+        return _M_chunks.end();
+    }
+    return it;
+}
+
+/**
+ * Finds the chunk with a specified key.
+ *
+ * @param key  index of the chunk
+ * @return     iterator to the chunk if found; end iterator otherwise
+ */
+std::vector<compressed_bool_array::_Container>::const_iterator
+compressed_bool_array::find_chunk(size_type key) const
+{
+    auto it = std::lower_bound(_M_chunks.begin(), _M_chunks.end(), key,
+                               chunk_key_less());
+    if (it != _M_chunks.end() && it->_M_key != key) {
+        return _M_chunks.end();
+    }
+    return it;
+}
+
+NVWA_NAMESPACE_END
@@ -0,0 +1,218 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  compressed_bool_array.h
+ *
+ * Header file for class compressed_bool_array (compressed boolean array
+ * for sparse or clustered data).  Using this file requires a
+ * C++17-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_COMPRESSED_BOOL_ARRAY_H
+#define NVWA_COMPRESSED_BOOL_ARRAY_H
+
+#include <assert.h>             // assert
+#include <stddef.h>             // size_t
+#include <stdint.h>             // uint16_t/uint32_t/uint64_t
+#include <utility>              // std::swap
+#include <vector>               // std::vector
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "bool_array.h"         // nvwa::bool_array
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class to represent a compressed boolean array.  The array is divided
+ * into chunks of 65536 elements, and only chunks with \c true elements
+ * use memory.  Like Roaring bitmaps, each chunk is stored in one of
+ * three kinds of containers:
+ *
+ *  - an \e array of the sorted offsets of the \c true elements, when
+ *    there are at most 4096 of them;
+ *  - a \e bitmap of 65536 bits (8 KiB), when there are more;
+ *  - a list of \e runs of \c true elements, which is used only when it
+ *    is smaller than the other two (see #optimize).
+ *
+ * The interface follows that of bool_array, so that one can replace the
+ * other when most elements are \c false.  A run container is converted
+ * to another kind when it is modified, so #optimize may be called after
+ * bulk modifications.
+ */
+class compressed_bool_array {
+public:
+    typedef bool_array::size_type size_type;    ///< Type of array indices
+
+    /** Constant representing `not found'. */
+    static constexpr auto npos = size_type(-1);
+
+    compressed_bool_array() noexcept;
+    explicit compressed_bool_array(size_type size);
+    explicit compressed_bool_array(const bool_array& ba);
+
+    bool create(size_type size) noexcept;
+    void initialize(bool value);
+
+    bool operator[](size_type pos) const;
+    bool at(size_type pos) const;
+    void reset(size_type pos);
+    void set(size_type pos);
+
+    size_type size() const noexcept;
+    size_type count() const noexcept;
+    size_type count(size_type begin, size_type end = npos) const;
+    size_type find(bool value, size_type offset = 0) const;
+    size_type find(bool value, size_type offset, size_type count) const;
+    size_type find_until(bool value, size_type begin, size_type end) const;
+
+    void swap(compressed_bool_array& rhs) noexcept;
+    void merge_and(const compressed_bool_array& rhs);
+    void merge_or (const compressed_bool_array& rhs);
+    void optimize();
+
+    size_t memory_usage() const noexcept;
+    bool_array to_bool_array() const;
+
+private:
+    /** Container of the elements in one chunk. */
+    struct _Container {
+        enum kind_type : unsigned char { array_kind, bitmap_kind, run_kind };
+
+        explicit _Container(size_type key) : _M_key(key) {}
+
+        bool contains(uint32_t low) const;
+        bool add(uint32_t low);
+        bool remove(uint32_t low);
+        uint32_t count_below(uint32_t low) const;
+        uint32_t next_set(uint32_t low) const;
+        uint32_t next_clear(uint32_t low) const;
+
+        void fill_words(uint64_t* words) const;
+        void assign_words(const uint64_t* words);
+        void to_array();
+        void to_bitmap();
+        void to_natural();
+        void optimize();
+        ptrdiff_t find_run(uint32_t low) const;
+
+        size_type             _M_key;               ///< Index of the chunk
+        kind_type             _M_kind{array_kind};  ///< Kind of container
+        uint32_t              _M_cardinality{};     ///< Count of true bits
+        std::vector<uint16_t> _M_values;    ///< Offsets, or first/last pairs
+        std::vector<uint64_t> _M_words;     ///< Bits of a bitmap container
+    };
+
+    std::vector<_Container>::iterator find_chunk(size_type key);
+    std::vector<_Container>::const_iterator find_chunk(size_type key) const;
+
+    std::vector<_Container> _M_chunks;      ///< Non-empty chunks by key
+    size_type               _M_length{};
+};
+
+
+/* Inline functions */
+
+/**
+ * Constructs an empty compressed_bool_array.
+ */
+inline compressed_bool_array::compressed_bool_array() noexcept = default;
+
+/**
+ * Gets the size of the compressed_bool_array.
+ *
+ * @return  the number of bits of the compressed_bool_array
+ */
+inline compressed_bool_array::size_type
+compressed_bool_array::size() const noexcept
+{
+    return _M_length;
+}
+
+/**
+ * Searches for the specified boolean value.  This function searches from
+ * the specified position (default to beginning) to the end.
+ *
+ * @param offset  the position at which the search is to begin
+ * @param value   the boolean value to find
+ * @return        position of the first value found if successful; \c #npos
+ *                otherwise
+ */
+inline compressed_bool_array::size_type compressed_bool_array::find(
+        bool value,
+        size_type offset) const
+{
+    return find_until(value, offset, _M_length);
+}
+
+/**
+ * Searches for the specified boolean value.  This function accepts a
+ * range expressed in {position, count}.
+ *
+ * @param offset        the position at which the search is to begin
+ * @param count         the number of bits to search
+ * @param value         the boolean value to find
+ * @return              position of the first value found if successful;
+ *                      \c #npos otherwise
+ * @throw out_of_range  \a offset and/or \a count is too big
+ */
+inline compressed_bool_array::size_type compressed_bool_array::find(
+        bool value,
+        size_type offset,
+        size_type count) const
+{
+    return find_until(value, offset, offset + count);
+}
+
+/**
+ * Exchanges the content of this compressed_bool_array with another.
+ *
+ * @param rhs  another compressed_bool_array to exchange content with
+ */
+inline void compressed_bool_array::swap(compressed_bool_array& rhs) noexcept
+{
+    _M_chunks.swap(rhs._M_chunks);
+    std::swap(_M_length, rhs._M_length);
+}
+
+/**
+ * Exchanges the content of two compressed_bool_arrays.
+ *
+ * @param lhs  the first compressed_bool_array to exchange
+ * @param rhs  the second compressed_bool_array to exchange
+ */
+inline void swap(compressed_bool_array& lhs,
+                 compressed_bool_array& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_COMPRESSED_BOOL_ARRAY_H
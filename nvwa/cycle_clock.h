@@ -0,0 +1,170 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  cycle_clock.h
+ *
+ * Definition of a low-overhead clock based on the processor time-stamp
+ * counter.  Using this file requires a C++11-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_CYCLE_CLOCK_H
+#define NVWA_CYCLE_CLOCK_H
+
+#include <chrono>               // std::chrono::steady_clock/...
+#include <stdint.h>             // uint64_t
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>             // __rdtsc
+#define NVWA_CYCLE_CLOCK_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && \
+        (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>          // __rdtsc
+#define NVWA_CYCLE_CLOCK_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#define NVWA_CYCLE_CLOCK_CNTVCT 1
+#endif
+
+#ifndef NVWA_CYCLE_CLOCK_CALIBRATION_MS
+/**
+ * Number of milliseconds the time-stamp counter is measured against
+ * \c std::chrono::steady_clock when nvwa#cycle_clock is first used.
+ */
+#define NVWA_CYCLE_CLOCK_CALIBRATION_MS 10
+#endif
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class to read a processor tick counter: \c rdtsc on x86, \c cntvct_el0
+ * on AArch64, and \c std::chrono::steady_clock (in nanoseconds)
+ * elsewhere.  Reading it costs a few nanoseconds.  The tick frequency of
+ * \c rdtsc is calibrated against \c steady_clock on first use, which
+ * takes #NVWA_CYCLE_CLOCK_CALIBRATION_MS milliseconds.  The tick counter
+ * is assumed to be invariant (as on all x86 processors of the last
+ * decade), i.e., to run at a constant rate and be synchronized across
+ * cores.
+ */
+class cycle_clock {
+public:
+    typedef uint64_t tick_t;
+
+#if defined(NVWA_CYCLE_CLOCK_RDTSC) || defined(NVWA_CYCLE_CLOCK_CNTVCT)
+    /** Whether a hardware tick counter is used. */
+    static constexpr bool is_hardware = true;
+#else
+    static constexpr bool is_hardware = false;
+#endif
+
+    /**
+     * Gets the current tick count.
+     *
+     * @return  the number of ticks since an unspecified point of time
+     */
+    static tick_t now() noexcept
+    {
+#if defined(NVWA_CYCLE_CLOCK_RDTSC)
+        return __rdtsc();
+#elif defined(NVWA_CYCLE_CLOCK_CNTVCT)
+        tick_t ticks;
+        __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return static_cast<tick_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+#endif
+    }
+
+    /**
+     * Gets the number of ticks per second.
+     *
+     * @return  the (calibrated) tick frequency
+     */
+    static double ticks_per_second()
+    {
+        static const double frequency = calibrate();
+        return frequency;
+    }
+
+    /**
+     * Converts ticks to seconds.
+     *
+     * @param ticks  the number of ticks
+     * @return       the equivalent number of seconds
+     */
+    static double to_seconds(tick_t ticks)
+    {
+        return static_cast<double>(ticks) / ticks_per_second();
+    }
+
+    /**
+     * Converts ticks to nanoseconds.
+     *
+     * @param ticks  the number of ticks
+     * @return       the equivalent number of nanoseconds
+     */
+    static uint64_t to_nanoseconds(tick_t ticks)
+    {
+        static const double ns_per_tick = 1e9 / ticks_per_second();
+        return static_cast<uint64_t>(static_cast<double>(ticks) *
+                                     ns_per_tick);
+    }
+
+private:
+    static double calibrate()
+    {
+#if defined(NVWA_CYCLE_CLOCK_CNTVCT)
+        uint64_t frequency;
+        __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(frequency));
+        return static_cast<double>(frequency);
+#elif defined(NVWA_CYCLE_CLOCK_RDTSC)
+        typedef std::chrono::steady_clock clock_type;
+        clock_type::time_point start_time = clock_type::now();
+        tick_t start_ticks = now();
+        clock_type::time_point end_time;
+        do {
+            end_time = clock_type::now();
+        } while (end_time - start_time <
+                 std::chrono::milliseconds(NVWA_CYCLE_CLOCK_CALIBRATION_MS));
+        tick_t end_ticks = now();
+        return static_cast<double>(end_ticks - start_ticks) /
+               std::chrono::duration<double>(end_time - start_time).count();
+#else
+        return 1e9;
+#endif
+    }
+};
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_CYCLE_CLOCK_H
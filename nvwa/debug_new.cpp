@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -31,15 +31,19 @@
  *
  * Implementation of debug versions of new and delete to check leakage.
  *
- * @date  2024-05-20
+ * @date  2026-10-14
  */
 
+#include <atomic>               // std::atomic
 #include <new>                  // std::bad_alloc/nothrow_t
+#include <algorithm>            // std::sort
 #include <assert.h>             // assert
+#include <inttypes.h>           // PRIxPTR
+#include <math.h>               // expm1/log
 #include <stdint.h>             // uint32_t/uintptr_t
 #include <stdio.h>              // fprintf/stderr/snprintf
 #include <stdlib.h>             // abort/malloc/free/posix_memalign
-#include <string.h>             // strcpy/strncpy
+#include <string.h>             // memcmp/memcpy/strcmp/strncpy
 #include "_nvwa.h"              // NVWA macros
 
 #if NVWA_UNIX
@@ -60,7 +64,7 @@
 #include <windows.h>            // CaptureStackBackTrace
 #endif
 
-#include "fast_mutex.h"         // nvwa::fast_mutex
+#include "fast_mutex.h"         // nvwa::fast_mutex/adaptive_fast_mutex
 
 #undef  _DEBUG_NEW_EMULATE_MALLOC
 #undef  _DEBUG_NEW_REDEFINE_NEW
@@ -182,6 +186,37 @@
 #define _DEBUG_NEW_REMEMBER_STACK_TRACE 0
 #endif
 
+/**
+ * @def _DEBUG_NEW_STACK_TRACE_DEPTH
+ *
+ * Maximum number of frames recorded in a stack trace when
+ * #_DEBUG_NEW_REMEMBER_STACK_TRACE is non-zero.  Identical stack traces
+ * are stored only once, and shared by all memory blocks allocated from
+ * the same call stack, so a smaller depth means both less memory and
+ * more sharing.
+ */
+#ifndef _DEBUG_NEW_STACK_TRACE_DEPTH
+#define _DEBUG_NEW_STACK_TRACE_DEPTH 64
+#endif
+
+/**
+ * @def _DEBUG_NEW_SHARD_COUNT
+ *
+ * Number of shards the list of allocated memory blocks is divided
+ * into.  Each shard has its own lock, and a block is put in the shard
+ * selected by its address, so that threads allocating and freeing
+ * memory seldom wait for one another.  It must be a power of two.
+ * Defining it to \c 1 restores a single list, in which leaks are
+ * reported strictly in the order of allocation.
+ */
+#ifndef _DEBUG_NEW_SHARD_COUNT
+#if defined(_NOTHREADS)
+#define _DEBUG_NEW_SHARD_COUNT 1
+#else
+#define _DEBUG_NEW_SHARD_COUNT 16
+#endif
+#endif
+
 /**
  * @def _DEBUG_NEW_TAILCHECK
  *
@@ -244,10 +279,12 @@ struct new_ptr_list_t {
     void*           addr;       ///< Address of the caller to \e new
     };
     uint32_t        head_size;  ///< Size of this struct, aligned
-    uint32_t        line   :31; ///< Line number of the caller; or \c 0
+    uint32_t        line   :30; ///< Line number of the caller; or \c 0
     uint32_t        is_array:1; ///< Non-zero iff <em>new[]</em> is used
+    uint32_t        is_sampled:1; ///< Non-zero iff the block is in the list
+    double          weight;     ///< Estimated allocations it stands for
 #if _DEBUG_NEW_REMEMBER_STACK_TRACE
-    void**          stacktrace; ///< Pointer to stack trace information
+    void**          stacktrace; ///< Pointer to interned stack trace
 #endif
     uint32_t        magic;      ///< Magic number for error detection
 };
@@ -298,6 +335,16 @@ stacktrace_print_callback_t stacktrace_print_callback = nullptr;
  */
 leak_whitelist_callback_t leak_whitelist_callback = nullptr;
 
+/**
+ * Average number of bytes allocated between two sampled allocations.
+ * Only sampled blocks are linked into the pointer list, and get stack
+ * traces if #_DEBUG_NEW_REMEMBER_STACK_TRACE is set; so nvwa#check_leaks
+ * and nvwa#check_mem_corruption only see sampled blocks, and the memory
+ * statistics become estimates.  The default value \c 0 means that every
+ * allocation is tracked.
+ */
+size_t new_sample_interval = 0;
+
 namespace {
 
 /**
@@ -325,47 +372,251 @@ constexpr uint32_t DEBUG_NEW_MAGIC = 0x4442474E;
 constexpr uint32_t ALIGNED_LIST_ITEM_SIZE = align(sizeof(new_ptr_list_t));
 
 /**
- * List of all new'd pointers.
+ * Shard of the list of all new'd pointers.  The list head is set up
+ * on first use, as the shards are zero-initialized before any dynamic
+ * initialization that may allocate memory.
  */
-new_ptr_list_t new_ptr_list = {
-    &new_ptr_list,
-    &new_ptr_list,
-    0,
-    {
-#if _DEBUG_NEW_FILENAME_LEN == 0
-        nullptr
-#else
-        ""
-#endif
-    },
-    0,
-    0,
-    0,
+struct alignas(64) new_ptr_shard_t {
+    new_ptr_list_t head;        ///< Sentinel of the doubly linked list
+    adaptive_fast_mutex lock;   ///< Guard of the list and the counters
+    double         mem_alloc;   ///< Allocated memory in bytes
+    double         alloc_cnt;   ///< Accumulated count of allocations
+    new_ptr_list_t* check_cursor; ///< Next item to check incrementally
+};
+
+static_assert((_DEBUG_NEW_SHARD_COUNT & (_DEBUG_NEW_SHARD_COUNT - 1)) == 0,
+              "Shard count must be power of two");
+
+/**
+ * Shards of the list of all new'd pointers.
+ */
+new_ptr_shard_t new_ptr_shards[_DEBUG_NEW_SHARD_COUNT];
+
+/**
+ * Gets the shard in which a memory block is tracked.
+ *
+ * @param ptr  pointer to the list item of the memory block
+ * @return     reference to the shard
+ */
+inline new_ptr_shard_t& get_shard(const new_ptr_list_t* ptr)
+{
+    auto key = reinterpret_cast<uintptr_t>(ptr) / _DEBUG_NEW_ALIGNMENT;
+    key ^= key >> 7;
+    return new_ptr_shards[key & (_DEBUG_NEW_SHARD_COUNT - 1)];
+}
+
+/**
+ * Gets the first item in a shard of the pointer list.  The caller
+ * should hold the lock of the shard.
+ *
+ * @param shard  shard of the pointer list
+ * @return       pointer to the first item; or the head if the shard is
+ *               empty
+ */
+inline new_ptr_list_t* get_first_item(new_ptr_shard_t& shard)
+{
+    if (shard.head.next == nullptr) {
+        shard.head.next = &shard.head;
+        shard.head.prev = &shard.head;
+        shard.head.magic = DEBUG_NEW_MAGIC;
+    }
+    return shard.head.next;
+}
+
+/**
+ * Number of bytes this thread can allocate before the next sample.
+ */
+thread_local size_t bytes_until_sample = 0;
+
+/**
+ * State of the random number generator for sampling in this thread.
+ */
+thread_local uint64_t sample_random_state = 0;
+
+/**
+ * Gets the distance in bytes to the next sampled allocation.  The
+ * distance is exponentially distributed, so the sampled points form a
+ * Poisson process on the allocated bytes.
+ *
+ * @param interval  average distance between sampled allocations
+ * @return          distance to the next sampled allocation
+ */
+size_t get_sample_distance(size_t interval)
+{
+    if (sample_random_state == 0) {
+        sample_random_state =
+            (reinterpret_cast<uintptr_t>(&bytes_until_sample) |
+             1) * 0x9E3779B97F4A7C15ULL;
+    }
+    sample_random_state ^= sample_random_state >> 12;
+    sample_random_state ^= sample_random_state << 25;
+    sample_random_state ^= sample_random_state >> 27;
+    uint64_t random = sample_random_state * 0x2545F4914F6CDD1DULL;
+    double u = double((random >> 11) + 1) / 9007199254740992.0; // (0, 1]
+    return static_cast<size_t>(-log(u) * double(interval)) + 1;
+}
+
+/**
+ * Decides whether an allocation should be tracked in the pointer list.
+ * A block of \a size bytes is sampled with the probability
+ * <code>1 - exp(-size / interval)</code>, and its weight is the inverse
+ * of the probability.
+ *
+ * @param size    size of the memory block
+ * @param weight  estimated number of allocations the block stands for,
+ *                set if the block is sampled
+ * @return        \c true if the block is sampled; \c false otherwise
+ */
+bool sample_allocation(size_t size, double& weight)
+{
+    size_t interval = new_sample_interval;
+    if (interval == 0) {
+        weight = 1;
+        return true;
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    if (bytes_until_sample == 0) {
+        bytes_until_sample = get_sample_distance(interval);
+    }
+    if (size < bytes_until_sample) {
+        bytes_until_sample -= size;
+        return false;
+    }
+    bytes_until_sample = get_sample_distance(interval);
+    weight = 1 / -expm1(-double(size) / double(interval));
+    return true;
+}
+
+/**
+ * Gets the estimated bytes a sampled memory block stands for.
+ *
+ * @param ptr  pointer to a new_ptr_list_t struct
+ * @return     estimated bytes
+ */
+inline double get_estimated_bytes(const new_ptr_list_t* ptr)
+{
+    return ptr->weight * double(ptr->size);
+}
+
 #if _DEBUG_NEW_REMEMBER_STACK_TRACE
-    nullptr,
-#endif
-    DEBUG_NEW_MAGIC
+/**
+ * Structure of an interned stack trace.  Entries are never freed, so
+ * that they can be shared by memory blocks without reference counting,
+ * and looked up without locking.
+ */
+struct stacktrace_entry_t {
+    stacktrace_entry_t* next;   ///< Next entry in the same bucket
+    size_t              hash;   ///< Hash value of the frames
+    uint32_t            depth;  ///< Number of frames
+    void*               frames[1]; ///< Frames, terminated by null
 };
 
 /**
- * The mutex guard to protect simultaneous access to the pointer list.
+ * Number of buckets of the stack trace table.
  */
-fast_mutex new_ptr_lock;
+constexpr size_t STACKTRACE_BUCKETS = 4096;
 
 /**
- * The mutex guard to protect simultaneous output to #new_output_fp.
+ * Buckets of the stack trace table.  New entries are pushed at the
+ * head of a bucket with compare-and-swap.
  */
-fast_mutex new_output_lock;
+std::atomic<stacktrace_entry_t*> stacktrace_table[STACKTRACE_BUCKETS];
 
 /**
- * Allocated memory in bytes.
+ * Gets the hash value of stack frames.
+ *
+ * @param frames  pointer to the stack frames
+ * @param depth   number of frames
+ * @return        hash value
  */
-size_t current_mem_alloc = 0;
+size_t hash_stacktrace(void* const* frames, uint32_t depth)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (uint32_t i = 0; i < depth; ++i) {
+        hash ^= reinterpret_cast<uintptr_t>(frames[i]);
+        hash *= 0x100000001B3ULL;
+        hash ^= hash >> 29;
+    }
+    return static_cast<size_t>(hash);
+}
+
+/**
+ * Finds the entry for stack frames in a bucket chain.
+ *
+ * @param entry   the first entry to search from
+ * @param last    the entry to stop at (exclusive)
+ * @param hash    hash value of the frames
+ * @param frames  pointer to the stack frames
+ * @param depth   number of frames
+ * @return        pointer to the entry found; or null if not found
+ */
+stacktrace_entry_t* find_stacktrace(stacktrace_entry_t* entry,
+                                    stacktrace_entry_t* last,
+                                    size_t hash, void* const* frames,
+                                    uint32_t depth)
+{
+    for (; entry != last; entry = entry->next) {
+        if (entry->hash == hash && entry->depth == depth &&
+                memcmp(entry->frames, frames, depth * sizeof(void*)) == 0) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
 
 /**
- * Accumulated count of total memory allocations.
+ * Gets the interned copy of stack frames, adding it to the stack trace
+ * table if it is not there yet.
+ *
+ * @param frames  pointer to the stack frames
+ * @param depth   number of frames
+ * @return        pointer to the null-terminated frames shared by all
+ *                identical stack traces; or null if memory is
+ *                insufficient
  */
-size_t total_mem_alloc_cnt_accum = 0;
+void** intern_stacktrace(void* const* frames, uint32_t depth)
+{
+    size_t hash = hash_stacktrace(frames, depth);
+    auto& bucket = stacktrace_table[hash % STACKTRACE_BUCKETS];
+    stacktrace_entry_t* head = bucket.load(std::memory_order_acquire);
+    stacktrace_entry_t* entry =
+        find_stacktrace(head, nullptr, hash, frames, depth);
+    if (entry != nullptr) {
+        return entry->frames;
+    }
+
+    entry = static_cast<stacktrace_entry_t*>(
+        malloc(sizeof(stacktrace_entry_t) + depth * sizeof(void*)));
+    if (entry == nullptr) {
+        return nullptr;
+    }
+    entry->hash = hash;
+    entry->depth = depth;
+    memcpy(entry->frames, frames, depth * sizeof(void*));
+    entry->frames[depth] = nullptr;
+    entry->next = head;
+    while (!bucket.compare_exchange_weak(entry->next, entry,
+                                         std::memory_order_release,
+                                         std::memory_order_acquire)) {
+        // Another thread may have added the same stack trace
+        stacktrace_entry_t* found =
+            find_stacktrace(entry->next, head, hash, frames, depth);
+        if (found != nullptr) {
+            free(entry);
+            return found->frames;
+        }
+        head = entry->next;
+    }
+    return entry->frames;
+}
+#endif
+
+/**
+ * The mutex guard to protect simultaneous output to #new_output_fp.
+ */
+fast_mutex new_output_lock;
 
 #if _DEBUG_NEW_USE_ADDR2LINE
 /**
@@ -682,6 +933,8 @@ void* alloc_mem(size_t size, const char* file, int line,
         alignment = _DEBUG_NEW_ALIGNMENT;
     }
 
+    double weight = 0;
+    bool is_sampled = sample_allocation(size, weight);
     uint32_t aligned_list_item_size = align(sizeof(new_ptr_list_t), alignment);
     size_t s = size + aligned_list_item_size + _DEBUG_NEW_TAILCHECK;
     auto ptr = static_cast<new_ptr_list_t*>(debug_new_alloc(s, alignment));
@@ -709,10 +962,12 @@ void* alloc_mem(size_t size, const char* file, int line,
     ptr->stacktrace = nullptr;
 
 #if _DEBUG_NEW_REMEMBER_STACK_TRACE == 2
-    if (line == 0)
+    if (line == 0 && is_sampled)
+#else
+    if (is_sampled)
 #endif
     {
-        void* buffer [255];
+        void* buffer [_DEBUG_NEW_STACK_TRACE_DEPTH];
         size_t buffer_length = sizeof(buffer) / sizeof(*buffer);
 
 #if NVWA_UNIX
@@ -724,28 +979,29 @@ void* alloc_mem(size_t size, const char* file, int line,
             0, DWORD(buffer_length), buffer, nullptr);
 #endif
 
-        size_t stacktrace_size = stacktrace_length * sizeof(void*);
         ptr->stacktrace =
-            static_cast<void**>(malloc(stacktrace_size + sizeof(void*)));
-
-        if (ptr->stacktrace != nullptr) {
-            memcpy(ptr->stacktrace, buffer, stacktrace_size);
-            ptr->stacktrace[stacktrace_length] = nullptr;
-        }
+            intern_stacktrace(buffer, uint32_t(stacktrace_length));
     }
 #endif
     ptr->is_array = is_array;
+    ptr->is_sampled = is_sampled;
+    ptr->weight = weight;
     ptr->size = size;
     ptr->head_size = aligned_list_item_size;
     ptr->magic = DEBUG_NEW_MAGIC;
-    {
-        fast_mutex_autolock lock(new_ptr_lock);
-        ptr->prev = new_ptr_list.prev;
-        ptr->next = &new_ptr_list;
-        new_ptr_list.prev->next = ptr;
-        new_ptr_list.prev = ptr;
-        current_mem_alloc += size;
-        ++total_mem_alloc_cnt_accum;
+    if (is_sampled) {
+        new_ptr_shard_t& shard = get_shard(ptr);
+        adaptive_fast_mutex_autolock lock(shard.lock);
+        get_first_item(shard);
+        ptr->prev = shard.head.prev;
+        ptr->next = &shard.head;
+        shard.head.prev->next = ptr;
+        shard.head.prev = ptr;
+        shard.mem_alloc += get_estimated_bytes(ptr);
+        shard.alloc_cnt += ptr->weight;
+    } else {
+        ptr->prev = nullptr;
+        ptr->next = nullptr;
     }
 #if _DEBUG_NEW_TAILCHECK
     memset(usr_ptr + size, _DEBUG_NEW_TAILCHECK_CHAR, _DEBUG_NEW_TAILCHECK);
@@ -825,23 +1081,247 @@ void free_pointer(void* usr_ptr, void* addr, is_array_t is_array,
         _DEBUG_NEW_ERROR_ACTION;
     }
 #endif
-    {
-        fast_mutex_autolock lock(new_ptr_lock);
-        current_mem_alloc -= ptr->size;
+    if (ptr->is_sampled) {
+        new_ptr_shard_t& shard = get_shard(ptr);
+        adaptive_fast_mutex_autolock lock(shard.lock);
+        if (shard.check_cursor == ptr) {
+            shard.check_cursor = ptr->next;
+        }
+        shard.mem_alloc -= get_estimated_bytes(ptr);
         ptr->magic = 0;
         ptr->prev->next = ptr->next;
         ptr->next->prev = ptr->prev;
+    } else {
+        ptr->magic = 0;
     }
     if (new_verbose_flag) {
         fast_mutex_autolock lock(new_output_lock);
         fprintf(new_output_fp,
                 "delete%s: freed %p (size %zu, %zu bytes still allocated)\n",
-                is_array ? "[]" : "", usr_ptr, ptr->size, current_mem_alloc);
+                is_array ? "[]" : "", usr_ptr, ptr->size,
+                get_current_mem_alloc());
     }
+    debug_new_free(ptr);
+}
+
+/**
+ * Structure to aggregate sampled memory blocks by allocation site.
+ */
+struct alloc_site_t {
+    union {
+#if _DEBUG_NEW_FILENAME_LEN == 0
+    const char*     file;       ///< Pointer to the file name of the caller
+#else
+    char            file[_DEBUG_NEW_FILENAME_LEN]; ///< File name of the caller
+#endif
+    void*           addr;       ///< Address of the caller to \e new
+    };
+    int             line;       ///< Line number of the caller; or \c 0
 #if _DEBUG_NEW_REMEMBER_STACK_TRACE
-    free(ptr->stacktrace);
+    void**          stacktrace; ///< Pointer to interned stack trace
 #endif
-    debug_new_free(ptr);
+    double          count;      ///< Estimated live allocations
+    double          bytes;      ///< Estimated live bytes
+};
+
+/**
+ * Compares two allocation sites.  Sites with caller addresses go before
+ * sites with file/line information.
+ *
+ * @param lhs  the first allocation site
+ * @param rhs  the second allocation site
+ * @return     \c true if \a lhs goes before \a rhs; \c false otherwise
+ */
+bool is_site_less(const alloc_site_t& lhs, const alloc_site_t& rhs)
+{
+    if (lhs.line == 0 || rhs.line == 0) {
+        if (lhs.line != rhs.line) {
+            return lhs.line == 0;
+        }
+        return reinterpret_cast<uintptr_t>(lhs.addr) <
+               reinterpret_cast<uintptr_t>(rhs.addr);
+    }
+    int result = strcmp(lhs.file, rhs.file);
+    if (result != 0) {
+        return result < 0;
+    }
+    return lhs.line < rhs.line;
+}
+
+#if _DEBUG_NEW_REMEMBER_STACK_TRACE
+/**
+ * Compares two allocation sites, with differing stack traces making
+ * different sites.  Interned stack traces are compared by address.
+ *
+ * @param lhs  the first allocation site
+ * @param rhs  the second allocation site
+ * @return     \c true if \a lhs goes before \a rhs; \c false otherwise
+ */
+bool is_site_stacktrace_less(const alloc_site_t& lhs,
+                             const alloc_site_t& rhs)
+{
+    if (lhs.stacktrace != rhs.stacktrace) {
+        return reinterpret_cast<uintptr_t>(lhs.stacktrace) <
+               reinterpret_cast<uintptr_t>(rhs.stacktrace);
+    }
+    return is_site_less(lhs, rhs);
+}
+#endif
+
+/**
+ * Collects the sampled memory blocks by allocation site.  The result
+ * is sorted in descending order of bytes, and shall be freed with \c
+ * free.
+ *
+ * @param by_stacktrace  whether blocks with different stack traces go to
+ *                       different sites
+ * @param[out] sites     pointer to the sites
+ * @param[out] site_cnt  number of the sites collected
+ * @return               \c true if successful; \c false if memory is
+ *                       insufficient
+ */
+bool collect_alloc_sites(bool by_stacktrace, alloc_site_t*& sites,
+                         size_t& site_cnt)
+{
+    site_cnt = 0;
+    size_t site_cap = 0;
+    sites = nullptr;
+    for (auto& shard : new_ptr_shards) {
+        adaptive_fast_mutex_autolock lock_ptr(shard.lock);
+        for (new_ptr_list_t* ptr = get_first_item(shard);
+                ptr != &shard.head;
+                ptr = ptr->next) {
+            if (site_cnt == site_cap) {
+                site_cap = site_cap ? site_cap * 2 : 256;
+                auto new_sites = static_cast<alloc_site_t*>(
+                    realloc(sites, site_cap * sizeof(alloc_site_t)));
+                if (new_sites == nullptr) {
+                    free(sites);
+                    sites = nullptr;
+                    site_cnt = 0;
+                    return false;
+                }
+                sites = new_sites;
+            }
+            alloc_site_t& site = sites[site_cnt++];
+            if (ptr->line != 0) {
+#if _DEBUG_NEW_FILENAME_LEN == 0
+                site.file = ptr->file;
+#else
+                memcpy(site.file, ptr->file, _DEBUG_NEW_FILENAME_LEN);
+#endif
+            } else {
+                site.addr = ptr->addr;
+            }
+            site.line = ptr->line;
+#if _DEBUG_NEW_REMEMBER_STACK_TRACE
+            site.stacktrace = by_stacktrace ? ptr->stacktrace : nullptr;
+#endif
+            site.count = ptr->weight;
+            site.bytes = get_estimated_bytes(ptr);
+        }
+    }
+
+    // Merge the blocks from the same site
+    auto less = is_site_less;
+#if _DEBUG_NEW_REMEMBER_STACK_TRACE
+    if (by_stacktrace) {
+        less = is_site_stacktrace_less;
+    }
+#else
+    (void)by_stacktrace;
+#endif
+    std::sort(sites, sites + site_cnt, less);
+    size_t merged_cnt = 0;
+    for (size_t i = 0; i < site_cnt; ++i) {
+        if (merged_cnt != 0 && !less(sites[merged_cnt - 1], sites[i])) {
+            sites[merged_cnt - 1].count += sites[i].count;
+            sites[merged_cnt - 1].bytes += sites[i].bytes;
+        } else {
+            sites[merged_cnt++] = sites[i];
+        }
+    }
+    std::sort(sites, sites + merged_cnt,
+              [](const alloc_site_t& lhs, const alloc_site_t& rhs) {
+                  return lhs.bytes > rhs.bytes;
+              });
+    site_cnt = merged_cnt;
+    return true;
+}
+
+/**
+ * Checks a memory block for corruption, and prints the problem to
+ * #new_output_fp if any.  The caller should hold the lock of its shard
+ * and #new_output_lock.
+ *
+ * @param ptr  pointer to a new_ptr_list_t struct
+ * @return     \c true if the block is fine; \c false otherwise
+ */
+bool check_block(new_ptr_list_t* ptr)
+{
+    auto usr_ptr =
+        reinterpret_cast<const char*>(ptr) + ALIGNED_LIST_ITEM_SIZE;
+    if (ptr->magic == DEBUG_NEW_MAGIC
+#if _DEBUG_NEW_TAILCHECK
+        && check_tail(ptr)
+#endif
+    ) {
+        return true;
+    }
+#if _DEBUG_NEW_TAILCHECK
+    if (ptr->magic != DEBUG_NEW_MAGIC) {
+#endif
+        fprintf(new_output_fp,
+                "Heap data corrupt near %p (size %zu, ",
+                usr_ptr, ptr->size);
+#if _DEBUG_NEW_TAILCHECK
+    } else {
+        // Adjust usr_ptr after the basic sanity check
+        usr_ptr = reinterpret_cast<const char*>(ptr) + ptr->head_size;
+        fprintf(new_output_fp,
+                "Overwritten past end of object at %p (size %zu, ",
+                usr_ptr, ptr->size);
+    }
+#endif
+    if (ptr->line != 0) {
+        print_position(ptr->file, ptr->line);
+    } else {
+        print_position(ptr->addr, ptr->line);
+    }
+    fprintf(new_output_fp, ")\n");
+
+#if _DEBUG_NEW_REMEMBER_STACK_TRACE
+    if (ptr->stacktrace != nullptr)
+        print_stacktrace(ptr->stacktrace);
+#endif
+    return false;
+}
+
+/**
+ * The mutex guard to protect the incremental check state.
+ */
+fast_mutex check_cursor_lock;
+
+/**
+ * Index of the shard the incremental check is in.
+ */
+size_t check_shard_index = 0;
+
+/**
+ * Prints an allocation site to #new_output_fp.  It is the default
+ * callback of nvwa#report_alloc_sites.
+ */
+void print_alloc_site(const char* file, int line, void* addr,
+                      size_t count, size_t bytes, void*)
+{
+    fprintf(new_output_fp, "Live allocations: %zu bytes in %zu objects (",
+            bytes, count);
+    if (line != 0) {
+        print_position(file, line);
+    } else {
+        print_position(addr, line);
+    }
+    fprintf(new_output_fp, ")\n");
 }
 
 } /* unnamed namespace */
@@ -855,53 +1335,55 @@ int check_leaks()
 {
     int leak_cnt = 0;
     int whitelisted_leak_cnt = 0;
-    fast_mutex_autolock lock_ptr(new_ptr_lock);
     fast_mutex_autolock lock_output(new_output_lock);
-    new_ptr_list_t* ptr = new_ptr_list.next;
-
-    while (ptr != &new_ptr_list) {
-        auto usr_ptr =
-            reinterpret_cast<const char*>(ptr) + ALIGNED_LIST_ITEM_SIZE;
-        if (ptr->magic != DEBUG_NEW_MAGIC) {
-            fprintf(new_output_fp,
-                    "warning: heap data corrupt near %p\n",
-                    usr_ptr);
-        } else {
-            // Adjust usr_ptr after the basic sanity check
-            usr_ptr = reinterpret_cast<const char*>(ptr) + ptr->head_size;
-        }
+    for (auto& shard : new_ptr_shards) {
+        adaptive_fast_mutex_autolock lock_ptr(shard.lock);
+        new_ptr_list_t* ptr = get_first_item(shard);
+
+        while (ptr != &shard.head) {
+            auto usr_ptr =
+                reinterpret_cast<const char*>(ptr) + ALIGNED_LIST_ITEM_SIZE;
+            if (ptr->magic != DEBUG_NEW_MAGIC) {
+                fprintf(new_output_fp,
+                        "warning: heap data corrupt near %p\n",
+                        usr_ptr);
+            } else {
+                // Adjust usr_ptr after the basic sanity check
+                usr_ptr = reinterpret_cast<const char*>(ptr) + ptr->head_size;
+            }
 #if _DEBUG_NEW_TAILCHECK
-        if (!check_tail(ptr)) {
-            fprintf(new_output_fp,
-                    "warning: overwritten past end of object at %p\n",
-                    usr_ptr);
-        }
+            if (!check_tail(ptr)) {
+                fprintf(new_output_fp,
+                        "warning: overwritten past end of object at %p\n",
+                        usr_ptr);
+            }
 #endif
 
-        if (is_leak_whitelisted(ptr)) {
-            ++whitelisted_leak_cnt;
-        } else {
-            fprintf(new_output_fp,
-                    "Leaked object at %p (size %zu, ",
-                    usr_ptr, ptr->size);
-
-            if (ptr->line != 0) {
-                print_position(ptr->file, ptr->line);
+            if (is_leak_whitelisted(ptr)) {
+                ++whitelisted_leak_cnt;
             } else {
-                print_position(ptr->addr, ptr->line);
-            }
+                fprintf(new_output_fp,
+                        "Leaked object at %p (size %zu, ",
+                        usr_ptr, ptr->size);
 
-            fprintf(new_output_fp, ")\n");
+                if (ptr->line != 0) {
+                    print_position(ptr->file, ptr->line);
+                } else {
+                    print_position(ptr->addr, ptr->line);
+                }
+
+                fprintf(new_output_fp, ")\n");
 
 #if _DEBUG_NEW_REMEMBER_STACK_TRACE
-            if (ptr->stacktrace != nullptr) {
-                print_stacktrace(ptr->stacktrace);
-            }
+                if (ptr->stacktrace != nullptr) {
+                    print_stacktrace(ptr->stacktrace);
+                }
 #endif
-        }
+            }
 
-        ptr = ptr->next;
-        ++leak_cnt;
+            ptr = ptr->next;
+            ++leak_cnt;
+        }
     }
     if (new_verbose_flag || leak_cnt) {
         if (whitelisted_leak_cnt > 0) {
@@ -924,49 +1406,17 @@ int check_leaks()
 int check_mem_corruption()
 {
     int corrupt_cnt = 0;
-    fast_mutex_autolock lock_ptr(new_ptr_lock);
     fast_mutex_autolock lock_output(new_output_lock);
     fprintf(new_output_fp, "*** Checking for memory corruption: START\n");
-    for (new_ptr_list_t* ptr = new_ptr_list.next;
-            ptr != &new_ptr_list;
-            ptr = ptr->next) {
-        auto usr_ptr =
-            reinterpret_cast<const char*>(ptr) + ALIGNED_LIST_ITEM_SIZE;
-        if (ptr->magic == DEBUG_NEW_MAGIC
-#if _DEBUG_NEW_TAILCHECK
-            && check_tail(ptr)
-#endif
-        ) {
-            continue;
-        }
-#if _DEBUG_NEW_TAILCHECK
-        if (ptr->magic != DEBUG_NEW_MAGIC) {
-#endif
-            fprintf(new_output_fp,
-                    "Heap data corrupt near %p (size %zu, ",
-                    usr_ptr, ptr->size);
-#if _DEBUG_NEW_TAILCHECK
-        } else {
-            // Adjust usr_ptr after the basic sanity check
-            usr_ptr = reinterpret_cast<const char*>(ptr) + ptr->head_size;
-            fprintf(new_output_fp,
-                    "Overwritten past end of object at %p (size %zu, ",
-                    usr_ptr, ptr->size);
-        }
-#endif
-        if (ptr->line != 0) {
-            print_position(ptr->file, ptr->line);
-        } else {
-            print_position(ptr->addr, ptr->line);
+    for (auto& shard : new_ptr_shards) {
+        adaptive_fast_mutex_autolock lock_ptr(shard.lock);
+        for (new_ptr_list_t* ptr = get_first_item(shard);
+                ptr != &shard.head;
+                ptr = ptr->next) {
+            if (!check_block(ptr)) {
+                ++corrupt_cnt;
+            }
         }
-        fprintf(new_output_fp, ")\n");
-
-#if _DEBUG_NEW_REMEMBER_STACK_TRACE
-        if (ptr->stacktrace != nullptr)
-            print_stacktrace(ptr->stacktrace);
-#endif
-
-        ++corrupt_cnt;
     }
     fprintf(new_output_fp, "*** Checking for memory corruption: %d FOUND\n",
             corrupt_cnt);
@@ -974,23 +1424,226 @@ int check_mem_corruption()
 }
 
 /**
- * Gets the current allocated memory in bytes.
+ * Checks for heap corruption incrementally.  Each call checks at most
+ * \a max_blocks memory blocks, starting from where the previous call
+ * stopped, and wraps around after reaching the last block, so that
+ * repeated calls (say, from a timer or a low-priority thread) cover the
+ * whole heap without the long pause of nvwa#check_mem_corruption.
+ * Blocks allocated after the cursor has passed their positions are
+ * checked in the next round.
+ *
+ * @param max_blocks  maximum number of memory blocks to check
+ * @return            the number of memory corruptions found in this call
+ */
+int check_mem_corruption_step(size_t max_blocks)
+{
+    int corrupt_cnt = 0;
+    fast_mutex_autolock lock_cursor(check_cursor_lock);
+    fast_mutex_autolock lock_output(new_output_lock);
+    for (size_t i = 0; i < _DEBUG_NEW_SHARD_COUNT && max_blocks > 0; ++i) {
+        new_ptr_shard_t& shard = new_ptr_shards[check_shard_index];
+        {
+            adaptive_fast_mutex_autolock lock_ptr(shard.lock);
+            new_ptr_list_t* ptr = shard.check_cursor;
+            if (ptr == nullptr) {
+                ptr = get_first_item(shard);
+            }
+            for (; ptr != &shard.head && max_blocks > 0;
+                    ptr = ptr->next, --max_blocks) {
+                if (!check_block(ptr)) {
+                    ++corrupt_cnt;
+                }
+            }
+            if (ptr != &shard.head) {
+                shard.check_cursor = ptr;
+                break;
+            }
+            shard.check_cursor = nullptr;
+        }
+        check_shard_index = (check_shard_index + 1) % _DEBUG_NEW_SHARD_COUNT;
+    }
+    return corrupt_cnt;
+}
+
+/**
+ * Gets the current allocated memory in bytes.  It is an estimate if
+ * nvwa#new_sample_interval is non-zero.  The lock of each shard is
+ * taken in turn, so it shall not be called with any of them held.
  *
  * @return  bytes of currently allocated memory
  */
 size_t get_current_mem_alloc()
 {
-    return current_mem_alloc;
+    double result = 0;
+    for (auto& shard : new_ptr_shards) {
+        adaptive_fast_mutex_autolock lock_ptr(shard.lock);
+        result += shard.mem_alloc;
+    }
+    return static_cast<size_t>(result + 0.5);
 }
 
 /**
- * Gets the total memory allocation count.
+ * Gets the total memory allocation count.  It is an estimate if
+ * nvwa#new_sample_interval is non-zero.
  *
  * @return  count of calls to the allocation function
  */
 size_t get_total_mem_alloc_cnt()
 {
-    return total_mem_alloc_cnt_accum;
+    double result = 0;
+    for (auto& shard : new_ptr_shards) {
+        adaptive_fast_mutex_autolock lock_ptr(shard.lock);
+        result += shard.alloc_cnt;
+    }
+    return static_cast<size_t>(result + 0.5);
+}
+
+/**
+ * Reports the estimated live memory by allocation site.  The sampled
+ * memory blocks (all blocks if nvwa#new_sample_interval is \c 0) are
+ * aggregated by their file/line information or caller address, and
+ * the sites are passed to \a callback in descending order of bytes.
+ *
+ * @param callback  the function to receive the sites; a null value
+ *                  causes the sites to be printed to #new_output_fp
+ * @param data      user data to pass to \a callback
+ * @return          the number of allocation sites, or \c -1 if memory
+ *                  is insufficient
+ */
+int report_alloc_sites(alloc_site_callback_t callback, void* data)
+{
+    alloc_site_t* sites;
+    size_t merged_cnt;
+    if (!collect_alloc_sites(false, sites, merged_cnt)) {
+        return -1;
+    }
+
+    // The callback may allocate memory, and no lock shall be held then
+    if (callback == nullptr) {
+        new_output_lock.lock();
+    }
+    for (size_t i = 0; i < merged_cnt; ++i) {
+        const alloc_site_t& site = sites[i];
+        (callback ? callback : print_alloc_site)(
+            site.line != 0 ? site.file : nullptr, site.line,
+            site.line == 0 ? site.addr : nullptr,
+            static_cast<size_t>(site.count + 0.5),
+            static_cast<size_t>(site.bytes + 0.5), data);
+    }
+    if (callback == nullptr) {
+        new_output_lock.unlock();
+    }
+    free(sites);
+    return static_cast<int>(merged_cnt);
+}
+
+/**
+ * Dumps the estimated live memory as a heap profile.  Blocks are
+ * aggregated by allocation site and, if
+ * #_DEBUG_NEW_REMEMBER_STACK_TRACE is non-zero, by stack trace.
+ *
+ * The format nvwa#heap_profile_pprof is the text heap profile of
+ * gperftools, which \e pprof reads with the executable for symbols.
+ * It only has code addresses, so blocks with only file/line information
+ * (and no stack trace) are given without frames.  The format
+ * nvwa#heap_profile_folded has one line per stack, frames from the
+ * outermost one separated by semicolons, followed by the bytes, which
+ * \e flamegraph.pl and similar tools read.
+ *
+ * @param fp      pointer to the output stream
+ * @param format  format of the profile
+ * @return        the number of allocation sites, or \c -1 if memory is
+ *                insufficient
+ */
+int dump_heap_profile(FILE* fp, heap_profile_format format)
+{
+    alloc_site_t* sites;
+    size_t site_cnt;
+    if (!collect_alloc_sites(true, sites, site_cnt)) {
+        return -1;
+    }
+
+    if (format == heap_profile_pprof) {
+        double total_count = 0;
+        double total_bytes = 0;
+        for (size_t i = 0; i < site_cnt; ++i) {
+            total_count += sites[i].count;
+            total_bytes += sites[i].bytes;
+        }
+        fprintf(fp, "heap profile: %zu: %zu [%zu: %zu] @ heapprofile\n",
+                static_cast<size_t>(total_count + 0.5),
+                static_cast<size_t>(total_bytes + 0.5),
+                static_cast<size_t>(total_count + 0.5),
+                static_cast<size_t>(total_bytes + 0.5));
+    }
+    for (size_t i = 0; i < site_cnt; ++i) {
+        const alloc_site_t& site = sites[i];
+        auto count = static_cast<size_t>(site.count + 0.5);
+        auto bytes = static_cast<size_t>(site.bytes + 0.5);
+        void** stacktrace = nullptr;
+#if _DEBUG_NEW_REMEMBER_STACK_TRACE
+        stacktrace = site.stacktrace;
+#endif
+        if (format == heap_profile_pprof) {
+            fprintf(fp, "%zu: %zu [%zu: %zu] @", count, bytes, count, bytes);
+            if (stacktrace != nullptr) {
+                for (size_t j = 0; stacktrace[j] != nullptr; ++j) {
+                    fprintf(fp, " 0x%" PRIxPTR,
+                            reinterpret_cast<uintptr_t>(stacktrace[j]));
+                }
+            } else if (site.line == 0 && site.addr != nullptr) {
+                fprintf(fp, " 0x%" PRIxPTR,
+                        reinterpret_cast<uintptr_t>(site.addr));
+            }
+            fprintf(fp, "\n");
+            continue;
+        }
+
+        const char* separator = "";
+        if (stacktrace != nullptr) {
+            size_t depth = 0;
+            while (stacktrace[depth] != nullptr) {
+                ++depth;
+            }
+            while (depth > 0) {
+                fprintf(fp, "%s0x%" PRIxPTR, separator,
+                        reinterpret_cast<uintptr_t>(stacktrace[--depth]));
+                separator = ";";
+            }
+            if (site.line == 0) {
+                separator = nullptr;  // Caller already in stack trace
+            }
+        }
+        if (separator != nullptr) {
+            if (site.line != 0) {
+                fprintf(fp, "%s%s:%d", separator, site.file, site.line);
+            } else if (site.addr != nullptr) {
+                fprintf(fp, "%s0x%" PRIxPTR, separator,
+                        reinterpret_cast<uintptr_t>(site.addr));
+            } else {
+                fprintf(fp, "%s<Unknown>", separator);
+            }
+        }
+        fprintf(fp, " %zu\n", bytes);
+    }
+
+#if NVWA_LINUX
+    if (format == heap_profile_pprof) {
+        // Let pprof relocate the addresses of position-independent code
+        FILE* maps = fopen("/proc/self/maps", "r");
+        if (maps != nullptr) {
+            fprintf(fp, "\nMAPPED_LIBRARIES:\n");
+            char buffer[512];
+            while (fgets(buffer, sizeof buffer, maps) != nullptr) {
+                fputs(buffer, fp);
+            }
+            fclose(maps);
+        }
+    }
+#endif
+    fflush(fp);
+    free(sites);
+    return static_cast<int>(site_cnt);
 }
 
 /**
@@ -1028,7 +1681,6 @@ void debug_new_recorder::_M_process(void* usr_ptr)
 #endif
     ptr->line = _M_line;
 #if _DEBUG_NEW_REMEMBER_STACK_TRACE == 2
-    free(ptr->stacktrace);
     ptr->stacktrace = nullptr;
 #endif
 }
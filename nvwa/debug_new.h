@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -31,7 +31,7 @@
  *
  * Header file for checking leaks caused by unmatched new/delete.
  *
- * @date  2024-05-20
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_DEBUG_NEW_H
@@ -143,11 +143,40 @@ typedef void (*stacktrace_print_callback_t)(FILE* fp, void** stacktrace);
 typedef bool (*leak_whitelist_callback_t)(char const* file, int line,
                                           void* addr, void** stacktrace);
 
+/**
+ * Callback type for reporting allocation sites.  Either \a file or \a
+ * addr is null, depending on whether file/line information is
+ * available.
+ *
+ * @param file   null-terminated string of the file name
+ * @param line   line number; or \c 0 if only \a addr is available
+ * @param addr   address of code where allocation happens
+ * @param count  estimated number of live allocations from the site
+ * @param bytes  estimated live bytes allocated from the site
+ * @param data   user data passed to nvwa#report_alloc_sites
+ */
+typedef void (*alloc_site_callback_t)(const char* file, int line,
+                                      void* addr, size_t count,
+                                      size_t bytes, void* data);
+
+/**
+ * Formats of heap profiles written by nvwa#dump_heap_profile.
+ */
+enum heap_profile_format {
+    heap_profile_pprof,         ///< Text heap profile of gperftools/pprof
+    heap_profile_folded         ///< Folded stacks for flame graphs
+};
+
 /* Prototypes */
 int check_leaks();
 int check_mem_corruption();
+int check_mem_corruption_step(size_t max_blocks);
 size_t get_current_mem_alloc();
 size_t get_total_mem_alloc_cnt();
+int report_alloc_sites(alloc_site_callback_t callback = nullptr,
+                       void* data = nullptr);
+int dump_heap_profile(FILE* fp,
+                      heap_profile_format format = heap_profile_pprof);
 
 /* Control variables */
 extern bool new_autocheck_flag; // default to true: call check_leaks() on exit
@@ -156,6 +185,7 @@ extern FILE* new_output_fp;     // default to stderr: output to console
 extern const char* new_progname;// default to null; should be assigned argv[0]
 extern stacktrace_print_callback_t stacktrace_print_callback;// default to null
 extern leak_whitelist_callback_t leak_whitelist_callback;    // default to null
+extern size_t new_sample_interval; // default to 0: track every allocation
 
 /**
  * @def DEBUG_NEW
@@ -0,0 +1,409 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+
+/**
+ * @file  decompressing_file.cpp
+ *
+ * Code for decompressing_file, a readable stream of the decompressed
+ * content of a gzip or zstd file.  It is implemented with POSIX and
+ * Win32 APIs.
+ *
+ * @date  2026-10-14
+ */
+
+#include "decompressing_file.h" // nvwa::decompressing_file
+#include <errno.h>              // errno/EINTR
+#include <stddef.h>             // size_t
+#include <stdio.h>              // FILE/fclose/fdopen/fread/_popen
+#include <string.h>             // memcmp
+#include <istream>              // std::istream
+#include <streambuf>            // std::streambuf
+#include <string>               // std::string
+#include <system_error>         // std::errc/error_code/system_error
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+
+#if NVWA_UNIX
+#include <fcntl.h>              // open/fcntl
+#include <spawn.h>              // posix_spawnp/posix_spawn_file_actions_*
+#include <sys/wait.h>           // waitpid
+#include <unistd.h>             // close/pipe/pread
+
+extern char** environ;
+#elif !NVWA_WINDOWS
+#error "Unrecognized platform"
+#endif
+
+namespace {
+
+std::error_code get_last_error_code()
+{
+    return std::error_code{errno, std::system_category()};
+}
+
+void indicate_error(std::error_code* ecp, const std::error_code& ec)
+{
+    if (!ecp) {
+        throw std::system_error(ec);
+    }
+    *ecp = ec;
+}
+
+void indicate_last_op_failure(std::error_code* ecp, const char* op)
+{
+    if (!ecp) {
+        std::string msg(op);
+        msg += " failed";
+        throw std::system_error(get_last_error_code(), msg);
+    }
+    *ecp = get_last_error_code();
+}
+
+const char* get_program(NVWA::decompressing_file::format_type format)
+{
+    return format == NVWA::decompressing_file::gzip ? "gzip" : "zstd";
+}
+
+/** Stream buffer reading from a stdio stream. */
+class stdio_streambuf : public std::streambuf {
+public:
+    explicit stdio_streambuf(FILE* stream) : _M_stream(stream) {}
+
+protected:
+    int_type underflow() override
+    {
+        size_t count = fread(_M_buffer, 1, sizeof _M_buffer, _M_stream);
+        if (count == 0) {
+            return traits_type::eof();
+        }
+        setg(_M_buffer, _M_buffer, _M_buffer + count);
+        return traits_type::to_int_type(_M_buffer[0]);
+    }
+
+private:
+    FILE* _M_stream;
+    char  _M_buffer[64 * 1024];
+};
+
+} /* unnamed namespace */
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Constructor.
+ *
+ * @param path          path to the file to open
+ * @param format        format of the file
+ * @throw system_error  an error occurred when calling a system function,
+ *                      or the decompressor cannot be started
+ */
+decompressing_file::decompressing_file(const char* path, format_type format)
+{
+    _open(path, format);
+}
+
+/** Destructor. */
+decompressing_file::~decompressing_file()
+{
+    close();
+}
+
+/**
+ * Opens a file.
+ *
+ * @param path          path to the file to open
+ * @param format        format of the file
+ * @throw system_error  an error occurred when calling a system function,
+ *                      or the decompressor cannot be started
+ */
+void decompressing_file::open(const char* path, format_type format)
+{
+    _open(path, format);
+}
+
+/**
+ * Opens a file, detecting its format.
+ *
+ * @param path          path to the file to open
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+bool decompressing_file::open(const char* path, std::error_code& ec) noexcept
+{
+    return _open(path, auto_detect, &ec);
+}
+
+/**
+ * Opens a file.
+ *
+ * @param path          path to the file to open
+ * @param format        format of the file
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+bool decompressing_file::open(const char* path, format_type format,
+                              std::error_code& ec) noexcept
+{
+    return _open(path, format, &ec);
+}
+
+/** Closes the file, ignoring any failure of the decompressor. */
+void decompressing_file::close() noexcept
+{
+    _close(nullptr);
+}
+
+/**
+ * Closes the file.  A decompressor that has not finished successfully,
+ * say, because the file is corrupt or it is closed before the end, is
+ * reported as a failure.
+ *
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+bool decompressing_file::close(std::error_code& ec) noexcept
+{
+    return _close(&ec);
+}
+
+/**
+ * Gets an input stream of the decompressed content, for use with
+ * istream_line_reader.  It shares the underlying stdio stream with
+ * #stream, so only one of them should be used.
+ *
+ * @pre  is_open()
+ */
+std::istream& decompressing_file::istream()
+{
+    if (!_M_istream) {
+        _M_streambuf.reset(new stdio_streambuf(_M_stream));
+        _M_istream.reset(new std::istream(_M_streambuf.get()));
+    }
+    return *_M_istream;
+}
+
+/**
+ * Detects the format of a file from its first bytes.
+ *
+ * @param header  pointer to the first bytes of the file
+ * @param size    number of bytes available at \a header
+ * @return        the format of the file
+ */
+decompressing_file::format_type
+decompressing_file::detect_format(const unsigned char* header,
+                                  size_t size) noexcept
+{
+    static const unsigned char gzip_magic[] = {0x1F, 0x8B};
+    static const unsigned char zstd_magic[] = {0x28, 0xB5, 0x2F, 0xFD};
+    if (size >= sizeof gzip_magic &&
+        memcmp(header, gzip_magic, sizeof gzip_magic) == 0) {
+        return gzip;
+    }
+    if (size >= sizeof zstd_magic &&
+        memcmp(header, zstd_magic, sizeof zstd_magic) == 0) {
+        return zstd;
+    }
+    return plain;
+}
+
+#if NVWA_UNIX
+bool decompressing_file::_open(const char* path, format_type format,
+                               std::error_code* ecp)
+{
+    close();
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        indicate_last_op_failure(ecp, "open");
+        return false;
+    }
+    if (format == auto_detect) {
+        unsigned char header[4];
+        ssize_t count = pread(fd, header, sizeof header, 0);
+        format = detect_format(header, count > 0 ? count : 0);
+    }
+    if (format == plain) {
+        _M_stream = fdopen(fd, "r");
+        if (!_M_stream) {
+            ::close(fd);
+            indicate_last_op_failure(ecp, "fdopen");
+            return false;
+        }
+        _M_format = plain;
+        if (ecp) {
+            ecp->clear();
+        }
+        return true;
+    }
+
+    // The child gets the file as stdin and the pipe as stdout; all other
+    // descriptors are closed on exec
+    int pipe_fds[2];
+    if (pipe(pipe_fds) < 0) {
+        ::close(fd);
+        indicate_last_op_failure(ecp, "pipe");
+        return false;
+    }
+    fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fd, 0);
+    posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], 1);
+    const char* program = get_program(format);
+    const char* argv[] = {program, "-dcq", nullptr};
+    pid_t pid;
+    int result = posix_spawnp(&pid, program, &actions, nullptr,
+                              const_cast<char* const*>(argv), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(fd);
+    ::close(pipe_fds[1]);
+    if (result != 0) {
+        ::close(pipe_fds[0]);
+        indicate_error(ecp, std::error_code{result, std::system_category()});
+        return false;
+    }
+    _M_pid = pid;
+    _M_stream = fdopen(pipe_fds[0], "r");
+    if (!_M_stream) {
+        ::close(pipe_fds[0]);
+        indicate_last_op_failure(ecp, "fdopen");
+        _close(nullptr);
+        return false;
+    }
+    _M_format = format;
+    if (ecp) {
+        ecp->clear();
+    }
+    return true;
+}
+
+bool decompressing_file::_close(std::error_code* ecp) noexcept
+{
+    _M_istream.reset();
+    _M_streambuf.reset();
+    if (_M_stream) {
+        fclose(_M_stream);
+        _M_stream = nullptr;
+    }
+    std::error_code ec;
+    if (_M_pid > 0) {
+        int status = 0;
+        pid_t result;
+        while ((result = waitpid(_M_pid, &status, 0)) < 0 && errno == EINTR) {
+        }
+        _M_pid = -1;
+        if (result < 0) {
+            // Say, ECHILD when SIGCHLD is ignored
+            ec = get_last_error_code();
+        } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ec = make_error_code(std::errc::io_error);
+        }
+    }
+    if (ecp) {
+        *ecp = ec;
+    }
+    return !ec;
+}
+#else // NVWA_UNIX
+bool decompressing_file::_open(const char* path, format_type format,
+                               std::error_code* ecp)
+{
+    close();
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        indicate_last_op_failure(ecp, "fopen");
+        return false;
+    }
+    if (format == auto_detect) {
+        unsigned char header[4];
+        size_t count = fread(header, 1, sizeof header, fp);
+        format = detect_format(header, count);
+    }
+    fclose(fp);
+    if (format == plain) {
+        _M_stream = fopen(path, "r");
+        if (!_M_stream) {
+            indicate_last_op_failure(ecp, "fopen");
+            return false;
+        }
+        _M_format = plain;
+        if (ecp) {
+            ecp->clear();
+        }
+        return true;
+    }
+
+    // Windows paths cannot contain double quotes, so quoting is safe
+    std::string command(get_program(format));
+    command += " -dcq < \"";
+    command += path;
+    command += '"';
+    _M_stream = _popen(command.c_str(), "r");
+    if (!_M_stream) {
+        indicate_last_op_failure(ecp, "_popen");
+        return false;
+    }
+    _M_is_pipe = true;
+    _M_format = format;
+    if (ecp) {
+        ecp->clear();
+    }
+    return true;
+}
+
+bool decompressing_file::_close(std::error_code* ecp) noexcept
+{
+    _M_istream.reset();
+    _M_streambuf.reset();
+    bool succeeded = true;
+    if (_M_stream) {
+        if (_M_is_pipe) {
+            succeeded = _pclose(_M_stream) == 0;
+            _M_is_pipe = false;
+        } else {
+            fclose(_M_stream);
+        }
+        _M_stream = nullptr;
+    }
+    if (ecp) {
+        if (succeeded) {
+            ecp->clear();
+        } else {
+            *ecp = make_error_code(std::errc::io_error);
+        }
+    }
+    return succeeded;
+}
+#endif // NVWA_UNIX
+
+NVWA_NAMESPACE_END
@@ -0,0 +1,128 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+
+/**
+ * @file  decompressing_file.h
+ *
+ * Header file for decompressing_file, a readable stream of the
+ * decompressed content of a gzip or zstd file.  It can be used with
+ * file_line_reader and istream_line_reader to read lines from
+ * compressed files, e.g.:
+ * @code
+ * nvwa::decompressing_file file("input.gz");
+ * for (const char* line : nvwa::file_line_reader(file.stream())) {
+ *     // Process line
+ * }
+ * @endcode
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_DECOMPRESSING_FILE_H
+#define NVWA_DECOMPRESSING_FILE_H
+
+#include <stddef.h>             // size_t
+#include <stdio.h>              // FILE
+#include <istream>              // std::istream
+#include <memory>               // std::unique_ptr
+#include <streambuf>            // std::streambuf
+#include <system_error>         // std::error_code
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class to read the decompressed content of a file.  The decompression
+ * is done by the \c gzip or \c zstd program (which shall be in the \c
+ * PATH) in a child process, connected with a pipe, so it runs in
+ * parallel with the processing of the content.  Files that are not
+ * compressed are read directly.
+ */
+class decompressing_file {
+public:
+    /** Enumeration of the formats of the file. */
+    enum format_type {
+        auto_detect,         ///< The format is detected from the content
+        plain,               ///< The file is not compressed
+        gzip,                ///< The file is compressed by gzip
+        zstd,                ///< The file is compressed by zstd
+    };
+
+    decompressing_file() = default;
+    explicit decompressing_file(const char* path,
+                                format_type format = auto_detect);
+    decompressing_file(const decompressing_file&) = delete;
+    decompressing_file& operator=(const decompressing_file&) = delete;
+    ~decompressing_file();
+
+    void open(const char* path, format_type format = auto_detect);
+    bool open(const char* path, std::error_code& ec) noexcept;
+    bool open(const char* path, format_type format,
+              std::error_code& ec) noexcept;
+    void close() noexcept;
+    bool close(std::error_code& ec) noexcept;
+    bool is_open() const noexcept
+    {
+        return _M_stream != nullptr;
+    }
+
+    /** Gets the stdio stream of the decompressed content. */
+    FILE* stream() const noexcept
+    {
+        return _M_stream;
+    }
+    /** Gets the format of the opened file. */
+    format_type format() const noexcept
+    {
+        return _M_format;
+    }
+    std::istream& istream();
+
+    static format_type detect_format(const unsigned char* header,
+                                     size_t size) noexcept;
+
+private:
+    bool _open(const char* path, format_type format,
+               std::error_code* ecp = nullptr);
+    bool _close(std::error_code* ecp) noexcept;
+
+    FILE*                           _M_stream{};
+    format_type                     _M_format{plain};
+#if NVWA_UNIX
+    int                             _M_pid{-1};
+#else
+    bool                            _M_is_pipe{};
+#endif
+    std::unique_ptr<std::streambuf> _M_streambuf;
+    std::unique_ptr<std::istream>   _M_istream;
+};
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_DECOMPRESSING_FILE_H
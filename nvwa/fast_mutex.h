@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2020 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -29,9 +29,10 @@
 /**
  * @file  fast_mutex.h
  *
- * A fast mutex implementation for POSIX, Win32, and modern C++.
+ * A fast mutex implementation for POSIX, Win32, and modern C++, along
+ * with an adaptive (spin-then-block) mutex and a reader/writer mutex.
  *
- * @date  2020-09-13
+ * @date  2026-10-15
  */
 
 #ifndef NVWA_FAST_MUTEX_H
@@ -128,6 +129,14 @@
 #   define _FAST_MUTEX_CHECK_INITIALIZATION 1
 # endif
 
+# ifndef NVWA_ADAPTIVE_MUTEX_SPIN_COUNT
+/**
+ * Number of times adaptive_fast_mutex retries to acquire the lock,
+ * pausing the processor in between, before the thread blocks.
+ */
+#   define NVWA_ADAPTIVE_MUTEX_SPIN_COUNT 100
+# endif
+
 # ifdef _DEBUG
 #   include <stdio.h>
 #   include <stdlib.h>
@@ -189,6 +198,22 @@ NVWA_NAMESPACE_BEGIN
             _M_locked = true;
 #       endif
         }
+        bool try_lock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return true;
+            }
+#       endif
+            if (!_M_mtx_impl.try_lock()) {
+                return false;
+            }
+#       ifdef _DEBUG
+            _FAST_MUTEX_ASSERT(!_M_locked, "try_lock(): already locked");
+            _M_locked = true;
+#       endif
+            return true;
+        }
         void unlock()
         {
 #       if _FAST_MUTEX_CHECK_INITIALIZATION
@@ -261,6 +286,22 @@ NVWA_NAMESPACE_BEGIN
             _M_locked = true;
 #       endif
         }
+        bool try_lock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return true;
+            }
+#       endif
+            if (::pthread_mutex_trylock(&_M_mtx_impl) != 0) {
+                return false;
+            }
+#       ifdef _DEBUG
+            _FAST_MUTEX_ASSERT(!_M_locked, "try_lock(): already locked");
+            _M_locked = true;
+#       endif
+            return true;
+        }
         void unlock()
         {
 #       if _FAST_MUTEX_CHECK_INITIALIZATION
@@ -331,6 +372,22 @@ NVWA_NAMESPACE_BEGIN
             _M_locked = true;
 #       endif
         }
+        bool try_lock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return true;
+            }
+#       endif
+            if (!::TryEnterCriticalSection(&_M_mtx_impl)) {
+                return false;
+            }
+#       ifdef _DEBUG
+            _FAST_MUTEX_ASSERT(!_M_locked, "try_lock(): already locked");
+            _M_locked = true;
+#       endif
+            return true;
+        }
         void unlock()
         {
 #       if _FAST_MUTEX_CHECK_INITIALIZATION
@@ -379,6 +436,11 @@ NVWA_NAMESPACE_BEGIN
             _M_locked = true;
 #       endif
         }
+        bool try_lock()
+        {
+            lock();
+            return true;
+        }
         void unlock()
         {
 #       ifdef _DEBUG
@@ -394,25 +456,353 @@ NVWA_NAMESPACE_BEGIN
 NVWA_NAMESPACE_END
 # endif // Definition of class fast_mutex
 
+// The C++11 threading mode provides fast_shared_mutex only when C++14
+// shared_timed_mutex is available; it is left undefined otherwise.
+# if NVWA_USE_CXX11_MUTEX != 0 && \
+        (__cplusplus >= 201402L || \
+         (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L))
+#   include <shared_mutex>
+#   if __cplusplus >= 201703L || \
+            (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#     define _FAST_SHARED_MUTEX_IMPL std::shared_mutex
+#   else
+#     define _FAST_SHARED_MUTEX_IMPL std::shared_timed_mutex
+#   endif
 NVWA_NAMESPACE_BEGIN
-/** RAII lock class for fast_mutex. */
-class fast_mutex_autolock {
-    fast_mutex& _M_mtx;
+    /**
+     * Class for non-reentrant reader/writer mutexes.  This is the
+     * implementation using the C++17 shared_mutex (or the C++14
+     * shared_timed_mutex).
+     */
+    class fast_shared_mutex {
+        _FAST_SHARED_MUTEX_IMPL _M_mtx_impl;
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+        bool _M_initialized;
+#       endif
+
+    public:
+        fast_shared_mutex()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            _M_initialized = true;
+#       endif
+        }
+        ~fast_shared_mutex()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            _M_initialized = false;
+#       endif
+        }
+        void lock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return;
+            }
+#       endif
+            _M_mtx_impl.lock();
+        }
+        bool try_lock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return true;
+            }
+#       endif
+            return _M_mtx_impl.try_lock();
+        }
+        void unlock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return;
+            }
+#       endif
+            _M_mtx_impl.unlock();
+        }
+        void lock_shared()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return;
+            }
+#       endif
+            _M_mtx_impl.lock_shared();
+        }
+        bool try_lock_shared()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return true;
+            }
+#       endif
+            return _M_mtx_impl.try_lock_shared();
+        }
+        void unlock_shared()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return;
+            }
+#       endif
+            _M_mtx_impl.unlock_shared();
+        }
+
+    private:
+        fast_shared_mutex(const fast_shared_mutex&) _DELETED;
+        fast_shared_mutex& operator=(const fast_shared_mutex&) _DELETED;
+    };
+NVWA_NAMESPACE_END
+#   undef _FAST_SHARED_MUTEX_IMPL
+# elif defined(NVWA_PTHREADS)
+NVWA_NAMESPACE_BEGIN
+    /**
+     * Class for non-reentrant reader/writer mutexes.  This is the
+     * implementation for POSIX threads.
+     */
+    class fast_shared_mutex {
+        pthread_rwlock_t _M_mtx_impl;
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+        bool _M_initialized;
+#       endif
+
+    public:
+        fast_shared_mutex()
+        {
+            ::pthread_rwlock_init(&_M_mtx_impl, _NULLPTR);
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            _M_initialized = true;
+#       endif
+        }
+        ~fast_shared_mutex()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            _M_initialized = false;
+#       endif
+            ::pthread_rwlock_destroy(&_M_mtx_impl);
+        }
+        void lock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return;
+            }
+#       endif
+            ::pthread_rwlock_wrlock(&_M_mtx_impl);
+        }
+        bool try_lock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return true;
+            }
+#       endif
+            return ::pthread_rwlock_trywrlock(&_M_mtx_impl) == 0;
+        }
+        void unlock()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return;
+            }
+#       endif
+            ::pthread_rwlock_unlock(&_M_mtx_impl);
+        }
+        void lock_shared()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return;
+            }
+#       endif
+            ::pthread_rwlock_rdlock(&_M_mtx_impl);
+        }
+        bool try_lock_shared()
+        {
+#       if _FAST_MUTEX_CHECK_INITIALIZATION
+            if (!_M_initialized) {
+                return true;
+            }
+#       endif
+            return ::pthread_rwlock_tryrdlock(&_M_mtx_impl) == 0;
+        }
+        void unlock_shared()
+        {
+            unlock();
+        }
+
+    private:
+        fast_shared_mutex(const fast_shared_mutex&) _DELETED;
+        fast_shared_mutex& operator=(const fast_shared_mutex&) _DELETED;
+    };
+NVWA_NAMESPACE_END
+# elif defined(NVWA_WIN32THREADS)
+NVWA_NAMESPACE_BEGIN
+    /**
+     * Class for non-reentrant reader/writer mutexes.  This is the
+     * implementation for Win32 threads, using the slim reader/writer
+     * locks (Windows 7 or later is required).
+     */
+    class fast_shared_mutex {
+        SRWLOCK _M_mtx_impl;
+
+    public:
+        // A zero-initialized SRWLOCK is unlocked, so it needs no
+        // initialization check
+        fast_shared_mutex()
+        {
+            ::InitializeSRWLock(&_M_mtx_impl);
+        }
+        void lock()
+        {
+            ::AcquireSRWLockExclusive(&_M_mtx_impl);
+        }
+        bool try_lock()
+        {
+            return ::TryAcquireSRWLockExclusive(&_M_mtx_impl) != 0;
+        }
+        void unlock()
+        {
+            ::ReleaseSRWLockExclusive(&_M_mtx_impl);
+        }
+        void lock_shared()
+        {
+            ::AcquireSRWLockShared(&_M_mtx_impl);
+        }
+        bool try_lock_shared()
+        {
+            return ::TryAcquireSRWLockShared(&_M_mtx_impl) != 0;
+        }
+        void unlock_shared()
+        {
+            ::ReleaseSRWLockShared(&_M_mtx_impl);
+        }
+
+    private:
+        fast_shared_mutex(const fast_shared_mutex&) _DELETED;
+        fast_shared_mutex& operator=(const fast_shared_mutex&) _DELETED;
+    };
+NVWA_NAMESPACE_END
+# elif defined(NVWA_NOTHREADS)
+NVWA_NAMESPACE_BEGIN
+    /**
+     * Class for non-reentrant reader/writer mutexes.  This is the null
+     * implementation for single-threaded environments.
+     */
+    class fast_shared_mutex {
+    public:
+        fast_shared_mutex() {}
+        void lock() {}
+        bool try_lock()
+        {
+            return true;
+        }
+        void unlock() {}
+        void lock_shared() {}
+        bool try_lock_shared()
+        {
+            return true;
+        }
+        void unlock_shared() {}
+
+    private:
+        fast_shared_mutex(const fast_shared_mutex&) _DELETED;
+        fast_shared_mutex& operator=(const fast_shared_mutex&) _DELETED;
+    };
+NVWA_NAMESPACE_END
+# endif // Definition of class fast_shared_mutex
+
+# if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64) || \
+                           defined(_M_ARM) || defined(_M_ARM64))
+#   include <intrin.h>
+# endif
+
+NVWA_NAMESPACE_BEGIN
+/**
+ * Class for non-reentrant adaptive mutexes.  A thread that finds the
+ * mutex locked first retries for a short while, pausing the processor
+ * in between, and blocks only if the mutex is still locked.  This saves
+ * the context switches when the critical sections are short.
+ */
+class adaptive_fast_mutex {
+    fast_mutex _M_mtx_impl;
 
 public:
-    explicit fast_mutex_autolock(fast_mutex& mtx) : _M_mtx(mtx)
+    adaptive_fast_mutex() {}
+    void lock()
+    {
+        if (_M_mtx_impl.try_lock()) {
+            return;
+        }
+        for (int i = 0; i < NVWA_ADAPTIVE_MUTEX_SPIN_COUNT; ++i) {
+            pause();
+            if (_M_mtx_impl.try_lock()) {
+                return;
+            }
+        }
+        _M_mtx_impl.lock();
+    }
+    bool try_lock()
+    {
+        return _M_mtx_impl.try_lock();
+    }
+    void unlock()
+    {
+        _M_mtx_impl.unlock();
+    }
+
+private:
+    adaptive_fast_mutex(const adaptive_fast_mutex&) _DELETED;
+    adaptive_fast_mutex& operator=(const adaptive_fast_mutex&) _DELETED;
+
+    /** Tells the processor that the thread is spinning. */
+    static void pause()
+    {
+# if (defined(__GNUC__) || defined(__clang__)) && \
+        (defined(__i386__) || defined(__x86_64__))
+        __builtin_ia32_pause();
+# elif (defined(__GNUC__) || defined(__clang__)) && \
+        (defined(__arm__) || defined(__aarch64__))
+        __asm__ __volatile__("yield");
+# elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+        _mm_pause();
+# elif defined(_MSC_VER) && (defined(_M_ARM) || defined(_M_ARM64))
+        __yield();
+# endif
+    }
+};
+
+/**
+ * RAII lock class for the fast mutexes.
+ *
+ * @param _Mutex  the mutex type
+ */
+template <class _Mutex>
+class basic_fast_mutex_autolock {
+    _Mutex& _M_mtx;
+
+public:
+    explicit basic_fast_mutex_autolock(_Mutex& mtx) : _M_mtx(mtx)
     {
         _M_mtx.lock();
     }
-    ~fast_mutex_autolock()
+    ~basic_fast_mutex_autolock()
     {
         _M_mtx.unlock();
     }
 
 private:
-    fast_mutex_autolock(const fast_mutex_autolock&) _DELETED;
-    fast_mutex_autolock& operator=(const fast_mutex_autolock&) _DELETED;
+    basic_fast_mutex_autolock(const basic_fast_mutex_autolock&) _DELETED;
+    basic_fast_mutex_autolock&
+    operator=(const basic_fast_mutex_autolock&) _DELETED;
 };
+
+/** RAII lock class for fast_mutex. */
+typedef basic_fast_mutex_autolock<fast_mutex> fast_mutex_autolock;
+
+/** RAII lock class for adaptive_fast_mutex. */
+typedef basic_fast_mutex_autolock<adaptive_fast_mutex>
+    adaptive_fast_mutex_autolock;
 NVWA_NAMESPACE_END
 
 #endif // NVWA_FAST_MUTEX_H
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2009-2022 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2009-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -29,10 +29,10 @@
 /**
  * @file  fc_queue.h
  *
- * Definition of a fixed-capacity queue.  Using this file requires a
+ * Definition of fixed-capacity queues.  Using this file requires a
  * C++17-compliant compiler.
  *
- * @date  2023-06-16
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_FC_QUEUE_H
@@ -41,7 +41,7 @@
 #include <assert.h>             // assert
 #include <atomic>               // std::atomic
 #include <memory>               // std::addressof/allocator/allocator_traits
-#include <new>                  // std::bad_alloc
+#include <new>                  // std::bad_alloc/launder
 #include <type_traits>          // std::integral_constant/false_type/true_type
 #include <utility>              // std::move/swap
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
@@ -50,6 +50,14 @@
 #define NVWA_FC_QUEUE_USE_ATOMIC 1
 #endif
 
+#ifndef NVWA_FC_QUEUE_CACHE_LINE_SIZE
+/**
+ * Size in bytes of a cache line.  Indices updated by different threads
+ * are placed this far apart to avoid false sharing.
+ */
+#define NVWA_FC_QUEUE_CACHE_LINE_SIZE 64
+#endif
+
 NVWA_NAMESPACE_BEGIN
 
 namespace detail {
@@ -66,6 +74,21 @@ inline void swap_allocator(_Alloc& lhs, _Alloc& rhs, std::true_type) noexcept
     swap(lhs, rhs);
 }
 
+/**
+ * Slot of mpmc_fc_queue.  The sequence number tells whether the slot is
+ * ready to be written or read at a given queue position.
+ */
+template <typename _Tp>
+struct mpmc_slot {
+    std::atomic<size_t> seq;
+    alignas(_Tp) unsigned char storage[sizeof(_Tp)];
+
+    _Tp* ptr() noexcept
+    {
+        return std::launder(reinterpret_cast<_Tp*>(storage));
+    }
+};
+
 } /* namespace detail */
 
 /**
@@ -93,6 +116,16 @@ public:
     typedef const value_type&                         const_reference;
     typedef std::atomic<pointer>                      atomic_pointer;
 
+    /** Contiguous run of elements at the front of the queue. */
+    struct span {
+        pointer   data;
+        size_type size;
+
+        pointer begin() const noexcept { return data; }
+        pointer end() const noexcept { return data + size; }
+        bool empty() const noexcept { return size == 0; }
+    };
+
     /**
      * Default-constructor that creates an empty queue.
      *
@@ -419,6 +452,8 @@ public:
             pop();
         }
         self_increment(_M_tail);
+        // The head may have been moved past the cached copy by pop()
+        _M_head_cache = load_acquire(_M_head);
     }
 
     /**
@@ -434,6 +469,8 @@ public:
         assert(!empty());
         destroy(std::addressof(*_M_head));
         self_increment(_M_head);
+        // The head may have been moved past the cached copy of the tail
+        _M_tail_cache = load_acquire(_M_tail);
     }
 
     /**
@@ -458,8 +495,11 @@ public:
 #if NVWA_FC_QUEUE_USE_ATOMIC
         auto tail = _M_tail.load(std::memory_order_relaxed);
         auto new_tail = increment(tail);
-        if (new_tail == _M_head.load(std::memory_order_acquire)) {
-            return false;
+        if (new_tail == _M_head_cache) {
+            _M_head_cache = _M_head.load(std::memory_order_acquire);
+            if (new_tail == _M_head_cache) {
+                return false;
+            }
         }
         allocator_traits::construct(get_alloc(), std::addressof(*tail),
                                     std::forward<decltype(args)>(args)...);
@@ -492,8 +532,11 @@ public:
     {
 #if NVWA_FC_QUEUE_USE_ATOMIC
         auto head = _M_head.load(std::memory_order_relaxed);
-        if (head == _M_tail.load(std::memory_order_acquire)) {
-            return false;
+        if (head == _M_tail_cache) {
+            _M_tail_cache = _M_tail.load(std::memory_order_acquire);
+            if (head == _M_tail_cache) {
+                return false;
+            }
         }
         dest = std::move(*head);
         destroy(std::addressof(*head));
@@ -509,6 +552,138 @@ public:
         return true;
     }
 
+    /**
+     * Inserts elements from a range at the end of the queue, until the
+     * range is exhausted or the queue is full.  The new elements are
+     * made visible to the consumer at once.
+     *
+     * @param first  beginning of the range to insert
+     * @param last   end of the range to insert
+     * @return       number of elements inserted
+     * @pre          <code>capacity() > 0</code>
+     * @post         Unless an exception is thrown, the inserted elements
+     *               are at the end of the queue; otherwise this queue is
+     *               unchanged (strong exception safety is guaranteed).
+     * @see write
+     */
+    template <typename _InputIt>
+    size_type write_bulk(_InputIt first, _InputIt last)
+    {
+        assert(capacity() > 0);
+        pointer tail = load_relaxed(_M_tail);
+        pointer ptr = tail;
+        size_type count = 0;
+        try {
+            for (; first != last; ++first) {
+                pointer new_ptr = increment(ptr);
+                if (new_ptr == _M_head_cache) {
+                    _M_head_cache = load_acquire(_M_head);
+                    if (new_ptr == _M_head_cache) {
+                        break;
+                    }
+                }
+                allocator_traits::construct(get_alloc(), std::addressof(*ptr),
+                                            *first);
+                ptr = new_ptr;
+                ++count;
+            }
+        } catch (...) {
+            for (; tail != ptr; self_increment(tail)) {
+                destroy(std::addressof(*tail));
+            }
+            throw;
+        }
+        if (count != 0) {
+            store_release(_M_tail, ptr);
+        }
+        return count;
+    }
+
+    /**
+     * Moves elements at the front of the queue to an output iterator,
+     * until  max_count elements are moved or the queue is empty.  The
+     * freed space is made visible to the producer at once.  If move
+     * assignment throws, the elements moved so far are still removed.
+     *
+     * @param[out] out        iterator to store the elements
+     * @param      max_count  maximum number of elements to move
+     * @return                number of elements moved out of the queue
+     * @see read
+     */
+    template <typename _OutputIt>
+    size_type read_bulk(_OutputIt out, size_type max_count)
+    {
+        pointer head = load_relaxed(_M_head);
+        size_type count = 0;
+        try {
+            for (; count < max_count; ++count) {
+                if (head == _M_tail_cache) {
+                    _M_tail_cache = load_acquire(_M_tail);
+                    if (head == _M_tail_cache) {
+                        break;
+                    }
+                }
+                *out = std::move(*head);
+                ++out;
+                destroy(std::addressof(*head));
+                self_increment(head);
+            }
+        } catch (...) {
+            store_release(_M_head, head);
+            throw;
+        }
+        if (count != 0) {
+            store_release(_M_head, head);
+        }
+        return count;
+    }
+
+    /**
+     * Gets the longest contiguous run of elements at the front of the
+     * queue, without removing them.  The consumer may access (and move
+     * from) the elements in place, and then call \c commit_read() to
+     * remove some of them.  Elements that wrap around to the beginning
+     * of the storage are not included.
+     *
+     * @return  the run of elements at the front of the queue, empty if
+     *          the queue is empty
+     * @see commit_read
+     */
+    span peek() noexcept
+    {
+        pointer head = load_relaxed(_M_head);
+        _M_tail_cache = load_acquire(_M_tail);
+        if (_M_tail_cache >= head) {
+            return {head, static_cast<size_type>(_M_tail_cache - head)};
+        }
+        return {head, static_cast<size_type>(_M_end - head)};
+    }
+
+    /**
+     * Removes elements obtained from \c peek() at the front of the
+     * queue.
+     *
+     * @param count  number of elements to remove
+     * @pre           count shall not exceed the size of the span
+     *               returned by the last call to \c peek().
+     * @post          count elements are discarded at the front, and
+     *               the freed space is made visible to the producer.
+     * @see peek
+     */
+    void commit_read(size_type count) noexcept
+    {
+        if (count == 0) {
+            return;
+        }
+        pointer head = load_relaxed(_M_head);
+        for (; count != 0; --count) {
+            assert(head != _M_tail_cache);
+            destroy(std::addressof(*head));
+            self_increment(head);
+        }
+        store_release(_M_head, head);
+    }
+
     /**
      * Checks whether the queue contains a specific element.
      *
@@ -544,6 +719,8 @@ public:
             typename allocator_traits::propagate_on_container_swap{});
         swap_pointer(_M_head,  rhs._M_head);
         swap_pointer(_M_tail,  rhs._M_tail);
+        swap_pointer(_M_head_cache, rhs._M_head_cache);
+        swap_pointer(_M_tail_cache, rhs._M_tail_cache);
         swap_pointer(_M_begin, rhs._M_begin);
         swap_pointer(_M_end,   rhs._M_end);
     }
@@ -591,6 +768,31 @@ private:
         ptr = decrement(ptr.load(std::memory_order_relaxed));
     }
 
+    static pointer load_relaxed(const pointer& ptr) noexcept
+    {
+        return ptr;
+    }
+    static pointer load_relaxed(const atomic_pointer& ptr) noexcept
+    {
+        return ptr.load(std::memory_order_relaxed);
+    }
+    static pointer load_acquire(const pointer& ptr) noexcept
+    {
+        return ptr;
+    }
+    static pointer load_acquire(const atomic_pointer& ptr) noexcept
+    {
+        return ptr.load(std::memory_order_acquire);
+    }
+    static void store_release(pointer& ptr, pointer value) noexcept
+    {
+        ptr = value;
+    }
+    static void store_release(atomic_pointer& ptr, pointer value) noexcept
+    {
+        ptr.store(value, std::memory_order_release);
+    }
+
     void clear() noexcept
     {
         pointer ptr = _M_head;
@@ -601,6 +803,8 @@ private:
         }
         _M_head = _M_begin;
         _M_tail = _M_begin;
+        _M_head_cache = _M_begin;
+        _M_tail_cache = _M_begin;
     }
     void deallocate() noexcept
     {
@@ -627,6 +831,8 @@ private:
         _M_end = _M_begin + max_size + 1;
         _M_head = _M_begin;
         _M_tail = _M_begin;
+        _M_head_cache = _M_begin;
+        _M_tail_cache = _M_begin;
     }
 
     void copy_elements(const fc_queue& rhs)
@@ -662,6 +868,10 @@ private:
         rhs._M_head = nullptr;
         rhs._M_tail = nullptr;
 #endif
+        _M_head_cache = rhs._M_head_cache;
+        _M_tail_cache = rhs._M_tail_cache;
+        rhs._M_head_cache = nullptr;
+        rhs._M_tail_cache = nullptr;
         _M_begin = rhs._M_begin;
         _M_end = rhs._M_end;
         rhs._M_begin = nullptr;
@@ -691,15 +901,26 @@ private:
         rhs.store(temp, std::memory_order_relaxed);
     }
 
+    // The head is written by the consumer, and the tail by the
+    // producer.  Each is kept on its own cache line, together with the
+    // owner's cached copy of the other, so that write() and read() only
+    // need to load the other index when the cached copy shows the
+    // queue as full or empty.
+    pointer         _M_begin{};
+    pointer         _M_end{};
 #if NVWA_FC_QUEUE_USE_ATOMIC
+    alignas(NVWA_FC_QUEUE_CACHE_LINE_SIZE)
     atomic_pointer  _M_head{};
+    pointer         _M_tail_cache{};
+    alignas(NVWA_FC_QUEUE_CACHE_LINE_SIZE)
     atomic_pointer  _M_tail{};
+    pointer         _M_head_cache{};
 #else
     pointer         _M_head{};
+    pointer         _M_tail_cache{};
     pointer         _M_tail{};
+    pointer         _M_head_cache{};
 #endif
-    pointer         _M_begin{};
-    pointer         _M_end{};
 };
 
 /**
@@ -715,6 +936,267 @@ void swap(fc_queue<_Tp, _Alloc>& lhs, fc_queue<_Tp, _Alloc>& rhs) noexcept
     lhs.swap(rhs);
 }
 
+/**
+ * Class to represent a fixed-capacity queue that allows lockless access
+ * from multiple producers and multiple consumers.  Each slot carries a
+ * sequence number that tells whether it is ready to be written or read,
+ * so that a producer or consumer only needs one compare-and-swap on the
+ * shared tail or head to claim a slot.  Unlike fc_queue, elements can
+ * only be inserted by \c write() and removed by \c read(), and the
+ * capacity is rounded up to a power of two.  The queue can be neither
+ * copied nor moved.
+ *
+ * @param _Tp     the type of elements in the queue
+ * @param _Alloc  allocator to use for memory management
+ * @pre           \a _Tp shall be \c Destructible, nothrow \c
+ *                MoveConstructible, and nothrow \c MoveAssignable, and
+ *                \a _Alloc shall meet the allocator requirements (Table
+ *                28 in the C++11 spec).
+ */
+template <class _Tp, class _Alloc = std::allocator<_Tp>>
+class alignas(NVWA_FC_QUEUE_CACHE_LINE_SIZE) mpmc_fc_queue
+    : private _Alloc {
+public:
+    typedef _Tp                                       value_type;
+    typedef _Alloc                                    allocator_type;
+    typedef std::allocator_traits<_Alloc>             allocator_traits;
+    typedef typename allocator_traits::size_type      size_type;
+    typedef value_type&                               reference;
+    typedef const value_type&                         const_reference;
+
+    static_assert(std::is_nothrow_move_constructible_v<_Tp> &&
+                      std::is_nothrow_move_assignable_v<_Tp>,
+                  "Element moves shall not throw");
+
+    /**
+     * Constructor that creates the queue with a minimum capacity.
+     *
+     * @param max_size  the minimum capacity, which will be rounded up to
+     *                  a power of two
+     * @param alloc     the allocator to use
+     * @pre             \a max_size shall not be zero.
+     * @post            Unless memory allocation throws an exception, this
+     *                  queue will be constructed with a capacity no less
+     *                  than \a max_size, and the following conditions
+     *                  will hold:
+     *                  - <code>empty()</code>
+     *                  - <code>! full()</code>
+     *                  - <code>capacity() >= max_size</code>
+     *                  - <code>size() == 0</code>
+     *                  - <code>get_allocator() == alloc</code>
+     */
+    explicit mpmc_fc_queue(size_type             max_size,
+                           const allocator_type& alloc = allocator_type())
+        : allocator_type(alloc)
+    {
+        assert(max_size != 0);
+        size_type capacity = 1;
+        while (capacity < max_size) {
+            if (capacity > size_type(-1) / 2) {
+                throw std::bad_alloc();
+            }
+            capacity *= 2;
+        }
+        slot_allocator_type slot_alloc(get_alloc());
+        _M_slots = slot_allocator_traits::allocate(slot_alloc, capacity);
+        _M_mask = capacity - 1;
+        for (size_type i = 0; i < capacity; ++i) {
+            slot_allocator_traits::construct(slot_alloc,
+                                             std::addressof(_M_slots[i]));
+            _M_slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_fc_queue(const mpmc_fc_queue&) = delete;
+    mpmc_fc_queue& operator=(const mpmc_fc_queue&) = delete;
+
+    /**
+     * Destructor.  It erases all elements and frees memory.
+     *
+     * @pre  No other threads are accessing the queue.
+     */
+    ~mpmc_fc_queue()
+    {
+        size_type tail = _M_tail.load(std::memory_order_relaxed);
+        for (size_type pos = _M_head.load(std::memory_order_relaxed);
+             pos != tail; ++pos) {
+            allocator_traits::destroy(get_alloc(),
+                                      _M_slots[pos & _M_mask].ptr());
+        }
+        slot_allocator_type slot_alloc(get_alloc());
+        for (size_type i = 0; i <= _M_mask; ++i) {
+            slot_allocator_traits::destroy(slot_alloc,
+                                           std::addressof(_M_slots[i]));
+        }
+        slot_allocator_traits::deallocate(slot_alloc, _M_slots, _M_mask + 1);
+    }
+
+    /**
+     * Checks whether the queue is empty (containing no elements).  The
+     * result may be outdated when other threads access the queue.
+     *
+     * @return  \c true if it is empty; \c false otherwise
+     */
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Checks whether the queue is full (containing the maximum allowed
+     * elements).  The result may be outdated when other threads access
+     * the queue.
+     *
+     * @return  \c true if it is full; \c false otherwise
+     */
+    bool full() const noexcept
+    {
+        return size() == capacity();
+    }
+
+    /**
+     * Gets the maximum number of allowed elements in the queue.
+     *
+     * @return  the maximum number of allowed elements in the queue
+     */
+    size_type capacity() const noexcept
+    {
+        return _M_mask + 1;
+    }
+
+    /**
+     * Gets the number of existing elements in the queue.  The result may
+     * be outdated when other threads access the queue.  Elements being
+     * written count as existing.
+     *
+     * @return  the number of existing elements in the queue
+     */
+    size_type size() const noexcept
+    {
+        size_type head = _M_head.load(std::memory_order_acquire);
+        size_type tail = _M_tail.load(std::memory_order_acquire);
+        size_type dist = tail - head;
+        if (static_cast<std::make_signed_t<size_type>>(dist) < 0) {
+            return 0;   // Head was loaded after a concurrent read
+        }
+        return dist < capacity() ? dist : capacity();
+    }
+
+    /**
+     * Inserts a new element at the end of the queue when the queue is
+     * not full.  It may be called concurrently from multiple threads.
+     *
+     * @param args  arguments to construct a new element
+     * @return      \c true if the new element is successfully inserted;
+     *              \c false if the queue is full
+     * @post        Unless an exception is thrown or the queue is full,
+     *              the new element is inserted.  Otherwise this queue is
+     *              unchanged (strong exception safety is guaranteed).
+     */
+    template <typename... _Targs>
+    bool write(_Targs&&... args)
+    {
+        if constexpr (!std::is_nothrow_constructible_v<value_type,
+                                                       _Targs&&...>) {
+            // Construct first, as a claimed slot must always be filled
+            value_type value(std::forward<_Targs>(args)...);
+            return write(std::move(value));
+        } else {
+            size_type pos = _M_tail.load(std::memory_order_relaxed);
+            slot_type* slot;
+            for (;;) {
+                slot = std::addressof(_M_slots[pos & _M_mask]);
+                size_type seq = slot->seq.load(std::memory_order_acquire);
+                auto diff =
+                    static_cast<std::make_signed_t<size_type>>(seq - pos);
+                if (diff == 0) {
+                    if (_M_tail.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = _M_tail.load(std::memory_order_relaxed);
+                }
+            }
+            allocator_traits::construct(get_alloc(), slot->ptr(),
+                                        std::forward<_Targs>(args)...);
+            slot->seq.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+    }
+
+    /**
+     * Moves the first element in the queue to the destination when the
+     * queue is not empty.  It may be called concurrently from multiple
+     * threads.
+     *
+     * @param[out] dest  destination to store the element
+     * @return           \c true if an element is moved out of the
+     *                   queue; \c false if the queue is empty
+     */
+    bool read(reference dest)
+    {
+        size_type pos = _M_head.load(std::memory_order_relaxed);
+        slot_type* slot;
+        for (;;) {
+            slot = std::addressof(_M_slots[pos & _M_mask]);
+            size_type seq = slot->seq.load(std::memory_order_acquire);
+            auto diff =
+                static_cast<std::make_signed_t<size_type>>(seq - (pos + 1));
+            if (diff == 0) {
+                if (_M_head.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _M_head.load(std::memory_order_relaxed);
+            }
+        }
+        dest = std::move(*slot->ptr());
+        allocator_traits::destroy(get_alloc(), slot->ptr());
+        slot->seq.store(pos + _M_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Gets the allocator of the queue.
+     *
+     * @return  the allocator of the queue
+     */
+    allocator_type get_allocator() const
+    {
+        return get_alloc();
+    }
+
+private:
+    typedef detail::mpmc_slot<_Tp>                    slot_type;
+    typedef typename allocator_traits::template rebind_alloc<slot_type>
+                                                      slot_allocator_type;
+    typedef std::allocator_traits<slot_allocator_type>
+                                                      slot_allocator_traits;
+    typedef typename slot_allocator_traits::pointer   slot_pointer;
+
+    allocator_type& get_alloc() noexcept
+    {
+        return static_cast<allocator_type&>(*this);
+    }
+    const allocator_type& get_alloc() const noexcept
+    {
+        return static_cast<const allocator_type&>(*this);
+    }
+
+    slot_pointer    _M_slots{};
+    size_type       _M_mask{};
+    alignas(NVWA_FC_QUEUE_CACHE_LINE_SIZE)
+    std::atomic<size_type> _M_head{};   ///< Next position to read
+    alignas(NVWA_FC_QUEUE_CACHE_LINE_SIZE)
+    std::atomic<size_type> _M_tail{};   ///< Next position to write
+};
+
 NVWA_NAMESPACE_END
 
 #endif // NVWA_FC_QUEUE_H
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2016-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2016-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -31,14 +31,28 @@
  *
  * Code for file_line_reader, an easy-to-use line-based file reader.
  *
- * @date  2024-05-20
+ * @date  2026-10-15
  */
 
 #include "file_line_reader.h"   // file_line_reader
-#include <stdio.h>              // fgets/fread/size_t
-#include <string.h>             // memcpy/strlen
-#include <utility>              // std::move/swap
-#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include <stdio.h>              // fread/size_t
+#include <string.h>             // memchr/memcpy/memmove
+#include <algorithm>            // std::min
+#include <condition_variable>   // std::condition_variable
+#include <mutex>                // std::mutex/lock_guard/unique_lock
+#include <thread>               // std::thread
+#include <utility>              // std::exchange/move/swap
+#include "_nvwa.h"              // NVWA_NAMESPACE_*/NVWA_UNIX/NVWA_WINDOWS
+
+#if NVWA_UNIX || NVWA_WINDOWS
+#include <sys/types.h>          // struct stat (required by MSVC)
+#include <sys/stat.h>           // fstat/S_ISREG
+#endif
+
+#ifndef NVWA_FILE_LINE_READER_BUFFER_SIZE
+/** Initial size of the buffer to read the file stream into. */
+#define NVWA_FILE_LINE_READER_BUFFER_SIZE (1024 * 1024)
+#endif
 
 NVWA_NAMESPACE_BEGIN
 
@@ -144,65 +158,231 @@ void file_line_reader::iterator::swap(
     std::swap(_M_capacity, rhs._M_capacity);
 }
 
+namespace {
+
+char* expand(char* data, size_t size, size_t capacity)
+{
+    char* new_ptr = new char[capacity];
+    memcpy(new_ptr, data, size);
+    delete[] data;
+    return new_ptr;
+}
+
+/**
+ * Checks whether a file stream is connected to a regular file, whose
+ * reads always complete.  Reads from pipes, terminals, and sockets may
+ * block indefinitely.
+ */
+bool is_regular_file(FILE* stream)
+{
+#if NVWA_UNIX
+    struct stat s;
+    return fstat(fileno(stream), &s) == 0 && S_ISREG(s.st_mode);
+#elif NVWA_WINDOWS
+    struct _stat s;
+    return _fstat(_fileno(stream), &s) == 0 &&
+           (s.st_mode & _S_IFMT) == _S_IFREG;
+#else
+    (void)stream;
+    return false;
+#endif
+}
+
+} // unnamed namespace
+
+/**
+ * Class to read a file stream in a helper thread.  Two chunks are used in
+ * turn: while the reader copies content out of one, the helper thread
+ * reads the next one into the other.
+ */
+class file_line_reader::_Prefetcher {
+public:
+    explicit _Prefetcher(FILE* stream);
+    ~_Prefetcher();
+    size_t read(char* buffer, size_t size);
+
+private:
+    static const size_t chunk_size = NVWA_FILE_LINE_READER_BUFFER_SIZE / 2;
+
+    void run();
+
+    struct chunk {
+        std::unique_ptr<char[]> data{new char[chunk_size]};
+        size_t                  size{};
+        bool                    full{};
+    };
+
+    FILE*                   _M_stream;
+    chunk                   _M_chunks[2];
+    unsigned                _M_index{};     ///< Chunk being consumed
+    size_t                  _M_read_pos{};  ///< Position in the chunk
+    bool                    _M_stopped{};
+    std::mutex              _M_lock;
+    std::condition_variable _M_cond;
+    std::thread             _M_thread;
+};
+
+file_line_reader::_Prefetcher::_Prefetcher(FILE* stream) : _M_stream(stream)
+{
+    _M_thread = std::thread(&_Prefetcher::run, this);
+}
+
+file_line_reader::_Prefetcher::~_Prefetcher()
+{
+    {
+        std::lock_guard<std::mutex> guard(_M_lock);
+        _M_stopped = true;
+    }
+    _M_cond.notify_all();
+    _M_thread.join();
+}
+
+/**
+ * Copies prefetched content, waiting for the helper thread if it has not
+ * got any.
+ *
+ * @param buffer  buffer to receive the content
+ * @param size    size of the buffer
+ * @return        number of bytes copied; \c 0 on end-of-file or error
+ */
+size_t file_line_reader::_Prefetcher::read(char* buffer, size_t size)
+{
+    chunk& current = _M_chunks[_M_index];
+    {
+        std::unique_lock<std::mutex> guard(_M_lock);
+        _M_cond.wait(guard, [&current] { return current.full; });
+    }
+    // The helper thread does not touch a full chunk
+    size_t count = std::min(size, current.size - _M_read_pos);
+    memcpy(buffer, current.data.get() + _M_read_pos, count);
+    _M_read_pos += count;
+    if (_M_read_pos == current.size && current.size != 0) {
+        {
+            std::lock_guard<std::mutex> guard(_M_lock);
+            current.full = false;
+        }
+        _M_cond.notify_all();
+        _M_index ^= 1;
+        _M_read_pos = 0;
+    }
+    return count;
+}
+
+void file_line_reader::_Prefetcher::run()
+{
+    for (unsigned index = 0;; index ^= 1) {
+        chunk& next = _M_chunks[index];
+        {
+            std::unique_lock<std::mutex> guard(_M_lock);
+            _M_cond.wait(guard, [this, &next] {
+                return _M_stopped || !next.full;
+            });
+            if (_M_stopped) {
+                return;
+            }
+        }
+        size_t count = fread(next.data.get(), 1, chunk_size, _M_stream);
+        {
+            std::lock_guard<std::mutex> guard(_M_lock);
+            next.size = count;
+            next.full = true;
+        }
+        _M_cond.notify_all();
+        if (count == 0) {
+            // End-of-file is left in the chunk for the reader to see
+            return;
+        }
+    }
+}
+
 /**
  * Constructor.
  *
  * @param stream     the file stream to read from
  * @param delimiter  the delimiter between text `lines' (default to LF)
  * @param strip      enumerator about whether to strip the delimiter
+ * @param prefetch   enumerator about whether to read in the background,
+ *                   so that reading and splitting lines can overlap; it
+ *                   takes effect only on regular files, as the helper
+ *                   thread could not be stopped while it is blocked
+ *                   reading a pipe, terminal, or socket
  */
 file_line_reader::file_line_reader(FILE* stream, char delimiter,
-                                   strip_type strip)
+                                   strip_type strip,
+                                   prefetch_type prefetch)
     : _M_stream(stream),
       _M_delimiter(delimiter),
-      _M_strip_delimiter(strip == strip_delimiter)
+      _M_strip_delimiter(strip == strip_delimiter),
+      _M_buffer(new char[NVWA_FILE_LINE_READER_BUFFER_SIZE]),
+      _M_capacity(NVWA_FILE_LINE_READER_BUFFER_SIZE)
 {
-    if (delimiter == '\n') {
-        _M_buffer = nullptr;
-    } else {
-        _M_buffer = new char[BUFFER_SIZE];
+    if (prefetch == async_prefetch && is_regular_file(stream)) {
+        _M_prefetcher.reset(new _Prefetcher(stream));
     }
 }
 
-/** Destructor. */
-file_line_reader::~file_line_reader()
+/** Move constructor. */
+file_line_reader::file_line_reader(file_line_reader&& rhs) noexcept
+    : _M_stream(rhs._M_stream),
+      _M_delimiter(rhs._M_delimiter),
+      _M_strip_delimiter(rhs._M_strip_delimiter),
+      _M_buffer(std::exchange(rhs._M_buffer, nullptr)),
+      _M_capacity(std::exchange(rhs._M_capacity, 0)),
+      _M_offset(rhs._M_offset),
+      _M_read_pos(std::exchange(rhs._M_read_pos, 0)),
+      _M_size(std::exchange(rhs._M_size, 0)),
+      _M_prefetcher(std::move(rhs._M_prefetcher))
 {
-    delete[] _M_buffer;
 }
 
-namespace {
+/** Move assignment operator. */
+file_line_reader& file_line_reader::operator=(file_line_reader&& rhs) noexcept
+{
+    if (this != &rhs) {
+        delete[] _M_buffer;
+        _M_stream = rhs._M_stream;
+        _M_delimiter = rhs._M_delimiter;
+        _M_strip_delimiter = rhs._M_strip_delimiter;
+        _M_buffer = std::exchange(rhs._M_buffer, nullptr);
+        _M_capacity = std::exchange(rhs._M_capacity, 0);
+        _M_offset = rhs._M_offset;
+        _M_read_pos = std::exchange(rhs._M_read_pos, 0);
+        _M_size = std::exchange(rhs._M_size, 0);
+        _M_prefetcher = std::move(rhs._M_prefetcher);
+    }
+    return *this;
+}
 
-char* expand(char* data, size_t size, size_t capacity)
+/** Destructor. */
+file_line_reader::~file_line_reader()
 {
-    char* new_ptr = new char[capacity];
-    memcpy(new_ptr, data, size);
-    delete[] data;
-    return new_ptr;
+    delete[] _M_buffer;
 }
 
-void get_line(char*& output, size_t& capacity, bool& found_delimiter,
-              size_t& write_pos, FILE* stream)
+/**
+ * Reads more content from the file stream to the end of the buffer.  It
+ * goes through \c fread, so that content already buffered in the stream
+ * (say, after reading a header line with \c fgets) is not lost, and the
+ * stream position agrees with what has been read.  In the prefetching
+ * mode, the content comes from the helper thread.
+ *
+ * @return  \c true if some content is read; \c false on end-of-file or
+ *          error, which can be told apart by \c ferror on the stream
+ */
+bool file_line_reader::fill_buffer()
 {
-    for (;;) {
-        if (!fgets(output + write_pos,
-                   static_cast<int>(capacity - write_pos), stream)) {
-            break;
-        }
-        size_t len = strlen(output + write_pos);
-        write_pos += len;
-        if (output[write_pos - 1] == '\n') {
-            found_delimiter = true;
-            break;
-        }
-        if (write_pos + 1 == capacity) {
-            output = expand(output, write_pos, capacity * 2);
-            capacity *= 2;
-        }
+    size_t count;
+    if (_M_prefetcher) {
+        count = _M_prefetcher->read(_M_buffer + _M_size,
+                                    _M_capacity - _M_size);
+    } else {
+        count = fread(_M_buffer + _M_size, 1, _M_capacity - _M_size,
+                      _M_stream);
     }
+    _M_size += count;
+    return count != 0;
 }
 
-} // unnamed namespace
-
 /**
  * Reads content from the file stream.  If necessary, the receiving
  * buffer will be expanded so that it is big enough to contain all the
@@ -221,28 +401,36 @@ bool file_line_reader::read(char*& output, size_t& size, size_t& capacity)
     bool found_delimiter = false;
     size_t write_pos = 0;
 
-    if (_M_delimiter == '\n') {
-        get_line(output, capacity, found_delimiter, write_pos, _M_stream);
-    } else {
-        for (;;) {
-            if (_M_read_pos == _M_size) {
-                _M_read_pos = 0;
-                _M_size = fread(_M_buffer, 1, BUFFER_SIZE, _M_stream);
-                if (_M_size == 0) {
-                    break;
-                }
-            }
-            char ch = _M_buffer[_M_read_pos++];
-            if (write_pos + 1 == capacity) {
-                output = expand(output, write_pos, capacity * 2);
-                capacity *= 2;
-            }
-            output[write_pos++] = ch;
-            if (ch == _M_delimiter) {
-                found_delimiter = true;
+    for (;;) {
+        if (_M_read_pos == _M_size) {
+            _M_read_pos = 0;
+            _M_size = 0;
+            if (!fill_buffer()) {
                 break;
             }
         }
+        const char* ptr = _M_buffer + _M_read_pos;
+        size_t len = _M_size - _M_read_pos;
+        auto delimiter_ptr =
+            static_cast<const char*>(memchr(ptr, _M_delimiter, len));
+        if (delimiter_ptr) {
+            found_delimiter = true;
+            len = delimiter_ptr - ptr + 1;
+        }
+        if (write_pos + len >= capacity) {
+            size_t new_capacity = capacity * 2;
+            while (write_pos + len >= new_capacity) {
+                new_capacity *= 2;
+            }
+            output = expand(output, write_pos, new_capacity);
+            capacity = new_capacity;
+        }
+        memcpy(output + write_pos, ptr, len);
+        write_pos += len;
+        _M_read_pos += len;
+        if (found_delimiter) {
+            break;
+        }
     }
     _M_offset += write_pos;
 
@@ -258,4 +446,57 @@ bool file_line_reader::read(char*& output, size_t& size, size_t& capacity)
     }
 }
 
+#if HAVE_CXX17_STRING_VIEW
+/**
+ * Reads content from the file stream without copying.  A line crossing
+ * the end of the buffer is moved to the beginning of the buffer before
+ * more content is read, and the buffer is expanded when a line is longer
+ * than it.
+ *
+ * @param[out] output  view of the line, valid until the next read
+ * @return             \c true if line content is returned; \c false
+ *                     otherwise
+ */
+bool file_line_reader::read(std::string_view& output)
+{
+    bool found_delimiter = false;
+    size_t scan_pos = _M_read_pos;
+    size_t end_pos;
+    for (;;) {
+        auto delimiter_ptr = static_cast<const char*>(memchr(
+            _M_buffer + scan_pos, _M_delimiter, _M_size - scan_pos));
+        if (delimiter_ptr) {
+            found_delimiter = true;
+            end_pos = delimiter_ptr - _M_buffer + 1;
+            break;
+        }
+        if (_M_read_pos != 0) {
+            memmove(_M_buffer, _M_buffer + _M_read_pos,
+                    _M_size - _M_read_pos);
+            _M_size -= _M_read_pos;
+            _M_read_pos = 0;
+        }
+        scan_pos = _M_size;
+        if (_M_size == _M_capacity) {
+            _M_buffer = expand(_M_buffer, _M_size, _M_capacity * 2);
+            _M_capacity *= 2;
+        }
+        if (!fill_buffer()) {
+            end_pos = _M_size;
+            break;
+        }
+    }
+
+    size_t len = end_pos - _M_read_pos;
+    if (len == 0) {
+        return false;
+    }
+    output = std::string_view(_M_buffer + _M_read_pos,
+                              len - (found_delimiter && _M_strip_delimiter));
+    _M_offset += len;
+    _M_read_pos = end_pos;
+    return true;
+}
+#endif
+
 NVWA_NAMESPACE_END
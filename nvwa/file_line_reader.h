@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2016-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2016-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -31,7 +31,7 @@
  *
  * Header file for file_line_reader, an easy-to-use line-based file reader.
  *
- * @date  2024-05-20
+ * @date  2026-10-15
  */
 
 #ifndef NVWA_FILE_LINE_READER_H
@@ -41,11 +41,21 @@
 #include <stddef.h>             // ptrdiff_t/size_t
 #include <stdio.h>              // FILE
 #include <iterator>             // std::input_iterator_tag
+#include <memory>               // std::unique_ptr
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "c++_features.h"       // HAVE_CXX17_STRING_VIEW
+
+#if HAVE_CXX17_STRING_VIEW
+#include <string_view>          // std::string_view
+#endif
 
 NVWA_NAMESPACE_BEGIN
 
-/** Class to allow iteration over all lines of a text file. */
+/**
+ * Class to allow iteration over all lines of a text file.  The file is
+ * read in large chunks into a buffer owned by the reader, so nothing
+ * else shall read from the stream while the reader is in use.
+ */
 class file_line_reader {
 public:
     /**
@@ -118,18 +128,107 @@ public:
         size_t            _M_capacity{};
     };
 
+#if HAVE_CXX17_STRING_VIEW
+    /**
+     * Iterator that contains a view of the line content.
+     *
+     * The content is \e owned by the reader, and it is valid only until
+     * the next line is read.
+     */
+    class view_iterator {  // implements InputIterator
+    public:
+        typedef ptrdiff_t               difference_type;
+        typedef std::string_view        value_type;
+        typedef const value_type*       pointer;
+        typedef const value_type&       reference;
+        typedef std::input_iterator_tag iterator_category;
+
+        view_iterator() = default;
+        explicit view_iterator(file_line_reader* reader) : _M_reader(reader)
+        {
+            ++*this;
+        }
+
+        reference operator*() const noexcept
+        {
+            assert(_M_reader != nullptr);
+            return _M_line;
+        }
+        pointer operator->() const noexcept
+        {
+            assert(_M_reader != nullptr);
+            return &_M_line;
+        }
+        view_iterator& operator++()
+        {
+            if (!_M_reader->read(_M_line)) {
+                _M_reader = nullptr;
+                _M_offset = 0;
+            } else {
+                _M_offset = _M_reader->_M_offset;
+            }
+            return *this;
+        }
+        view_iterator operator++(int)
+        {
+            view_iterator temp(*this);
+            ++*this;
+            return temp;
+        }
+
+        bool operator==(const view_iterator& rhs) const noexcept
+        {
+            return _M_reader == rhs._M_reader && _M_offset == rhs._M_offset;
+        }
+        bool operator!=(const view_iterator& rhs) const noexcept
+        {
+            return !operator==(rhs);
+        }
+
+    private:
+        file_line_reader* _M_reader{};
+        size_t            _M_offset{};
+        value_type        _M_line;
+    };
+
+    /** Range of line views, as returned by #views. */
+    class view_range {
+    public:
+        explicit view_range(file_line_reader* reader) : _M_reader(reader) {}
+        view_iterator begin()
+        {
+            return view_iterator(_M_reader);
+        }
+        view_iterator end() const noexcept
+        {
+            return {};
+        }
+
+    private:
+        file_line_reader* _M_reader;
+    };
+#endif
+
     /** Enumeration of whether the delimiter should be stripped. */
     enum strip_type {
         strip_delimiter,     ///< The delimiter should be stripped
         no_strip_delimiter,  ///< The delimiter should be retained
     };
 
+    /** Enumeration of whether the file should be read in the background. */
+    enum prefetch_type {
+        no_prefetch,         ///< Reading happens when the buffer is used up
+        async_prefetch,      ///< The next chunk is read by a helper thread
+                             ///< (for regular files only)
+    };
+
     explicit file_line_reader(FILE* stream, char delimiter = '\n',
-                              strip_type strip = strip_delimiter);
+                              strip_type strip = strip_delimiter,
+                              prefetch_type prefetch = no_prefetch);
     file_line_reader(const file_line_reader&) = delete;
     file_line_reader& operator=(const file_line_reader&) = delete;
-    file_line_reader(file_line_reader&&) = default;
-    file_line_reader& operator=(file_line_reader&&) = default;
+    file_line_reader(file_line_reader&& rhs) noexcept;
+    file_line_reader& operator=(file_line_reader&& rhs) noexcept;
     ~file_line_reader();
 
     iterator begin()
@@ -140,16 +239,37 @@ public:
     {
         return {};
     }
+#if HAVE_CXX17_STRING_VIEW
+    /**
+     * Gets a range to iterate over the lines without copying them.
+     * Lines are viewed directly in the read buffer, so it is the fastest
+     * way to read lines from pipes and sockets.
+     */
+    view_range views()
+    {
+        return view_range(this);
+    }
+#endif
+
     bool read(char*& output, size_t& size, size_t& capacity);
+#if HAVE_CXX17_STRING_VIEW
+    bool read(std::string_view& output);
+#endif
 
 private:
+    class _Prefetcher;
+
+    bool fill_buffer();
+
     FILE*  _M_stream;
     char   _M_delimiter;
     bool   _M_strip_delimiter;
     char*  _M_buffer;
+    size_t _M_capacity;
     size_t _M_offset{};
     size_t _M_read_pos{};
     size_t _M_size{};
+    std::unique_ptr<_Prefetcher> _M_prefetcher;
 };
 
 inline void swap(file_line_reader::iterator& lhs,
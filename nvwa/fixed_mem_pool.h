@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2005-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2005-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -42,14 +42,22 @@
  *   alignment value for this specific type.
  * - Optionally, specialize fixed_mem_pool::bad_alloc_handler to change
  *   the behaviour when all memory blocks are allocated.
+ * - Optionally, specialize fixed_mem_pool::max_arenas to let the memory
+ *   pool grow by adding arenas (of the initial size) on demand, and
+ *   fixed_mem_pool::numa_local to allocate each arena on the NUMA node
+ *   of the thread that causes its allocation.
+ * - Optionally, specialize fixed_mem_pool::huge_pages to back the
+ *   arenas with huge pages (requires linking aligned_memory.cpp).
  * - Call fixed_mem_pool<_Cls>::initialize at the beginning of the
  *   program.
  * - Optionally, call fixed_mem_pool<_Cls>::deinitialize at exit of the
  *   program to check for memory leaks.
  * - Optionally, call fixed_mem_pool<_Cls>::get_alloc_count to check
- *   memory usage when the program is running.
+ *   memory usage when the program is running, or define
+ *   #_MEM_POOL_STATS to a non-zero value and call
+ *   fixed_mem_pool<_Cls>::get_stats for more statistics.
  *
- * @date  2024-05-20
+ * @date  2026-10-15
  */
 
 #ifndef NVWA_FIXED_MEM_POOL_H
@@ -73,6 +81,16 @@ NVWA_NAMESPACE_BEGIN
 #define MEM_POOL_ALIGNMENT sizeof(void*)
 #endif
 
+#if _MEM_POOL_STATS
+/*
+ * The statistics change the layout of fixed_mem_pool, so it is put into
+ * an inline namespace when they are enabled, and translation units
+ * built with and without them get distinct pool types.  Specializations
+ * of its member structs can still be written in namespace nvwa.
+ */
+inline namespace fixed_mem_pool_stats {
+#endif
+
 /**
  * Class template to manipulate a fixed-size memory pool.  Please notice
  * that only allocate and deallocate are protected by a lock.
@@ -82,7 +100,8 @@ NVWA_NAMESPACE_BEGIN
 template <class _Tp>
 class fixed_mem_pool {
 public:
-    typedef typename class_level_lock<fixed_mem_pool<_Tp> >::lock lock;
+    typedef typename class_level_lock<fixed_mem_pool<_Tp>, true,
+                                      adaptive_fast_mutex>::lock lock;
     /**
      * Specializable struct to define the alignment of an object in the
      * fixed_mem_pool.
@@ -99,23 +118,94 @@ public:
             (sizeof(_Tp) + fixed_mem_pool<_Tp>::alignment::value - 1)
                        & ~(fixed_mem_pool<_Tp>::alignment::value - 1);
     };
+    /**
+     * Specializable struct to define the maximum number of arenas
+     * (chunks of memory of the size given to initialize).  The default
+     * value 1 means that the memory pool does not grow.
+     */
+    struct max_arenas {
+        static const size_t value = 1;
+    };
+    /**
+     * Specializable struct to define whether each arena is allocated on
+     * the NUMA node of the thread that causes its allocation.
+     */
+    struct numa_local {
+        static const bool value = false;
+    };
+    /**
+     * Specializable struct to define whether the arenas are backed by
+     * huge pages when possible (see nvwa#huge_page_malloc).  It takes
+     * precedence over fixed_mem_pool::numa_local.
+     */
+    struct huge_pages {
+        static const bool value = false;
+    };
     static void*  allocate();
     static void   deallocate(void* block_ptr);
     static bool   initialize(size_t size);
     static int    deinitialize();
     static int    get_alloc_count();
+    static int    get_alloc_count(size_t arena);
+    static size_t get_arena_count();
+    static bool   get_stats(mem_pool_stats& stats);
     static bool   is_initialized();
 protected:
     static bool   bad_alloc_handler();
 private:
-    static void*  _S_mem_pool_ptr;
+    /** Struct to store information about an arena. */
+    struct _Arena {
+        char*     _M_begin;         ///< Start of the arena memory
+        int       _M_alloc_cnt;     ///< Count of allocations in the arena
+    };
+    static bool   _S_add_arena();
+    static _Arena* _S_find_arena(void* block_ptr);
+
+#   if _MEM_POOL_STATS
+    /** Guard on the pool lock that counts its contentions. */
+    struct _Guard : lock {
+        _Guard() : lock(_S_lock_contentions) {}
+    };
+    static std::atomic<size_t> _S_lock_contentions;
+    static int    _S_high_water;
+#   else
+    typedef lock _Guard;
+#   endif
+
+    static _Arena _S_arenas[];
+    static size_t _S_arena_cnt;
+    static size_t _S_arena_size;
+    static char*  _S_unused_ptr;
+    static char*  _S_unused_end;
     static void*  _S_first_avail_ptr;
     static int    _S_alloc_cnt;
 };
 
-/** Pointer to the allocated chunk of memory. */
+/** Information about the allocated arenas. */
+template <class _Tp>
+typename fixed_mem_pool<_Tp>::_Arena
+fixed_mem_pool<_Tp>::_S_arenas[fixed_mem_pool<_Tp>::max_arenas::value];
+
+/** Number of allocated arenas. */
+template <class _Tp>
+size_t fixed_mem_pool<_Tp>::_S_arena_cnt = 0;
+
+/** Number of memory blocks in each arena. */
 template <class _Tp>
-void* fixed_mem_pool<_Tp>::_S_mem_pool_ptr = _NULLPTR;
+size_t fixed_mem_pool<_Tp>::_S_arena_size = 0;
+
+/**
+ * Pointer to the first never-allocated memory block in the latest
+ * arena.  Blocks are linked into the list of available memory blocks
+ * only when they are deallocated, so that a large memory pool is not
+ * touched as a whole on initialization.
+ */
+template <class _Tp>
+char* fixed_mem_pool<_Tp>::_S_unused_ptr = _NULLPTR;
+
+/** Pointer to the end of the latest arena. */
+template <class _Tp>
+char* fixed_mem_pool<_Tp>::_S_unused_end = _NULLPTR;
 
 /** Pointer to the first available memory block. */
 template <class _Tp>
@@ -125,6 +215,16 @@ void* fixed_mem_pool<_Tp>::_S_first_avail_ptr = _NULLPTR;
 template <class _Tp>
 int   fixed_mem_pool<_Tp>::_S_alloc_cnt = 0;
 
+#if _MEM_POOL_STATS
+/** Count of waits to acquire the lock. */
+template <class _Tp>
+std::atomic<size_t> fixed_mem_pool<_Tp>::_S_lock_contentions(0);
+
+/** Maximum count of allocations. */
+template <class _Tp>
+int   fixed_mem_pool<_Tp>::_S_high_water = 0;
+#endif
+
 /**
  * Allocates a memory block from the memory pool.
  *
@@ -133,15 +233,29 @@ int   fixed_mem_pool<_Tp>::_S_alloc_cnt = 0;
 template <class _Tp>
 inline void* fixed_mem_pool<_Tp>::allocate()
 {
-    lock guard;
+    _Guard guard;
     for (;;) {
-        if (void* result = _S_first_avail_ptr) {
+        void* result = _S_first_avail_ptr;
+        if (result) {
             _S_first_avail_ptr = *(void**)_S_first_avail_ptr;
-            ++_S_alloc_cnt;
-            return result;
-        } else if (!bad_alloc_handler()) {
+        } else if (_S_unused_ptr != _S_unused_end) {
+            result = _S_unused_ptr;
+            _S_unused_ptr += block_size::value;
+        } else if (!_S_add_arena() && !bad_alloc_handler()) {
             return _NULLPTR;
+        } else {
+            continue;
         }
+        ++_S_alloc_cnt;
+#   if _MEM_POOL_STATS
+        if (_S_alloc_cnt > _S_high_water) {
+            _S_high_water = _S_alloc_cnt;
+        }
+#   endif
+        if (max_arenas::value > 1) {
+            ++_S_find_arena(result)->_M_alloc_cnt;
+        }
+        return result;
     }
 }
 
@@ -156,9 +270,12 @@ inline void fixed_mem_pool<_Tp>::deallocate(void* block_ptr)
     if (block_ptr == _NULLPTR) {
         return;
     }
-    lock guard;
+    _Guard guard;
     assert(_S_alloc_cnt != 0);
     --_S_alloc_cnt;
+    if (max_arenas::value > 1) {
+        --_S_find_arena(block_ptr)->_M_alloc_cnt;
+    }
     *static_cast<void**>(block_ptr) = _S_first_avail_ptr;
     _S_first_avail_ptr = block_ptr;
 }
@@ -166,7 +283,8 @@ inline void fixed_mem_pool<_Tp>::deallocate(void* block_ptr)
 /**
  * Initializes the memory pool.
  *
- * @param size  number of memory blocks to put in the memory pool
+ * @param size  number of memory blocks to put in the memory pool (in
+ *              each arena, if fixed_mem_pool::max_arenas is specialized)
  * @return      \c true if successful; \c false if memory insufficient
  */
 template <class _Tp>
@@ -178,21 +296,11 @@ bool fixed_mem_pool<_Tp>::initialize(size_t size)
                   Alignment_must_be_power_of_two);
     STATIC_ASSERT(block_size::value >= sizeof(void*),
                   Alignment_too_small);
+    STATIC_ASSERT(max_arenas::value > 0, Bad_max_arenas);
     assert(!is_initialized());
     assert(size > 0);
-    _S_mem_pool_ptr = mem_pool_base::alloc_sys(size * block_size::value);
-    _S_first_avail_ptr = _S_mem_pool_ptr;
-    if (_S_mem_pool_ptr == _NULLPTR) {
-        return false;
-    }
-    char* block = (char*)_S_mem_pool_ptr;
-    while (--size != 0) {
-        char* next = block + block_size::value;
-        *reinterpret_cast<void**>(block) = next;
-        block = next;
-    }
-    *reinterpret_cast<void**>(block) = _NULLPTR;
-    return true;
+    _S_arena_size = size;
+    return _S_add_arena();
 }
 
 /**
@@ -209,9 +317,20 @@ int fixed_mem_pool<_Tp>::deinitialize()
         return _S_alloc_cnt;
     }
     assert(is_initialized());
-    mem_pool_base::dealloc_sys(_S_mem_pool_ptr);
-    _S_mem_pool_ptr = _NULLPTR;
+    while (_S_arena_cnt != 0) {
+        char* arena_ptr = _S_arenas[--_S_arena_cnt]._M_begin;
+        size_t arena_bytes = _S_arena_size * block_size::value;
+        if (huge_pages::value) {
+            mem_pool_base::dealloc_sys_huge(arena_ptr, arena_bytes);
+        } else if (numa_local::value) {
+            mem_pool_base::dealloc_sys_local(arena_ptr, arena_bytes);
+        } else {
+            mem_pool_base::dealloc_sys(arena_ptr);
+        }
+    }
     _S_first_avail_ptr = _NULLPTR;
+    _S_unused_ptr = _NULLPTR;
+    _S_unused_end = _NULLPTR;
     return 0;
 }
 
@@ -226,6 +345,65 @@ inline int fixed_mem_pool<_Tp>::get_alloc_count()
     return _S_alloc_cnt;
 }
 
+/**
+ * Gets the allocation count of an arena.  It is only tracked when
+ * fixed_mem_pool::max_arenas is greater than 1; otherwise it is the
+ * same as the total allocation count.
+ *
+ * @param arena  index of the arena, less than get_arena_count()
+ * @return       the number of memory blocks still in allocation in the
+ *               arena
+ */
+template <class _Tp>
+inline int fixed_mem_pool<_Tp>::get_alloc_count(size_t arena)
+{
+    assert(arena < _S_arena_cnt);
+    lock guard;
+    if (max_arenas::value > 1) {
+        return _S_arenas[arena]._M_alloc_cnt;
+    } else {
+        return _S_alloc_cnt;
+    }
+}
+
+/**
+ * Gets the number of arenas.
+ *
+ * @return  the number of arenas currently allocated
+ */
+template <class _Tp>
+inline size_t fixed_mem_pool<_Tp>::get_arena_count()
+{
+    return _S_arena_cnt;
+}
+
+/**
+ * Gets the run-time statistics of the memory pool.  The number of
+ * system allocations is the number of arenas.
+ *
+ * @param[out] stats  the statistics, if available
+ * @return            \c true if #_MEM_POOL_STATS is non-zero; \c false
+ *                    otherwise
+ */
+template <class _Tp>
+bool fixed_mem_pool<_Tp>::get_stats(mem_pool_stats& stats)
+{
+#   if _MEM_POOL_STATS
+    lock guard;
+    stats.block_size = block_size::value;
+    stats.group_id = 0;
+    stats.allocated = _S_alloc_cnt;
+    stats.high_water = _S_high_water;
+    stats.free_blocks = _S_arena_cnt * _S_arena_size - _S_alloc_cnt;
+    stats.sys_allocs = _S_arena_cnt;
+    stats.lock_contentions = _S_lock_contentions.load();
+    return true;
+#   else
+    (void)stats;
+    return false;
+#   endif
+}
+
 /**
  * Is the memory pool initialized?
  *
@@ -234,7 +412,7 @@ inline int fixed_mem_pool<_Tp>::get_alloc_count()
 template <class _Tp>
 inline bool fixed_mem_pool<_Tp>::is_initialized()
 {
-    return _S_mem_pool_ptr != _NULLPTR;
+    return _S_arena_cnt != 0;
 }
 
 /**
@@ -251,6 +429,64 @@ bool fixed_mem_pool<_Tp>::bad_alloc_handler()
     return false;
 }
 
+/**
+ * Adds an arena to the memory pool, when there are no more available
+ * memory blocks.  Its memory blocks are handed out in order, without
+ * being linked first, so its pages are touched only when used.
+ *
+ * @return  \c true if successful; \c false if the maximum number of
+ *          arenas is reached or memory is insufficient
+ */
+template <class _Tp>
+bool fixed_mem_pool<_Tp>::_S_add_arena()
+{
+    assert(_S_first_avail_ptr == _NULLPTR);
+    assert(_S_unused_ptr == _S_unused_end);
+    if (_S_arena_cnt == max_arenas::value) {
+        return false;
+    }
+    size_t arena_bytes = _S_arena_size * block_size::value;
+    char* arena_ptr = static_cast<char*>(
+        huge_pages::value ? mem_pool_base::alloc_sys_huge(arena_bytes)
+        : numa_local::value ? mem_pool_base::alloc_sys_local(arena_bytes)
+                            : mem_pool_base::alloc_sys(arena_bytes));
+    if (arena_ptr == _NULLPTR) {
+        return false;
+    }
+    _Arena& arena = _S_arenas[_S_arena_cnt++];
+    arena._M_begin = arena_ptr;
+    arena._M_alloc_cnt = 0;
+    _S_unused_ptr = arena_ptr;
+    _S_unused_end = arena_ptr + arena_bytes;
+    return true;
+}
+
+/**
+ * Finds the arena a memory block belongs to.
+ *
+ * @param block_ptr  pointer to the memory block
+ * @return           pointer to the arena information
+ */
+template <class _Tp>
+typename fixed_mem_pool<_Tp>::_Arena*
+fixed_mem_pool<_Tp>::_S_find_arena(void* block_ptr)
+{
+    char* ptr = static_cast<char*>(block_ptr);
+    size_t arena_bytes = _S_arena_size * block_size::value;
+    for (size_t i = 0; i < _S_arena_cnt; ++i) {
+        if (ptr >= _S_arenas[i]._M_begin &&
+                ptr < _S_arenas[i]._M_begin + arena_bytes) {
+            return &_S_arenas[i];
+        }
+    }
+    assert(false);
+    return _NULLPTR;
+}
+
+#if _MEM_POOL_STATS
+} /* inline namespace fixed_mem_pool_stats */
+#endif
+
 NVWA_NAMESPACE_END
 
 /**
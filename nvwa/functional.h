@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2014-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2014-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -32,19 +32,23 @@
  * Utility templates for functional programming style.  Using this file
  * requires a C++14-compliant compiler.
  *
- * @date  2024-04-29
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_FUNCTIONAL_H
 #define NVWA_FUNCTIONAL_H
 
+#include <algorithm>            // std::min
 #include <cassert>              // assert
+#include <exception>            // std::exception_ptr/current_exception/...
 #include <functional>           // std::function/ref
-#include <iterator>             // std::begin/iterator_traits
+#include <iterator>             // std::begin/distance/iterator_traits/next
 #include <memory>               // std::allocator
 #include <new>                  // placement new
 #include <stdexcept>            // std::logic_error
+#include <stddef.h>             // ptrdiff_t/size_t
 #include <string>               // std::string
+#include <thread>               // std::thread
 #include <tuple>                // std::tuple
 #include <type_traits>          // std::decay_t/is_const/integral_constant/...
 #include <utility>              // std::declval/forward/move/index_sequence
@@ -775,6 +779,522 @@ constexpr auto reduce(_Fn&& f, _Rng&& inputs, _Rs&& initval)
                   begin(inputs), end(inputs));
 }
 
+namespace execution {
+
+/** Execution policy that requires sequential execution. */
+struct sequenced_policy {};
+
+/**
+ * Execution policy that allows the work to be split across threads.
+ * Unlike \c std::execution::par, it does not require a parallel backend
+ * (like TBB) from the standard library, and allows specifying the level
+ * of parallelism.
+ */
+struct parallel_policy {
+    /**
+     * Constructor.
+     *
+     * @param max_threads  maximum number of threads to use, zero
+     *                     meaning \c std::thread::hardware_concurrency()
+     * @param grain_size   minimum number of elements for a thread
+     */
+    constexpr explicit parallel_policy(unsigned max_threads = 0,
+                                       size_t grain_size = 1024) noexcept
+        : max_threads(max_threads), grain_size(grain_size)
+    {
+    }
+
+    unsigned max_threads;
+    size_t   grain_size;
+};
+
+constexpr sequenced_policy seq{};
+constexpr parallel_policy par{};
+
+} /* namespace execution */
+
+namespace detail {
+
+// Range that applies a function to the elements of the underlying
+// range when they are accessed.  _Rng is an lvalue reference if the
+// underlying range is an lvalue, and the range is moved in otherwise.
+template <typename _Fn, class _Rng>
+class fmap_view {
+public:
+    typedef decltype(adl_begin(std::declval<const _Rng&>())) base_iterator;
+
+    class iterator {  // implements InputIterator
+    public:
+        typedef ptrdiff_t difference_type;
+        typedef decltype(std::declval<const _Fn&>()(
+            *std::declval<base_iterator>()))
+                          reference;
+        typedef std::decay_t<reference> value_type;
+        typedef const value_type*       pointer;
+        typedef std::input_iterator_tag iterator_category;
+
+        iterator() = default;
+        iterator(const fmap_view* view, base_iterator it)
+            : _M_view(view), _M_it(it)
+        {
+        }
+
+        reference operator*() const
+        {
+            return _M_view->_M_fn(*_M_it);
+        }
+        iterator& operator++()
+        {
+            ++_M_it;
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator temp(*this);
+            ++_M_it;
+            return temp;
+        }
+        bool operator==(const iterator& rhs) const
+        {
+            return _M_it == rhs._M_it;
+        }
+        bool operator!=(const iterator& rhs) const
+        {
+            return !operator==(rhs);
+        }
+
+    private:
+        const fmap_view* _M_view{};
+        base_iterator    _M_it{};
+    };
+
+    fmap_view(_Fn f, _Rng&& rng)
+        : _M_fn(std::move(f)), _M_rng(std::forward<_Rng>(rng))
+    {
+    }
+
+    iterator begin() const
+    {
+        using std::begin;
+        return iterator(this, begin(_M_rng));
+    }
+    iterator end() const
+    {
+        using std::end;
+        return iterator(this, end(_M_rng));
+    }
+
+private:
+    _Fn  _M_fn;
+    _Rng _M_rng;
+};
+
+// Range that skips the elements of the underlying range that do not
+// satisfy a predicate.  _Rng is as in fmap_view.
+template <typename _Pred, class _Rng>
+class filter_view {
+public:
+    typedef decltype(adl_begin(std::declval<const _Rng&>())) base_iterator;
+
+    class iterator {  // implements InputIterator
+    public:
+        typedef ptrdiff_t difference_type;
+        typedef typename std::iterator_traits<base_iterator>::reference
+                          reference;
+        typedef typename std::iterator_traits<base_iterator>::value_type
+                          value_type;
+        typedef typename std::iterator_traits<base_iterator>::pointer
+                          pointer;
+        typedef std::input_iterator_tag iterator_category;
+
+        iterator() = default;
+        iterator(const filter_view* view, base_iterator it)
+            : _M_view(view), _M_it(it)
+        {
+            skip();
+        }
+
+        reference operator*() const
+        {
+            return *_M_it;
+        }
+        iterator& operator++()
+        {
+            ++_M_it;
+            skip();
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator temp(*this);
+            operator++();
+            return temp;
+        }
+        bool operator==(const iterator& rhs) const
+        {
+            return _M_it == rhs._M_it;
+        }
+        bool operator!=(const iterator& rhs) const
+        {
+            return !operator==(rhs);
+        }
+
+    private:
+        void skip()
+        {
+            using std::end;
+            base_iterator last = end(_M_view->_M_rng);
+            while (_M_it != last && !_M_view->_M_pred(*_M_it)) {
+                ++_M_it;
+            }
+        }
+
+        const filter_view* _M_view{};
+        base_iterator      _M_it{};
+    };
+
+    filter_view(_Pred pred, _Rng&& rng)
+        : _M_pred(std::move(pred)), _M_rng(std::forward<_Rng>(rng))
+    {
+    }
+
+    iterator begin() const
+    {
+        using std::begin;
+        return iterator(this, begin(_M_rng));
+    }
+    iterator end() const
+    {
+        using std::end;
+        return iterator(this, end(_M_rng));
+    }
+
+private:
+    _Pred _M_pred;
+    _Rng  _M_rng;
+};
+
+// Gets the number of chunks to split n elements into.
+inline size_t par_chunk_count(const execution::parallel_policy& policy,
+                              size_t n)
+{
+    size_t threads = policy.max_threads;
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    size_t grain_size = policy.grain_size == 0 ? 1 : policy.grain_size;
+    size_t chunks = std::min((n + grain_size - 1) / grain_size, threads);
+    return chunks == 0 ? 1 : chunks;
+}
+
+// Calls fn(0), ..., fn(chunks - 1), each in its own thread but the
+// first in the calling thread, and rethrows the first exception thrown.
+// The remaining chunks run in the calling thread if threads cannot be
+// created.
+template <typename _Fn>
+void par_run(size_t chunks, _Fn&& fn)
+{
+    std::vector<std::exception_ptr> errors(chunks);
+    auto run = [&fn, &errors](size_t i) {
+        try {
+            fn(i);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    size_t started = 1;
+    try {
+        threads.reserve(chunks - 1);
+        for (; started < chunks; ++started) {
+            threads.emplace_back(run, started);
+        }
+    } catch (...) {
+    }
+    run(0);
+    for (size_t i = started; i < chunks; ++i) {
+        run(i);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+} /* namespace detail */
+
+/**
+ * Applies a function lazily to each element in the input range.  No
+ * container is created: \a f is called each time an element of the
+ * returned range is accessed, so stages of a pipeline are fused, e.g.:
+ *
+ * @code
+ * // Sum of the squares of the odd numbers, without intermediate vectors
+ * int sum = nvwa::reduce(std::plus<int>(),
+ *                        nvwa::lazy_fmap(sqr, nvwa::lazy_filter(odd, v)));
+ * @endcode
+ *
+ * @param f       the function to apply
+ * @param inputs  the input range, which is referred to if it is an
+ *                lvalue, and moved into the returned range otherwise
+ * @pre           \a f shall take one argument of the type of the
+ *                elements in \a inputs, and the input range shall
+ *                support iteration and outlive the returned
+ *                range if it is an lvalue.
+ * @return        the range of results
+ */
+template <typename _Fn, class _Rng>
+auto lazy_fmap(_Fn f, _Rng&& inputs)
+    -> decltype(detail::adl_begin(inputs), detail::adl_end(inputs),
+                detail::fmap_view<_Fn, _Rng>(std::move(f),
+                                             std::forward<_Rng>(inputs)))
+{
+    return detail::fmap_view<_Fn, _Rng>(std::move(f),
+                                        std::forward<_Rng>(inputs));
+}
+
+/**
+ * Makes a function that applies a function lazily to each element of its
+ * argument range.  It is suitable for use in #pipeline and #compose.
+ *
+ * @param f  the function to apply
+ * @return   the function object that calls #lazy_fmap with \a f
+ */
+template <typename _Fn>
+auto lazy_fmap(_Fn f)
+{
+    return [f = std::move(f)](auto&& inputs) {
+        return lazy_fmap(f, std::forward<decltype(inputs)>(inputs));
+    };
+}
+
+/**
+ * Selects lazily the elements in the input range that satisfy a
+ * predicate.  No container is created.
+ *
+ * @param pred    the predicate to check the elements with
+ * @param inputs  the input range, which is referred to if it is an
+ *                lvalue, and moved into the returned range otherwise
+ * @pre           \a pred shall take one argument of the type of the
+ *                elements in \a inputs, and the input range shall
+ *                support iteration and outlive the returned
+ *                range if it is an lvalue.
+ * @return        the range of elements satisfying \a pred
+ */
+template <typename _Pred, class _Rng>
+auto lazy_filter(_Pred pred, _Rng&& inputs)
+    -> decltype(detail::adl_begin(inputs), detail::adl_end(inputs),
+                detail::filter_view<_Pred, _Rng>(std::move(pred),
+                                                 std::forward<_Rng>(inputs)))
+{
+    return detail::filter_view<_Pred, _Rng>(std::move(pred),
+                                            std::forward<_Rng>(inputs));
+}
+
+/**
+ * Makes a function that selects lazily the elements of its argument
+ * range that satisfy a predicate.  It is suitable for use in #pipeline
+ * and #compose.
+ *
+ * @param pred  the predicate to check the elements with
+ * @return      the function object that calls #lazy_filter with \a pred
+ */
+template <typename _Pred>
+auto lazy_filter(_Pred pred)
+{
+    return [pred = std::move(pred)](auto&& inputs) {
+        return lazy_filter(pred, std::forward<decltype(inputs)>(inputs));
+    };
+}
+
+/**
+ * Applies a function to each element in the input range sequentially.
+ * It is the same as #fmap.
+ *
+ * @param f       the function to apply
+ * @param inputs  the input range
+ * @return        the container of results
+ */
+template <template <typename, typename> class _OutCont = std::vector,
+          template <typename> class _Alloc = std::allocator,
+          typename _Fn, class _Rng>
+auto par_fmap(const execution::sequenced_policy&, _Fn f, _Rng&& inputs)
+    -> decltype(fmap<_OutCont, _Alloc>(f, std::forward<_Rng>(inputs)))
+{
+    return fmap<_OutCont, _Alloc>(std::move(f), std::forward<_Rng>(inputs));
+}
+
+/**
+ * Applies a function to each element in the input range, splitting the
+ * range across threads.  Each thread stores its results in order, and
+ * the results are moved into the output container, whose space is
+ * reserved beforehand when possible (as in #fmap).
+ *
+ * @param policy  the parallel execution policy
+ * @param f       the function to apply
+ * @param inputs  the input range
+ * @pre           \a f shall take one argument of the type of the
+ *                elements in \a inputs and be safe to call from
+ *                multiple threads concurrently, the output container
+ *                shall support \c push_back, and the input range shall
+ *                support multi-pass iteration (preferably random
+ *                access).
+ * @return        the container of results, in the order of \a inputs
+ */
+template <template <typename, typename> class _OutCont = std::vector,
+          template <typename> class _Alloc = std::allocator,
+          typename _Fn, class _Rng>
+auto par_fmap(const execution::parallel_policy& policy, _Fn f,
+              _Rng&& inputs)
+    -> decltype(fmap<_OutCont, _Alloc>(f, std::forward<_Rng>(inputs)))
+{
+    typedef std::decay_t<decltype(f(*detail::adl_begin(inputs)))>
+        result_type;
+    using std::begin;
+    using std::end;
+    auto first = begin(inputs);
+    size_t n = static_cast<size_t>(std::distance(first, end(inputs)));
+    size_t chunks = detail::par_chunk_count(policy, n);
+    std::vector<std::vector<result_type>> parts(chunks);
+    detail::par_run(chunks, [&](size_t i) {
+        size_t offset = n * i / chunks;
+        size_t count = n * (i + 1) / chunks - offset;
+        auto it = std::next(first, static_cast<ptrdiff_t>(offset));
+        parts[i].reserve(count);
+        for (; count != 0; --count, ++it) {
+            parts[i].push_back(f(*it));
+        }
+    });
+    _OutCont<result_type, _Alloc<result_type>> result;
+    detail::try_reserve(
+        result, inputs,
+        std::integral_constant<
+            bool, detail::can_reserve<decltype(result), _Rng>::value>{});
+    for (auto& part : parts) {
+        for (auto&& item : part) {
+            result.push_back(std::move(item));
+        }
+    }
+    return result;
+}
+
+/**
+ * Applies a function cumulatively to elements in the input range
+ * sequentially, starting from an initial value.  Unlike #reduce, it
+ * iterates (instead of recursing) and returns a value.
+ *
+ * @param f        the function to apply
+ * @param inputs   the input range
+ * @param initval  initial value for the cumulative calculation
+ * @return         the result of the cumulative calculation
+ */
+template <typename _Rs, typename _Fn, class _Rng>
+auto par_reduce(const execution::sequenced_policy&, _Fn f, _Rng&& inputs,
+                _Rs&& initval)
+    -> decltype(detail::adl_begin(inputs), detail::adl_end(inputs),
+                std::decay_t<_Rs>{})
+{
+    std::decay_t<_Rs> result(std::forward<_Rs>(initval));
+    for (auto&& item : inputs) {
+        result = f(std::move(result), std::forward<decltype(item)>(item));
+    }
+    return result;
+}
+
+/**
+ * Applies a function cumulatively to elements in the input range,
+ * splitting the range across threads.  Each thread reduces its part
+ * starting from the first element of the part, and the partial results
+ * are then combined in order, starting from \a initval.  Like \c
+ * std::reduce, the result equals that of sequential reduction only if
+ * \a f is associative.
+ *
+ * @param policy   the parallel execution policy
+ * @param f        the function to apply
+ * @param inputs   the input range
+ * @param initval  initial value for the cumulative calculation
+ * @pre            \a f shall take two arguments of the decayed type of
+ *                 \a initval, to which the elements in \a inputs shall
+ *                 be convertible, be associative, and be safe to call
+ *                 from multiple threads concurrently, and the input
+ *                 range shall support multi-pass iteration (preferably
+ *                 random access).
+ * @return         the result of the cumulative calculation
+ */
+template <typename _Rs, typename _Fn, class _Rng>
+auto par_reduce(const execution::parallel_policy& policy, _Fn f,
+                _Rng&& inputs, _Rs&& initval)
+    -> decltype(detail::adl_begin(inputs), detail::adl_end(inputs),
+                std::decay_t<_Rs>{})
+{
+    typedef std::decay_t<_Rs> result_type;
+    using std::begin;
+    using std::end;
+    auto first = begin(inputs);
+    size_t n = static_cast<size_t>(std::distance(first, end(inputs)));
+    size_t chunks = detail::par_chunk_count(policy, n);
+    std::vector<optional<result_type>> partials(chunks);
+    detail::par_run(chunks, [&](size_t i) {
+        size_t offset = n * i / chunks;
+        size_t count = n * (i + 1) / chunks - offset;
+        if (count == 0) {
+            return;
+        }
+        auto it = std::next(first, static_cast<ptrdiff_t>(offset));
+        result_type partial(*it);
+        for (++it; --count != 0; ++it) {
+            partial = f(std::move(partial), *it);
+        }
+        partials[i] = std::move(partial);
+    });
+    result_type result(std::forward<_Rs>(initval));
+    for (auto& partial : partials) {
+        if (partial) {
+            result = f(std::move(result), std::move(*partial));
+        }
+    }
+    return result;
+}
+
+/**
+ * Applies a function cumulatively to elements in the input range
+ * sequentially, starting from a value-initialized element (like
+ * #reduce without an initial value).
+ *
+ * @param f       the function to apply
+ * @param inputs  the input range
+ * @return        the result of the cumulative calculation
+ */
+template <typename _Fn, class _Rng>
+auto par_reduce(const execution::sequenced_policy& policy, _Fn f,
+                _Rng&& inputs)
+{
+    return par_reduce(policy, std::move(f), std::forward<_Rng>(inputs),
+                      typename detail::value_type<_Rng>{});
+}
+
+/**
+ * Applies a function cumulatively to elements in the input range,
+ * splitting the range across threads, starting from a
+ * value-initialized element.
+ *
+ * @param policy  the parallel execution policy
+ * @param f       the function to apply
+ * @param inputs  the input range
+ * @return        the result of the cumulative calculation
+ */
+template <typename _Fn, class _Rng>
+auto par_reduce(const execution::parallel_policy& policy, _Fn f,
+                _Rng&& inputs)
+{
+    return par_reduce(policy, std::move(f), std::forward<_Rng>(inputs),
+                      typename detail::value_type<_Rng>{});
+}
+
 /**
  * Makes a two-argument function accept a pair instead.
  *
@@ -0,0 +1,209 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  latency_histogram.cpp
+ *
+ * Code for the queries and the output of the latency histogram.
+ *
+ * @date  2026-10-14
+ */
+
+#include "latency_histogram.h"  // nvwa::latency_histogram
+#include <math.h>               // ceil
+#include <stdint.h>             // uint64_t/UINT64_MAX
+#include <stdio.h>              // fprintf
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Constructor that creates an empty histogram.
+ */
+latency_histogram::latency_histogram() noexcept
+{
+    reset();
+}
+
+/**
+ * Clears all recorded values.  Values recorded at the same time may or
+ * may not be cleared.
+ */
+void latency_histogram::reset() noexcept
+{
+    for (auto& counter : _M_counts) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    _M_sum.store(0, std::memory_order_relaxed);
+    _M_min.store(UINT64_MAX, std::memory_order_relaxed);
+    _M_max.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Gets the number of recorded values.
+ *
+ * @return  the number of recorded values
+ */
+uint64_t latency_histogram::count() const noexcept
+{
+    uint64_t total = 0;
+    for (const auto& counter : _M_counts) {
+        total += counter.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * Gets the smallest recorded value.
+ *
+ * @return  the smallest value, or 0 if nothing is recorded
+ */
+uint64_t latency_histogram::min() const noexcept
+{
+    uint64_t result = _M_min.load(std::memory_order_relaxed);
+    return result == UINT64_MAX && count() == 0 ? 0 : result;
+}
+
+/**
+ * Gets the largest recorded value.
+ *
+ * @return  the largest value, or 0 if nothing is recorded
+ */
+uint64_t latency_histogram::max() const noexcept
+{
+    return _M_max.load(std::memory_order_relaxed);
+}
+
+/**
+ * Gets the mean of the recorded values.
+ *
+ * @return  the mean, or 0 if nothing is recorded
+ */
+double latency_histogram::mean() const noexcept
+{
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    return static_cast<double>(_M_sum.load(std::memory_order_relaxed)) /
+           static_cast<double>(total);
+}
+
+/**
+ * Gets a percentile of the recorded values.  The result is the largest
+ * value that falls into the same bucket as the exact percentile, but
+ * no larger than #max.
+ *
+ * @param pct  the percentile, in the range [0, 100]
+ * @return     the value below or at which \a pct percent of the
+ *             recorded values are, or 0 if nothing is recorded
+ */
+uint64_t latency_histogram::percentile(double pct) const noexcept
+{
+    uint64_t counts[bucket_count];
+    uint64_t total = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+        counts[i] = _M_counts[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    if (pct < 0) {
+        pct = 0;
+    } else if (pct > 100) {
+        pct = 100;
+    }
+    uint64_t rank =
+        static_cast<uint64_t>(ceil(pct / 100 * static_cast<double>(total)));
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t largest = max();
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            uint64_t result = bucket_upper_bound(i);
+            return result < largest ? result : largest;
+        }
+    }
+    return largest;
+}
+
+/**
+ * Prints the count, the mean, the extremes and the common percentiles
+ * of the recorded values.
+ *
+ * @param name  name to identify the histogram
+ * @param fp    the output stream
+ */
+void latency_histogram::print(const char* name, FILE* fp) const
+{
+    fprintf(fp,
+            "%s: count %llu, mean %.1f, min %llu, p50 %llu, p90 %llu, "
+            "p99 %llu, p99.9 %llu, max %llu\n",
+            name, static_cast<unsigned long long>(count()), mean(),
+            static_cast<unsigned long long>(min()),
+            static_cast<unsigned long long>(percentile(50)),
+            static_cast<unsigned long long>(percentile(90)),
+            static_cast<unsigned long long>(percentile(99)),
+            static_cast<unsigned long long>(percentile(99.9)),
+            static_cast<unsigned long long>(max()));
+}
+
+/**
+ * Gets the smallest value counted in a bucket.
+ *
+ * @param index  the bucket index
+ * @return       the smallest value in the bucket
+ */
+uint64_t latency_histogram::bucket_lower_bound(size_t index) noexcept
+{
+    if (index < 2 * sub_bucket_count) {
+        return index;
+    }
+    unsigned shift = static_cast<unsigned>(index / sub_bucket_count) - 1;
+    return static_cast<uint64_t>(index - shift * sub_bucket_count) << shift;
+}
+
+/**
+ * Gets the largest value counted in a bucket.
+ *
+ * @param index  the bucket index
+ * @return       the largest value in the bucket
+ */
+uint64_t latency_histogram::bucket_upper_bound(size_t index) noexcept
+{
+    if (index + 1 == bucket_count) {
+        return UINT64_MAX;
+    }
+    return bucket_lower_bound(index + 1) - 1;
+}
+
+NVWA_NAMESPACE_END
@@ -0,0 +1,172 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  latency_histogram.h
+ *
+ * Header file for a lock-free latency histogram, and a scoped timer that
+ * records into it.  Using this file requires a C++11-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_LATENCY_HISTOGRAM_H
+#define NVWA_LATENCY_HISTOGRAM_H
+
+#include <atomic>               // std::atomic
+#include <stddef.h>             // size_t
+#include <stdint.h>             // uint64_t/UINT64_MAX
+#include <stdio.h>              // FILE/stderr
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "cycle_clock.h"        // nvwa::cycle_clock
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>             // _BitScanReverse64
+#endif
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class to count values, usually latencies in nanoseconds, in
+ * logarithmic buckets like an HDR histogram.  Values below 64 are
+ * counted exactly; above that, each power of two is divided into 32
+ * buckets, so that a percentile is accurate to about 3%.  Recording
+ * takes a few relaxed atomic operations and never locks or allocates,
+ * so any number of threads may record at the same time.  The queries
+ * see a snapshot that may be slightly inconsistent while other threads
+ * are recording.
+ */
+class latency_histogram {
+public:
+    /** Number of bits to distinguish values within a power of two. */
+    static constexpr unsigned sub_bucket_bits = 5;
+    /** Number of buckets within a power of two. */
+    static constexpr size_t sub_bucket_count = size_t(1) << sub_bucket_bits;
+    /** Total number of buckets. */
+    static constexpr size_t bucket_count =
+        (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+    latency_histogram() noexcept;
+    latency_histogram(const latency_histogram&) = delete;
+    latency_histogram& operator=(const latency_histogram&) = delete;
+
+    void record(uint64_t value) noexcept;
+    void reset() noexcept;
+
+    uint64_t count() const noexcept;
+    uint64_t min() const noexcept;
+    uint64_t max() const noexcept;
+    double mean() const noexcept;
+    uint64_t percentile(double pct) const noexcept;
+    void print(const char* name, FILE* fp = stderr) const;
+
+    static size_t bucket_index(uint64_t value) noexcept;
+    static uint64_t bucket_lower_bound(size_t index) noexcept;
+    static uint64_t bucket_upper_bound(size_t index) noexcept;
+
+private:
+    std::atomic<uint64_t> _M_counts[bucket_count];
+    std::atomic<uint64_t> _M_sum;
+    std::atomic<uint64_t> _M_min;
+    std::atomic<uint64_t> _M_max;
+};
+
+/**
+ * Records a value.
+ *
+ * @param value  the value to record
+ */
+inline void latency_histogram::record(uint64_t value) noexcept
+{
+    _M_counts[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    _M_sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t old_value = _M_min.load(std::memory_order_relaxed);
+    while (value < old_value &&
+           !_M_min.compare_exchange_weak(old_value, value,
+                                         std::memory_order_relaxed)) {
+    }
+    old_value = _M_max.load(std::memory_order_relaxed);
+    while (value > old_value &&
+           !_M_max.compare_exchange_weak(old_value, value,
+                                         std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * Gets the index of the bucket that counts a value.
+ *
+ * @param value  the value
+ * @return       the bucket index, less than #bucket_count
+ */
+inline size_t latency_histogram::bucket_index(uint64_t value) noexcept
+{
+    if (value < 2 * sub_bucket_count) {
+        return static_cast<size_t>(value);
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long msb;
+    _BitScanReverse64(&msb, value);
+#else
+    unsigned msb = 0;
+    for (uint64_t v = value >> 1; v != 0; v >>= 1) {
+        ++msb;
+    }
+#endif
+    unsigned shift = static_cast<unsigned>(msb) - sub_bucket_bits;
+    return shift * sub_bucket_count + static_cast<size_t>(value >> shift);
+}
+
+/**
+ * Class to measure the time from its construction to its destruction
+ * with nvwa#cycle_clock, and record it in nanoseconds into a
+ * latency_histogram.
+ */
+class pctimer_scope {
+public:
+    explicit pctimer_scope(latency_histogram& histogram) noexcept
+        : _M_histogram(histogram), _M_start(cycle_clock::now())
+    {
+    }
+    ~pctimer_scope()
+    {
+        _M_histogram.record(
+            cycle_clock::to_nanoseconds(cycle_clock::now() - _M_start));
+    }
+    pctimer_scope(const pctimer_scope&) = delete;
+    pctimer_scope& operator=(const pctimer_scope&) = delete;
+
+private:
+    latency_histogram& _M_histogram;
+    cycle_clock::tick_t _M_start;
+};
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_LATENCY_HISTOGRAM_H
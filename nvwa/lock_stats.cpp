@@ -0,0 +1,172 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  lock_stats.cpp
+ *
+ * Code for the registry and the output of the lock contention
+ * statistics.
+ *
+ * @date  2026-10-14
+ */
+
+#include "lock_stats.h"         // nvwa::lock_stats/lock_stats_counter
+#include <algorithm>            // std::sort
+#include <stdlib.h>             // free
+#include <vector>               // std::vector
+#include "_nvwa.h"              // NVWA_NAMESPACE_*/NVWA_GCC/NVWA_CLANG
+
+#if NVWA_GCC || NVWA_CLANG
+#include <cxxabi.h>             // abi::__cxa_demangle
+#endif
+
+NVWA_NAMESPACE_BEGIN
+
+namespace {
+
+/** Head of the list of registered counters, which only grows. */
+std::atomic<lock_stats_counter*> lock_stats_head{nullptr};
+
+} /* unnamed namespace */
+
+/**
+ * Gets a snapshot of the counters.  It may be slightly inconsistent
+ * while the lock is in use.
+ *
+ * @param[out] stats  the statistics
+ */
+void lock_stats_counter::get(lock_stats& stats) const noexcept
+{
+    stats.kind = _M_kind;
+    stats.host_name = _M_host_name();
+    stats.acquisitions = _M_acquisitions.load(std::memory_order_relaxed);
+    stats.contentions = _M_contentions.load(std::memory_order_relaxed);
+    stats.wait_time =
+        static_cast<double>(_M_wait_ns.load(std::memory_order_relaxed)) /
+        1e9;
+}
+
+/**
+ * Resets the counters to zero.
+ */
+void lock_stats_counter::reset() noexcept
+{
+    _M_acquisitions.store(0, std::memory_order_relaxed);
+    _M_contentions.store(0, std::memory_order_relaxed);
+    _M_wait_ns.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Adds the counter to the registry, unless it has been added.
+ */
+void lock_stats_counter::register_self() noexcept
+{
+    if (_M_registered.exchange(true, std::memory_order_relaxed)) {
+        return;
+    }
+    _M_next = lock_stats_head.load(std::memory_order_relaxed);
+    while (!lock_stats_head.compare_exchange_weak(
+        _M_next, this, std::memory_order_release,
+        std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * Gets the statistics of all lock types that have been used.  Nothing
+ * is recorded unless #_LOCK_STATS is non-zero.
+ *
+ * @param[out] result  the statistics, one item per lock type
+ */
+void get_lock_stats(std::vector<lock_stats>& result)
+{
+    result.clear();
+    for (lock_stats_counter* counter =
+             lock_stats_head.load(std::memory_order_acquire);
+         counter; counter = counter->_M_next) {
+        lock_stats stats;
+        counter->get(stats);
+        result.push_back(stats);
+    }
+}
+
+/**
+ * Resets the statistics of all lock types.
+ */
+void reset_lock_stats() noexcept
+{
+    for (lock_stats_counter* counter =
+             lock_stats_head.load(std::memory_order_acquire);
+         counter; counter = counter->_M_next) {
+        counter->reset();
+    }
+}
+
+/**
+ * Prints the statistics of all lock types that have been used, the
+ * lock type having waited longest first.
+ *
+ * @param fp  the output stream
+ */
+void print_lock_stats(FILE* fp)
+{
+    std::vector<lock_stats> result;
+    get_lock_stats(result);
+    std::sort(result.begin(), result.end(),
+              [](const lock_stats& lhs, const lock_stats& rhs) {
+                  return lhs.wait_time > rhs.wait_time;
+              });
+    fprintf(fp, "Lock statistics (%u lock types):\n",
+            static_cast<unsigned>(result.size()));
+    for (const lock_stats& stats : result) {
+        const char* name = stats.host_name;
+#if NVWA_GCC || NVWA_CLANG
+        int status;
+        char* demangled =
+            abi::__cxa_demangle(stats.host_name, nullptr, nullptr, &status);
+        if (demangled) {
+            name = demangled;
+        }
+#endif
+        fprintf(fp,
+                "  %s<%s>: %lu acquisitions, %lu contended (%.2f%%), "
+                "%.6f s waited\n",
+                stats.kind, name,
+                static_cast<unsigned long>(stats.acquisitions),
+                static_cast<unsigned long>(stats.contentions),
+                stats.acquisitions == 0
+                    ? 0.0
+                    : 100.0 * static_cast<double>(stats.contentions) /
+                          static_cast<double>(stats.acquisitions),
+                stats.wait_time);
+#if NVWA_GCC || NVWA_CLANG
+        free(demangled);
+#endif
+    }
+}
+
+NVWA_NAMESPACE_END
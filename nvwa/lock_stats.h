@@ -0,0 +1,133 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  lock_stats.h
+ *
+ * Header file for the contention statistics of class_level_lock and
+ * object_level_lock.  Using this file requires a C++11-compliant
+ * compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_LOCK_STATS_H
+#define NVWA_LOCK_STATS_H
+
+#include <atomic>               // std::atomic
+#include <stddef.h>             // size_t
+#include <stdint.h>             // uint64_t
+#include <stdio.h>              // FILE/stderr
+#include <vector>               // std::vector
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+
+# ifndef _LOCK_STATS
+/**
+ * Macro to control whether class_level_lock and object_level_lock keep
+ * contention statistics per host type (see nvwa#lock_stats).  Defining
+ * it to a non-zero value will make each acquisition update atomic
+ * counters, and each contended acquisition measure its wait with
+ * nvwa#pctimer.  Nothing is counted when it is zero (the default).
+ */
+#   define _LOCK_STATS 0
+# endif
+
+NVWA_NAMESPACE_BEGIN
+
+/** Snapshot of the contention statistics of a lock type. */
+struct lock_stats {
+    const char* kind;           ///< "class_level_lock" or "object_level_lock"
+    const char* host_name;      ///< Name of the host type (from typeid)
+    size_t      acquisitions;   ///< Number of acquisitions
+    size_t      contentions;    ///< Number of acquisitions that waited
+    double      wait_time;      ///< Total wait time in seconds
+};
+
+/**
+ * Counters behind nvwa#lock_stats.  A counter shall have static storage
+ * duration.  It is constant-initialized and registers itself on first
+ * use, so locks used during dynamic initialization are counted as well.
+ * The counters are updated with relaxed atomic operations.
+ */
+class lock_stats_counter {
+public:
+    typedef const char* (*name_func_t)();
+
+    constexpr lock_stats_counter(const char* kind,
+                                 name_func_t host_name) noexcept
+        : _M_kind(kind), _M_host_name(host_name), _M_acquisitions(0),
+          _M_contentions(0), _M_wait_ns(0), _M_registered(false),
+          _M_next(nullptr)
+    {
+    }
+    lock_stats_counter(const lock_stats_counter&) = delete;
+    lock_stats_counter& operator=(const lock_stats_counter&) = delete;
+
+    /**
+     * Records an acquisition.
+     *
+     * @param contended  whether the lock was held by another thread
+     * @param wait_time  the time waited in seconds
+     */
+    void on_acquire(bool contended, double wait_time) noexcept
+    {
+        if (!_M_registered.load(std::memory_order_relaxed)) {
+            register_self();
+        }
+        _M_acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (contended) {
+            _M_contentions.fetch_add(1, std::memory_order_relaxed);
+            _M_wait_ns.fetch_add(static_cast<uint64_t>(wait_time * 1e9),
+                                 std::memory_order_relaxed);
+        }
+    }
+    void get(lock_stats& stats) const noexcept;
+    void reset() noexcept;
+
+private:
+    friend void get_lock_stats(std::vector<lock_stats>& result);
+    friend void reset_lock_stats() noexcept;
+
+    void register_self() noexcept;
+
+    const char*                      _M_kind;
+    name_func_t                      _M_host_name;
+    std::atomic<size_t>              _M_acquisitions;
+    std::atomic<size_t>              _M_contentions;
+    std::atomic<uint64_t>            _M_wait_ns;
+    std::atomic<bool>                _M_registered;
+    lock_stats_counter*              _M_next;   ///< Next registered
+};
+
+void get_lock_stats(std::vector<lock_stats>& result);
+void reset_lock_stats() noexcept;
+void print_lock_stats(FILE* fp = stderr);
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_LOCK_STATS_H
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2017 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -31,7 +31,7 @@
  *
  * Implementation for the memory pool base.
  *
- * @date  2017-09-09
+ * @date  2026-10-14
  */
 
 #include "mem_pool_base.h"      // nvwa::mem_pool_base
@@ -42,7 +42,20 @@
 #include <new>                  // std::bad_alloc
 #endif
 
-#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include <stdint.h>             // uintptr_t
+#include "_nvwa.h"              // NVWA_NAMESPACE_*/NVWA_LINUX/NVWA_WIN32
+#include "c++_features.h"       // _NULLPTR
+
+#if NVWA_LINUX
+#include <sys/mman.h>           // mmap/munmap
+#include <sys/syscall.h>        // SYS_getcpu/SYS_mbind
+#include <unistd.h>             // syscall
+#elif NVWA_WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>            // VirtualAllocExNuma/VirtualFree/...
+#endif
 
 NVWA_NAMESPACE_BEGIN
 
@@ -69,6 +82,29 @@ mem_pool_base::~mem_pool_base()
 {
 }
 
+/**
+ * Returns idle memory to the system, keeping at most \a max_idle idle
+ * memory blocks.  The base version does nothing.
+ *
+ * @param max_idle  maximum number of idle blocks to keep
+ */
+void mem_pool_base::trim(size_t)
+{
+}
+
+/**
+ * Gets the run-time statistics of the memory pool.  The base version
+ * provides none.
+ *
+ * @param[out] stats  the statistics, if available
+ * @return            \c true if statistics are available (only when
+ *                    #_MEM_POOL_STATS is non-zero); \c false otherwise
+ */
+bool mem_pool_base::get_stats(mem_pool_stats&) const
+{
+    return false;
+}
+
 /**
  * Allocates memory from the run-time system.
  *
@@ -91,4 +127,134 @@ void mem_pool_base::dealloc_sys(void* ptr)
     _MEM_POOL_DEALLOCATE(ptr);
 }
 
+/**
+ * Allocates memory from the system on the NUMA node of the calling
+ * thread.  On Linux it maps anonymous memory with a preferred-node
+ * memory policy; on Windows it uses \c VirtualAllocExNuma.  The node
+ * preference is silently dropped when it cannot be determined or
+ * applied, and alloc_sys is used on other platforms.
+ *
+ * @param size  size of the memory to allocate in bytes
+ * @return      pointer to allocated memory block if successful; or
+ *              null if memory allocation fails
+ * @see         dealloc_sys_local
+ */
+void* mem_pool_base::alloc_sys_local(size_t size)
+{
+#if NVWA_LINUX
+    void* ptr = mmap(_NULLPTR, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return _NULLPTR;
+    }
+#if defined(SYS_getcpu) && defined(SYS_mbind)
+    unsigned cpu;
+    unsigned node;
+    if (syscall(SYS_getcpu, &cpu, &node, _NULLPTR) == 0 &&
+            node < sizeof(unsigned long) * 8) {
+        // MPOL_PREFERRED is 1 in <linux/mempolicy.h>.  A failure (say,
+        // when the kernel has no NUMA support) leaves the default
+        // policy in effect, which is harmless.
+        unsigned long nodemask = 1UL << node;
+        syscall(SYS_mbind, ptr, size, 1, &nodemask,
+                sizeof(nodemask) * 8, 0);
+    }
+#endif
+    return ptr;
+#elif NVWA_WIN32 && _WIN32_WINNT >= 0x0601
+    PROCESSOR_NUMBER processor;
+    USHORT node;
+    GetCurrentProcessorNumberEx(&processor);
+    if (!GetNumaProcessorNodeEx(&processor, &node)) {
+        return VirtualAlloc(_NULLPTR, size, MEM_RESERVE | MEM_COMMIT,
+                            PAGE_READWRITE);
+    }
+    return VirtualAllocExNuma(GetCurrentProcess(), _NULLPTR, size,
+                              MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE,
+                              node);
+#else
+    return alloc_sys(size);
+#endif
+}
+
+/**
+ * Frees memory allocated by alloc_sys_local.
+ *
+ * @param ptr   pointer to the memory block previously allocated
+ * @param size  size of the memory block, as passed to alloc_sys_local
+ */
+void mem_pool_base::dealloc_sys_local(void* ptr, size_t size)
+{
+#if NVWA_LINUX
+    munmap(ptr, size);
+#elif NVWA_WIN32 && _WIN32_WINNT >= 0x0601
+    (void)size;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    (void)size;
+    dealloc_sys(ptr);
+#endif
+}
+
+/**
+ * Sorts a null-terminated list of memory blocks by address.  It is a
+ * bottom-up merge sort, which needs no memory other than the blocks
+ * themselves, and thus can run when memory is exhausted.
+ *
+ * @param first  pointer to the first memory block in the list
+ * @return       pointer to the first memory block in the sorted list
+ */
+mem_pool_base::_Block_list* mem_pool_base::sort_blocks(_Block_list* first)
+{
+    _Block_list* result = first;
+    for (size_t run = 1; ; run *= 2) {
+        _Block_list*  remaining = result;
+        _Block_list*  tail = _NULLPTR;
+        size_t        merges = 0;
+        result = _NULLPTR;
+        while (remaining) {
+            ++merges;
+            _Block_list* left = remaining;
+            _Block_list* right = left;
+            size_t left_size = 0;
+            while (right && left_size < run) {
+                right = right->_M_next;
+                ++left_size;
+            }
+            size_t right_size = run;
+            while (left_size > 0 || (right_size > 0 && right)) {
+                _Block_list* block;
+                if (left_size == 0) {
+                    block = right;
+                    right = right->_M_next;
+                    --right_size;
+                } else if (right_size == 0 || !right ||
+                           reinterpret_cast<uintptr_t>(left) <
+                           reinterpret_cast<uintptr_t>(right)) {
+                    block = left;
+                    left = left->_M_next;
+                    --left_size;
+                } else {
+                    block = right;
+                    right = right->_M_next;
+                    --right_size;
+                }
+                if (tail) {
+                    tail->_M_next = block;
+                } else {
+                    result = block;
+                }
+                tail = block;
+            }
+            remaining = right;
+        }
+        if (tail) {
+            tail->_M_next = _NULLPTR;
+        }
+        if (merges <= 1) {
+            return result;
+        }
+    }
+}
+
 NVWA_NAMESPACE_END
@@ -31,7 +31,7 @@
  *
  * Header file for the memory pool base.
  *
- * @date  2024-05-20
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_MEM_POOL_BASE_H
@@ -39,10 +39,104 @@
 
 #include <stddef.h>             // size_t
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
-#include "c++_features.h"       // _DELETE
+#include "aligned_memory.h"     // nvwa::huge_page_malloc/huge_page_free
+#include "c++_features.h"       // _DELETE/HAVE_CXX11_ATOMIC
+
+# ifndef _MEM_POOL_STATS
+/**
+ * Macro to control whether memory pools keep run-time statistics (see
+ * nvwa#mem_pool_stats).  Defining it to a non-zero value will make each
+ * allocation and deallocation update atomic counters, and each pool
+ * lock count the times it is contended.  Nothing is counted when it is
+ * zero (the default).
+ */
+#   define _MEM_POOL_STATS 0
+# endif
+
+# if _MEM_POOL_STATS
+#   if !HAVE_CXX11_ATOMIC
+#     error "_MEM_POOL_STATS requires atomic support"
+#   endif
+#   include <atomic>            // std::atomic
+# endif
 
 NVWA_NAMESPACE_BEGIN
 
+/** Snapshot of the run-time statistics of a memory pool. */
+struct mem_pool_stats {
+    size_t block_size;          ///< Size of the memory blocks
+    int    group_id;            ///< Group ID of a static_mem_pool, or 0
+    size_t allocated;           ///< Number of blocks in use
+    size_t high_water;          ///< Maximum number of blocks in use
+    size_t free_blocks;         ///< Number of blocks held but not in use
+    size_t sys_allocs;          ///< Number of allocations from the system
+    size_t lock_contentions;    ///< Number of waits to acquire the lock
+};
+
+#if _MEM_POOL_STATS
+/**
+ * Counters behind nvwa#mem_pool_stats.  They are updated with relaxed
+ * atomic operations, so a snapshot may be slightly inconsistent while
+ * the pool is in use.
+ */
+class mem_pool_counters {
+public:
+    mem_pool_counters()
+        : _M_allocated(0), _M_high_water(0), _M_sys_blocks(0),
+          _M_sys_allocs(0), _M_lock_contentions(0)
+    {
+    }
+
+    void on_allocate()
+    {
+        size_t allocated =
+            _M_allocated.fetch_add(1, std::memory_order_relaxed) + 1;
+        size_t high_water = _M_high_water.load(std::memory_order_relaxed);
+        while (allocated > high_water &&
+               !_M_high_water.compare_exchange_weak(
+                   high_water, allocated, std::memory_order_relaxed)) {
+        }
+    }
+    void on_deallocate()
+    {
+        _M_allocated.fetch_sub(1, std::memory_order_relaxed);
+    }
+    void on_alloc_sys(size_t blocks)
+    {
+        _M_sys_allocs.fetch_add(1, std::memory_order_relaxed);
+        _M_sys_blocks.fetch_add(blocks, std::memory_order_relaxed);
+    }
+    void on_dealloc_sys(size_t blocks)
+    {
+        _M_sys_blocks.fetch_sub(blocks, std::memory_order_relaxed);
+    }
+    void get(mem_pool_stats& stats) const
+    {
+        size_t allocated = _M_allocated.load(std::memory_order_relaxed);
+        size_t sys_blocks = _M_sys_blocks.load(std::memory_order_relaxed);
+        stats.allocated = allocated;
+        stats.high_water = _M_high_water.load(std::memory_order_relaxed);
+        stats.free_blocks =
+            sys_blocks > allocated ? sys_blocks - allocated : 0;
+        stats.sys_allocs = _M_sys_allocs.load(std::memory_order_relaxed);
+        stats.lock_contentions =
+            _M_lock_contentions.load(std::memory_order_relaxed);
+    }
+    /** Gets the counter to pass to a counting class_level_lock::lock. */
+    std::atomic<size_t>& contention_counter()
+    {
+        return _M_lock_contentions;
+    }
+
+private:
+    std::atomic<size_t> _M_allocated;
+    std::atomic<size_t> _M_high_water;
+    std::atomic<size_t> _M_sys_blocks;
+    std::atomic<size_t> _M_sys_allocs;
+    std::atomic<size_t> _M_lock_contentions;
+};
+#endif // _MEM_POOL_STATS
+
 /**
  * Base class for memory pools.
  */
@@ -50,19 +144,55 @@ class mem_pool_base {
 public:
     virtual ~mem_pool_base();
     virtual void recycle() = 0;
+    virtual void trim(size_t max_idle);
+    virtual bool get_stats(mem_pool_stats& stats) const;
     static void* alloc_sys(size_t size);
     static void dealloc_sys(void* ptr);
+    static void* alloc_sys_local(size_t size);
+    static void dealloc_sys_local(void* ptr, size_t size);
+    static void* alloc_sys_huge(size_t size);
+    static void dealloc_sys_huge(void* ptr, size_t size);
 
     /** Structure to store the next available memory block. */
     struct _Block_list {
         _Block_list* _M_next;   ///< Pointer to the next memory block
     };
 
+    static _Block_list* sort_blocks(_Block_list* first);
+
+protected:
+    mem_pool_base() {}
+
 private:
     mem_pool_base(const mem_pool_base&) _DELETED;
     mem_pool_base& operator=(const mem_pool_base&) _DELETED;
 };
 
+/**
+ * Allocates memory from the system, backed by huge pages when possible.
+ * Using it requires linking aligned_memory.cpp.
+ *
+ * @param size  size of the memory to allocate in bytes
+ * @return      pointer to allocated memory block if successful; or
+ *              null if memory allocation fails
+ * @see         nvwa#huge_page_malloc
+ */
+inline void* mem_pool_base::alloc_sys_huge(size_t size)
+{
+    return huge_page_malloc(size);
+}
+
+/**
+ * Frees memory allocated by alloc_sys_huge.
+ *
+ * @param ptr   pointer to the memory block previously allocated
+ * @param size  size of the memory block, as passed to alloc_sys_huge
+ */
+inline void mem_pool_base::dealloc_sys_huge(void* ptr, size_t size)
+{
+    huge_page_free(ptr, size);
+}
+
 NVWA_NAMESPACE_END
 
 #endif // NVWA_MEM_POOL_BASE_H
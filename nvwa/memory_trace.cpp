@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2022-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2022-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -31,22 +31,23 @@
  *
  * Implementation of memory tracing facilities.
  *
- * @date  2024-05-20
+ * @date  2026-10-14
  */
 
 #include "memory_trace.h"       // memory trace declarations
 #include <assert.h>             // assert
+#include <math.h>               // expm1/log
 #include <stddef.h>             // size_t
 #include <stdio.h>              // FILE
 #include <stdint.h>             // uint32_t/uintptr_t
-#include <stdlib.h>             // abort/malloc/free
+#include <stdlib.h>             // abort/calloc/malloc/realloc/free
 #include <string.h>             // strcmp
-#include <deque>                // std::deque
+#include <algorithm>            // std::sort
+#include <atomic>               // std::atomic
 #include <new>                  // operator new declarations
 #include "_nvwa.h"              // NVWA macros
 #include "aligned_memory.h"     // nvwa::aligned_malloc/aligned_free
 #include "fast_mutex.h"         // nvwa::fast_mutex/fast_mutex_autolock
-#include "malloc_allocator.h"   // nvwa::malloc_allocator
 
 #ifndef NVWA_CMT_ERROR_ACTION
 #define NVWA_CMT_ERROR_ACTION() abort()
@@ -60,7 +61,6 @@
 
 namespace {
 
-NVWA::fast_mutex new_ptr_lock;
 NVWA::fast_mutex new_output_lock;
 
 enum is_array_t : uint32_t {
@@ -68,14 +68,15 @@ enum is_array_t : uint32_t {
     alloc_is_array
 };
 
-thread_local std::deque<NVWA::context,
-                        NVWA::malloc_allocator<NVWA::context>>
-    context_stack{{"<UNKNOWN>", "<UNKNOWN>"}};
+const NVWA::context unknown_context{"<UNKNOWN>", "<UNKNOWN>"};
+
+// The innermost context of this thread; outer contexts are linked from
+// the checkpoints, so the stack needs no allocation or locking
+thread_local const NVWA::context* current_context = &unknown_context;
 
 const NVWA::context& get_current_context()
 {
-    assert(!context_stack.empty());
-    return context_stack.back();
+    return *current_context;
 }
 
 void print_context(const NVWA::context& ctx, FILE* fp)
@@ -83,15 +84,61 @@ void print_context(const NVWA::context& ctx, FILE* fp)
     fprintf(fp, "context: %s/%s", ctx.file, ctx.func);
 }
 
-void save_context(const NVWA::context& ctx)
+const NVWA::context* save_context(const NVWA::context& ctx)
 {
-    context_stack.push_back(ctx);
+    const NVWA::context* prev_ctx = current_context;
+    current_context = &ctx;
+    return prev_ctx;
 }
 
-void restore_context([[maybe_unused]] const NVWA::context& ctx)
+void restore_context([[maybe_unused]] const NVWA::context& ctx,
+                     const NVWA::context* prev_ctx)
+{
+    assert(current_context == &ctx);
+    current_context = prev_ctx;
+}
+
+thread_local size_t bytes_until_sample = 0;
+thread_local uint64_t sample_random_state = 0;
+
+// Gets an exponentially distributed distance to the next sample, so
+// that the sampled points form a Poisson process on allocated bytes
+size_t get_sample_distance(size_t interval)
 {
-    assert(!context_stack.empty() && context_stack.back() == ctx);
-    context_stack.pop_back();
+    if (sample_random_state == 0) {
+        sample_random_state =
+            (reinterpret_cast<uintptr_t>(&bytes_until_sample) |
+             1) * 0x9E3779B97F4A7C15ULL;
+    }
+    sample_random_state ^= sample_random_state >> 12;
+    sample_random_state ^= sample_random_state << 25;
+    sample_random_state ^= sample_random_state >> 27;
+    uint64_t random = sample_random_state * 0x2545F4914F6CDD1DULL;
+    double u = double((random >> 11) + 1) / 9007199254740992.0; // (0, 1]
+    return static_cast<size_t>(-log(u) * double(interval)) + 1;
+}
+
+// Samples a block of size bytes with probability 1 - exp(-size /
+// interval); the weight is the inverse of the probability
+bool sample_allocation(size_t interval, size_t size, double& weight)
+{
+    if (interval == 0) {
+        weight = 1;
+        return true;
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    if (bytes_until_sample == 0) {
+        bytes_until_sample = get_sample_distance(interval);
+    }
+    if (size < bytes_until_sample) {
+        bytes_until_sample -= size;
+        return false;
+    }
+    bytes_until_sample = get_sample_distance(interval);
+    weight = 1 / -expm1(-double(size) / double(interval));
+    return true;
 }
 
 } /* unnamed namespace */
@@ -101,8 +148,7 @@ NVWA_NAMESPACE_BEGIN
 bool new_autocheck_flag = true;
 bool new_verbose_flag = false;
 FILE* new_output_fp = stderr;
-size_t current_mem_alloc = 0;
-size_t total_mem_alloc_cnt_accum = 0;
+size_t new_sample_interval = 0;
 
 bool operator==(const context& lhs, const context& rhs)
 {
@@ -115,14 +161,14 @@ bool operator!=(const context& lhs, const context& rhs)
     return !(lhs == rhs);
 }
 
-checkpoint::checkpoint(const context& ctx) : ctx_(ctx)
+checkpoint::checkpoint(const context& ctx)
+    : ctx_(ctx), prev_ctx_(save_context(ctx_))
 {
-    save_context(ctx);
 }
 
 checkpoint::~checkpoint()
 {
-    restore_context(ctx_);
+    restore_context(ctx_, prev_ctx_);
 }
 
 constexpr uint32_t CMT_MAGIC = 0x4D'58'54'43;  // "CTXM";
@@ -132,19 +178,92 @@ struct alloc_list_base {
     alloc_list_base* prev;  ///< Pointer to the previous memory block
 };
 
+struct thread_alloc_list;
+
 struct alloc_list_t : alloc_list_base {
+    thread_alloc_list* owner; ///< List the block is linked into
     size_t   size;            ///< Size of the memory block
     context  ctx;             ///< The context
-    uint32_t head_size : 31;  ///< Size of this struct, aligned
+    uint32_t head_size : 30;  ///< Size of this struct, aligned
     uint32_t is_array : 1;    ///< Non-zero iff <em>new[]</em> is used
+    uint32_t is_sampled : 1;  ///< Non-zero iff the block is in the list
     uint32_t magic;           ///< Magic number for error detection
+    double   weight;          ///< Estimated allocations it stands for
 };
 
-alloc_list_base alloc_list = {
-    &alloc_list,  // head (next)
-    &alloc_list,  // tail (prev)
+// List of the sampled blocks allocated by a thread.  A list is never
+// freed: when its thread exits, the list, with the blocks still in it,
+// is handed over to the next new thread.  Blocks freed by other threads
+// are unlinked under the lock of the list, which is seldom contended.
+struct thread_alloc_list {
+    alloc_list_base    head;
+    fast_mutex         lock;
+    double             mem_alloc;   ///< Allocated memory in bytes
+    double             alloc_cnt;   ///< Accumulated count of allocations
+    thread_alloc_list* next_list;   ///< Next list in the registry
+    bool               in_use;      ///< Whether a thread owns the list
 };
 
+// List for threads without their own lists (being exited, or out of
+// memory), and the head of the registry of all thread lists.  It is
+// not constant-initialized, so all members are left to the zero
+// initialization, and its head is set up on first use.
+thread_alloc_list global_alloc_list;
+
+// Guards the registry of thread lists
+fast_mutex alloc_lists_lock;
+
+thread_local thread_alloc_list* thread_allocs = nullptr;
+
+// Gets the first block of a list; called with the list lock held
+alloc_list_base* get_first_node(thread_alloc_list& list)
+{
+    if (list.head.next == nullptr) {
+        list.head.next = &list.head;
+        list.head.prev = &list.head;
+    }
+    return list.head.next;
+}
+
+thread_alloc_list* acquire_alloc_list()
+{
+    fast_mutex_autolock guard{alloc_lists_lock};
+    for (auto list = global_alloc_list.next_list; list != nullptr;
+         list = list->next_list) {
+        if (!list->in_use) {
+            list->in_use = true;
+            return list;
+        }
+    }
+    void* ptr = calloc(1, sizeof(thread_alloc_list));
+    if (ptr == nullptr) {
+        return nullptr;
+    }
+    auto list = ::new (ptr) thread_alloc_list();
+    list->in_use = true;
+    list->next_list = global_alloc_list.next_list;
+    global_alloc_list.next_list = list;
+    return list;
+}
+
+void release_alloc_list(thread_alloc_list* list)
+{
+    fast_mutex_autolock guard{alloc_lists_lock};
+    list->in_use = false;
+}
+
+// Calls func on each list with its lock held
+template <typename _Func>
+void for_each_alloc_list(_Func func)
+{
+    fast_mutex_autolock guard{alloc_lists_lock};
+    for (auto list = &global_alloc_list; list != nullptr;
+         list = list->next_list) {
+        fast_mutex_autolock list_guard{list->lock};
+        func(*list);
+    }
+}
+
 constexpr uint32_t align(size_t alignment, size_t s)
 {
     return static_cast<uint32_t>((s + alignment - 1) & ~(alignment - 1));
@@ -186,11 +305,185 @@ alloc_list_t* convert_user_ptr(void* usr_ptr, size_t alignment)
     return nullptr;
 }
 
+constexpr size_t CONTEXT_STATS_SLOTS = 128;
+
+// Counters of a context, written only by the owning thread.  They are
+// atomic so that other threads may read them without a data race.
+struct context_counters {
+    std::atomic<const char*> file;  ///< Published after func is set
+    const char* func;
+    std::atomic<size_t> alloc_cnt;
+    std::atomic<size_t> alloc_bytes;
+    std::atomic<size_t> size_histogram[context_alloc_stats::
+                                           histogram_buckets];
+};
+
+// Per-thread (or retired) counters, keyed by the addresses of the
+// context strings in an open-addressing table.  Contexts that do not
+// fit go to other_counters.
+struct context_stats_table {
+    context_stats_table* next;
+    context_stats_table* prev;
+    context_counters     entries[CONTEXT_STATS_SLOTS];
+    context_counters     other_counters;
+};
+
+const context other_context{"<OTHER>", "<OTHER>"};
+
+// Guards the list of thread tables and the retired table
+fast_mutex context_stats_lock;
+
+// Counters of exited threads, and the list head of live thread tables
+context_stats_table retired_context_stats = {
+    &retired_context_stats,
+    &retired_context_stats,
+    {},
+    {}
+};
+
+thread_local context_stats_table* thread_context_stats = nullptr;
+thread_local bool thread_state_retired = false;
+
+unsigned get_size_bucket(size_t size)
+{
+    constexpr unsigned max_bucket =
+        context_alloc_stats::histogram_buckets - 1;
+    unsigned bucket = 0;
+    while (size > 1 && bucket < max_bucket) {
+        size >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+// Increments a counter that only the current thread writes to
+void add_to(std::atomic<size_t>& counter, size_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+}
+
+context_counters& find_counters(context_stats_table& table,
+                                const context& ctx)
+{
+    size_t hash = reinterpret_cast<uintptr_t>(ctx.file) * 31 +
+                  reinterpret_cast<uintptr_t>(ctx.func);
+    hash ^= hash >> 11;
+    for (size_t i = 0; i < CONTEXT_STATS_SLOTS; ++i) {
+        auto& entry =
+            table.entries[(hash + i) % CONTEXT_STATS_SLOTS];
+        const char* file = entry.file.load(std::memory_order_relaxed);
+        if (file == nullptr) {
+            entry.func = ctx.func;
+            entry.file.store(ctx.file, std::memory_order_release);
+            return entry;
+        }
+        if (file == ctx.file && entry.func == ctx.func) {
+            return entry;
+        }
+    }
+    return table.other_counters;
+}
+
+void add_counters(context_counters& to, const context_counters& from)
+{
+    add_to(to.alloc_cnt, from.alloc_cnt.load(std::memory_order_relaxed));
+    add_to(to.alloc_bytes,
+           from.alloc_bytes.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < context_alloc_stats::histogram_buckets; ++i) {
+        add_to(to.size_histogram[i],
+               from.size_histogram[i].load(std::memory_order_relaxed));
+    }
+}
+
+void add_allocation(context_counters& counters, size_t size)
+{
+    add_to(counters.alloc_cnt, 1);
+    add_to(counters.alloc_bytes, size);
+    add_to(counters.size_histogram[get_size_bucket(size)], 1);
+}
+
+// Moves the counters of a table to the retired table; called with
+// context_stats_lock held
+void retire_context_stats(context_stats_table& table)
+{
+    for (auto& entry : table.entries) {
+        const char* file = entry.file.load(std::memory_order_relaxed);
+        if (file != nullptr) {
+            add_counters(find_counters(retired_context_stats,
+                                       context{file, entry.func}),
+                         entry);
+        }
+    }
+    add_counters(retired_context_stats.other_counters, table.other_counters);
+}
+
+// Owner of the per-thread data, created on the first allocation in a
+// thread, and destroyed when the thread exits
+struct thread_state_owner {
+    thread_state_owner()
+    {
+        thread_allocs = acquire_alloc_list();
+        void* ptr = calloc(1, sizeof(context_stats_table));
+        if (ptr == nullptr) {
+            return;
+        }
+        auto table = static_cast<context_stats_table*>(ptr);
+        fast_mutex_autolock guard{context_stats_lock};
+        table->prev = &retired_context_stats;
+        table->next = retired_context_stats.next;
+        retired_context_stats.next->prev = table;
+        retired_context_stats.next = table;
+        thread_context_stats = table;
+    }
+    ~thread_state_owner()
+    {
+        thread_alloc_list* list = thread_allocs;
+        context_stats_table* table = thread_context_stats;
+        thread_allocs = nullptr;
+        thread_context_stats = nullptr;
+        thread_state_retired = true;
+        if (list != nullptr) {
+            release_alloc_list(list);
+        }
+        if (table == nullptr) {
+            return;
+        }
+        {
+            fast_mutex_autolock guard{context_stats_lock};
+            table->prev->next = table->next;
+            table->next->prev = table->prev;
+            retire_context_stats(*table);
+        }
+        free(table);
+    }
+};
+
+void init_thread_state()
+{
+    if (thread_context_stats == nullptr && !thread_state_retired) {
+        static thread_local thread_state_owner owner;
+    }
+}
+
+void count_allocation(const context& ctx, size_t size)
+{
+    if (context_stats_table* table = thread_context_stats) {
+        add_allocation(find_counters(*table, ctx), size);
+    } else {
+        // The thread is exiting, or the table cannot be allocated
+        fast_mutex_autolock guard{context_stats_lock};
+        add_allocation(find_counters(retired_context_stats, ctx), size);
+    }
+}
+
 void* alloc_mem(size_t size, const context& ctx, is_array_t is_array,
                 size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__)
 {
     assert(alignment >= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
 
+    double weight = 0;
+    bool is_sampled = sample_allocation(new_sample_interval, size, weight);
     uint32_t aligned_list_node_size = align(alignment, sizeof(alloc_list_t));
     alloc_list_t* ptr;
     if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
@@ -204,20 +497,32 @@ void* alloc_mem(size_t size, const context& ctx, is_array_t is_array,
         return nullptr;
     }
 
+    init_thread_state();
+    count_allocation(ctx, size);
     auto usr_ptr = reinterpret_cast<char*>(ptr) + aligned_list_node_size;
     ptr->ctx = ctx;
     ptr->is_array = is_array;
+    ptr->is_sampled = is_sampled;
+    ptr->weight = weight;
     ptr->size = size;
     ptr->head_size = aligned_list_node_size;
     ptr->magic = CMT_MAGIC;
-    {
-        fast_mutex_autolock guard{new_ptr_lock};
-        ptr->prev = alloc_list.prev;
-        ptr->next = &alloc_list;
-        alloc_list.prev->next = ptr;
-        alloc_list.prev = ptr;
-        current_mem_alloc += size;
-        ++total_mem_alloc_cnt_accum;
+    if (is_sampled) {
+        thread_alloc_list* list =
+            thread_allocs ? thread_allocs : &global_alloc_list;
+        fast_mutex_autolock guard{list->lock};
+        get_first_node(*list);
+        ptr->owner = list;
+        ptr->prev = list->head.prev;
+        ptr->next = &list->head;
+        list->head.prev->next = ptr;
+        list->head.prev = ptr;
+        list->mem_alloc += weight * double(size);
+        list->alloc_cnt += weight;
+    } else {
+        ptr->owner = nullptr;
+        ptr->prev = nullptr;
+        ptr->next = nullptr;
     }
     if (new_verbose_flag) {
         fast_mutex_autolock guard{new_output_lock};
@@ -250,18 +555,23 @@ void free_mem(void* usr_ptr, is_array_t is_array,
                                msg, usr_ptr, ptr->size);
         NVWA_CMT_ERROR_ACTION();
     }
-    {
-        fast_mutex_autolock guard{new_ptr_lock};
-        current_mem_alloc -= ptr->size;
+    if (ptr->is_sampled) {
+        fast_mutex_autolock guard{ptr->owner->lock};
+        ptr->owner->mem_alloc -= ptr->weight * double(ptr->size);
         ptr->magic = 0;
         ptr->prev->next = ptr->next;
         ptr->next->prev = ptr->prev;
+    } else {
+        ptr->magic = 0;
     }
     if (new_verbose_flag) {
+        // The list locks must not be taken with new_output_lock held,
+        // as check_leaks takes them in the opposite order.
+        size_t mem_alloc = get_current_mem_alloc();
         fast_mutex_autolock guard{new_output_lock};
         fprintf(new_output_fp,
                 "delete%s: freed %p (size %zu, %zu bytes still allocated)\n",
-                is_array ? "[]" : "", usr_ptr, ptr->size, current_mem_alloc);
+                is_array ? "[]" : "", usr_ptr, ptr->size, mem_alloc);
     }
 
     if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
@@ -274,27 +584,30 @@ void free_mem(void* usr_ptr, is_array_t is_array,
 int check_leaks()
 {
     int leak_cnt = 0;
-    fast_mutex_autolock guard_ptr{new_ptr_lock};
-    fast_mutex_autolock guard_output{new_output_lock};
-    auto ptr = static_cast<alloc_list_t*>(alloc_list.next);
-
-    while (ptr != &alloc_list) {
-        if (ptr->magic != CMT_MAGIC) {
-            fprintf(new_output_fp, "error: heap data corrupt near %p\n",
-                    &ptr->magic);
-            NVWA_CMT_ERROR_ACTION();
+    for_each_alloc_list([&leak_cnt](thread_alloc_list& list) {
+        fast_mutex_autolock guard_output{new_output_lock};
+        auto ptr = static_cast<alloc_list_t*>(get_first_node(list));
+
+        while (ptr != &list.head) {
+            if (ptr->magic != CMT_MAGIC) {
+                fprintf(new_output_fp, "error: heap data corrupt near %p\n",
+                        &ptr->magic);
+                NVWA_CMT_ERROR_ACTION();
+            }
+
+            auto usr_ptr =
+                reinterpret_cast<const char*>(ptr) + ptr->head_size;
+            fprintf(new_output_fp, "Leaked object at %p (size %zu, ",
+                    usr_ptr, ptr->size);
+
+            print_context(ptr->ctx, new_output_fp);
+            fprintf(new_output_fp, ")\n");
+
+            ptr = static_cast<alloc_list_t*>(ptr->next);
+            ++leak_cnt;
         }
-
-        auto usr_ptr = reinterpret_cast<const char*>(ptr) + ptr->head_size;
-        fprintf(new_output_fp, "Leaked object at %p (size %zu, ", usr_ptr,
-                ptr->size);
-
-        print_context(ptr->ctx, new_output_fp);
-        fprintf(new_output_fp, ")\n");
-
-        ptr = static_cast<alloc_list_t*>(ptr->next);
-        ++leak_cnt;
-    }
+    });
+    fast_mutex_autolock guard_output{new_output_lock};
     if (leak_cnt) {
         fprintf(new_output_fp, "*** %d leaks found\n", leak_cnt);
     }
@@ -304,12 +617,244 @@ int check_leaks()
 
 size_t get_current_mem_alloc()
 {
-    return current_mem_alloc;
+    double result = 0;
+    for_each_alloc_list([&result](thread_alloc_list& list) {
+        result += list.mem_alloc;
+    });
+    return static_cast<size_t>(result + 0.5);
 }
 
 size_t get_total_mem_alloc_cnt()
 {
-    return total_mem_alloc_cnt_accum;
+    double result = 0;
+    for_each_alloc_list([&result](thread_alloc_list& list) {
+        result += list.alloc_cnt;
+    });
+    return static_cast<size_t>(result + 0.5);
+}
+
+struct alloc_site_t {
+    context ctx;
+    double  count;
+    double  bytes;
+};
+
+bool is_site_less(const alloc_site_t& lhs, const alloc_site_t& rhs)
+{
+    int result = strcmp(lhs.ctx.file, rhs.ctx.file);
+    if (result != 0) {
+        return result < 0;
+    }
+    return strcmp(lhs.ctx.func, rhs.ctx.func) < 0;
+}
+
+// Collects the sampled blocks by context, in descending order of bytes
+bool collect_alloc_sites(alloc_site_t*& sites, size_t& site_cnt)
+{
+    site_cnt = 0;
+    size_t site_cap = 0;
+    sites = nullptr;
+    bool success = true;
+    for_each_alloc_list([&](thread_alloc_list& list) {
+        for (auto ptr = get_first_node(list); ptr != &list.head;
+             ptr = ptr->next) {
+            if (!success) {
+                return;
+            }
+            if (site_cnt == site_cap) {
+                site_cap = site_cap ? site_cap * 2 : 256;
+                auto new_sites = static_cast<alloc_site_t*>(
+                    realloc(sites, site_cap * sizeof(alloc_site_t)));
+                if (new_sites == nullptr) {
+                    success = false;
+                    return;
+                }
+                sites = new_sites;
+            }
+            auto node = static_cast<alloc_list_t*>(ptr);
+            sites[site_cnt++] = {node->ctx, node->weight,
+                                 node->weight * double(node->size)};
+        }
+    });
+    if (!success) {
+        free(sites);
+        sites = nullptr;
+        site_cnt = 0;
+        return false;
+    }
+
+    // Merge the blocks from the same context
+    std::sort(sites, sites + site_cnt, is_site_less);
+    size_t merged_cnt = 0;
+    for (size_t i = 0; i < site_cnt; ++i) {
+        if (merged_cnt != 0 && sites[merged_cnt - 1].ctx == sites[i].ctx) {
+            sites[merged_cnt - 1].count += sites[i].count;
+            sites[merged_cnt - 1].bytes += sites[i].bytes;
+        } else {
+            sites[merged_cnt++] = sites[i];
+        }
+    }
+    std::sort(sites, sites + merged_cnt,
+              [](const alloc_site_t& lhs, const alloc_site_t& rhs) {
+                  return lhs.bytes > rhs.bytes;
+              });
+    site_cnt = merged_cnt;
+    return true;
+}
+
+int report_alloc_sites(alloc_site_callback_t callback, void* data)
+{
+    alloc_site_t* sites;
+    size_t merged_cnt;
+    if (!collect_alloc_sites(sites, merged_cnt)) {
+        return -1;
+    }
+
+    // The callback may allocate memory, and no lock shall be held then
+    if (callback == nullptr) {
+        new_output_lock.lock();
+    }
+    for (size_t i = 0; i < merged_cnt; ++i) {
+        auto count = static_cast<size_t>(sites[i].count + 0.5);
+        auto bytes = static_cast<size_t>(sites[i].bytes + 0.5);
+        if (callback) {
+            callback(sites[i].ctx, count, bytes, data);
+        } else {
+            fprintf(new_output_fp,
+                    "Live allocations: %zu bytes in %zu objects (",
+                    bytes, count);
+            print_context(sites[i].ctx, new_output_fp);
+            fprintf(new_output_fp, ")\n");
+        }
+    }
+    if (callback == nullptr) {
+        new_output_lock.unlock();
+    }
+    free(sites);
+    return static_cast<int>(merged_cnt);
+}
+
+// Writes folded stacks (file;func bytes), as read by flamegraph.pl
+int dump_heap_profile(FILE* fp)
+{
+    alloc_site_t* sites;
+    size_t site_cnt;
+    if (!collect_alloc_sites(sites, site_cnt)) {
+        return -1;
+    }
+    for (size_t i = 0; i < site_cnt; ++i) {
+        fprintf(fp, "%s;%s %zu\n", sites[i].ctx.file, sites[i].ctx.func,
+                static_cast<size_t>(sites[i].bytes + 0.5));
+    }
+    fflush(fp);
+    free(sites);
+    return static_cast<int>(site_cnt);
+}
+
+int report_context_stats(context_stats_callback_t callback, void* data)
+{
+    size_t stats_cnt = 0;
+    size_t stats_cap = 0;
+    context_alloc_stats* stats = nullptr;
+    auto collect = [&](const context& ctx, const context_counters& from) {
+        if (from.alloc_cnt.load(std::memory_order_relaxed) == 0) {
+            return true;
+        }
+        if (stats_cnt == stats_cap) {
+            stats_cap = stats_cap ? stats_cap * 2 : 256;
+            auto new_stats = static_cast<context_alloc_stats*>(
+                realloc(stats, stats_cap * sizeof(context_alloc_stats)));
+            if (new_stats == nullptr) {
+                return false;
+            }
+            stats = new_stats;
+        }
+        context_alloc_stats& result = stats[stats_cnt++];
+        result.ctx = ctx;
+        result.alloc_cnt = from.alloc_cnt.load(std::memory_order_relaxed);
+        result.alloc_bytes =
+            from.alloc_bytes.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < context_alloc_stats::histogram_buckets;
+             ++i) {
+            result.size_histogram[i] =
+                from.size_histogram[i].load(std::memory_order_relaxed);
+        }
+        return true;
+    };
+    bool success = true;
+    {
+        fast_mutex_autolock guard{context_stats_lock};
+        auto table = &retired_context_stats;
+        do {
+            for (auto& entry : table->entries) {
+                const char* file =
+                    entry.file.load(std::memory_order_acquire);
+                if (file != nullptr) {
+                    success &= collect(context{file, entry.func}, entry);
+                }
+            }
+            success &= collect(other_context, table->other_counters);
+            table = table->next;
+        } while (table != &retired_context_stats);
+    }
+    if (!success) {
+        free(stats);
+        return -1;
+    }
+
+    // Merge the counters of the same context from different threads
+    std::sort(stats, stats + stats_cnt,
+              [](const context_alloc_stats& lhs,
+                 const context_alloc_stats& rhs) {
+                  int result = strcmp(lhs.ctx.file, rhs.ctx.file);
+                  if (result != 0) {
+                      return result < 0;
+                  }
+                  return strcmp(lhs.ctx.func, rhs.ctx.func) < 0;
+              });
+    size_t merged_cnt = 0;
+    for (size_t i = 0; i < stats_cnt; ++i) {
+        if (merged_cnt != 0 && stats[merged_cnt - 1].ctx == stats[i].ctx) {
+            auto& merged = stats[merged_cnt - 1];
+            merged.alloc_cnt += stats[i].alloc_cnt;
+            merged.alloc_bytes += stats[i].alloc_bytes;
+            for (size_t j = 0; j < context_alloc_stats::histogram_buckets;
+                 ++j) {
+                merged.size_histogram[j] += stats[i].size_histogram[j];
+            }
+        } else {
+            stats[merged_cnt++] = stats[i];
+        }
+    }
+
+    // The callback may allocate memory, and no lock shall be held then
+    if (callback == nullptr) {
+        new_output_lock.lock();
+    }
+    for (size_t i = 0; i < merged_cnt; ++i) {
+        if (callback) {
+            callback(stats[i], data);
+            continue;
+        }
+        fprintf(new_output_fp, "Allocations: %zu, %zu bytes (",
+                stats[i].alloc_cnt, stats[i].alloc_bytes);
+        print_context(stats[i].ctx, new_output_fp);
+        fprintf(new_output_fp, ")\n\tsizes:");
+        for (size_t j = 0; j < context_alloc_stats::histogram_buckets;
+             ++j) {
+            if (stats[i].size_histogram[j] != 0) {
+                fprintf(new_output_fp, " %zu+:%zu",
+                        j == 0 ? 0 : size_t(1) << j,
+                        stats[i].size_histogram[j]);
+            }
+        }
+        fprintf(new_output_fp, "\n");
+    }
+    if (callback == nullptr) {
+        new_output_lock.unlock();
+    }
+    free(stats);
+    return static_cast<int>(merged_cnt);
 }
 
 int memory_trace_counter::_S_count = 0;
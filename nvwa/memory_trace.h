@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2022 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2022-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -32,7 +32,7 @@
  * Header file for tracing memory with contextual checkpoints.  The
  * current code requires a C++17-compliant compiler.
  *
- * @date  2022-04-07
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_MEMORY_TRACE_H
@@ -49,18 +49,41 @@
 
 NVWA_NAMESPACE_BEGIN
 
+struct context {
+    const char* file;
+    const char* func;
+};
+
+typedef void (*alloc_site_callback_t)(const context& ctx, size_t count,
+                                      size_t bytes, void* data);
+
+// Accumulated allocations in a context since the program start; the
+// size histogram counts sizes in [2^i, 2^(i+1)) in bucket i (with 0 in
+// bucket 0, and all bigger sizes in the last bucket)
+struct context_alloc_stats {
+    static constexpr size_t histogram_buckets = 32;
+    context ctx;
+    size_t  alloc_cnt;
+    size_t  alloc_bytes;
+    size_t  size_histogram[histogram_buckets];
+};
+
+typedef void (*context_stats_callback_t)(const context_alloc_stats& stats,
+                                         void* data);
+
 int check_leaks();
 size_t get_current_mem_alloc();
 size_t get_total_mem_alloc_cnt();
+int report_alloc_sites(alloc_site_callback_t callback = nullptr,
+                       void* data = nullptr);
+int dump_heap_profile(FILE* fp);
+int report_context_stats(context_stats_callback_t callback = nullptr,
+                         void* data = nullptr);
 
 extern bool new_autocheck_flag; // default to true: call check_leaks() on exit
 extern bool new_verbose_flag;   // default to false: no verbose information
 extern FILE* new_output_fp;     // default to stderr: output to console
-
-struct context {
-    const char* file;
-    const char* func;
-};
+extern size_t new_sample_interval; // default to 0: track every allocation
 
 bool operator==(const context& lhs, const context& rhs);
 bool operator!=(const context& lhs, const context& rhs);
@@ -74,6 +97,7 @@ public:
 
 private:
     const context ctx_;
+    const context* prev_ctx_;
 };
 
 class memory_trace_counter {
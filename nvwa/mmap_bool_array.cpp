@@ -0,0 +1,238 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  mmap_bool_array.cpp
+ *
+ * Code for class mmap_bool_array (bool_array backed by a memory-mapped
+ * file).  The current code requires a C++17-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#include "mmap_bool_array.h"    // mmap_bool_array
+#include <errno.h>              // errno
+#include <stdint.h>             // uint64_t/uintptr_t
+#include <stdio.h>              // fopen/fwrite/fclose/FILE
+#include <stdexcept>            // std::out_of_range
+#include <system_error>         // std::errc/error_code/system_error
+#include "_nvwa.h"              // NVWA macros
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "mmap_bool_array requires a little-endian platform"
+#endif
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Maps a bitmap file.
+ *
+ * @param path          path to the file to map
+ * @param mode          mode of the mapping
+ * @param size          size of the array; \c #npos means all bits in
+ *                      the file
+ * @throw system_error  an error occurred when calling a system function,
+ *                      or the bits after \a size are not zero
+ * @throw out_of_range  \a size is zero or too big for the file
+ */
+mmap_bool_array::mmap_bool_array(const char* path, mode_type mode,
+                                 size_type size)
+{
+    _open(path, mode, size);
+}
+
+#if NVWA_WINDOWS
+/**
+ * Maps a bitmap file.
+ *
+ * @param path          path to the file to map
+ * @param mode          mode of the mapping
+ * @param size          size of the array; \c #npos means all bits in
+ *                      the file
+ * @throw system_error  an error occurred when calling a system function,
+ *                      or the bits after \a size are not zero
+ * @throw out_of_range  \a size is zero or too big for the file
+ */
+mmap_bool_array::mmap_bool_array(const wchar_t* path, mode_type mode,
+                                 size_type size)
+{
+    _open(path, mode, size);
+}
+#endif
+
+/**
+ * Destructor.  Changes in the read-write mode go to the file, but they
+ * may not be written to the disk before #sync is called.
+ */
+mmap_bool_array::~mmap_bool_array()
+{
+    close();
+}
+
+/**
+ * Maps a bitmap file.  The previously mapped file, if any, is closed
+ * first.
+ *
+ * @param path          path to the file to map
+ * @param mode          mode of the mapping
+ * @param size          size of the array; \c #npos means all bits in
+ *                      the file
+ * @throw system_error  an error occurred when calling a system function,
+ *                      or the bits after \a size are not zero
+ * @throw out_of_range  \a size is zero or too big for the file
+ */
+void mmap_bool_array::open(const char* path, mode_type mode, size_type size)
+{
+    _open(path, mode, size);
+}
+
+#if NVWA_WINDOWS
+/**
+ * Maps a bitmap file.  The previously mapped file, if any, is closed
+ * first.
+ *
+ * @param path          path to the file to map
+ * @param mode          mode of the mapping
+ * @param size          size of the array; \c #npos means all bits in
+ *                      the file
+ * @throw system_error  an error occurred when calling a system function,
+ *                      or the bits after \a size are not zero
+ * @throw out_of_range  \a size is zero or too big for the file
+ */
+void mmap_bool_array::open(const wchar_t* path, mode_type mode,
+                           size_type size)
+{
+    _open(path, mode, size);
+}
+#endif
+
+/**
+ * Unmaps the file.  The array becomes empty.
+ */
+void mmap_bool_array::close() noexcept
+{
+    // The memory belongs to the mapping, and shall not be freed
+    _M_array._M_word_ptr = nullptr;
+    _M_array._M_length = 0;
+    _M_writable = false;
+    _M_file.close();
+}
+
+/**
+ * Writes the changes back to the file.  It is useful only in the
+ * read-write mode.
+ *
+ * @throw system_error  an error occurred when calling a system function
+ */
+void mmap_bool_array::sync()
+{
+    _M_file.sync();
+}
+
+/**
+ * Initializes all array elements to a specific value.
+ *
+ * @param value         the boolean value to assign to all elements
+ * @throw system_error  the file is not mapped in the read-write mode
+ */
+void mmap_bool_array::initialize(bool value)
+{
+    check_writable();
+    _M_array.initialize(value);
+}
+
+/**
+ * Saves a bool_array to a file in the bitmap layout, which can be
+ * mapped by mmap_bool_array later.  An existing file is overwritten.
+ *
+ * @param ba            the bool_array to save
+ * @param path          path to the file to write
+ * @throw system_error  an error occurred when calling a system function
+ */
+void mmap_bool_array::save(const bool_array& ba, const char* path)
+{
+    assert(ba._M_word_ptr);
+    FILE* fp = fopen(path, "wb");
+    if (fp == nullptr) {
+        throw std::system_error(errno, std::system_category(), "fopen failed");
+    }
+    size_t byte_cnt = bool_array::get_num_bytes_from_bits(ba.size());
+    size_t written = fwrite(ba._M_word_ptr, 1, byte_cnt, fp);
+    int error = written == byte_cnt ? 0 : errno;
+    if (fclose(fp) != 0 && error == 0) {
+        error = errno;
+    }
+    if (error != 0) {
+        throw std::system_error(error, std::system_category(),
+                                "writing bitmap failed");
+    }
+}
+
+template <typename _Char>
+void mmap_bool_array::_open(const _Char* path, mode_type mode,
+                            size_type size)
+{
+    close();
+    mmap_reader_base file(path, mode);
+    if (size == npos) {
+        size = file.size() * size_type(8);
+    }
+    if (size == 0 ||
+            bool_array::get_num_bytes_from_bits(size) > file.size()) {
+        throw std::out_of_range("invalid mmap_bool_array size");
+    }
+
+    // The mapping is page-aligned, and a word never crosses the end of
+    // the mapped pages
+    auto word_ptr = reinterpret_cast<uint64_t*>(file.data());
+    assert(reinterpret_cast<uintptr_t>(word_ptr) % alignof(uint64_t) == 0);
+    if (unsigned valid_bits_in_last_word = size % 64) {
+        uint64_t last_word = word_ptr[(size - 1) / 64];
+        if ((last_word & (~uint64_t(0) << valid_bits_in_last_word)) != 0) {
+            throw std::system_error(
+                make_error_code(std::errc::invalid_argument),
+                "extra bits in bitmap file");
+        }
+    }
+
+    _M_file = std::move(file);
+    _M_array._M_word_ptr = word_ptr;
+    _M_array._M_length = size;
+    _M_writable = mode == mmap_reader_base::read_write;
+}
+
+void mmap_bool_array::check_writable() const
+{
+    if (!_M_writable) {
+        throw std::system_error(
+            make_error_code(std::errc::operation_not_permitted),
+            "mmap_bool_array is read-only");
+    }
+}
+
+NVWA_NAMESPACE_END
@@ -0,0 +1,231 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  mmap_bool_array.h
+ *
+ * Header file for class mmap_bool_array (bool_array backed by a
+ * memory-mapped file).  Using this file requires a C++17-compliant
+ * compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_MMAP_BOOL_ARRAY_H
+#define NVWA_MMAP_BOOL_ARRAY_H
+
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "bool_array.h"         // nvwa::bool_array
+#include "mmap_reader_base.h"   // nvwa::mmap_reader_base
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class to use a bitmap file as a bool_array without copying.  The file
+ * is memory-mapped, so it is loaded on demand, and a read-only mapping
+ * is shared by all processes mapping the same file.  In the read-write
+ * mode, the mapping is shared, and changes go to the file and are seen
+ * by other processes mapping it.
+ *
+ * The file has the bitmap layout of bool_array::copy_to_bitmap (or
+ * #save).  The bits after the array size up to a 64-bit boundary shall
+ * be zero (so they shall either be unused bits in the file or beyond the
+ * end of the file).  Only little-endian platforms are supported.
+ */
+class mmap_bool_array {
+public:
+    typedef bool_array::size_type size_type;        ///< Type of array indices
+    typedef mmap_reader_base::mode_type mode_type;  ///< Mode of the mapping
+
+    /** Constant representing `not found'. */
+    static constexpr auto npos = size_type(-1);
+
+    mmap_bool_array() noexcept;
+    explicit mmap_bool_array(const char* path,
+                             mode_type mode = mmap_reader_base::read_only,
+                             size_type size = npos);
+#if NVWA_WINDOWS
+    explicit mmap_bool_array(const wchar_t* path,
+                             mode_type mode = mmap_reader_base::read_only,
+                             size_type size = npos);
+#endif
+    ~mmap_bool_array();
+
+    mmap_bool_array(const mmap_bool_array&) = delete;
+    mmap_bool_array& operator=(const mmap_bool_array&) = delete;
+
+    void open(const char* path,
+              mode_type mode = mmap_reader_base::read_only,
+              size_type size = npos);
+#if NVWA_WINDOWS
+    void open(const wchar_t* path,
+              mode_type mode = mmap_reader_base::read_only,
+              size_type size = npos);
+#endif
+    void close() noexcept;
+    void sync();
+
+    bool is_open() const noexcept;
+    bool is_writable() const noexcept;
+    const bool_array& array() const noexcept;
+    size_type size() const noexcept;
+
+    bool operator[](size_type pos) const;
+    bool_array::reference operator[](size_type pos);
+    bool at(size_type pos) const;
+    void reset(size_type pos);
+    void set(size_type pos);
+    void initialize(bool value);
+
+    static void save(const bool_array& ba, const char* path);
+
+private:
+    template <typename _Char>
+    void _open(const _Char* path, mode_type mode, size_type size);
+    void check_writable() const;
+
+    mmap_reader_base _M_file;
+    bool_array       _M_array;      ///< Borrowing the mapped memory
+    bool             _M_writable{};
+};
+
+
+/* Inline functions */
+
+/**
+ * Constructs an object without a mapped file.
+ */
+inline mmap_bool_array::mmap_bool_array() noexcept = default;
+
+/**
+ * Checks whether a file is mapped.
+ *
+ * @return  \c true if a file is mapped; \c false otherwise
+ */
+inline bool mmap_bool_array::is_open() const noexcept
+{
+    return _M_file.is_open();
+}
+
+/**
+ * Checks whether the mapped file is writable.
+ *
+ * @return  \c true if the file is mapped in the read-write mode; \c
+ *          false otherwise
+ */
+inline bool mmap_bool_array::is_writable() const noexcept
+{
+    return _M_writable;
+}
+
+/**
+ * Gets the bool_array view of the mapped file.  It can be used for all
+ * read operations, and in copying to a normal bool_array.
+ *
+ * @return  const reference to the bool_array
+ */
+inline const bool_array& mmap_bool_array::array() const noexcept
+{
+    return _M_array;
+}
+
+/**
+ * Gets the size of the array.
+ *
+ * @return  the number of bits of the array
+ */
+inline mmap_bool_array::size_type mmap_bool_array::size() const noexcept
+{
+    return _M_array.size();
+}
+
+/**
+ * Reads the boolean value of an array element.
+ *
+ * @param pos  position of the array element to access
+ * @return     the boolean value of the accessed array element
+ */
+inline bool mmap_bool_array::operator[](size_type pos) const
+{
+    return static_cast<const bool_array&>(_M_array)[pos];
+}
+
+/**
+ * Creates a reference to an array element.  Assignment through the
+ * reference requires that the file be mapped in the read-write mode,
+ * and it crashes otherwise.
+ *
+ * @param pos  position of the array element to access
+ * @return     reference to the specified element
+ */
+inline bool_array::reference mmap_bool_array::operator[](size_type pos)
+{
+    return _M_array[pos];
+}
+
+/**
+ * Reads the boolean value of an array element at a specified position.
+ *
+ * @param pos           position of the array element to access
+ * @return              the boolean value of the accessed array element
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+inline bool mmap_bool_array::at(size_type pos) const
+{
+    return _M_array.at(pos);
+}
+
+/**
+ * Resets an array element to \c false at a specified position.
+ *
+ * @param pos           position of the array element to access
+ * @throw system_error  the file is not mapped in the read-write mode
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+inline void mmap_bool_array::reset(size_type pos)
+{
+    check_writable();
+    _M_array.reset(pos);
+}
+
+/**
+ * Sets an array element to \c true at a specified position.
+ *
+ * @param pos           position of the array element to access
+ * @throw system_error  the file is not mapped in the read-write mode
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+inline void mmap_bool_array::set(size_type pos)
+{
+    check_writable();
+    _M_array.set(pos);
+}
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_MMAP_BOOL_ARRAY_H
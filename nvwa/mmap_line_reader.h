@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2016-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2016-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -32,7 +32,7 @@
  * Header file for mmap_line_reader and mmap_line_reader_sv, easy-to-use
  * line-based file readers.  It is implemented with memory-mapped file APIs.
  *
- * @date  2024-04-29
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_MMAP_LINE_READER_H
@@ -40,10 +40,12 @@
 
 #include <assert.h>             // assert
 #include <stddef.h>             // ptrdiff_t/size_t
+#include <string.h>             // memchr
 #include <iterator>             // std::forward_iterator_tag
+#include <vector>               // std::vector
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
 #include "c++_features.h"       // HAVE_CXX17_STRING_VIEW
-#include "mmap_reader_base.h"   // nvwa::mmap_reader_base
+#include "mmap_reader_base.h"   // nvwa::mmap_reader_base/mmap_read_window
 
 #include <string>               // std::string
 #if HAVE_CXX17_STRING_VIEW
@@ -67,7 +69,14 @@ public:
 
         iterator() = default;
         explicit iterator(basic_mmap_line_reader* reader)
-            : _M_reader(reader)
+            : _M_reader(reader), _M_end(reader->size()),
+              _M_window(reader->_M_read_window)
+        {
+            ++*this;
+        }
+        iterator(basic_mmap_line_reader* reader, size_t begin, size_t end)
+            : _M_reader(reader), _M_offset(begin), _M_end(end),
+              _M_window(reader->_M_read_window)
         {
             ++*this;
         }
@@ -84,7 +93,8 @@ public:
         }
         iterator& operator++()
         {
-            if (!_M_reader->read(_M_line, _M_offset)) {
+            _M_window.advance(*_M_reader, _M_offset);
+            if (!_M_reader->read(_M_line, _M_offset, _M_end)) {
                 _M_reader = nullptr;
                 _M_offset = 0;
             }
@@ -109,9 +119,43 @@ public:
     private:
         basic_mmap_line_reader* _M_reader{};
         size_t                  _M_offset{};
+        size_t                  _M_end{};
+        mmap_read_window        _M_window;
         value_type              _M_line;
     };
 
+    /** Range of the lines in part of the file, as returned by #chunks. */
+    class chunk {
+    public:
+        iterator begin() const
+        {
+            return iterator(_M_reader, _M_begin, _M_end);
+        }
+        iterator end() const noexcept
+        {
+            return {};
+        }
+        size_t begin_offset() const noexcept
+        {
+            return _M_begin;
+        }
+        size_t end_offset() const noexcept
+        {
+            return _M_end;
+        }
+
+    private:
+        friend class basic_mmap_line_reader;
+        chunk(basic_mmap_line_reader* reader, size_t begin, size_t end)
+            : _M_reader(reader), _M_begin(begin), _M_end(end)
+        {
+        }
+
+        basic_mmap_line_reader* _M_reader;
+        size_t                  _M_begin;
+        size_t                  _M_end;
+    };
+
     /** Enumeration of whether the delimiter should be stripped. */
     enum strip_type {
         strip_delimiter,     ///< The delimiter should be stripped
@@ -151,6 +195,7 @@ public:
     using mmap_reader_base::open;
     using mmap_reader_base::close;
     using mmap_reader_base::is_open;
+    using mmap_reader_base::advise;
 
     void set_delimiter(char delimiter, strip_type strip = strip_delimiter)
     {
@@ -158,6 +203,21 @@ public:
         _M_strip_delimiter = strip == strip_delimiter;
     }
 
+    /**
+     * Sets the read-ahead window used by iterators created afterwards.
+     * Each iterator (including those of different chunks) keeps its own
+     * window.
+     *
+     * @param window_size     number of bytes to prefetch ahead of the
+     *                        line being read; \c 0 disables the window
+     * @param release_behind  whether to release the pages of lines
+     *                        already read
+     */
+    void set_read_ahead(size_t window_size, bool release_behind = false)
+    {
+        _M_read_window.set(window_size, release_behind);
+    }
+
     iterator begin()
     {
         return iterator(this);
@@ -167,11 +227,15 @@ public:
         return {};
     }
 
+    std::vector<chunk> chunks(size_t n);
+
     bool read(_Tp& output, size_t& offset);
+    bool read(_Tp& output, size_t& offset, size_t end_offset);
 
 private:
-    char  _M_delimiter{'\n'};
-    bool  _M_strip_delimiter{true};
+    char             _M_delimiter{'\n'};
+    bool             _M_strip_delimiter{true};
+    mmap_read_window _M_read_window;
 };
 
 /**
@@ -185,19 +249,34 @@ private:
 template <typename _Tp>
 bool basic_mmap_line_reader<_Tp>::read(_Tp& output, size_t& offset)
 {
-    if (offset == size()) {
+    return read(output, offset, size());
+}
+
+/**
+ * Reads content from part of the mmaped file.
+ *
+ * @param[out]    output      object to receive the line
+ * @param[in,out] offset      offset of reading pos on entry; end offset on
+ *                            exit
+ * @param[in]     end_offset  offset to stop reading at
+ * @return                    \c true if line content is returned; \c
+ *                            false otherwise
+ */
+template <typename _Tp>
+bool basic_mmap_line_reader<_Tp>::read(_Tp& output, size_t& offset,
+                                       size_t end_offset)
+{
+    assert(end_offset <= size());
+    if (offset >= end_offset) {
         return false;
     }
 
-    size_t pos = offset;
-    bool found_delimiter = false;
-    while (pos < size()) {
-        char ch = data()[pos++];
-        if (ch == _M_delimiter) {
-            found_delimiter = true;
-            break;
-        }
-    }
+    // memchr is vectorized in common C libraries
+    const char* ptr = data() + offset;
+    auto delimiter_ptr = static_cast<const char*>(
+        memchr(ptr, _M_delimiter, end_offset - offset));
+    bool found_delimiter = delimiter_ptr != nullptr;
+    size_t pos = found_delimiter ? delimiter_ptr - data() + 1 : end_offset;
 
     output = _Tp(data() + offset,
                  pos - offset - (found_delimiter && _M_strip_delimiter));
@@ -205,6 +284,29 @@ bool basic_mmap_line_reader<_Tp>::read(_Tp& output, size_t& offset)
     return true;
 }
 
+/**
+ * Splits the file into chunks of lines, which can be iterated over
+ * independently (say, by separate threads).  The chunks have about the
+ * same size, and each starts at the beginning of a line.  This reader
+ * shall outlive the chunks.
+ *
+ * @param n  maximum number of chunks
+ * @return   the non-empty chunks, in the order of the file
+ */
+template <typename _Tp>
+std::vector<typename basic_mmap_line_reader<_Tp>::chunk>
+basic_mmap_line_reader<_Tp>::chunks(size_t n)
+{
+    std::vector<size_t> offsets =
+        chunk_offsets(n, _M_delimiter, 0, size());
+    std::vector<chunk> result;
+    result.reserve(offsets.size() - 1);
+    for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+        result.push_back(chunk(this, offsets[i], offsets[i + 1]));
+    }
+    return result;
+}
+
 typedef basic_mmap_line_reader<std::string>      mmap_line_reader;
 #if HAVE_CXX17_STRING_VIEW
 typedef basic_mmap_line_reader<std::string_view> mmap_line_reader_sv;
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2019-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2019-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -33,7 +33,7 @@
  * satisfies the copyable concept.  It is similar to mmap_line_reader_sv
  * otherwise (except some minor differences caused by free store usage).
  *
- * @date  2024-04-29
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_MMAP_LINE_VIEW_H
@@ -41,12 +41,16 @@
 
 #include <assert.h>             // assert
 #include <stddef.h>             // ptrdiff_t/size_t
+#include <string.h>             // memchr
+#include <stdint.h>             // SIZE_MAX
+#include <algorithm>            // std::min
 #include <iterator>             // std::forward_iterator_tag
 #include <memory>               // std::shared_ptr
 #include <string_view>          // std::string_view
+#include <vector>               // std::vector
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
 #include "c++_features.h"       // HAVE_CXX20_RANGES
-#include "mmap_reader_base.h"   // nvwa::mmap_reader_base
+#include "mmap_reader_base.h"   // nvwa::mmap_reader_base/mmap_read_window
 
 NVWA_NAMESPACE_BEGIN
 
@@ -64,7 +68,9 @@ public:
         typedef std::forward_iterator_tag iterator_category;
 
         iterator() = default;
-        explicit iterator(basic_mmap_line_view* reader) : _M_reader(reader)
+        explicit iterator(basic_mmap_line_view* reader)
+            : _M_reader(reader), _M_offset(reader->_M_begin),
+              _M_window(reader->_M_read_window)
         {
             ++*this;
         }
@@ -81,6 +87,9 @@ public:
         }
         iterator& operator++()
         {
+            if (_M_reader->_M_reader_base) {
+                _M_window.advance(*_M_reader->_M_reader_base, _M_offset);
+            }
             if (!_M_reader->read(_M_line, _M_offset)) {
                 _M_reader = nullptr;
                 _M_offset = 0;
@@ -106,6 +115,7 @@ public:
     private:
         basic_mmap_line_view* _M_reader{};
         size_t                _M_offset{};
+        mmap_read_window      _M_window;
         value_type            _M_line;
     };
 
@@ -146,20 +156,24 @@ public:
     void open(const char* path)
     {
         _M_reader_base = std::make_shared<mmap_reader_base>(path);
+        reset_range();
     }
     bool open(const char* path, std::error_code& ec)
     {
         _M_reader_base = std::make_shared<mmap_reader_base>();
+        reset_range();
         return _M_reader_base->open(path, ec);
     }
 #if NVWA_WINDOWS
     void open(const wchar_t* path)
     {
         _M_reader_base = std::make_shared<mmap_reader_base>(path);
+        reset_range();
     }
     bool open(const wchar_t* path, std::error_code& ec)
     {
         _M_reader_base = std::make_shared<mmap_reader_base>();
+        reset_range();
         return _M_reader_base->open(path, ec);
     }
 #endif
@@ -167,16 +181,19 @@ public:
     void open(int fd)
     {
         _M_reader_base = std::make_shared<mmap_reader_base>(fd);
+        reset_range();
     }
     bool open(int fd, std::error_code& ec)
     {
         _M_reader_base = std::make_shared<mmap_reader_base>();
+        reset_range();
         return _M_reader_base->open(fd, ec);
     }
 #endif
     void close() noexcept
     {
         _M_reader_base.reset();
+        reset_range();
     }
     bool is_open() const noexcept
     {
@@ -189,6 +206,34 @@ public:
         _M_strip_delimiter = strip == strip_delimiter;
     }
 
+    /**
+     * Gives hints about how the mapped memory will be accessed.  The
+     * mapping is shared by the copies and chunks of the view.
+     *
+     * @param advice  bitwise or of mmap_reader_base::advice_type values
+     * @return        \c true if the hints are accepted or no file is
+     *                open; \c false otherwise
+     */
+    bool advise(unsigned advice) noexcept
+    {
+        return !_M_reader_base || _M_reader_base->advise(advice);
+    }
+
+    /**
+     * Sets the read-ahead window used by iterators created afterwards.
+     * Chunks created afterwards inherit the setting, and each iterator
+     * keeps its own window.
+     *
+     * @param window_size     number of bytes to prefetch ahead of the
+     *                        line being read; \c 0 disables the window
+     * @param release_behind  whether to release the pages of lines
+     *                        already read
+     */
+    void set_read_ahead(size_t window_size, bool release_behind = false)
+    {
+        _M_read_window.set(window_size, release_behind);
+    }
+
     iterator begin()
     {
         return iterator(this);
@@ -198,12 +243,43 @@ public:
         return {};
     }
 
+    /**
+     * Gets the offset where the view begins in the file.
+     *
+     * @return  \c 0, or the begin offset of a chunk
+     */
+    size_t begin_offset() const noexcept
+    {
+        return _M_begin;
+    }
+    /**
+     * Gets the offset where the view ends in the file.
+     *
+     * @return  the file size, or the end offset of a chunk
+     */
+    size_t end_offset() const noexcept
+    {
+        return std::min(_M_end, _M_reader_base ? _M_reader_base->size()
+                                               : size_t(0));
+    }
+
+    std::vector<basic_mmap_line_view> chunks(size_t n) const;
+
     bool read(_Tp& output, size_t& offset);
 
 private:
+    void reset_range() noexcept
+    {
+        _M_begin = 0;
+        _M_end = SIZE_MAX;
+    }
+
     std::shared_ptr<mmap_reader_base> _M_reader_base;
     char                              _M_delimiter{'\n'};
     bool                              _M_strip_delimiter{true};
+    size_t                            _M_begin{};
+    size_t                            _M_end{SIZE_MAX};
+    mmap_read_window                  _M_read_window;
 };
 
 /**
@@ -217,19 +293,17 @@ private:
 template <typename _Tp>
 bool basic_mmap_line_view<_Tp>::read(_Tp& output, size_t& offset)
 {
-    if (offset == _M_reader_base->size()) {
+    size_t end = end_offset();
+    if (offset >= end) {
         return false;
     }
 
-    size_t pos = offset;
-    bool found_delimiter = false;
-    while (pos < _M_reader_base->size()) {
-        char ch = _M_reader_base->data()[pos++];
-        if (ch == _M_delimiter) {
-            found_delimiter = true;
-            break;
-        }
-    }
+    const char* ptr = _M_reader_base->data() + offset;
+    auto delimiter_ptr = static_cast<const char*>(
+        memchr(ptr, _M_delimiter, end - offset));
+    bool found_delimiter = delimiter_ptr != nullptr;
+    size_t pos = found_delimiter ? delimiter_ptr - _M_reader_base->data() + 1
+                                 : end;
 
     output = _Tp(_M_reader_base->data() + offset,
                  pos - offset - (found_delimiter && _M_strip_delimiter));
@@ -237,6 +311,34 @@ bool basic_mmap_line_view<_Tp>::read(_Tp& output, size_t& offset)
     return true;
 }
 
+/**
+ * Splits the view into chunks of lines, which can be iterated over
+ * independently (say, by separate threads).  The chunks have about the
+ * same size, and each starts at the beginning of a line.  They share the
+ * mapped file with this view.
+ *
+ * @param n  maximum number of chunks
+ * @return   the non-empty chunks, in the order of the file
+ */
+template <typename _Tp>
+std::vector<basic_mmap_line_view<_Tp>>
+basic_mmap_line_view<_Tp>::chunks(size_t n) const
+{
+    std::vector<basic_mmap_line_view> result;
+    if (!is_open()) {
+        return result;
+    }
+    std::vector<size_t> offsets = _M_reader_base->chunk_offsets(
+        n, _M_delimiter, std::min(_M_begin, end_offset()), end_offset());
+    result.reserve(offsets.size() - 1);
+    for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+        result.push_back(*this);
+        result.back()._M_begin = offsets[i];
+        result.back()._M_end = offsets[i + 1];
+    }
+    return result;
+}
+
 typedef basic_mmap_line_view<std::string_view> mmap_line_view;
 
 NVWA_NAMESPACE_END
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2017-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2017-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -32,23 +32,28 @@
  * Code for mmap_reader_base, common base for memory-mapped file readers.
  * It is implemented with POSIX and Win32 APIs.
  *
- * @date  2024-05-20
+ * @date  2026-10-14
  */
 
 #include "mmap_reader_base.h"   // nvwa::mmap_reader_base
+#include <assert.h>             // assert
 #include <stddef.h>             // size_t
-#include <stdint.h>             // SIZE_MAX
+#include <stdint.h>             // SIZE_MAX/uint64_t
+#include <string.h>             // memchr
+#include <algorithm>            // std::min
+#include <limits>               // std::numeric_limits
 #include <string>               // std::string
 #include <system_error>         // std::errc/error_code/system_error
 #include <utility>              // std::exchange
+#include <vector>               // std::vector
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
 
 #if NVWA_UNIX
 #include <errno.h>              // errno
 #include <fcntl.h>              // open
-#include <sys/mman.h>           // mmap/munmap
+#include <sys/mman.h>           // madvise/mmap/msync/munmap
 #include <sys/stat.h>           // fstat
-#include <unistd.h>             // close
+#include <unistd.h>             // close/sysconf
 #elif NVWA_WINDOWS
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>            // Win32 API
@@ -86,6 +91,22 @@ void indicate_last_op_failure(std::error_code* ecp, const char* op)
     *ecp = get_last_error_code();
 }
 
+#if NVWA_WINDOWS
+DWORD get_desired_access(NVWA::mmap_reader_base::mode_type mode)
+{
+    return mode == NVWA::mmap_reader_base::read_write
+               ? GENERIC_READ | GENERIC_WRITE
+               : GENERIC_READ;
+}
+
+DWORD get_share_mode(NVWA::mmap_reader_base::mode_type mode)
+{
+    return mode == NVWA::mmap_reader_base::read_write
+               ? FILE_SHARE_READ | FILE_SHARE_WRITE
+               : FILE_SHARE_READ;
+}
+#endif
+
 } /* unnamed namespace */
 
 NVWA_NAMESPACE_BEGIN
@@ -94,24 +115,26 @@ NVWA_NAMESPACE_BEGIN
  * Constructor.
  *
  * @param path          path to the file to open
+ * @param mode          mode of the mapping
  * @throw system_error  an error occurred when calling a system function, or
  *                      when the file size is too big
  */
-mmap_reader_base::mmap_reader_base(const char* path)
+mmap_reader_base::mmap_reader_base(const char* path, mode_type mode)
 {
-    _open(path);
+    _open(path, mode);
 }
 
 /**
  * Opens a file.
  *
  * @param path          path to the file to open
+ * @param mode          mode of the mapping
  * @throw system_error  an error occurred when calling a system function, or
  *                      when the file size is too big
  */
-void mmap_reader_base::open(const char* path)
+void mmap_reader_base::open(const char* path, mode_type mode)
 {
-    _open(path);
+    _open(path, mode);
 }
 
 /**
@@ -125,14 +148,31 @@ void mmap_reader_base::open(const char* path)
 // NOLINTNEXTLINE(bugprone-exception-escape)
 bool mmap_reader_base::open(const char* path, std::error_code& ec) noexcept
 {
-    return _open(path, &ec);
+    return _open(path, read_only, &ec);
+}
+
+/**
+ * Opens a file.
+ *
+ * @param path          path to the file to open
+ * @param mode          mode of the mapping
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+bool mmap_reader_base::open(const char* path, mode_type mode,
+                            std::error_code& ec) noexcept
+{
+    return _open(path, mode, &ec);
 }
 
-bool mmap_reader_base::_open(const char* path, std::error_code* ecp)
+bool mmap_reader_base::_open(const char* path, mode_type mode,
+                             std::error_code* ecp)
 {
     close();
 #if NVWA_UNIX
-    _M_fd = ::open(path, O_RDONLY);
+    _M_fd = ::open(path, mode == read_write ? O_RDWR : O_RDONLY);
     if (_M_fd < 0) {
         indicate_last_op_failure(ecp, "open");
         return false;
@@ -140,8 +180,8 @@ bool mmap_reader_base::_open(const char* path, std::error_code* ecp)
 #else // NVWA_UNIX
     _M_file_handle = CreateFileA(
             path,
-            GENERIC_READ,
-            FILE_SHARE_READ,
+            get_desired_access(mode),
+            get_share_mode(mode),
             nullptr,
             OPEN_EXISTING,
             FILE_ATTRIBUTE_NORMAL,
@@ -151,7 +191,7 @@ bool mmap_reader_base::_open(const char* path, std::error_code* ecp)
         return false;
     }
 #endif // NVWA_UNIX
-    return _initialize(ecp);
+    return _initialize(mode, ecp);
 }
 
 #if NVWA_WINDOWS
@@ -159,24 +199,26 @@ bool mmap_reader_base::_open(const char* path, std::error_code* ecp)
  * Constructor.
  *
  * @param path          path to the file to open
+ * @param mode          mode of the mapping
  * @throw system_error  an error occurred when calling a system function, or
  *                      when the file size is too big
  */
-mmap_reader_base::mmap_reader_base(const wchar_t* path)
+mmap_reader_base::mmap_reader_base(const wchar_t* path, mode_type mode)
 {
-    _open(path);
+    _open(path, mode);
 }
 
 /**
  * Opens a file.
  *
  * @param path          path to the file to open
+ * @param mode          mode of the mapping
  * @throw system_error  an error occurred when calling a system function, or
  *                      when the file size is too big
  */
-void mmap_reader_base::open(const wchar_t* path)
+void mmap_reader_base::open(const wchar_t* path, mode_type mode)
 {
-    _open(path);
+    _open(path, mode);
 }
 
 /**
@@ -190,16 +232,33 @@ void mmap_reader_base::open(const wchar_t* path)
 // NOLINTNEXTLINE(bugprone-exception-escape)
 bool mmap_reader_base::open(const wchar_t* path, std::error_code& ec) noexcept
 {
-    return _open(path, &ec);
+    return _open(path, read_only, &ec);
 }
 
-bool mmap_reader_base::_open(const wchar_t* path, std::error_code* ecp)
+/**
+ * Opens a file.
+ *
+ * @param path          path to the file to open
+ * @param mode          mode of the mapping
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+bool mmap_reader_base::open(const wchar_t* path, mode_type mode,
+                            std::error_code& ec) noexcept
+{
+    return _open(path, mode, &ec);
+}
+
+bool mmap_reader_base::_open(const wchar_t* path, mode_type mode,
+                             std::error_code* ecp)
 {
     close();
     _M_file_handle = CreateFileW(
             path,
-            GENERIC_READ,
-            FILE_SHARE_READ,
+            get_desired_access(mode),
+            get_share_mode(mode),
             nullptr,
             OPEN_EXISTING,
             FILE_ATTRIBUTE_NORMAL,
@@ -208,7 +267,7 @@ bool mmap_reader_base::_open(const wchar_t* path, std::error_code* ecp)
         indicate_last_op_failure(ecp, "CreateFile");
         return false;
     }
-    return _initialize(ecp);
+    return _initialize(mode, ecp);
 }
 #endif // NVWA_WINDOWS
 
@@ -216,25 +275,29 @@ bool mmap_reader_base::_open(const wchar_t* path, std::error_code* ecp)
 /**
  * Constructor.
  *
- * @param fd            a file descriptor
+ * @param fd            a file descriptor, which shall be opened for
+ *                      writing as well in the read-write mode
+ * @param mode          mode of the mapping
  * @throw system_error  an error occurred when calling a system function, or
  *                      when the file size is too big
  */
-mmap_reader_base::mmap_reader_base(int fd)
+mmap_reader_base::mmap_reader_base(int fd, mode_type mode)
 {
-    _open(fd);
+    _open(fd, mode);
 }
 
 /**
- * Constructor.
+ * Opens a file.
  *
- * @param fd            a file descriptor
+ * @param fd            a file descriptor, which shall be opened for
+ *                      writing as well in the read-write mode
+ * @param mode          mode of the mapping
  * @throw system_error  an error occurred when calling a system function, or
  *                      when the file size is too big
  */
-void mmap_reader_base::open(int fd)
+void mmap_reader_base::open(int fd, mode_type mode)
 {
-    _open(fd);
+    _open(fd, mode);
 }
 
 /**
@@ -248,14 +311,31 @@ void mmap_reader_base::open(int fd)
 // NOLINTNEXTLINE(bugprone-exception-escape)
 bool mmap_reader_base::open(int fd, std::error_code& ec) noexcept
 {
-    return _open(fd, &ec);
+    return _open(fd, read_only, &ec);
 }
 
-bool mmap_reader_base::_open(int fd, std::error_code* ecp)
+/**
+ * Opens a file.
+ *
+ * @param fd            a file descriptor, which shall be opened for
+ *                      writing as well in the read-write mode
+ * @param mode          mode of the mapping
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+bool mmap_reader_base::open(int fd, mode_type mode,
+                            std::error_code& ec) noexcept
+{
+    return _open(fd, mode, &ec);
+}
+
+bool mmap_reader_base::_open(int fd, mode_type mode, std::error_code* ecp)
 {
     close();
     _M_fd = fd;
-    return _initialize(ecp);
+    return _initialize(mode, ecp);
 }
 #endif
 
@@ -263,6 +343,7 @@ bool mmap_reader_base::_open(int fd, std::error_code* ecp)
 mmap_reader_base::mmap_reader_base(mmap_reader_base&& rhs) noexcept
     : _M_mmap_ptr(std::exchange(rhs._M_mmap_ptr, nullptr)),
       _M_size(std::exchange(rhs._M_size, 0)),
+      _M_advice(rhs._M_advice),
 #if NVWA_UNIX
       _M_fd(rhs._M_fd)
 #else
@@ -278,6 +359,7 @@ mmap_reader_base& mmap_reader_base::operator=(mmap_reader_base&& rhs) noexcept
     if (this != &rhs) {
         _M_mmap_ptr = std::exchange(rhs._M_mmap_ptr, nullptr);
         _M_size = std::exchange(rhs._M_size, 0);
+        _M_advice = rhs._M_advice;
 #if NVWA_UNIX
         _M_fd = rhs._M_fd;
 #else
@@ -309,13 +391,205 @@ void mmap_reader_base::close() noexcept
     }
 }
 
+/**
+ * Writes the changes in the mapped memory back to the file.  It is
+ * useful only in the read-write mode.
+ *
+ * @throw system_error  an error occurred when calling a system function
+ */
+void mmap_reader_base::sync()
+{
+    _sync(nullptr);
+}
+
+/**
+ * Writes the changes in the mapped memory back to the file.  It is
+ * useful only in the read-write mode.
+ *
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+bool mmap_reader_base::sync(std::error_code& ec) noexcept
+{
+    return _sync(&ec);
+}
+
+bool mmap_reader_base::_sync(std::error_code* ecp)
+{
+    if (_M_mmap_ptr) {
+#if NVWA_UNIX
+        if (msync(_M_mmap_ptr, _M_size, MS_SYNC) < 0) {
+            indicate_last_op_failure(ecp, "msync");
+            return false;
+        }
+#else
+        if (!FlushViewOfFile(_M_mmap_ptr, 0)) {
+            indicate_last_op_failure(ecp, "FlushViewOfFile");
+            return false;
+        }
+        if (!FlushFileBuffers(_M_file_handle)) {
+            indicate_last_op_failure(ecp, "FlushFileBuffers");
+            return false;
+        }
+#endif
+    }
+    if (ecp) {
+        ecp->clear();
+    }
+    return true;
+}
+
+/**
+ * Gives hints about how the mapped memory will be accessed.  The hints
+ * are also remembered for files opened later, when \c advise_populate
+ * can be applied at mapping (with \c MAP_POPULATE where available).
+ *
+ * @param advice  bitwise or of advice_type values
+ * @return        \c true if the hints are accepted or no file is open;
+ *                \c false if the system rejects any of them
+ */
+bool mmap_reader_base::advise(unsigned advice) noexcept
+{
+    _M_advice = advice;
+    return _advise(advice);
+}
+
+/**
+ * Starts reading pages of the mapped file in the background, so that
+ * accessing them later will not stall.  This is only a hint.
+ *
+ * @param offset  offset of the bytes to prefetch
+ * @param length  number of bytes to prefetch
+ * @return        \c true if successful; \c false otherwise
+ */
+bool mmap_reader_base::prefetch(size_t offset, size_t length) noexcept
+{
+    if (!_M_mmap_ptr || offset >= _M_size || length == 0) {
+        return true;
+    }
+    length = std::min(length, _M_size - offset);
+    size_t begin = offset & ~(page_size() - 1);
+    length += offset - begin;
+#if NVWA_UNIX
+    return madvise(_M_mmap_ptr + begin, length, MADV_WILLNEED) == 0;
+#elif _WIN32_WINNT >= 0x0602
+    WIN32_MEMORY_RANGE_ENTRY entry{_M_mmap_ptr + begin, length};
+    return PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+#else
+    return true;
+#endif
+}
+
+/**
+ * Releases the pages of the mapped file that will not be accessed soon,
+ * so that they no longer count towards the memory used by the process.
+ * Only pages entirely in the given range are released.  The content is
+ * not affected: accessing released pages simply reads them in again.
+ *
+ * @param offset  offset of the bytes to release
+ * @param length  number of bytes to release
+ * @return        \c true if successful; \c false otherwise
+ */
+bool mmap_reader_base::release(size_t offset, size_t length) noexcept
+{
+    if (!_M_mmap_ptr || offset >= _M_size) {
+        return true;
+    }
+    length = std::min(length, _M_size - offset);
+    size_t page_mask = page_size() - 1;
+    size_t begin = (offset + page_mask) & ~page_mask;
+    size_t end = offset + length;
+    if (end != _M_size) {
+        end &= ~page_mask;
+    }
+    if (begin >= end) {
+        return true;
+    }
+#if NVWA_UNIX
+    return madvise(_M_mmap_ptr + begin, end - begin, MADV_DONTNEED) == 0;
+#else
+    // Unlocking pages that are not locked removes them from the working
+    // set, and such a call always reports ERROR_NOT_LOCKED
+    return VirtualUnlock(_M_mmap_ptr + begin, end - begin) ||
+           GetLastError() == ERROR_NOT_LOCKED;
+#endif
+}
+
+/**
+ * Gets the page size of the system.
+ *
+ * @return  the granularity of prefetch and release
+ */
+size_t mmap_reader_base::page_size() noexcept
+{
+    static const size_t size = [] {
+#if NVWA_UNIX
+        long result = sysconf(_SC_PAGESIZE);
+        return result > 0 ? static_cast<size_t>(result) : size_t(4096);
+#else
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwPageSize);
+#endif
+    }();
+    return size;
+}
+
+/**
+ * Splits part of the mapped file into chunks of about the same size on
+ * delimiter boundaries, so that each chunk can be processed
+ * independently (say, by a separate thread).  Each chunk except the
+ * first one starts right after a delimiter.
+ *
+ * @param n          maximum number of chunks
+ * @param delimiter  the delimiter that ends each record
+ * @param begin      offset of the part to split
+ * @param end        end offset of the part to split
+ * @return           offsets of the chunk boundaries, beginning with \a
+ *                   begin and ending with \a end, so chunk \e i is in
+ *                   [offsets[i], offsets[i + 1]); empty chunks are
+ *                   omitted
+ */
+std::vector<size_t> mmap_reader_base::chunk_offsets(size_t n,
+                                                    char delimiter,
+                                                    size_t begin,
+                                                    size_t end) const
+{
+    assert(n != 0);
+    assert(begin <= end && end <= _M_size);
+    std::vector<size_t> offsets{begin};
+    if (begin == end) {
+        return offsets;
+    }
+    size_t length = end - begin;
+    for (size_t i = 1; i < n; ++i) {
+        // Equal to begin + length * i / n, but without overflow
+        size_t target = begin + length / n * i + length % n * i / n;
+        if (target <= offsets.back()) {
+            continue;
+        }
+        // Snaps to the first line starting at or after target
+        auto ptr = static_cast<const char*>(
+            memchr(_M_mmap_ptr + target - 1, delimiter, end - target + 1));
+        if (ptr == nullptr || ptr + 1 == _M_mmap_ptr + end) {
+            break;
+        }
+        offsets.push_back(static_cast<size_t>(ptr + 1 - _M_mmap_ptr));
+    }
+    offsets.push_back(end);
+    return offsets;
+}
+
 /**
  * Initializes the object.  It gets the file size and mmaps the whole file.
  * This function can throw only if \a ecp is null.
  *
+ * @param mode          mode of the mapping
  * @param ecp           pointer to the error_code
  */
-bool mmap_reader_base::_initialize(std::error_code* ecp)
+bool mmap_reader_base::_initialize(mode_type mode, std::error_code* ecp)
 {
 #if NVWA_UNIX
     struct stat s;  // NOLINT(cppcoreguidelines-pro-type-member-init)
@@ -327,13 +601,23 @@ bool mmap_reader_base::_initialize(std::error_code* ecp)
         indicate_error(ecp, make_error_code(std::errc::file_too_large));
         return false;
     }
-    void* ptr = mmap(nullptr, s.st_size, PROT_READ, MAP_SHARED, _M_fd, 0);
+    int prot = mode == read_write ? PROT_READ | PROT_WRITE : PROT_READ;
+    int flags = MAP_SHARED;
+    unsigned advice = _M_advice;
+#ifdef MAP_POPULATE
+    if (advice & advise_populate) {
+        flags |= MAP_POPULATE;
+        advice &= ~advise_populate;
+    }
+#endif
+    void* ptr = mmap(nullptr, s.st_size, prot, flags, _M_fd, 0);
     if (ptr == MAP_FAILED) {
         indicate_last_op_failure(ecp, "mmap");
         return false;
     }
     _M_mmap_ptr = static_cast<char*>(ptr);
     _M_size = s.st_size;
+    _advise(advice);
 #else
     LARGE_INTEGER file_size;
     if (!GetFileSizeEx(_M_file_handle, &file_size)) {
@@ -353,7 +637,7 @@ bool mmap_reader_base::_initialize(std::error_code* ecp)
     _M_map_handle = CreateFileMapping(
             _M_file_handle,
             nullptr,
-            PAGE_READONLY,
+            mode == read_write ? PAGE_READWRITE : PAGE_READONLY,
             file_size.HighPart,
             file_size.LowPart,
             nullptr);
@@ -363,7 +647,7 @@ bool mmap_reader_base::_initialize(std::error_code* ecp)
     }
     _M_mmap_ptr = static_cast<char*>(MapViewOfFile(
             _M_map_handle,
-            FILE_MAP_READ,
+            mode == read_write ? FILE_MAP_WRITE : FILE_MAP_READ,
             0,
             0,
             _M_size));
@@ -371,6 +655,401 @@ bool mmap_reader_base::_initialize(std::error_code* ecp)
         indicate_last_op_failure(ecp, "MapViewOfFile");
         return false;
     }
+    _advise(_M_advice);
+#endif
+    if (ecp) {
+        ecp->clear();
+    }
+    return true;
+}
+
+bool mmap_reader_base::_advise(unsigned advice) noexcept
+{
+    if (!_M_mmap_ptr || _M_size == 0) {
+        return true;
+    }
+    bool result = true;
+#if NVWA_UNIX
+    if (advice & advise_sequential) {
+        result &= madvise(_M_mmap_ptr, _M_size, MADV_SEQUENTIAL) == 0;
+    }
+    if (advice & advise_random) {
+        result &= madvise(_M_mmap_ptr, _M_size, MADV_RANDOM) == 0;
+    }
+#ifdef MADV_HUGEPAGE
+    if (advice & advise_hugepage) {
+        result &= madvise(_M_mmap_ptr, _M_size, MADV_HUGEPAGE) == 0;
+    }
+#endif
+#ifdef MADV_POPULATE_READ
+    if (advice & advise_populate) {
+        // This blocks until the pages are read in, like MAP_POPULATE
+        result &= madvise(_M_mmap_ptr, _M_size, MADV_POPULATE_READ) == 0;
+        advice &= ~advise_willneed;
+    }
+#else
+    if (advice & advise_populate) {
+        advice |= advise_willneed;
+    }
+#endif
+    if (advice & advise_willneed) {
+        result &= madvise(_M_mmap_ptr, _M_size, MADV_WILLNEED) == 0;
+    }
+#else
+    if (advice & (advise_willneed | advise_populate)) {
+        result &= prefetch(0, _M_size);
+    }
+#endif
+    return result;
+}
+
+/**
+ * Sets the size of the window.  Setting it to zero disables the window.
+ *
+ * @param window_size     number of bytes to keep prefetched ahead of the
+ *                        reading position
+ * @param release_behind  whether to release pages behind the reading
+ *                        position
+ */
+void mmap_read_window::set(size_t window_size, bool release_behind) noexcept
+{
+    _M_window_size = window_size;
+    _M_release_behind = release_behind;
+    _M_prefetched = 0;
+    _M_released = 0;
+}
+
+/**
+ * Advances the window to the reading position.  Prefetching is issued
+ * when less than half of the window remains prefetched, and releasing
+ * when a whole window of bytes has been consumed, so that system calls
+ * are made only once in a while.
+ *
+ * @param base    the mapping being read
+ * @param offset  the reading position, before which all bytes have been
+ *                consumed
+ */
+void mmap_read_window::advance(mmap_reader_base& base,
+                               size_t offset) noexcept
+{
+    if (_M_window_size == 0) {
+        return;
+    }
+    size_t page_mask = mmap_reader_base::page_size() - 1;
+    if (offset < _M_released) {
+        // Reading has restarted from an earlier position
+        _M_released = offset & ~page_mask;
+        _M_prefetched = offset;
+    } else if (offset > _M_prefetched) {
+        _M_prefetched = offset;
+    }
+    if (_M_prefetched - offset <= _M_window_size / 2 &&
+        _M_prefetched < base.size()) {
+        size_t end = offset + std::min(_M_window_size, base.size() - offset);
+        base.prefetch(_M_prefetched, end - _M_prefetched);
+        _M_prefetched = end;
+    }
+    if (_M_release_behind && offset - _M_released >= _M_window_size) {
+        size_t end = offset & ~page_mask;
+        base.release(_M_released, end - _M_released);
+        _M_released = end;
+    }
+}
+
+/**
+ * Constructor.
+ *
+ * @param path          path to the file to open
+ * @param window_size   number of bytes to map at a time
+ * @throw system_error  an error occurred when calling a system function
+ */
+mmap_window_reader_base::mmap_window_reader_base(const char* path,
+                                                 size_t window_size)
+    : _M_window_size(window_size)
+{
+    _open(path);
+}
+
+/**
+ * Opens a file.
+ *
+ * @param path          path to the file to open
+ * @throw system_error  an error occurred when calling a system function
+ */
+void mmap_window_reader_base::open(const char* path)
+{
+    _open(path);
+}
+
+/**
+ * Opens a file.
+ *
+ * @param path          path to the file to open
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+bool mmap_window_reader_base::open(const char* path,
+                                   std::error_code& ec) noexcept
+{
+    return _open(path, &ec);
+}
+
+bool mmap_window_reader_base::_open(const char* path, std::error_code* ecp)
+{
+    close();
+#if NVWA_UNIX
+    _M_fd = ::open(path, O_RDONLY);
+    if (_M_fd < 0) {
+        indicate_last_op_failure(ecp, "open");
+        return false;
+    }
+#else // NVWA_UNIX
+    // Writing by others is allowed, so that a growing file can be followed
+    _M_file_handle = CreateFileA(
+            path,
+            GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr);
+    if (_M_file_handle == INVALID_HANDLE_VALUE) {
+        _M_file_handle = nullptr;
+        indicate_last_op_failure(ecp, "CreateFile");
+        return false;
+    }
+#endif // NVWA_UNIX
+    return _refresh(ecp);
+}
+
+#if NVWA_WINDOWS
+/**
+ * Constructor.
+ *
+ * @param path          path to the file to open
+ * @param window_size   number of bytes to map at a time
+ * @throw system_error  an error occurred when calling a system function
+ */
+mmap_window_reader_base::mmap_window_reader_base(const wchar_t* path,
+                                                 size_t window_size)
+    : _M_window_size(window_size)
+{
+    _open(path);
+}
+
+/**
+ * Opens a file.
+ *
+ * @param path          path to the file to open
+ * @throw system_error  an error occurred when calling a system function
+ */
+void mmap_window_reader_base::open(const wchar_t* path)
+{
+    _open(path);
+}
+
+/**
+ * Opens a file.
+ *
+ * @param path          path to the file to open
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+bool mmap_window_reader_base::open(const wchar_t* path,
+                                   std::error_code& ec) noexcept
+{
+    return _open(path, &ec);
+}
+
+bool mmap_window_reader_base::_open(const wchar_t* path,
+                                    std::error_code* ecp)
+{
+    close();
+    _M_file_handle = CreateFileW(
+            path,
+            GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr);
+    if (_M_file_handle == INVALID_HANDLE_VALUE) {
+        _M_file_handle = nullptr;
+        indicate_last_op_failure(ecp, "CreateFile");
+        return false;
+    }
+    return _refresh(ecp);
+}
+#endif // NVWA_WINDOWS
+
+#if NVWA_UNIX
+/**
+ * Constructor.
+ *
+ * @param fd            a file descriptor
+ * @param window_size   number of bytes to map at a time
+ * @throw system_error  an error occurred when calling a system function
+ */
+mmap_window_reader_base::mmap_window_reader_base(int fd, size_t window_size)
+    : _M_window_size(window_size)
+{
+    _open(fd);
+}
+
+/**
+ * Opens a file.
+ *
+ * @param fd            a file descriptor
+ * @throw system_error  an error occurred when calling a system function
+ */
+void mmap_window_reader_base::open(int fd)
+{
+    _open(fd);
+}
+
+/**
+ * Opens a file.
+ *
+ * @param fd            a file descriptor
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+bool mmap_window_reader_base::open(int fd, std::error_code& ec) noexcept
+{
+    return _open(fd, &ec);
+}
+
+bool mmap_window_reader_base::_open(int fd, std::error_code* ecp)
+{
+    close();
+    _M_fd = fd;
+    return _refresh(ecp);
+}
+#endif
+
+/** Move constructor. */
+mmap_window_reader_base::mmap_window_reader_base(
+    mmap_window_reader_base&& rhs) noexcept
+    : _M_view_ptr(std::exchange(rhs._M_view_ptr, nullptr)),
+      _M_view_offset(rhs._M_view_offset),
+      _M_view_length(rhs._M_view_length),
+      _M_size(std::exchange(rhs._M_size, 0)),
+      _M_window_size(rhs._M_window_size),
+#if NVWA_UNIX
+      _M_fd(std::exchange(rhs._M_fd, -1))
+#else
+      _M_file_handle(std::exchange(rhs._M_file_handle, nullptr)),
+      _M_map_handle(std::exchange(rhs._M_map_handle, nullptr)),
+      _M_map_size(rhs._M_map_size)
+#endif
+{
+}
+
+/** Move assignment operator. */
+mmap_window_reader_base&
+mmap_window_reader_base::operator=(mmap_window_reader_base&& rhs) noexcept
+{
+    if (this != &rhs) {
+        close();
+        _M_view_ptr = std::exchange(rhs._M_view_ptr, nullptr);
+        _M_view_offset = rhs._M_view_offset;
+        _M_view_length = rhs._M_view_length;
+        _M_size = std::exchange(rhs._M_size, 0);
+        _M_window_size = rhs._M_window_size;
+#if NVWA_UNIX
+        _M_fd = std::exchange(rhs._M_fd, -1);
+#else
+        _M_file_handle = std::exchange(rhs._M_file_handle, nullptr);
+        _M_map_handle = std::exchange(rhs._M_map_handle, nullptr);
+        _M_map_size = rhs._M_map_size;
+#endif
+    }
+    return *this;
+}
+
+/** Destructor. */
+mmap_window_reader_base::~mmap_window_reader_base()
+{
+    close();
+}
+
+void mmap_window_reader_base::close() noexcept
+{
+    _unmap();
+#if NVWA_UNIX
+    if (_M_fd >= 0) {
+        ::close(_M_fd);
+        _M_fd = -1;
+    }
+#else
+    if (_M_map_handle) {
+        CloseHandle(_M_map_handle);
+        _M_map_handle = nullptr;
+    }
+    if (_M_file_handle) {
+        CloseHandle(_M_file_handle);
+        _M_file_handle = nullptr;
+    }
+#endif
+    _M_size = 0;
+}
+
+bool mmap_window_reader_base::is_open() const noexcept
+{
+#if NVWA_UNIX
+    return _M_fd >= 0;
+#else
+    return _M_file_handle != nullptr;
+#endif
+}
+
+/**
+ * Gets the file size again, so that the content appended to the file
+ * since opening can be mapped.
+ *
+ * @throw system_error  an error occurred when calling a system function
+ */
+void mmap_window_reader_base::refresh()
+{
+    _refresh(nullptr);
+}
+
+/**
+ * Gets the file size again, so that the content appended to the file
+ * since opening can be mapped.
+ *
+ * @param ec            reference to the error_code
+ * @return              \c true if successful (\a ec is cleared); \c false
+ *                      otherwise (\a ec is updated)
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+bool mmap_window_reader_base::refresh(std::error_code& ec) noexcept
+{
+    return _refresh(&ec);
+}
+
+bool mmap_window_reader_base::_refresh(std::error_code* ecp)
+{
+#if NVWA_UNIX
+    struct stat s;  // NOLINT(cppcoreguidelines-pro-type-member-init)
+    if (fstat(_M_fd, &s) < 0) {
+        indicate_last_op_failure(ecp, "fstat");
+        return false;
+    }
+    _M_size = static_cast<offset_type>(s.st_size);
+#else
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(_M_file_handle, &file_size)) {
+        indicate_last_op_failure(ecp, "GetFileSizeEx");
+        return false;
+    }
+    _M_size = static_cast<offset_type>(file_size.QuadPart);
 #endif
     if (ecp) {
         ecp->clear();
@@ -378,4 +1057,141 @@ bool mmap_reader_base::_initialize(std::error_code* ecp)
     return true;
 }
 
+/**
+ * Maps part of the file.  If the bytes are not in the current window,
+ * the window is moved, and previously returned pointers become invalid.
+ *
+ * @param[in]     offset  offset of the bytes to map
+ * @param[in,out] length  number of bytes needed on entry; number of bytes
+ *                        accessible from the returned pointer on exit
+ * @return                pointer to the byte at \a offset
+ * @pre                   <code>0 < length && offset + length <=
+ *                        size()</code>
+ * @throw system_error    an error occurred when calling a system
+ *                        function, or the bytes cannot fit in the address
+ *                        space
+ */
+const char* mmap_window_reader_base::map(offset_type offset, size_t& length)
+{
+    return _map(offset, length, nullptr);
+}
+
+/**
+ * Maps part of the file.  If the bytes are not in the current window,
+ * the window is moved, and previously returned pointers become invalid.
+ *
+ * @param[in]     offset  offset of the bytes to map
+ * @param[in,out] length  number of bytes needed on entry; number of bytes
+ *                        accessible from the returned pointer on exit
+ * @param[out]    ec      reference to the error_code
+ * @return                pointer to the byte at \a offset if successful
+ *                        (\a ec is cleared); \c nullptr otherwise (\a ec
+ *                        is updated)
+ * @pre                   <code>0 < length && offset + length <=
+ *                        size()</code>
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+const char* mmap_window_reader_base::map(offset_type offset, size_t& length,
+                                         std::error_code& ec) noexcept
+{
+    return _map(offset, length, &ec);
+}
+
+const char* mmap_window_reader_base::_map(offset_type offset,
+                                          size_t& length,
+                                          std::error_code* ecp)
+{
+    assert(length != 0 && offset <= _M_size && length <= _M_size - offset);
+    if (_M_view_ptr && offset >= _M_view_offset &&
+        offset - _M_view_offset + length <= _M_view_length) {
+        size_t skipped = static_cast<size_t>(offset - _M_view_offset);
+        length = _M_view_length - skipped;
+        if (ecp) {
+            ecp->clear();
+        }
+        return _M_view_ptr + skipped;
+    }
+
+    _unmap();
+#if NVWA_UNIX
+    offset_type granularity = mmap_reader_base::page_size();
+#else
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    offset_type granularity = info.dwAllocationGranularity;
+#endif
+    offset_type start = offset & ~(granularity - 1);
+    offset_type map_length = offset - start + length;
+    if (map_length < _M_window_size) {
+        map_length = std::min(offset_type(_M_window_size), _M_size - start);
+    }
+    if (map_length > SIZE_MAX) {
+        indicate_error(ecp, make_error_code(std::errc::file_too_large));
+        return nullptr;
+    }
+#if NVWA_UNIX
+    if (start > static_cast<offset_type>(std::numeric_limits<off_t>::max())) {
+        indicate_error(ecp, make_error_code(std::errc::file_too_large));
+        return nullptr;
+    }
+    void* ptr = mmap(nullptr, static_cast<size_t>(map_length), PROT_READ,
+                     MAP_SHARED, _M_fd, static_cast<off_t>(start));
+    if (ptr == MAP_FAILED) {
+        indicate_last_op_failure(ecp, "mmap");
+        return nullptr;
+    }
+    _M_view_ptr = static_cast<char*>(ptr);
+#else
+    if (_M_map_handle && _M_map_size < start + map_length) {
+        // The file has grown since the mapping object was created
+        CloseHandle(_M_map_handle);
+        _M_map_handle = nullptr;
+    }
+    if (!_M_map_handle) {
+        _M_map_handle = CreateFileMapping(
+                _M_file_handle,
+                nullptr,
+                PAGE_READONLY,
+                0,
+                0,
+                nullptr);
+        if (_M_map_handle == nullptr) {
+            indicate_last_op_failure(ecp, "CreateFileMapping");
+            return nullptr;
+        }
+        _M_map_size = _M_size;
+    }
+    _M_view_ptr = static_cast<char*>(MapViewOfFile(
+            _M_map_handle,
+            FILE_MAP_READ,
+            static_cast<DWORD>(start >> 32),
+            static_cast<DWORD>(start),
+            static_cast<size_t>(map_length)));
+    if (_M_view_ptr == nullptr) {
+        indicate_last_op_failure(ecp, "MapViewOfFile");
+        return nullptr;
+    }
+#endif
+    _M_view_offset = start;
+    _M_view_length = static_cast<size_t>(map_length);
+    size_t skipped = static_cast<size_t>(offset - start);
+    length = _M_view_length - skipped;
+    if (ecp) {
+        ecp->clear();
+    }
+    return _M_view_ptr + skipped;
+}
+
+void mmap_window_reader_base::_unmap() noexcept
+{
+    if (_M_view_ptr) {
+#if NVWA_UNIX
+        munmap(_M_view_ptr, _M_view_length);
+#else
+        UnmapViewOfFile(_M_view_ptr);
+#endif
+        _M_view_ptr = nullptr;
+    }
+}
+
 NVWA_NAMESPACE_END
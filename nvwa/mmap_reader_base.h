@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2017-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2017-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -32,28 +32,56 @@
  * Header file for mmap_reader_base, common base for mmap-based file
  * readers.  It currently supports POSIX and Win32.
  *
- * @date  2024-04-29
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_MMAP_READER_BASE_H
 #define NVWA_MMAP_READER_BASE_H
 
 #include <stddef.h>             // size_t
+#include <stdint.h>             // uint64_t
 #include <system_error>         // std::error_code
+#include <vector>               // std::vector
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
 
 NVWA_NAMESPACE_BEGIN
 
-/** Class to wrap the platform details of an mmapped file. */
+/**
+ * Class to wrap the platform details of an mmapped file.  The file is
+ * mapped read-only by default; in the read-write mode, it is mapped
+ * shared, so that changes are written back to the file and visible to
+ * other processes mapping the same file.
+ */
 class mmap_reader_base {
 public:
+    /** Mode of the mapping. */
+    enum mode_type {
+        read_only,      ///< The mapped memory can only be read
+        read_write      ///< Changes to the mapped memory go to the file
+    };
+
+    /**
+     * Hints about how the mapped memory will be accessed, which can be
+     * combined with bitwise or.  Hints not supported by the platform are
+     * ignored.
+     */
+    enum advice_type {
+        advise_normal = 0,      ///< No special treatment
+        advise_sequential = 1,  ///< Pages will be accessed in order
+        advise_random = 2,      ///< Pages will be accessed randomly
+        advise_willneed = 4,    ///< Pages will be needed soon
+        advise_hugepage = 8,    ///< Huge pages should be used if possible
+        advise_populate = 16    ///< Pages should be read in at mapping
+    };
+
     mmap_reader_base() = default;
-    explicit mmap_reader_base(const char* path);
+    explicit mmap_reader_base(const char* path, mode_type mode = read_only);
 #if NVWA_WINDOWS
-    explicit mmap_reader_base(const wchar_t* path);
+    explicit mmap_reader_base(const wchar_t* path,
+                              mode_type mode = read_only);
 #endif
 #if NVWA_UNIX
-    explicit mmap_reader_base(int fd);
+    explicit mmap_reader_base(int fd, mode_type mode = read_only);
 #endif
     mmap_reader_base(const mmap_reader_base&) = delete;
     mmap_reader_base& operator=(const mmap_reader_base&) = delete;
@@ -61,17 +89,24 @@ public:
     mmap_reader_base& operator=(mmap_reader_base&& rhs) noexcept;
     ~mmap_reader_base();
 
-    void open(const char* path);
+    void open(const char* path, mode_type mode = read_only);
     bool open(const char* path, std::error_code& ec) noexcept;
+    bool open(const char* path, mode_type mode,
+              std::error_code& ec) noexcept;
 #if NVWA_WINDOWS
-    void open(const wchar_t* path);
+    void open(const wchar_t* path, mode_type mode = read_only);
     bool open(const wchar_t* path, std::error_code& ec) noexcept;
+    bool open(const wchar_t* path, mode_type mode,
+              std::error_code& ec) noexcept;
 #endif
 #if NVWA_UNIX
-    void open(int fd);
+    void open(int fd, mode_type mode = read_only);
     bool open(int fd, std::error_code& ec) noexcept;
+    bool open(int fd, mode_type mode, std::error_code& ec) noexcept;
 #endif
     void close() noexcept;
+    void sync();
+    bool sync(std::error_code& ec) noexcept;
     bool is_open() const noexcept
     {
         return _M_mmap_ptr != nullptr;
@@ -86,8 +121,129 @@ public:
         return _M_size;
     }
 
+    bool advise(unsigned advice) noexcept;
+    bool prefetch(size_t offset, size_t length) noexcept;
+    bool release(size_t offset, size_t length) noexcept;
+    static size_t page_size() noexcept;
+
+    std::vector<size_t> chunk_offsets(size_t n, char delimiter,
+                                      size_t begin, size_t end) const;
+
+private:
+    bool _initialize(mode_type mode, std::error_code* ecp);
+    bool _open(const char* path, mode_type mode,
+               std::error_code* ecp = nullptr);
+#if NVWA_WINDOWS
+    bool _open(const wchar_t* path, mode_type mode,
+               std::error_code* ecp = nullptr);
+#endif
+#if NVWA_UNIX
+    bool _open(int fd, mode_type mode, std::error_code* ecp = nullptr);
+#endif
+    bool _sync(std::error_code* ecp);
+    bool _advise(unsigned advice) noexcept;
+
+    char*         _M_mmap_ptr{};
+    size_t        _M_size{};
+    unsigned      _M_advice{advise_normal};
+#if NVWA_UNIX
+    int           _M_fd{-1};
+#else
+    void*         _M_file_handle{};
+    void*         _M_map_handle{};
+#endif
+};
+
+/**
+ * Class to keep a read-ahead window in front of sequential reading of a
+ * mapping.  Pages in the window are prefetched in the background, and
+ * pages behind the reading position can be released, so that the amount
+ * of memory used for the file stays bounded.
+ */
+class mmap_read_window {
+public:
+    void set(size_t window_size, bool release_behind = false) noexcept;
+    void reset() noexcept;
+    void advance(mmap_reader_base& base, size_t offset) noexcept;
+
+private:
+    size_t _M_window_size{};
+    bool   _M_release_behind{};
+    size_t _M_prefetched{};     ///< End offset of the prefetched pages
+    size_t _M_released{};       ///< End offset of the released pages
+};
+
+/**
+ * Class to map a file through a window that slides as the file is read.
+ * Unlike mmap_reader_base, it never maps the whole file at once, so it
+ * can read files larger than the address space, and it can follow files
+ * that are still growing.  The file is mapped read-only, and it shall not
+ * be truncated while it is mapped.
+ */
+class mmap_window_reader_base {
+public:
+    /** Type of offsets in the file, which may exceed the address space. */
+    typedef uint64_t offset_type;
+
+    /** Default number of bytes to map at a time. */
+    static constexpr size_t default_window_size =
+        sizeof(void*) >= 8 ? 64 * 1024 * 1024 : 16 * 1024 * 1024;
+
+    mmap_window_reader_base() = default;
+    explicit mmap_window_reader_base(
+        const char* path, size_t window_size = default_window_size);
+#if NVWA_WINDOWS
+    explicit mmap_window_reader_base(
+        const wchar_t* path, size_t window_size = default_window_size);
+#endif
+#if NVWA_UNIX
+    explicit mmap_window_reader_base(
+        int fd, size_t window_size = default_window_size);
+#endif
+    mmap_window_reader_base(const mmap_window_reader_base&) = delete;
+    mmap_window_reader_base&
+    operator=(const mmap_window_reader_base&) = delete;
+    mmap_window_reader_base(mmap_window_reader_base&& rhs) noexcept;
+    mmap_window_reader_base&
+    operator=(mmap_window_reader_base&& rhs) noexcept;
+    ~mmap_window_reader_base();
+
+    void open(const char* path);
+    bool open(const char* path, std::error_code& ec) noexcept;
+#if NVWA_WINDOWS
+    void open(const wchar_t* path);
+    bool open(const wchar_t* path, std::error_code& ec) noexcept;
+#endif
+#if NVWA_UNIX
+    void open(int fd);
+    bool open(int fd, std::error_code& ec) noexcept;
+#endif
+    void close() noexcept;
+    bool is_open() const noexcept;
+
+    void refresh();
+    bool refresh(std::error_code& ec) noexcept;
+    const char* map(offset_type offset, size_t& length);
+    const char* map(offset_type offset, size_t& length,
+                    std::error_code& ec) noexcept;
+
+    /** Gets the file size, as of opening or the last #refresh. */
+    offset_type size() const noexcept
+    {
+        return _M_size;
+    }
+    /** Gets the number of bytes to map at a time. */
+    size_t window_size() const noexcept
+    {
+        return _M_window_size;
+    }
+    /** Sets the number of bytes to map at a time, used by later mappings. */
+    void set_window_size(size_t window_size) noexcept
+    {
+        _M_window_size = window_size;
+    }
+
 private:
-    bool _initialize(std::error_code* ecp);
     bool _open(const char* path, std::error_code* ecp = nullptr);
 #if NVWA_WINDOWS
     bool _open(const wchar_t* path, std::error_code* ecp = nullptr);
@@ -95,14 +251,22 @@ private:
 #if NVWA_UNIX
     bool _open(int fd, std::error_code* ecp = nullptr);
 #endif
+    bool _refresh(std::error_code* ecp);
+    const char* _map(offset_type offset, size_t& length,
+                     std::error_code* ecp);
+    void _unmap() noexcept;
 
-    char*         _M_mmap_ptr{};
-    size_t        _M_size{};
+    char*         _M_view_ptr{};
+    offset_type   _M_view_offset{};
+    size_t        _M_view_length{};
+    offset_type   _M_size{};
+    size_t        _M_window_size{default_window_size};
 #if NVWA_UNIX
     int           _M_fd{-1};
 #else
     void*         _M_file_handle{};
     void*         _M_map_handle{};
+    offset_type   _M_map_size{};    ///< File size when the mapping was made
 #endif
 };
 
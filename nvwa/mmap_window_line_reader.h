@@ -0,0 +1,260 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+
+/**
+ * @file  mmap_window_line_reader.h
+ *
+ * Header file for mmap_window_line_reader, an easy-to-use line-based
+ * file reader that maps the file through a sliding window.  It is
+ * similar to mmap_line_reader, but it can read files larger than the
+ * address space, and follow files that are still growing.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_MMAP_WINDOW_LINE_READER_H
+#define NVWA_MMAP_WINDOW_LINE_READER_H
+
+#include <assert.h>             // assert
+#include <stddef.h>             // ptrdiff_t/size_t
+#include <string.h>             // memchr
+#include <iterator>             // std::forward_iterator_tag
+#include <string>               // std::string
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "mmap_reader_base.h"   // nvwa::mmap_window_reader_base
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class to allow iteration over all lines of a file mapped through a
+ * sliding window.  The lines are copied out of the mapping, as the
+ * mapping moves when reading goes on.
+ */
+class mmap_window_line_reader : private mmap_window_reader_base {
+public:
+    typedef mmap_window_reader_base::offset_type offset_type;
+
+    /** Iterator that contains the line content. */
+    class iterator {  // implements ForwardIterator
+    public:
+        typedef std::string               value_type;
+        typedef const value_type*         pointer;
+        typedef const value_type&         reference;
+        typedef ptrdiff_t                 difference_type;
+        typedef std::forward_iterator_tag iterator_category;
+
+        iterator() = default;
+        explicit iterator(mmap_window_line_reader* reader)
+            : _M_reader(reader)
+        {
+            ++*this;
+        }
+
+        reference operator*() const noexcept
+        {
+            assert(_M_reader != nullptr);
+            return _M_line;
+        }
+        pointer operator->() const noexcept
+        {
+            assert(_M_reader != nullptr);
+            return &_M_line;
+        }
+        iterator& operator++()
+        {
+            if (!_M_reader->read(_M_line, _M_offset)) {
+                _M_reader = nullptr;
+                _M_offset = 0;
+            }
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator temp(*this);
+            ++*this;
+            return temp;
+        }
+
+        bool operator==(const iterator& rhs) const noexcept
+        {
+            return _M_reader == rhs._M_reader && _M_offset == rhs._M_offset;
+        }
+        bool operator!=(const iterator& rhs) const noexcept
+        {
+            return !operator==(rhs);
+        }
+
+    private:
+        mmap_window_line_reader* _M_reader{};
+        offset_type              _M_offset{};
+        value_type               _M_line;
+    };
+
+    /** Enumeration of whether the delimiter should be stripped. */
+    enum strip_type {
+        strip_delimiter,     ///< The delimiter should be stripped
+        no_strip_delimiter,  ///< The delimiter should be retained
+    };
+
+    /** Enumeration of whether reading should follow a growing file. */
+    enum follow_type {
+        no_follow,           ///< Reading stops at the end of the file
+        follow_tail,         ///< Content appended later is read as well
+    };
+
+    mmap_window_line_reader() = default;
+    explicit mmap_window_line_reader(
+        const char* path, char delimiter = '\n',
+        strip_type strip = strip_delimiter,
+        size_t window_size = default_window_size)
+        : mmap_window_reader_base(path, window_size),
+          _M_delimiter(delimiter),
+          _M_strip_delimiter(strip == strip_delimiter)
+    {
+    }
+#if NVWA_WINDOWS
+    explicit mmap_window_line_reader(
+        const wchar_t* path, char delimiter = '\n',
+        strip_type strip = strip_delimiter,
+        size_t window_size = default_window_size)
+        : mmap_window_reader_base(path, window_size),
+          _M_delimiter(delimiter),
+          _M_strip_delimiter(strip == strip_delimiter)
+    {
+    }
+#endif
+#if NVWA_UNIX
+    explicit mmap_window_line_reader(
+        int fd, char delimiter = '\n', strip_type strip = strip_delimiter,
+        size_t window_size = default_window_size)
+        : mmap_window_reader_base(fd, window_size),
+          _M_delimiter(delimiter),
+          _M_strip_delimiter(strip == strip_delimiter)
+    {
+    }
+#endif
+
+    using mmap_window_reader_base::open;
+    using mmap_window_reader_base::close;
+    using mmap_window_reader_base::is_open;
+    using mmap_window_reader_base::size;
+    using mmap_window_reader_base::window_size;
+    using mmap_window_reader_base::set_window_size;
+
+    void set_delimiter(char delimiter, strip_type strip = strip_delimiter)
+    {
+        _M_delimiter = delimiter;
+        _M_strip_delimiter = strip == strip_delimiter;
+    }
+
+    /**
+     * Sets whether reading should follow a growing file.  When following,
+     * reaching the end makes the reader check the file size again, and a
+     * last line without the delimiter is regarded as still being written,
+     * so it is not returned until the delimiter is appended.  Iteration
+     * still ends at the current end of the file; call #read in a loop to
+     * poll for new lines.
+     *
+     * @param follow  whether to follow the tail of the file
+     */
+    void set_follow(follow_type follow)
+    {
+        _M_follow = follow == follow_tail;
+    }
+
+    iterator begin()
+    {
+        return iterator(this);
+    }
+    iterator end() const noexcept
+    {
+        return {};
+    }
+
+    bool read(std::string& output, offset_type& offset);
+
+private:
+    char  _M_delimiter{'\n'};
+    bool  _M_strip_delimiter{true};
+    bool  _M_follow{false};
+};
+
+/**
+ * Reads a line from the file.
+ *
+ * @param[out]    output  object to receive the line
+ * @param[in,out] offset  offset of reading pos on entry; end offset on exit
+ * @return                \c true if line content is returned; \c false
+ *                        otherwise
+ * @throw system_error    an error occurred when calling a system function
+ */
+inline bool mmap_window_line_reader::read(std::string& output,
+                                          offset_type& offset)
+{
+    const char* ptr = nullptr;
+    const char* delimiter_ptr = nullptr;
+    size_t searched = 0;
+    for (;;) {
+        if (offset + searched >= size()) {
+            if (_M_follow) {
+                refresh();
+            }
+            if (offset + searched >= size()) {
+                if (searched == 0 || _M_follow) {
+                    return false;
+                }
+                break;
+            }
+        }
+        // Takes all the bytes in the window; when the line does not end
+        // in it, the window is moved and grown geometrically
+        size_t length = 1;
+        if (searched != 0) {
+            length = size() - offset > searched * 2
+                         ? searched * 2
+                         : static_cast<size_t>(size() - offset);
+        }
+        ptr = map(offset, length);
+        delimiter_ptr = static_cast<const char*>(
+            memchr(ptr + searched, _M_delimiter, length - searched));
+        searched = length;
+        if (delimiter_ptr) {
+            break;
+        }
+    }
+
+    size_t pos = delimiter_ptr ? delimiter_ptr - ptr + 1 : searched;
+    output.assign(ptr, pos - (delimiter_ptr && _M_strip_delimiter));
+    offset += pos;
+    return true;
+}
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_MMAP_WINDOW_LINE_READER_H
@@ -0,0 +1,179 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  monotonic_arena.cpp
+ *
+ * Code for the monotonic memory arena.
+ *
+ * @date  2026-10-14
+ */
+
+#include "monotonic_arena.h"    // nvwa::monotonic_arena
+#include <assert.h>             // assert
+#include <new>                  // std::bad_alloc
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "aligned_memory.h"     // nvwa::aligned_malloc/aligned_free
+
+NVWA_NAMESPACE_BEGIN
+
+/** Header at the beginning of each memory block of the arena. */
+struct monotonic_arena::_Block_header {
+    _Block_header* _M_prev;     ///< Previously used (or next spare) block
+    size_t         _M_size;     ///< Total size of the block
+    char*          _M_top;      ///< End of used memory, when not current
+};
+
+/**
+ * Constructs an empty arena.  No memory is allocated until the first
+ * allocation.
+ *
+ * @param block_size       size of each normal block obtained from the
+ *                         system; larger blocks are used when needed
+ * @param block_alignment  alignment of the blocks, which limits the
+ *                         alignment of allocations
+ */
+monotonic_arena::monotonic_arena(size_t block_size, size_t block_alignment)
+    : _M_block_size(block_size),
+      _M_block_alignment(block_alignment < alignof(_Block_header)
+                             ? alignof(_Block_header)
+                             : block_alignment)
+{
+    assert((block_alignment & (block_alignment - 1)) == 0);
+}
+
+/**
+ * Destroys the arena and returns all its memory to the system.
+ */
+monotonic_arena::~monotonic_arena()
+{
+    release();
+}
+
+/**
+ * Rewinds the arena to a checkpoint.  Memory allocated after the
+ * checkpoint becomes available for new allocations.  Checkpoints shall
+ * be rewound to in the reverse order of their creation.
+ *
+ * @param m  marker previously returned by #mark on this arena
+ */
+void monotonic_arena::rewind(const marker& m) noexcept
+{
+    while (_M_current != m._M_block) {
+        assert(_M_current != nullptr);
+        _Block_header* block = _M_current;
+        _M_current = block->_M_prev;
+        block->_M_prev = _M_spare;
+        _M_spare = block;
+    }
+    _M_ptr = m._M_ptr;
+    _M_end = _M_current ? reinterpret_cast<char*>(_M_current) +
+                              _M_current->_M_size
+                        : nullptr;
+}
+
+/**
+ * Returns all memory of the arena to the system.  All markers obtained
+ * earlier become invalid.
+ */
+void monotonic_arena::release() noexcept
+{
+    rewind(marker());
+    while (_M_spare) {
+        _Block_header* next = _M_spare->_M_prev;
+        aligned_free(_M_spare);
+        _M_spare = next;
+    }
+}
+
+/**
+ * Gets the number of bytes currently allocated from the arena,
+ * including alignment padding.
+ *
+ * @return  the number of bytes in use
+ */
+size_t monotonic_arena::bytes_used() const noexcept
+{
+    size_t result = 0;
+    char* top = _M_ptr;
+    for (_Block_header* block = _M_current; block; block = block->_M_prev) {
+        result += top - reinterpret_cast<char*>(block + 1);
+        top = block->_M_prev ? block->_M_prev->_M_top : nullptr;
+    }
+    return result;
+}
+
+/**
+ * Allocates memory from a new (or spare) block, when the current block
+ * does not have enough space.
+ *
+ * @param size       number of bytes to allocate
+ * @param alignment  alignment of the memory
+ * @return           pointer to the allocated memory
+ * @throw bad_alloc  memory is insufficient
+ */
+void* monotonic_arena::_M_allocate_slow(size_t size, size_t alignment)
+{
+    size_t header_size =
+        (sizeof(_Block_header) + alignment - 1) & ~(alignment - 1);
+    if (size > size_t(-1) - header_size) {
+        throw std::bad_alloc();
+    }
+    size_t needed = header_size + size;
+
+    _Block_header* block = nullptr;
+    for (_Block_header** link = &_M_spare; *link;
+            link = &(*link)->_M_prev) {
+        if ((*link)->_M_size >= needed) {
+            block = *link;
+            *link = block->_M_prev;
+            break;
+        }
+    }
+    if (block == nullptr) {
+        size_t block_size = needed > _M_block_size ? needed : _M_block_size;
+        block = static_cast<_Block_header*>(
+            aligned_malloc(block_size, _M_block_alignment));
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        block->_M_size = block_size;
+    }
+
+    if (_M_current) {
+        _M_current->_M_top = _M_ptr;
+    }
+    block->_M_prev = _M_current;
+    _M_current = block;
+    char* result = reinterpret_cast<char*>(block) + header_size;
+    _M_ptr = result + size;
+    _M_end = reinterpret_cast<char*>(block) + block->_M_size;
+    return result;
+}
+
+NVWA_NAMESPACE_END
@@ -0,0 +1,234 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  monotonic_arena.h
+ *
+ * Header file for a monotonic (bump-pointer) memory arena with rewind
+ * checkpoints, and an allocator adaptor on top of it.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_MONOTONIC_ARENA_H
+#define NVWA_MONOTONIC_ARENA_H
+
+#include <assert.h>             // assert
+#include <new>                  // std::bad_alloc
+#include <type_traits>          // std::true_type/false_type
+#include <stddef.h>             // size_t/max_align_t
+#include <stdint.h>             // uintptr_t
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class to allocate memory by bumping a pointer in blocks obtained with
+ * nvwa#aligned_malloc.  Individual allocations are never freed; instead,
+ * all memory allocated after a checkpoint (see #mark) can be given back
+ * at once with #rewind, and all memory with #release.  Blocks given back
+ * are kept for reuse until #release or destruction.
+ *
+ * This class is not thread-safe.
+ */
+class monotonic_arena {
+public:
+    /** Default alignment of allocations. */
+    static constexpr size_t default_alignment = alignof(max_align_t);
+
+    /** Checkpoint returned by #mark and used by #rewind. */
+    class marker {
+    public:
+        marker() = default;
+
+    private:
+        friend class monotonic_arena;
+        marker(void* block, char* ptr) : _M_block(block), _M_ptr(ptr) {}
+
+        void* _M_block{};
+        char* _M_ptr{};
+    };
+
+    /** RAII class to rewind an arena to the state at its construction. */
+    class scoped_rewind {
+    public:
+        explicit scoped_rewind(monotonic_arena& arena)
+            : _M_arena(arena), _M_marker(arena.mark())
+        {
+        }
+        ~scoped_rewind()
+        {
+            _M_arena.rewind(_M_marker);
+        }
+        scoped_rewind(const scoped_rewind&) = delete;
+        scoped_rewind& operator=(const scoped_rewind&) = delete;
+
+    private:
+        monotonic_arena& _M_arena;
+        marker           _M_marker;
+    };
+
+    explicit monotonic_arena(size_t block_size = 64 * 1024,
+                             size_t block_alignment = default_alignment);
+    ~monotonic_arena();
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = default_alignment);
+    marker mark() const noexcept;
+    void rewind(const marker& m) noexcept;
+    void release() noexcept;
+
+    size_t block_size() const noexcept;
+    size_t bytes_used() const noexcept;
+
+private:
+    struct _Block_header;
+
+    void* _M_allocate_slow(size_t size, size_t alignment);
+
+    size_t         _M_block_size;
+    size_t         _M_block_alignment;
+    _Block_header* _M_current{};    ///< Block being bumped in
+    _Block_header* _M_spare{};      ///< Blocks given back by rewind
+    char*          _M_ptr{};        ///< Next free byte in _M_current
+    char*          _M_end{};        ///< End of _M_current
+};
+
+/**
+ * Allocates memory from the arena.
+ *
+ * @param size       number of bytes to allocate
+ * @param alignment  alignment of the memory, which shall be a power of
+ *                   two no greater than the block alignment
+ * @return           pointer to the allocated memory
+ * @throw bad_alloc  memory is insufficient
+ */
+inline void* monotonic_arena::allocate(size_t size, size_t alignment)
+{
+    assert((alignment & (alignment - 1)) == 0);
+    assert(alignment <= _M_block_alignment);
+    uintptr_t ptr = reinterpret_cast<uintptr_t>(_M_ptr);
+    size_t padding = ((ptr + alignment - 1) & ~(alignment - 1)) - ptr;
+    size_t available = static_cast<size_t>(_M_end - _M_ptr);
+    if (padding <= available && size <= available - padding) {
+        void* result = _M_ptr + padding;
+        _M_ptr += padding + size;
+        return result;
+    }
+    return _M_allocate_slow(size, alignment);
+}
+
+/**
+ * Gets a checkpoint of the current allocation state.
+ *
+ * @return  marker to pass to #rewind
+ */
+inline monotonic_arena::marker monotonic_arena::mark() const noexcept
+{
+    return marker(_M_current, _M_ptr);
+}
+
+/**
+ * Gets the size of the normal blocks.
+ *
+ * @return  the block size given at construction
+ */
+inline size_t monotonic_arena::block_size() const noexcept
+{
+    return _M_block_size;
+}
+
+/**
+ * Allocator adaptor that takes memory from a monotonic_arena.
+ * Deallocation does nothing; memory is reclaimed when the arena is
+ * rewound or released.  Copies of the allocator share the same arena.
+ *
+ * @param _Tp  type of objects to allocate
+ */
+template <typename _Tp>
+class arena_allocator {
+public:
+    typedef _Tp value_type;
+    typedef std::false_type is_always_equal;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    explicit arena_allocator(monotonic_arena& arena) noexcept
+        : _M_arena(&arena)
+    {
+    }
+    template <typename _Up>
+    arena_allocator(const arena_allocator<_Up>& rhs) noexcept
+        : _M_arena(&rhs.arena())
+    {
+    }
+
+    template <typename _Up>
+    struct rebind {
+        typedef arena_allocator<_Up> other;
+    };
+
+    _Tp* allocate(size_t n)
+    {
+        if (n > size_t(-1) / sizeof(_Tp)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<_Tp*>(
+            _M_arena->allocate(n * sizeof(_Tp), alignof(_Tp)));
+    }
+    void deallocate(_Tp*, size_t) noexcept {}
+
+    monotonic_arena& arena() const noexcept
+    {
+        return *_M_arena;
+    }
+
+private:
+    monotonic_arena* _M_arena;
+};
+
+template <typename _Tp, typename _Up>
+bool operator==(const arena_allocator<_Tp>& lhs,
+                const arena_allocator<_Up>& rhs) noexcept
+{
+    return &lhs.arena() == &rhs.arena();
+}
+
+template <typename _Tp, typename _Up>
+bool operator!=(const arena_allocator<_Tp>& lhs,
+                const arena_allocator<_Up>& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_MONOTONIC_ARENA_H
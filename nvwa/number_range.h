@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2019-2021 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2019-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -30,17 +30,22 @@
  * @file  number_range.h
  *
  * Header file for number_range, a number range type that satisfies the
- * InputRange concept.  A compiler that supports C++17 or later is
+ * RandomAccessRange concept.  A compiler that supports C++17 or later is
  * required.
  *
- * @date  2021-08-06
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_NUMBER_RANGE_H
 #define NVWA_NUMBER_RANGE_H
 
-#include <stddef.h>             // ptrdiff_t
-#include <iterator>             // std::input_iterator_tag
+#include <assert.h>             // assert
+#include <math.h>               // ceil
+#include <stddef.h>             // ptrdiff_t/size_t
+#include <iterator>             // std::random_access_iterator_tag
+#include <type_traits>          // std::common_type_t/conditional_t/
+                                // is_integral_v/make_unsigned_t
+#include <vector>               // std::vector
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
 
 NVWA_NAMESPACE_BEGIN
@@ -49,27 +54,63 @@ NVWA_NAMESPACE_BEGIN
  * Class template that allows iterating over a number range with a
  * step value other than one.  It is quite similar to the C++20 \c
  * iota_view, except for allowing non-integer types and custom step
- * values.  It satisfies the InputRange concept, and can work with
- * std::ranges and range-v3.
+ * values.  It satisfies the RandomAccessRange and SizedRange concepts,
+ * and can work with std::ranges, range-v3, and parallel algorithms.
+ * The <em>i</em>th number is calculated as <code>begin + i *
+ * step</code>, so that loops over it can be vectorized, and rounding
+ * errors of floating-point steps do not accumulate.
  */
 template <typename _Tp>
 class number_range {
+    // Indexing in an integer type lets compilers see loops as affine.
+    // It is at least as wide as ptrdiff_t, so that the index of the end
+    // of a range of a narrow type does not wrap around.
+    typedef std::conditional_t<std::is_integral_v<_Tp>,
+                               std::common_type_t<_Tp, ptrdiff_t>, ptrdiff_t>
+        index_type;
+    // Integer arithmetic is done in an unsigned type, so that the
+    // distance across a full-width range does not overflow.
+    typedef std::make_unsigned_t<index_type> unsigned_index_type;
+
 public:
     class sentinel;
 
-    class iterator {  // implements InputIterator
+    class iterator {  // implements RandomAccessIterator
+
     public:
-        typedef ptrdiff_t               difference_type;
-        typedef _Tp                     value_type;
-        typedef value_type*             pointer;
-        typedef value_type&             reference;
-        typedef std::input_iterator_tag iterator_category;
+        typedef ptrdiff_t                       difference_type;
+        typedef _Tp                             value_type;
+        typedef value_type*                     pointer;
+        typedef value_type                      reference;
+        typedef std::random_access_iterator_tag iterator_category;
 
         iterator() = default;
-        iterator(_Tp val, _Tp step) : _M_curr(val), _M_step(step) {}
+        iterator(_Tp begin, _Tp step, difference_type index = 0)
+            : _M_begin(begin), _M_step(step),
+              _M_index(static_cast<index_type>(index))
+        {
+        }
+
+        value_type operator*() const
+        {
+            if constexpr (std::is_integral_v<_Tp>) {
+                return static_cast<_Tp>(
+                    static_cast<unsigned_index_type>(_M_begin) +
+                    static_cast<unsigned_index_type>(_M_index) *
+                        static_cast<unsigned_index_type>(_M_step));
+            } else {
+                return static_cast<_Tp>(
+                    _M_begin + static_cast<_Tp>(_M_index) * _M_step);
+            }
+        }
+        value_type operator[](difference_type n) const
+        {
+            return *(*this + n);
+        }
+
         iterator& operator++()
         {
-            _M_curr += _M_step;
+            ++_M_index;
             return *this;
         }
         iterator operator++(int)
@@ -78,22 +119,67 @@ public:
             ++*this;
             return temp;
         }
-        value_type operator*() const
+        iterator& operator--()
+        {
+            --_M_index;
+            return *this;
+        }
+        iterator operator--(int)
         {
-            return _M_curr;
+            iterator temp(*this);
+            --*this;
+            return temp;
+        }
+        iterator& operator+=(difference_type n)
+        {
+            _M_index += static_cast<index_type>(n);
+            return *this;
+        }
+        iterator& operator-=(difference_type n)
+        {
+            _M_index -= static_cast<index_type>(n);
+            return *this;
+        }
+        friend iterator operator+(iterator it, difference_type n)
+        {
+            return it += n;
+        }
+        friend iterator operator+(difference_type n, iterator it)
+        {
+            return it += n;
+        }
+        friend iterator operator-(iterator it, difference_type n)
+        {
+            return it -= n;
+        }
+        friend difference_type operator-(const iterator& lhs,
+                                         const iterator& rhs)
+        {
+            return static_cast<difference_type>(lhs._M_index) -
+                   static_cast<difference_type>(rhs._M_index);
         }
 
         friend class sentinel;
         bool operator==(const iterator& rhs) const;
         bool operator!=(const iterator& rhs) const;
+        bool operator<(const iterator& rhs) const;
+        bool operator>(const iterator& rhs) const;
+        bool operator<=(const iterator& rhs) const;
+        bool operator>=(const iterator& rhs) const;
         bool operator==(const sentinel& rhs) const;
         bool operator!=(const sentinel& rhs) const;
 
     private:
-        _Tp _M_curr{};
-        _Tp _M_step{};
+        _Tp             _M_begin{};
+        _Tp             _M_step{};
+        index_type      _M_index{};
     };
 
+    /**
+     * Sentinel that compares equal to the iterators whose values reach
+     * the end value.  #end returns an iterator instead now; the
+     * sentinel is kept for compatibility.
+     */
     class sentinel {
     public:
         sentinel() = default;
@@ -109,32 +195,131 @@ public:
         _Tp _M_end{};
     };
 
+    typedef _Tp      value_type;
+    typedef size_t   size_type;
+
     number_range() = default;
+    /**
+     * Constructor.
+     *
+     * @param begin  the first number
+     * @param end    the number to stop before
+     * @param step   the difference between adjacent numbers
+     * @pre          \a step shall be positive if \a begin is less than
+     *               \a end.
+     */
     number_range(_Tp begin, _Tp end, _Tp step = 1)
-        : _M_begin(begin), _M_end(end), _M_step(step)
+        : _M_begin(begin), _M_end(end), _M_step(step),
+          _M_size(count(begin, end, step))
     {
     }
 
     iterator begin() const
     {
-        return iterator(_M_begin, _M_step);
+        return iterator(_M_begin, _M_step,
+                        static_cast<ptrdiff_t>(_M_first));
+    }
+    iterator end() const
+    {
+        return iterator(_M_begin, _M_step,
+                        static_cast<ptrdiff_t>(_M_first + _M_size));
     }
 
-    sentinel end() const
+    size_type size() const noexcept
     {
-        return sentinel(_M_end);
+        return _M_size;
     }
+    bool empty() const noexcept
+    {
+        return _M_size == 0;
+    }
+    value_type operator[](size_type pos) const
+    {
+        assert(pos < _M_size);
+        return begin()[static_cast<ptrdiff_t>(pos)];
+    }
+
+    std::vector<number_range> chunks(size_type n) const;
 
 private:
-    _Tp _M_begin{};
-    _Tp _M_end{};
-    _Tp _M_step{};
+    number_range(const number_range& whole, size_type first,
+                 size_type size)
+        : _M_begin(whole._M_begin), _M_end(whole._M_end),
+          _M_step(whole._M_step), _M_first(first), _M_size(size)
+    {
+    }
+
+    static size_type count(_Tp begin, _Tp end, _Tp step);
+
+    _Tp       _M_begin{};
+    _Tp       _M_end{};
+    _Tp       _M_step{};
+    size_type _M_first{};    ///< Index of the first number (in a chunk)
+    size_type _M_size{};
 };
 
+/**
+ * Splits the range into consecutive sub-ranges, say, to be processed by
+ * different threads.  The sizes of the sub-ranges differ by at most
+ * one.  A number in a sub-range is exactly the same as the one at the
+ * same position in the whole range.
+ *
+ * @param n  the maximum number of sub-ranges
+ * @return   <code>min(n, size())</code> non-empty sub-ranges in order,
+ *           or one sub-range when \a n is zero
+ */
+template <typename _Tp>
+std::vector<number_range<_Tp>> number_range<_Tp>::chunks(size_type n) const
+{
+    if (n == 0) {
+        n = 1;
+    }
+    if (n > _M_size) {
+        n = _M_size;
+    }
+    std::vector<number_range> result;
+    result.reserve(n);
+    for (size_type i = 0; i < n; ++i) {
+        size_type first = _M_size * i / n;
+        size_type last = _M_size * (i + 1) / n;
+        result.push_back(number_range(*this, _M_first + first, last - first));
+    }
+    return result;
+}
+
+template <typename _Tp>
+typename number_range<_Tp>::size_type
+number_range<_Tp>::count(_Tp begin, _Tp end, _Tp step)
+{
+    if (!(begin < end)) {
+        return 0;
+    }
+    assert(step > 0);
+    if constexpr (std::is_integral_v<_Tp>) {
+        auto distance = static_cast<unsigned_index_type>(end) -
+                        static_cast<unsigned_index_type>(begin);
+        return static_cast<size_type>(
+                   (distance - 1) / static_cast<unsigned_index_type>(step)) +
+               1;
+    } else {
+        // Corrects the rounding errors so that exactly the numbers less
+        // than end are included
+        auto result = static_cast<size_type>(ceil((end - begin) / step));
+        while (result > 0 &&
+               !(begin + static_cast<_Tp>(result - 1) * step < end)) {
+            --result;
+        }
+        while (begin + static_cast<_Tp>(result) * step < end) {
+            ++result;
+        }
+        return result;
+    }
+}
+
 template <typename _Tp>
 inline bool number_range<_Tp>::iterator::operator==(const iterator& rhs) const
 {
-    return _M_curr == rhs._M_curr;
+    return _M_index == rhs._M_index;
 }
 
 template <typename _Tp>
@@ -143,10 +328,35 @@ inline bool number_range<_Tp>::iterator::operator!=(const iterator& rhs) const
     return !operator==(rhs);
 }
 
+template <typename _Tp>
+inline bool number_range<_Tp>::iterator::operator<(const iterator& rhs) const
+{
+    return static_cast<difference_type>(_M_index) <
+           static_cast<difference_type>(rhs._M_index);
+}
+
+template <typename _Tp>
+inline bool number_range<_Tp>::iterator::operator>(const iterator& rhs) const
+{
+    return rhs.operator<(*this);
+}
+
+template <typename _Tp>
+inline bool number_range<_Tp>::iterator::operator<=(const iterator& rhs) const
+{
+    return !rhs.operator<(*this);
+}
+
+template <typename _Tp>
+inline bool number_range<_Tp>::iterator::operator>=(const iterator& rhs) const
+{
+    return !operator<(rhs);
+}
+
 template <typename _Tp>
 inline bool number_range<_Tp>::iterator::operator==(const sentinel& rhs) const
 {
-    return _M_curr >= rhs._M_end;
+    return **this >= rhs._M_end;
 }
 
 template <typename _Tp>
@@ -158,7 +368,7 @@ inline bool number_range<_Tp>::iterator::operator!=(const sentinel& rhs) const
 template <typename _Tp>
 inline bool number_range<_Tp>::sentinel::operator==(const iterator& rhs) const
 {
-    return rhs._M_curr >= _M_end;
+    return *rhs >= _M_end;
 }
 
 template <typename _Tp>
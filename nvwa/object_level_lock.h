@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2021 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -34,15 +34,21 @@
  * href="http://www.awprofessional.com/articles/article.asp?p=25298">
  * "Multithreading and the C++ Type System"</a> for the ideas behind.
  *
- * @date  2021-08-06
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_OBJECT_LEVEL_LOCK_H
 #define NVWA_OBJECT_LEVEL_LOCK_H
 
-#include "fast_mutex.h"         // nvwa::fast_mutex/_NOTHREADS
+#include "fast_mutex.h"         // nvwa::fast_mutex/_NOTHREADS/...
+#include "lock_stats.h"         // _LOCK_STATS/nvwa::lock_stats_counter
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
 
+#if _LOCK_STATS && !defined(_NOTHREADS)
+#include <typeinfo>             // typeid
+#include "pctimer.h"            // nvwa::pctimer
+#endif
+
 NVWA_NAMESPACE_BEGIN
 
 # ifdef _NOTHREADS
@@ -50,7 +56,7 @@ NVWA_NAMESPACE_BEGIN
      * Helper class for object-level locking.  This is the
      * single-threaded implementation.
      */
-    template <class _Host>
+    template <class _Host, class _Mutex = fast_mutex>
     class object_level_lock {
     public:
         /** Type that provides locking/unlocking semantics. */
@@ -61,13 +67,13 @@ NVWA_NAMESPACE_BEGIN
 
         public:
             explicit lock(const object_level_lock& host)
-            lock(const lock&) = delete;
-            lock& operator=(const lock&) = delete;
 #   ifndef NDEBUG
                 : _M_host(host)
 #   endif
             {
             }
+            lock(const lock&) = delete;
+            lock& operator=(const lock&) = delete;
 #   ifndef NDEBUG
             // The purpose of this method is allow one to write code
             // like "assert(guard.get_locked_object() == this)" to
@@ -79,17 +85,60 @@ NVWA_NAMESPACE_BEGIN
             }
 #   endif
         };
+        /** Type that provides shared locking/unlocking semantics. */
+        typedef lock shared_lock;
 
         typedef _Host volatile_type;
     };
 # else
     /**
      * Helper class for object-level locking.  This is the
-     * multi-threaded implementation.
+     * multi-threaded implementation.  The mutex type may be specified,
+     * say, adaptive_fast_mutex for short critical sections, or
+     * fast_shared_mutex to allow #shared_lock.  When #_LOCK_STATS is
+     * non-zero, the acquisitions and contentions of all objects of a
+     * host type are counted together (see nvwa#print_lock_stats).
      */
-    template <class _Host>
+    template <class _Host, class _Mutex = fast_mutex>
     class object_level_lock {
-        mutable fast_mutex _M_mtx;
+        mutable _Mutex _M_mtx;
+#   if _LOCK_STATS
+        static lock_stats_counter _S_stats;
+
+        static const char* host_name()
+        {
+            return typeid(_Host).name();
+        }
+#   endif
+
+        void acquire() const
+        {
+#   if _LOCK_STATS
+            if (_M_mtx.try_lock()) {
+                _S_stats.on_acquire(false, 0);
+            } else {
+                pctimer_t start = pctimer();
+                _M_mtx.lock();
+                _S_stats.on_acquire(true, pctimer() - start);
+            }
+#   else
+            _M_mtx.lock();
+#   endif
+        }
+        void acquire_shared() const
+        {
+#   if _LOCK_STATS
+            if (_M_mtx.try_lock_shared()) {
+                _S_stats.on_acquire(false, 0);
+            } else {
+                pctimer_t start = pctimer();
+                _M_mtx.lock_shared();
+                _S_stats.on_acquire(true, pctimer() - start);
+            }
+#   else
+            _M_mtx.lock_shared();
+#   endif
+        }
 
     public:
         // The C++ 1998 Standard required the use of `friend' here, but
@@ -97,7 +146,9 @@ NVWA_NAMESPACE_BEGIN
         // changed.  It is still used here for compatibility with older
         // compilers.
         class lock;
+        class shared_lock;
         friend class lock;
+        friend class shared_lock;
 
         /** Type that provides locking/unlocking semantics. */
         class lock {
@@ -106,7 +157,7 @@ NVWA_NAMESPACE_BEGIN
         public:
             explicit lock(const object_level_lock& host) : _M_host(host)
             {
-                _M_host._M_mtx.lock();
+                _M_host.acquire();
             }
             lock(const lock&) = delete;
             lock& operator=(const lock&) = delete;
@@ -126,8 +177,41 @@ NVWA_NAMESPACE_BEGIN
 #   endif
         };
 
+        /**
+         * Type that provides shared locking/unlocking semantics.  It
+         * requires a mutex type like fast_shared_mutex.
+         */
+        class shared_lock {
+            const object_level_lock& _M_host;
+
+        public:
+            explicit shared_lock(const object_level_lock& host)
+                : _M_host(host)
+            {
+                _M_host.acquire_shared();
+            }
+            shared_lock(const shared_lock&) = delete;
+            shared_lock& operator=(const shared_lock&) = delete;
+            ~shared_lock()
+            {
+                _M_host._M_mtx.unlock_shared();
+            }
+#   ifndef NDEBUG
+            const object_level_lock* get_locked_object() const
+            {
+                return &_M_host;
+            }
+#   endif
+        };
+
         typedef volatile _Host volatile_type;
     };
+
+#   if _LOCK_STATS
+    template <class _Host, class _Mutex>
+    lock_stats_counter object_level_lock<_Host, _Mutex>::_S_stats(
+        "object_level_lock", &object_level_lock<_Host, _Mutex>::host_name);
+#   endif
 # endif // _NOTHREADS
 
 NVWA_NAMESPACE_END
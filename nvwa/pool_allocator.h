@@ -0,0 +1,209 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  pool_allocator.h
+ *
+ * A standard-compatible allocator that takes memory from size classes
+ * of static_mem_pool.  Using this file requires a C++14-compliant
+ * compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_POOL_ALLOCATOR_H
+#define NVWA_POOL_ALLOCATOR_H
+
+#include <new>                  // std::bad_alloc
+#include <type_traits>          // std::true_type
+#include <utility>              // std::index_sequence
+#include <stddef.h>             // size_t/max_align_t
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "mem_pool_base.h"      // nvwa::mem_pool_base
+#include "static_mem_pool.h"    // nvwa::static_mem_pool
+
+#ifndef NVWA_POOL_ALLOCATOR_GRANULARITY
+/**
+ * Difference in bytes between adjacent size classes of pool_allocator.
+ * It shall be a power of two no less than the alignment of \c
+ * max_align_t, so that all blocks are suitably aligned.
+ */
+#define NVWA_POOL_ALLOCATOR_GRANULARITY 16
+#endif
+
+#ifndef NVWA_POOL_ALLOCATOR_MAX_SIZE
+/**
+ * Maximum size in bytes served by the size classes of pool_allocator.
+ * Larger requests go directly to mem_pool_base::alloc_sys.
+ */
+#define NVWA_POOL_ALLOCATOR_MAX_SIZE 256
+#endif
+
+NVWA_NAMESPACE_BEGIN
+
+namespace detail {
+
+/**
+ * Dispatcher from run-time sizes to the compile-time sizes of
+ * static_mem_pool.  The sizes are rounded up to a multiple of
+ * #NVWA_POOL_ALLOCATOR_GRANULARITY.
+ *
+ * @param _Gid  group ID of the underlying static_mem_pools
+ */
+template <int _Gid>
+struct pool_size_classes {
+    static const size_t granularity = NVWA_POOL_ALLOCATOR_GRANULARITY;
+    static const size_t max_size = NVWA_POOL_ALLOCATOR_MAX_SIZE;
+    static const size_t class_count = max_size / granularity;
+
+    static_assert((granularity & (granularity - 1)) == 0 &&
+                      granularity >= alignof(max_align_t),
+                  "Bad size class granularity");
+    static_assert(max_size % granularity == 0 && class_count > 0,
+                  "Bad maximum size for size classes");
+
+    static void* allocate(size_t size)
+    {
+        if (size > max_size) {
+            return mem_pool_base::alloc_sys(size);
+        }
+        return _S_dispatch_allocate(
+            _S_index(size), std::make_index_sequence<class_count>());
+    }
+    static void deallocate(void* ptr, size_t size)
+    {
+        if (size > max_size) {
+            mem_pool_base::dealloc_sys(ptr);
+            return;
+        }
+        _S_dispatch_deallocate(
+            ptr, _S_index(size), std::make_index_sequence<class_count>());
+    }
+
+private:
+    static size_t _S_index(size_t size)
+    {
+        return size == 0 ? 0 : (size - 1) / granularity;
+    }
+
+    template <size_t _Sz>
+    static void* _S_allocate()
+    {
+        return static_mem_pool<_Sz, _Gid>::instance_known().allocate();
+    }
+    template <size_t _Sz>
+    static void _S_deallocate(void* ptr)
+    {
+        static_mem_pool<_Sz, _Gid>::instance_known().deallocate(ptr);
+    }
+
+    template <size_t... _I>
+    static void* _S_dispatch_allocate(size_t index,
+                                      std::index_sequence<_I...>)
+    {
+        static void* (*const allocators[])() = {
+            &_S_allocate<(_I + 1) * granularity>...};
+        return allocators[index]();
+    }
+    template <size_t... _I>
+    static void _S_dispatch_deallocate(void* ptr, size_t index,
+                                       std::index_sequence<_I...>)
+    {
+        static void (*const deallocators[])(void*) = {
+            &_S_deallocate<(_I + 1) * granularity>...};
+        deallocators[index](ptr);
+    }
+};
+
+} /* namespace detail */
+
+/**
+ * Allocator that takes memory from a table of static_mem_pool size
+ * classes.  It lets node-based containers use pooled memory without
+ * per-class operator new/delete.  Like the #DECLARE_STATIC_MEM_POOL
+ * macros, it shall not be used to allocate memory before the static
+ * initialization of the memory pools is finished.
+ *
+ * @param _Tp   type of objects to allocate
+ * @param _Gid  group ID of the underlying static_mem_pools: if it is
+ *              negative, simultaneous accesses will be protected from
+ *              each other; otherwise no protection is given
+ */
+template <typename _Tp, int _Gid = -1>
+struct pool_allocator {
+    typedef _Tp value_type;
+    typedef std::true_type is_always_equal;
+    typedef std::true_type propagate_on_container_move_assignment;
+
+    static_assert(alignof(_Tp) <= NVWA_POOL_ALLOCATOR_GRANULARITY,
+                  "Over-aligned types are not supported");
+
+    pool_allocator() = default;
+    template <typename _Up>
+    pool_allocator(const pool_allocator<_Up, _Gid>&) {}
+
+    template <typename _Up>
+    struct rebind {
+        typedef pool_allocator<_Up, _Gid> other;
+    };
+
+    _Tp* allocate(size_t n)
+    {
+        if (n > size_t(-1) / sizeof(_Tp)) {
+            throw std::bad_alloc();
+        }
+        void* ptr =
+            detail::pool_size_classes<_Gid>::allocate(n * sizeof(_Tp));
+        if (ptr == _NULLPTR) {
+            throw std::bad_alloc();
+        }
+        return static_cast<_Tp*>(ptr);
+    }
+    void deallocate(_Tp* p, size_t n)
+    {
+        detail::pool_size_classes<_Gid>::deallocate(p, n * sizeof(_Tp));
+    }
+};
+
+template <typename _Tp, typename _Up, int _Gid>
+bool operator==(const pool_allocator<_Tp, _Gid>&,
+                const pool_allocator<_Up, _Gid>&)
+{
+    return true;
+}
+
+template <typename _Tp, typename _Up, int _Gid>
+bool operator!=(const pool_allocator<_Tp, _Gid>&,
+                const pool_allocator<_Up, _Gid>&)
+{
+    return false;
+}
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_POOL_ALLOCATOR_H
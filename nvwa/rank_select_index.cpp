@@ -0,0 +1,281 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  rank_select_index.cpp
+ *
+ * Code for class rank_select_index (rank/select directory of a
+ * bool_array).  The current code requires a C++17-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#include "rank_select_index.h"  // rank_select_index
+#include <assert.h>             // assert
+#include <algorithm>            // std::min
+#include <bitset>               // std::bitset
+#include <stdexcept>            // std::out_of_range
+#include "_nvwa.h"              // NVWA macros
+
+#if defined(__BMI2__)
+#include <immintrin.h>          // _pdep_u64
+#endif
+
+NVWA_NAMESPACE_BEGIN
+
+namespace {
+
+/** Number of bits in a block, which has an entry in the directory. */
+constexpr size_t block_bits = 2048;
+
+/** Number of words in a block. */
+constexpr size_t block_words = block_bits / 64;
+
+/** Number of words in a sub-block. */
+constexpr size_t sub_block_words = block_words / 4;
+
+/** Number of blocks whose entries are relative to the same base. */
+constexpr size_t blocks_per_upper = (size_t(1) << 32) / block_bits;
+
+/** Interval of the \c true elements whose blocks are sampled. */
+constexpr size_t select_sample_rate = 8192;
+
+/** Calculates how many 1-bits there are in a 64-bit word. */
+inline unsigned count_bits_in_word(uint64_t value)
+{
+    return static_cast<unsigned>(std::bitset<64>(value).count());
+}
+
+/**
+ * Counts the 1-bits in 64-bit words.
+ *
+ * @param ptr       pointer to the first word
+ * @param word_cnt  number of words to count
+ * @return          the count of 1-bits
+ */
+inline size_t count_bits_in_words(const uint64_t* ptr, size_t word_cnt)
+{
+    size_t true_cnt = 0;
+    for (size_t i = 0; i < word_cnt; ++i) {
+        true_cnt += count_bits_in_word(ptr[i]);
+    }
+    return true_cnt;
+}
+
+/**
+ * Finds the position of a 1-bit in a word.
+ *
+ * @param value  the word to search
+ * @param nth    the number of 1-bits to skip
+ * @pre          \a nth is less than the count of 1-bits in \a value
+ * @return       the offset of the 1-bit
+ */
+inline unsigned select_in_word(uint64_t value, unsigned nth)
+{
+    assert(nth < count_bits_in_word(value));
+#if defined(__BMI2__)
+    return static_cast<unsigned>(
+        __builtin_ctzll(_pdep_u64(uint64_t(1) << nth, value)));
+#else
+    unsigned offset = 0;
+    for (unsigned width = 32; width >= 8; width /= 2) {
+        unsigned low_cnt =
+            count_bits_in_word(value & ((uint64_t(1) << width) - 1));
+        if (nth >= low_cnt) {
+            nth -= low_cnt;
+            value >>= width;
+            offset += width;
+        }
+    }
+    for (;; value >>= 1, ++offset) {
+        if (value & 1) {
+            if (nth == 0) {
+                return offset;
+            }
+            --nth;
+        }
+    }
+#endif
+}
+
+} /* unnamed namespace */
+
+/**
+ * Builds the rank/select directory of a bool_array.
+ *
+ * @param ba            the bool_array to index
+ * @throw out_of_range  \a ba is empty
+ * @throw bad_alloc     memory is insufficient
+ */
+rank_select_index::rank_select_index(const bool_array& ba) : _M_array(&ba)
+{
+    if (ba.size() == 0) {
+        throw std::out_of_range("invalid bool_array size");
+    }
+    const uint64_t* words = ba._M_word_ptr;
+    size_t word_cnt = bool_array::get_num_words_from_bits(ba.size());
+    // The extra block allows ranking at the end of the array
+    size_t block_cnt = ba.size() / block_bits + 1;
+    _M_blocks.resize(block_cnt);
+    _M_upper.resize((block_cnt - 1) / blocks_per_upper + 1);
+
+    size_type true_cnt = 0;
+    for (size_t block = 0; block < block_cnt; ++block) {
+        if (block % blocks_per_upper == 0) {
+            _M_upper[block / blocks_per_upper] = true_cnt;
+        }
+        uint64_t entry = true_cnt - _M_upper[block / blocks_per_upper];
+        size_type block_true_cnt = 0;
+        for (size_t sub = 0; sub < 4; ++sub) {
+            size_t first = block * block_words + sub * sub_block_words;
+            size_t last = std::min(first + sub_block_words, word_cnt);
+            size_t sub_true_cnt =
+                first < last ? count_bits_in_words(words + first, last - first)
+                             : 0;
+            if (sub < 3) {
+                entry |= uint64_t(sub_true_cnt) << (32 + 10 * sub);
+            }
+            block_true_cnt += sub_true_cnt;
+        }
+        _M_blocks[block] = entry;
+        while (_M_samples.size() * select_sample_rate <
+               true_cnt + block_true_cnt) {
+            _M_samples.push_back(block);
+        }
+        true_cnt += block_true_cnt;
+    }
+    _M_count = true_cnt;
+}
+
+/**
+ * Counts the \c true elements before a specified position.
+ *
+ * @param pos           position in the array, which may be the size of
+ *                      the array
+ * @return              the count of \c true elements in [0, pos)
+ * @throw out_of_range  \a pos is greater than the size of the array
+ */
+rank_select_index::size_type rank_select_index::rank(size_type pos) const
+{
+    if (pos > _M_array->size()) {
+        throw std::out_of_range("invalid rank_select_index position");
+    }
+    size_t block = pos / block_bits;
+    size_type result = block_rank(block);
+    uint64_t entry = _M_blocks[block];
+    size_t sub = pos % block_bits / (sub_block_words * 64);
+    for (size_t i = 0; i < sub; ++i) {
+        result += (entry >> (32 + 10 * i)) & 0x3FF;
+    }
+    const uint64_t* words = _M_array->_M_word_ptr;
+    size_t first = block * block_words + sub * sub_block_words;
+    result += count_bits_in_words(words + first, pos / 64 - first);
+    if (pos % 64 != 0) {
+        result += count_bits_in_word(words[pos / 64] &
+                                     ~(~uint64_t(0) << (pos % 64)));
+    }
+    return result;
+}
+
+/**
+ * Finds the position of a \c true element by its order.
+ *
+ * @param nth  the number of \c true elements before the one to find
+ * @return     position of the element if found; \c #npos if there are
+ *             not more than \a nth \c true elements
+ */
+rank_select_index::size_type
+rank_select_index::select(size_type nth) const noexcept
+{
+    if (nth >= _M_count) {
+        return npos;
+    }
+
+    // Finds the last block whose rank is not greater than nth
+    size_t sample = nth / select_sample_rate;
+    size_t low = _M_samples[sample];
+    size_t high = sample + 1 < _M_samples.size() ? _M_samples[sample + 1]
+                                                 : _M_blocks.size() - 1;
+    while (low < high) {
+        size_t mid = low + (high - low + 1) / 2;
+        if (block_rank(mid) <= nth) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    size_type remaining = nth - block_rank(low);
+    uint64_t entry = _M_blocks[low];
+    size_t sub = 0;
+    for (; sub < 3; ++sub) {
+        size_type sub_true_cnt = (entry >> (32 + 10 * sub)) & 0x3FF;
+        if (remaining < sub_true_cnt) {
+            break;
+        }
+        remaining -= sub_true_cnt;
+    }
+    const uint64_t* words = _M_array->_M_word_ptr;
+    size_t word_pos = low * block_words + sub * sub_block_words;
+    for (;; ++word_pos) {
+        unsigned word_true_cnt = count_bits_in_word(words[word_pos]);
+        if (remaining < word_true_cnt) {
+            break;
+        }
+        remaining -= word_true_cnt;
+    }
+    return word_pos * 64 + select_in_word(words[word_pos],
+                                          static_cast<unsigned>(remaining));
+}
+
+/**
+ * Gets the approximate number of bytes of memory used by the directory.
+ *
+ * @return  the number of bytes used, excluding the indexed bool_array
+ */
+size_t rank_select_index::memory_usage() const noexcept
+{
+    return sizeof *this + _M_blocks.capacity() * sizeof(uint64_t) +
+           _M_upper.capacity() * sizeof(size_type) +
+           _M_samples.capacity() * sizeof(size_t);
+}
+
+/**
+ * Gets the count of \c true elements before a block.
+ *
+ * @param block  index of the block
+ * @return       the count of \c true elements before the block
+ */
+rank_select_index::size_type
+rank_select_index::block_rank(size_t block) const noexcept
+{
+    return _M_upper[block / blocks_per_upper] +
+           (_M_blocks[block] & 0xFFFFFFFF);
+}
+
+NVWA_NAMESPACE_END
@@ -0,0 +1,106 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  rank_select_index.h
+ *
+ * Header file for class rank_select_index (rank/select directory of a
+ * bool_array).  Using this file requires a C++17-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_RANK_SELECT_INDEX_H
+#define NVWA_RANK_SELECT_INDEX_H
+
+#include <stddef.h>             // size_t
+#include <stdint.h>             // uint64_t
+#include <vector>               // std::vector
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "bool_array.h"         // nvwa::bool_array
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class to answer rank and select queries on a bool_array in (nearly)
+ * constant time.  The directory follows the Poppy layout: for each
+ * block of 2048 bits, a 64-bit entry holds the count of \c true
+ * elements before the block and the counts in three of its four
+ * 512-bit sub-blocks, which is 3.125% of the size of the array.  For
+ * select, the block of every 8192nd \c true element is also sampled,
+ * which costs at most 0.8% more.
+ *
+ * The index refers to the bool_array it is built on, which shall not
+ * be modified or destroyed while the index is in use.
+ */
+class rank_select_index {
+public:
+    typedef bool_array::size_type size_type;    ///< Type of array indices
+
+    /** Constant representing `not found'. */
+    static constexpr auto npos = size_type(-1);
+
+    explicit rank_select_index(const bool_array& ba);
+
+    size_type rank(size_type pos) const;
+    size_type select(size_type nth) const noexcept;
+    size_type count() const noexcept;
+    size_t memory_usage() const noexcept;
+
+    /** Gets the indexed bool_array. */
+    const bool_array& array() const noexcept
+    {
+        return *_M_array;
+    }
+
+private:
+    size_type block_rank(size_t block) const noexcept;
+
+    const bool_array*      _M_array;
+    std::vector<uint64_t>  _M_blocks;   ///< Relative and sub-block counts
+    std::vector<size_type> _M_upper;    ///< Counts before each 2^32 bits
+    std::vector<size_t>    _M_samples;  ///< Blocks of sampled elements
+    size_type              _M_count{};
+};
+
+
+/* Inline functions */
+
+/**
+ * Counts elements with a \c true value.
+ *
+ * @return  the count of \c true elements
+ */
+inline rank_select_index::size_type rank_select_index::count() const noexcept
+{
+    return _M_count;
+}
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_RANK_SELECT_INDEX_H
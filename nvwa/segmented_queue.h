@@ -0,0 +1,308 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  segmented_queue.h
+ *
+ * Definition of an unbounded queue made of fixed-capacity segments.
+ * Using this file requires a C++17-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_SEGMENTED_QUEUE_H
+#define NVWA_SEGMENTED_QUEUE_H
+
+#include <assert.h>             // assert
+#include <atomic>               // std::atomic
+#include <memory>               // std::addressof/allocator/allocator_traits/...
+#include <mutex>                // std::lock_guard
+#include <type_traits>          // std::conditional_t
+#include <utility>              // std::forward
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "fast_mutex.h"         // nvwa::fast_mutex
+#include "fc_queue.h"           // nvwa::fc_queue
+
+NVWA_NAMESPACE_BEGIN
+
+namespace detail {
+
+/** Lock that does nothing, for queues with only one producer. */
+struct null_mutex {
+    void lock() noexcept {}
+    void unlock() noexcept {}
+};
+
+} /* namespace detail */
+
+/**
+ * Class to represent an unbounded queue.  Elements are stored in a
+ * linked list of fc_queue segments: the producer writes to the last
+ * segment and links a new one when it is full, and the consumer reads
+ * from the first segment and unlinks it when it is drained.  A drained
+ * segment is kept for reuse, so that a queue whose length stays within
+ * the capacity of a few segments does not allocate memory after
+ * warm-up.  Like fc_queue, it allows lockless one-producer,
+ * one-consumer access; multiple producers may be allowed at the cost of
+ * a lock on the producer side.
+ *
+ * @param _Tp             the type of elements in the queue
+ * @param _Alloc          allocator to use for memory management
+ * @param _MultiProducer  whether multiple producers are allowed
+ * @pre                   \a _Tp shall be \c MoveConstructible and \c
+ *                        Destructible, and \a _Alloc shall meet the
+ *                        allocator requirements (Table 28 in the C++11
+ *                        spec) and be usable from the producer and the
+ *                        consumer at the same time.
+ */
+template <class _Tp, class _Alloc = std::allocator<_Tp>,
+          bool _MultiProducer = false>
+class segmented_queue : private _Alloc {
+public:
+    typedef _Tp                                       value_type;
+    typedef _Alloc                                    allocator_type;
+    typedef fc_queue<_Tp, _Alloc>                     segment_type;
+    typedef typename segment_type::size_type          size_type;
+    typedef value_type&                               reference;
+    typedef const value_type&                         const_reference;
+
+    /**
+     * Constructor that creates an empty queue.
+     *
+     * @param segment_capacity  the capacity of each segment
+     * @param alloc             the allocator to use
+     * @pre                     \a segment_capacity shall not be zero.
+     * @post                    Unless memory allocation throws an
+     *                          exception, this queue will be constructed
+     *                          with one segment, and the following
+     *                          conditions will hold:
+     *                          - <code>empty()</code>
+     *                          - <code>get_allocator() == alloc</code>
+     */
+    explicit segmented_queue(size_type             segment_capacity = 256,
+                             const allocator_type& alloc = allocator_type())
+        : allocator_type(alloc), _M_segment_capacity(segment_capacity)
+    {
+        assert(segment_capacity != 0);
+        _M_head_seg = _M_tail_seg = create_segment();
+    }
+
+    segmented_queue(const segmented_queue&) = delete;
+    segmented_queue& operator=(const segmented_queue&) = delete;
+
+    /**
+     * Destructor.  It erases all elements and frees memory.
+     *
+     * @pre  No other threads are accessing the queue.
+     */
+    ~segmented_queue()
+    {
+        segment* seg = _M_head_seg;
+        while (seg) {
+            segment* next = seg->next.load(std::memory_order_relaxed);
+            destroy_segment(seg);
+            seg = next;
+        }
+        if (segment* spare = _M_spare.load(std::memory_order_relaxed)) {
+            destroy_segment(spare);
+        }
+    }
+
+    /**
+     * Checks whether the queue is empty.  It shall be called only by the
+     * consumer.
+     *
+     * @return  \c true if it is empty; \c false otherwise
+     */
+    bool empty() const noexcept
+    {
+        return _M_head_seg->queue.empty() &&
+               _M_head_seg->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+    /**
+     * Gets the capacity of each segment.
+     *
+     * @return  the capacity given at construction
+     */
+    size_type segment_capacity() const noexcept
+    {
+        return _M_segment_capacity;
+    }
+
+    /**
+     * Inserts a new element at the end of the queue.  A new segment is
+     * linked if the last one is full.
+     *
+     * @param args  arguments to construct a new element
+     * @post        Unless an exception is thrown, the new element is at
+     *              the end of the queue; otherwise this queue is
+     *              unchanged (strong exception safety is guaranteed).
+     */
+    template <typename... _Targs>
+    void write(_Targs&&... args)
+    {
+        std::lock_guard<producer_lock_type> guard(_M_producer_lock);
+        // fc_queue::write does not touch the arguments on failure
+        if (_M_tail_seg->queue.write(std::forward<_Targs>(args)...)) {
+            return;
+        }
+        segment* seg = acquire_segment();
+        try {
+            seg->queue.write(std::forward<_Targs>(args)...);
+        } catch (...) {
+            recycle_segment(seg);
+            throw;
+        }
+        // Publishes the elements in seg as well
+        _M_tail_seg->next.store(seg, std::memory_order_release);
+        _M_tail_seg = seg;
+    }
+
+    /**
+     * Moves the first element in the queue to the destination when the
+     * queue is not empty.  Drained segments are unlinked and kept for
+     * reuse.  It shall be called only by the consumer.
+     *
+     * @param[out] dest  destination to store the element
+     * @return           \c true if an element is moved out of the
+     *                   queue; \c false if the queue is empty
+     */
+    bool read(reference dest)
+    {
+        for (;;) {
+            if (_M_head_seg->queue.read(dest)) {
+                return true;
+            }
+            segment* next = _M_head_seg->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                return false;
+            }
+            // Elements written before the link are visible now
+            if (_M_head_seg->queue.read(dest)) {
+                return true;
+            }
+            segment* drained = _M_head_seg;
+            _M_head_seg = next;
+            recycle_segment(drained);
+        }
+    }
+
+    /**
+     * Gets the allocator of the queue.
+     *
+     * @return  the allocator of the queue
+     */
+    allocator_type get_allocator() const
+    {
+        return get_alloc();
+    }
+
+private:
+    struct segment {
+        segment(size_type capacity, const allocator_type& alloc)
+            : queue(capacity, alloc)
+        {
+        }
+
+        segment_type          queue;
+        std::atomic<segment*> next{};
+    };
+
+    typedef std::allocator_traits<_Alloc>             allocator_traits;
+    typedef typename allocator_traits::template rebind_alloc<segment>
+                                                      segment_allocator_type;
+    typedef std::allocator_traits<segment_allocator_type>
+                                                      segment_allocator_traits;
+    typedef typename segment_allocator_traits::pointer
+                                                      segment_pointer;
+    typedef std::conditional_t<_MultiProducer, fast_mutex,
+                               detail::null_mutex>    producer_lock_type;
+
+    segment* create_segment()
+    {
+        segment_allocator_type seg_alloc(get_alloc());
+        segment_pointer ptr = segment_allocator_traits::allocate(seg_alloc, 1);
+        try {
+            segment_allocator_traits::construct(seg_alloc,
+                                                std::addressof(*ptr),
+                                                _M_segment_capacity,
+                                                get_alloc());
+        } catch (...) {
+            segment_allocator_traits::deallocate(seg_alloc, ptr, 1);
+            throw;
+        }
+        return std::addressof(*ptr);
+    }
+    void destroy_segment(segment* seg) noexcept
+    {
+        segment_allocator_type seg_alloc(get_alloc());
+        segment_allocator_traits::destroy(seg_alloc, seg);
+        segment_allocator_traits::deallocate(
+            seg_alloc, std::pointer_traits<segment_pointer>::pointer_to(*seg),
+            1);
+    }
+
+    segment* acquire_segment()
+    {
+        segment* seg = _M_spare.exchange(nullptr, std::memory_order_acquire);
+        if (seg == nullptr) {
+            seg = create_segment();
+        }
+        return seg;
+    }
+    void recycle_segment(segment* seg) noexcept
+    {
+        seg->next.store(nullptr, std::memory_order_relaxed);
+        segment* old = _M_spare.exchange(seg, std::memory_order_acq_rel);
+        if (old) {
+            destroy_segment(old);
+        }
+    }
+
+    allocator_type& get_alloc() noexcept
+    {
+        return static_cast<allocator_type&>(*this);
+    }
+    const allocator_type& get_alloc() const noexcept
+    {
+        return static_cast<const allocator_type&>(*this);
+    }
+
+    size_type             _M_segment_capacity;
+    std::atomic<segment*> _M_spare{};       ///< Drained segment for reuse
+    alignas(NVWA_FC_QUEUE_CACHE_LINE_SIZE)
+    segment*              _M_head_seg{};    ///< Owned by the consumer
+    alignas(NVWA_FC_QUEUE_CACHE_LINE_SIZE)
+    segment*              _M_tail_seg{};    ///< Owned by the producer
+    producer_lock_type    _M_producer_lock;
+};
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_SEGMENTED_QUEUE_H
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2019 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -30,108 +30,278 @@
  * @file  set_assign.h
  *
  * Definition of template functions set_assign_union and set_assign_difference.
+ * Using this file requires a C++11-compliant compiler.
  *
- * @date  2019-08-22
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_SET_ASSIGN_H
 #define NVWA_SET_ASSIGN_H
 
-#include <algorithm>            // std::copy
+#include <algorithm>            // std::inplace_merge/move
+#include <iterator>             // std::inserter/iterator_traits/...
+#include <type_traits>          // std::false_type/true_type/is_base_of
+#include <utility>              // std::declval/move
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
 
 NVWA_NAMESPACE_BEGIN
 
-template <class _Container, class _InputIter>
-_Container& set_assign_union(_Container& dest,
-                             _InputIter first,
-                             _InputIter last)
+namespace detail {
+
+// Struct to check whether a container is a sequence with random-access
+// iterators, push_back, and range erase, like std::vector, so that it
+// can be merged in place.
+template <class _Container>
+struct is_random_access_sequence {
+    template <class _Up>
+    static auto test(_Up* c)
+        -> decltype(c->push_back(
+                        std::declval<const typename _Up::value_type&>()),
+                    c->erase(c->begin(), c->end()),
+                    std::is_base_of<
+                        std::random_access_iterator_tag,
+                        typename std::iterator_traits<
+                            typename _Up::iterator>::iterator_category>{});
+    template <class _Up>
+    static std::false_type test(...);
+    static const bool value = decltype(test<_Container>(nullptr))::value;
+};
+
+// Struct to check whether a container is associative, i.e., has a
+// comparison object.
+template <class _Container>
+struct is_associative {
+    template <class _Up>
+    static auto test(const _Up* c) -> decltype(c->value_comp(),
+                                               std::true_type{});
+    template <class _Up>
+    static std::false_type test(...);
+    static const bool value = decltype(test<_Container>(nullptr))::value;
+};
+
+// Comparison using operator<, which may take arguments of different
+// types.
+struct set_assign_less {
+    template <typename _T1, typename _T2>
+    bool operator()(const _T1& lhs, const _T2& rhs) const
+    {
+        return lhs < rhs;
+    }
+};
+
+// Gets the ordering of an associative container.
+template <class _Container>
+auto set_assign_compare(const _Container& dest, std::true_type)
+    -> decltype(dest.value_comp())
+{
+    return dest.value_comp();
+}
+
+// Gets the ordering of other containers.
+template <class _Container>
+set_assign_less set_assign_compare(const _Container&, std::false_type)
+{
+    return set_assign_less();
+}
+
+// Merges into a sorted sequence in place: new elements are appended,
+// and the two sorted parts are merged, taking linear time.
+template <class _Container, class _InputIter, class _Compare>
+void set_assign_union(_Container& dest, _InputIter first, _InputIter last,
+                      _Compare comp, std::true_type)
+{
+    typedef typename _Container::size_type size_type;
+    size_type old_size = dest.size();
+    size_type pos = 0;
+    try {
+        for (; first != last; ++first) {
+            while (pos != old_size && comp(dest.begin()[pos], *first)) {
+                ++pos;
+            }
+            if (pos != old_size && !comp(*first, dest.begin()[pos])) {
+                ++pos;  // dest.begin()[pos] is equivalent to *first
+            } else {
+                dest.push_back(*first);
+            }
+        }
+    } catch (...) {
+        dest.erase(dest.begin() + old_size, dest.end());
+        throw;
+    }
+    std::inplace_merge(dest.begin(), dest.begin() + old_size, dest.end(),
+                       comp);
+}
+
+// Merges into other sorted containers element by element, using the
+// insertion position as the hint for associative containers.
+template <class _Container, class _InputIter, class _Compare>
+void set_assign_union(_Container& dest, _InputIter first, _InputIter last,
+                      _Compare comp, std::false_type)
 {
     typename _Container::iterator first_dest = dest.begin();
-    typename _Container::iterator  last_dest = dest.end();
-    while (first_dest != last_dest && first != last) {
-        if (*first_dest < *first) {
+    while (first_dest != dest.end() && first != last) {
+        if (comp(*first_dest, *first)) {
+            ++first_dest;
+        } else if (comp(*first, *first_dest)) {
+            first_dest = dest.insert(first_dest, *first);
             ++first_dest;
-        } else if (*first < *first_dest) {
-            dest.insert(first_dest, *first);
             ++first;
-        } else {  // *first_dest == *first
+        } else {  // *first_dest is equivalent to *first
             ++first_dest;
             ++first;
         }
     }
     if (first != last) {
-        std::copy(first, last, inserter(dest, last_dest));
+        std::copy(first, last, std::inserter(dest, dest.end()));
     }
-    return dest;
 }
 
+// Removes from a sorted sequence by compacting the retained elements,
+// taking linear time.
 template <class _Container, class _InputIter, class _Compare>
-_Container& set_assign_union(_Container& dest,
-                             _InputIter first,
-                             _InputIter last,
-                             _Compare comp)
+void set_assign_difference(_Container& dest, _InputIter first,
+                           _InputIter last, _Compare comp, std::true_type)
 {
     typename _Container::iterator first_dest = dest.begin();
     typename _Container::iterator  last_dest = dest.end();
+    typename _Container::iterator     output = first_dest;
     while (first_dest != last_dest && first != last) {
         if (comp(*first_dest, *first)) {
+            if (output != first_dest) {
+                *output = std::move(*first_dest);
+            }
+            ++output;
             ++first_dest;
         } else if (comp(*first, *first_dest)) {
-            dest.insert(first_dest, *first);
             ++first;
         } else {  // *first_dest is equivalent to *first
             ++first_dest;
             ++first;
         }
     }
-    if (first != last) {
-        std::copy(first, last, inserter(dest, last_dest));
+    if (output != first_dest) {
+        dest.erase(std::move(first_dest, last_dest, output), last_dest);
     }
-    return dest;
 }
 
-template <class _Container, class _InputIter>
-_Container& set_assign_difference(_Container& dest,
-                                  _InputIter first,
-                                  _InputIter last)
+// Removes from other sorted containers element by element.
+template <class _Container, class _InputIter, class _Compare>
+void set_assign_difference(_Container& dest, _InputIter first,
+                           _InputIter last, _Compare comp, std::false_type)
 {
     typename _Container::iterator first_dest = dest.begin();
-    typename _Container::iterator  last_dest = dest.end();
-    while (first_dest != last_dest && first != last) {
-        if (*first_dest < *first) {
+    while (first_dest != dest.end() && first != last) {
+        if (comp(*first_dest, *first)) {
             ++first_dest;
-        } else if (*first < *first_dest) {
+        } else if (comp(*first, *first_dest)) {
             ++first;
-        } else {  // *first == *first_dest
-            dest.erase(first_dest++);
+        } else {  // *first_dest is equivalent to *first
+            first_dest = dest.erase(first_dest);
             ++first;
         }
     }
+}
+
+} /* namespace detail */
+
+/**
+ * Adds the elements of a sorted range to a sorted container (like \c
+ * std::set_union, but in place).  A sequence with random-access
+ * iterators and \c push_back (like \c std::vector) is merged in
+ * linear time, reusing its own storage; other containers (like \c
+ * std::set, \c std::list, or flat sets) get hinted insertions, so that
+ * node-based containers take amortized constant time per element, and
+ * allocate nodes with their allocators (say, nvwa#pool_allocator).
+ *
+ * @param dest   the container sorted by \a comp
+ * @param first  beginning of the range sorted by \a comp
+ * @param last   end of the range
+ * @param comp   the comparison object
+ * @return       \a dest
+ */
+template <class _Container, class _InputIter, class _Compare>
+_Container& set_assign_union(_Container& dest,
+                             _InputIter first,
+                             _InputIter last,
+                             _Compare comp)
+{
+    detail::set_assign_union(
+        dest, first, last, comp,
+        std::integral_constant<
+            bool, detail::is_random_access_sequence<_Container>::value>{});
     return dest;
 }
 
+/**
+ * Adds the elements of a sorted range to a sorted container.  An
+ * associative container is compared with its \c value_comp, and other
+ * containers with \c operator<.
+ *
+ * @param dest   the sorted container
+ * @param first  beginning of the sorted range
+ * @param last   end of the range
+ * @return       \a dest
+ */
+template <class _Container, class _InputIter>
+_Container& set_assign_union(_Container& dest,
+                             _InputIter first,
+                             _InputIter last)
+{
+    return set_assign_union(
+        dest, first, last,
+        detail::set_assign_compare(
+            dest, std::integral_constant<
+                      bool, detail::is_associative<_Container>::value>{}));
+}
+
+/**
+ * Removes the elements of a sorted range from a sorted container (like
+ * \c std::set_difference, but in place).  A sequence with
+ * random-access iterators and \c push_back (like \c std::vector) is
+ * compacted in linear time; other containers get element-wise
+ * erasures.
+ *
+ * @param dest   the container sorted by \a comp
+ * @param first  beginning of the range sorted by \a comp
+ * @param last   end of the range
+ * @param comp   the comparison object
+ * @return       \a dest
+ */
 template <class _Container, class _InputIter, class _Compare>
 _Container& set_assign_difference(_Container& dest,
                                   _InputIter first,
                                   _InputIter last,
                                   _Compare comp)
 {
-    typename _Container::iterator first_dest = dest.begin();
-    typename _Container::iterator  last_dest = dest.end();
-    while (first_dest != last_dest && first != last) {
-        if (comp(*first_dest, *first)) {
-            ++first_dest;
-        } else if (comp(*first, *first_dest)) {
-            ++first;
-        } else {  // *first_dest is equivalent to *first
-            dest.erase(first_dest++);
-            ++first;
-        }
-    }
+    detail::set_assign_difference(
+        dest, first, last, comp,
+        std::integral_constant<
+            bool, detail::is_random_access_sequence<_Container>::value>{});
     return dest;
 }
 
+/**
+ * Removes the elements of a sorted range from a sorted container.  An
+ * associative container is compared with its \c value_comp, and other
+ * containers with \c operator<.
+ *
+ * @param dest   the sorted container
+ * @param first  beginning of the sorted range
+ * @param last   end of the range
+ * @return       \a dest
+ */
+template <class _Container, class _InputIter>
+_Container& set_assign_difference(_Container& dest,
+                                  _InputIter first,
+                                  _InputIter last)
+{
+    return set_assign_difference(
+        dest, first, last,
+        detail::set_assign_compare(
+            dest, std::integral_constant<
+                      bool, detail::is_associative<_Container>::value>{}));
+}
+
 NVWA_NAMESPACE_END
 
 #endif // NVWA_SET_ASSIGN_H
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2020-2023 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2020-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -39,14 +39,29 @@
  * }
  * @endcode
  *
- * @date  2023-01-20
+ * For CSV/TSV records, split_fields splits on a set of delimiter
+ * characters, optionally not splitting inside quotes:
+ * @code
+ * for (auto field : nvwa::split_fields(a_line, ",;", '"')) {
+ *     // Process field (nvwa::unquote_field gets the content)
+ * }
+ * @endcode
+ *
+ * In a loop over many records, split_into (which reuses the capacity of
+ * a container) and split_n (which stores at most a fixed number of items
+ * in a std::array) avoid the heap allocations of to_vector.
+ *
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_SPLIT_H
 #define NVWA_SPLIT_H
 
 #include <assert.h>             // assert
-#include <stddef.h>             // ptrdiff_t
+#include <stddef.h>             // ptrdiff_t/size_t
+#include <stdint.h>             // uint64_t
+#include <string.h>             // memcpy/memset
+#include <array>                // std::array
 #include <iterator>             // std::input_iterator_tag
 #include <string>               // std::basic_string
 #include <string_view>          // std::basic_string_view
@@ -55,8 +70,101 @@
 #include "_nvwa.h"              // NVWA_NAMESPACE_*
 #include "c++_features.h"       // HAVE_CXX20_RANGES
 
+#ifndef NVWA_SPLIT_USES_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NVWA_SPLIT_USES_SSE2 1
+#else
+#define NVWA_SPLIT_USES_SSE2 0
+#endif
+#endif
+
+#if NVWA_SPLIT_USES_SSE2
+#include <emmintrin.h>          // SSE2 intrinsics
+#endif
+
 NVWA_NAMESPACE_BEGIN
 
+/**
+ * Result of a split into at most a fixed number of items, which needs no
+ * heap allocations.  When the input has more items, the last one holds
+ * the rest of the input unsplit.
+ *
+ * @param _CharType  the character type
+ * @param _Nm        the maximum number of items
+ */
+template <typename _CharType, size_t _Nm>
+struct fixed_split_result {
+    typedef std::basic_string_view<_CharType> value_type;
+    typedef const value_type*                 const_iterator;
+
+    std::array<value_type, _Nm> items{};    ///< Items split from the input
+    size_t                      count{};    ///< Number of valid items
+
+    const_iterator begin() const noexcept
+    {
+        return items.data();
+    }
+    const_iterator end() const noexcept
+    {
+        return items.data() + count;
+    }
+    size_t size() const noexcept
+    {
+        return count;
+    }
+    const value_type& operator[](size_t n) const noexcept
+    {
+        assert(n < count);
+        return items[n];
+    }
+};
+
+namespace detail {
+
+/**
+ * Stores the items of a split view into a container.  Existing elements
+ * are assigned to instead of recreated, so that the capacity of both the
+ * container and its strings are reused.
+ */
+template <typename _View, typename _Container>
+size_t split_into(const _View& view, _Container& result)
+{
+    size_t count = 0;
+    for (const auto& sv : view) {
+        if (count < result.size()) {
+            result[count] = sv;
+        } else {
+            result.emplace_back(sv);
+        }
+        ++count;
+    }
+    result.resize(count);
+    return count;
+}
+
+/** Stores the first \a _Nm - 1 items of a split view and the rest. */
+template <size_t _Nm, typename _CharType, typename _View>
+fixed_split_result<_CharType, _Nm>
+split_n(const _View& view, std::basic_string_view<_CharType> src)
+{
+    static_assert(_Nm > 0, "At least one item shall be allowed");
+    fixed_split_result<_CharType, _Nm> result;
+    auto it = view.begin();
+    auto last = view.end();
+    for (; it != last && result.count < _Nm - 1; ++it) {
+        result.items[result.count++] = *it;
+    }
+    if (it != last) {
+        const _CharType* start = it->data();
+        result.items[result.count++] = std::basic_string_view<_CharType>(
+            start, static_cast<size_t>(src.data() + src.size() - start));
+    }
+    return result;
+}
+
+} /* namespace detail */
+
 /**
  * Class to allow iteration over split items from the input.
  *
@@ -202,6 +310,31 @@ public:
         return result;
     }
 
+    /**
+     * Stores the split items into a container, reusing its capacity.
+     *
+     * @param[out] result  container of strings or string_views, which
+     *                     will hold exactly the split items
+     * @return             the number of items
+     */
+    template <typename _Container>
+    size_t split_into(_Container& result) const
+    {
+        return detail::split_into(*this, result);
+    }
+    /**
+     * Splits into at most \a _Nm items without heap allocations.
+     *
+     * @return  the split items, the last of which is the rest of the
+     *          input when there are more than \a _Nm items
+     */
+    template <size_t _Nm>
+    fixed_split_result<char_type, _Nm> split_n() const
+    {
+        return detail::split_n<_Nm>(
+            *this, std::basic_string_view<char_type>(*_M_src));
+    }
+
 private:
     const string_type* _M_src{};
     delimiter_type     _M_delimiter{};
@@ -222,6 +355,383 @@ split(const _StringType& src, _DelimiterType delimiter) noexcept
     return basic_split_view<_StringType, _DelimiterType>(src, delimiter);
 }
 
+/**
+ * Splits a string (or string_view) into at most \a _Nm items without heap
+ * allocations.  The items refer to the source input.
+ *
+ * @param src        the source input to be split
+ * @param delimiter  delimiter used to split \a src; its type should be
+ *                   the same as that of \a src, or its character type
+ * @return           the split items, the last of which is the rest of
+ *                   \a src when there are more than \a _Nm items
+ */
+template <size_t _Nm, typename _StringType, typename _DelimiterType>
+fixed_split_result<typename _StringType::value_type, _Nm>
+split_n(const _StringType& src, _DelimiterType delimiter)
+{
+    return split(src, delimiter).template split_n<_Nm>();
+}
+
+namespace detail {
+
+/**
+ * Class to classify the characters in 64-byte blocks, so that field
+ * boundaries are found with bit operations instead of per-character
+ * branches (the approach used by simdjson).
+ */
+class field_classifier {
+public:
+    /** Maximum number of delimiters compared with SIMD instructions. */
+    static constexpr size_t max_simd_delimiters = 4;
+
+    field_classifier(std::string_view delimiters, int quote) noexcept
+        : _M_delimiters(delimiters), _M_quote(quote)
+    {
+        // The table is not needed (nor initialized) for SIMD comparisons,
+        // which makes a classifier cheap to create for each record
+        if (!NVWA_SPLIT_USES_SSE2 ||
+            delimiters.size() > max_simd_delimiters) {
+            memset(_M_is_delimiter, 0, sizeof _M_is_delimiter);
+            for (char ch : delimiters) {
+                _M_is_delimiter[static_cast<unsigned char>(ch)] = true;
+            }
+        }
+    }
+
+    bool has_quote() const noexcept
+    {
+        return _M_quote >= 0;
+    }
+
+    /**
+     * Gets the masks of the delimiters and quotes in a block.  Bit \e n
+     * of a mask corresponds to <code>ptr[n]</code>.
+     *
+     * @param ptr               pointer to 64 readable bytes
+     * @param[out] delim_mask   mask of the delimiters
+     * @param[out] quote_mask   mask of the quotes
+     */
+    void classify(const char* ptr, uint64_t& delim_mask,
+                  uint64_t& quote_mask) const noexcept
+    {
+        delim_mask = 0;
+        quote_mask = 0;
+#if NVWA_SPLIT_USES_SSE2
+        if (_M_delimiters.size() <= max_simd_delimiters) {
+            __m128i quote = _mm_set1_epi8(static_cast<char>(_M_quote));
+            for (int i = 0; i < 64; i += 16) {
+                __m128i chunk = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(ptr + i));
+                __m128i found = _mm_setzero_si128();
+                for (char ch : _M_delimiters) {
+                    found = _mm_or_si128(
+                        found, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(ch)));
+                }
+                delim_mask |= uint64_t(static_cast<uint16_t>(
+                                  _mm_movemask_epi8(found)))
+                              << i;
+                if (has_quote()) {
+                    quote_mask |= uint64_t(static_cast<uint16_t>(
+                                      _mm_movemask_epi8(
+                                          _mm_cmpeq_epi8(chunk, quote))))
+                                  << i;
+                }
+            }
+            return;
+        }
+#endif
+        for (int i = 0; i < 64; ++i) {
+            auto ch = static_cast<unsigned char>(ptr[i]);
+            delim_mask |= uint64_t(_M_is_delimiter[ch]) << i;
+            quote_mask |= uint64_t(ch == _M_quote) << i;
+        }
+    }
+
+private:
+    std::string_view _M_delimiters;
+    int              _M_quote;
+    bool             _M_is_delimiter[256];
+};
+
+/** Calculates the prefix xor: bit \e n is the parity of bits 0 to \e n. */
+inline uint64_t prefix_xor(uint64_t value) noexcept
+{
+    value ^= value << 1;
+    value ^= value << 2;
+    value ^= value << 4;
+    value ^= value << 8;
+    value ^= value << 16;
+    value ^= value << 32;
+    return value;
+}
+
+/** Calculates at which offset the first 1-bit is in a non-zero word. */
+inline int first_bit_one_offset(uint64_t value) noexcept
+{
+    assert(value != 0);
+#if NVWA_GCC || NVWA_CLANG
+    return __builtin_ctzll(value);
+#else
+    int offset = 0;
+    while ((value & 1) == 0) {
+        value >>= 1;
+        ++offset;
+    }
+    return offset;
+#endif
+}
+
+} /* namespace detail */
+
+/**
+ * Class to allow iteration over the fields of a record.  The fields are
+ * separated by any of a set of delimiter characters, and delimiters
+ * between quotes (as in CSV) optionally do not split.  The input is
+ * classified 64 bytes at a time into bit masks, and each field is then
+ * found with a bit scan.  The fields are returned as they appear in the
+ * input, including any quotes; see nvwa#unquote_field.
+ */
+class field_split_view {
+public:
+    /**
+     * Iterator over the fields.  The view shall be alive when the
+     * iterator is used.
+     */
+    class iterator {  // implements ForwardIterator
+    public:
+        typedef ptrdiff_t                 difference_type;
+        typedef std::string_view          value_type;
+        typedef const value_type*         pointer;
+        typedef const value_type&         reference;
+        typedef std::forward_iterator_tag iterator_category;
+
+        iterator() = default;
+        explicit iterator(const field_split_view* view)
+            : _M_view(view), _M_pos(0)
+        {
+            load_block(0);
+            ++*this;
+        }
+
+        reference operator*() const noexcept
+        {
+            assert(_M_view != nullptr);
+            return _M_cur;
+        }
+        pointer operator->() const noexcept
+        {
+            assert(_M_view != nullptr);
+            return &_M_cur;
+        }
+        iterator& operator++()
+        {
+            assert(_M_view != nullptr);
+            if (_M_pos == std::string_view::npos) {
+                _M_view = nullptr;
+                return *this;
+            }
+            std::string_view src = _M_view->_M_src;
+            while (_M_mask == 0) {
+                size_t next_block = _M_block_pos + 64;
+                if (next_block >= src.size()) {
+                    _M_cur = src.substr(_M_pos);
+                    _M_pos = std::string_view::npos;
+                    return *this;
+                }
+                load_block(next_block);
+            }
+            size_t end =
+                _M_block_pos + detail::first_bit_one_offset(_M_mask);
+            _M_mask &= _M_mask - 1;
+            _M_cur = src.substr(_M_pos, end - _M_pos);
+            _M_pos = end + 1;
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator temp(*this);
+            ++*this;
+            return temp;
+        }
+
+        bool operator==(const iterator& rhs) const noexcept
+        {
+            return _M_view == rhs._M_view && _M_pos == rhs._M_pos;
+        }
+        bool operator!=(const iterator& rhs) const noexcept
+        {
+            return !operator==(rhs);
+        }
+
+    private:
+        void load_block(size_t block_pos) noexcept
+        {
+            std::string_view src = _M_view->_M_src;
+            const char* ptr = src.data() + block_pos;
+            size_t remaining = src.size() - block_pos;
+            char buffer[64];
+            if (remaining < 64) {
+                if (remaining != 0) {
+                    memcpy(buffer, ptr, remaining);
+                }
+                memset(buffer + remaining, 0, 64 - remaining);
+                ptr = buffer;
+            }
+            uint64_t delim_mask;
+            uint64_t quote_mask;
+            _M_view->_M_classifier.classify(ptr, delim_mask, quote_mask);
+            if (remaining < 64) {
+                uint64_t valid_mask = (uint64_t(1) << remaining) - 1;
+                delim_mask &= valid_mask;
+                quote_mask &= valid_mask;
+            }
+            if (_M_view->_M_classifier.has_quote()) {
+                // Bits between an opening quote and a closing quote
+                uint64_t inside =
+                    detail::prefix_xor(quote_mask) ^ _M_inside_quote;
+                _M_inside_quote = uint64_t(0) - (inside >> 63);
+                delim_mask &= ~inside;
+            }
+            _M_block_pos = block_pos;
+            _M_mask = delim_mask;
+        }
+
+        const field_split_view* _M_view{};
+        size_t                  _M_pos{std::string_view::npos};
+        size_t                  _M_block_pos{};
+        uint64_t                _M_mask{};          ///< Delimiters left
+        uint64_t                _M_inside_quote{};  ///< All-ones if inside
+        value_type              _M_cur;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param src         the record to split
+     * @param delimiters  the characters that separate fields
+     * @param quote       the quote character, or \c -1 if quotes are
+     *                    not special
+     */
+    field_split_view(std::string_view src, std::string_view delimiters,
+                     int quote = -1) noexcept
+        : _M_src(src), _M_classifier(delimiters, quote)
+    {
+    }
+
+    iterator begin() const
+    {
+        return iterator(this);
+    }
+    iterator end() const noexcept
+    {
+        return {};
+    }
+
+    /** Converts the view to a string vector. */
+    std::vector<std::string> to_vector() const
+    {
+        std::vector<std::string> result;
+        for (const auto& sv : *this) {
+            result.emplace_back(sv);
+        }
+        return result;
+    }
+    /** Converts the view to a string_view vector. **/
+    std::vector<std::string_view> to_vector_sv() const
+    {
+        std::vector<std::string_view> result;
+        for (const auto& sv : *this) {
+            result.push_back(sv);
+        }
+        return result;
+    }
+
+    /**
+     * Stores the fields into a container, reusing its capacity.
+     *
+     * @param[out] result  container of strings or string_views, which
+     *                     will hold exactly the fields
+     * @return             the number of fields
+     */
+    template <typename _Container>
+    size_t split_into(_Container& result) const
+    {
+        return detail::split_into(*this, result);
+    }
+    /**
+     * Splits into at most \a _Nm fields without heap allocations.
+     *
+     * @return  the fields, the last of which is the rest of the record
+     *          when there are more than \a _Nm fields
+     */
+    template <size_t _Nm>
+    fixed_split_result<char, _Nm> split_n() const
+    {
+        return detail::split_n<_Nm>(*this, _M_src);
+    }
+
+private:
+    std::string_view         _M_src;
+    detail::field_classifier _M_classifier;
+};
+
+/**
+ * Splits a record into fields separated by any of the delimiters.  The
+ * source input and the delimiters shall remain unchanged when the
+ * generated field_split_view is used in anyway.
+ *
+ * @param src         the record to split, say, a line from mmap_line_view
+ * @param delimiters  the characters that separate fields
+ */
+inline field_split_view split_fields(std::string_view src,
+                                     std::string_view delimiters) noexcept
+{
+    return field_split_view(src, delimiters);
+}
+
+/**
+ * Splits a record into fields separated by any of the delimiters, except
+ * delimiters between quotes.  A quote inside a quoted field is written
+ * twice, as in CSV.  The source input and the delimiters shall remain
+ * unchanged when the generated field_split_view is used in anyway.
+ *
+ * @param src         the record to split, say, a line from mmap_line_view
+ * @param delimiters  the characters that separate fields
+ * @param quote       the quote character
+ */
+inline field_split_view split_fields(std::string_view src,
+                                     std::string_view delimiters,
+                                     char quote) noexcept
+{
+    return field_split_view(src, delimiters,
+                            static_cast<unsigned char>(quote));
+}
+
+/**
+ * Gets the content of a field returned by split_fields.  Surrounding
+ * quotes are removed, and doubled quotes inside are made single.
+ *
+ * @param field  the field to unquote
+ * @param quote  the quote character
+ * @return       the content of the field
+ */
+inline std::string unquote_field(std::string_view field, char quote = '"')
+{
+    if (field.size() < 2 || field.front() != quote ||
+        field.back() != quote) {
+        return std::string(field);
+    }
+    std::string result;
+    result.reserve(field.size() - 2);
+    for (size_t i = 1; i < field.size() - 1; ++i) {
+        result += field[i];
+        if (field[i] == quote && field[i + 1] == quote) {
+            ++i;
+        }
+    }
+    return result;
+}
+
 NVWA_NAMESPACE_END
 
 #if HAVE_CXX20_RANGES
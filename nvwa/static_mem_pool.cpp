@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2019 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -31,7 +31,7 @@
  *
  * Non-template and non-inline code for the `static' memory pool.
  *
- * @date  2019-08-22
+ * @date  2026-10-14
  */
 
 #include "static_mem_pool.h"    // nvwa::static_mem_pool_set
@@ -83,15 +83,73 @@ void static_mem_pool_set::recycle()
     }
 }
 
+/**
+ * Asks all locking static memory pools to return their idle memory
+ * blocks to the system, keeping at most \a max_idle idle blocks each.
+ * Unlike recycle, it shall be called without the lock, which it takes
+ * only to get a copy of the list of memory pools.  Non-locking memory
+ * pools (those with a non-negative group ID) are skipped, as they may
+ * only be used by their owning threads, and it may run in a background
+ * thread (see nvwa#static_mem_pool_reclaimer).  They can be trimmed by
+ * calling static_mem_pool::trim from their owning threads instead.
+ *
+ * @param max_idle  maximum number of idle blocks to keep in each pool
+ * @see             static_mem_pool::trim
+ */
+void static_mem_pool_set::trim(size_t max_idle)
+{
+    container_type memory_pool_set;
+    {
+        lock guard;
+        memory_pool_set = _M_locking_pool_set;
+    }
+    container_type::iterator end = memory_pool_set.end();
+    for (container_type::iterator
+            i  = memory_pool_set.begin();
+            i != end; ++i) {
+        (*i)->trim(max_idle);
+    }
+}
+
 /**
  * Adds a new memory pool to nvwa#static_mem_pool_set.
  *
  * @param memory_pool_p  pointer to the memory pool to add
+ * @param is_locking     whether the memory pool protects simultaneous
+ *                       accesses, so that it can be trimmed from any
+ *                       thread
  */
-void static_mem_pool_set::add(mem_pool_base* memory_pool_p)
+void static_mem_pool_set::add(mem_pool_base* memory_pool_p, bool is_locking)
 {
     lock guard;
+    if (is_locking) {
+        _M_locking_pool_set.reserve(_M_locking_pool_set.size() + 1);
+    }
     _M_memory_pool_set.push_back(memory_pool_p);
+    if (is_locking) {
+        _M_locking_pool_set.push_back(memory_pool_p);
+    }
+}
+
+/**
+ * Gets the run-time statistics of all static memory pools that provide
+ * them (when #_MEM_POOL_STATS is non-zero).
+ *
+ * @param[out] result  the statistics of the memory pools
+ */
+void static_mem_pool_set::get_stats(std::vector<mem_pool_stats>& result)
+{
+    lock guard;
+    result.clear();
+    mem_pool_stats stats;
+    container_type::iterator end = _M_memory_pool_set.end();
+    for (container_type::iterator
+            i  = _M_memory_pool_set.begin();
+            i != end; ++i) {
+        if ((*i)->get_stats(stats)) {
+            result.push_back(stats);
+        }
+    }
 }
 
 NVWA_NAMESPACE_END
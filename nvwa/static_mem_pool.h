@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2004-2021 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2004-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -31,7 +31,7 @@
  *
  * Header file for the `static' memory pool.
  *
- * @date  2021-08-01
+ * @date  2026-10-15
  */
 
 #ifndef NVWA_STATIC_MEM_POOL_H
@@ -42,9 +42,12 @@
 #include <vector>               // std::vector
 #include <assert.h>             // assert
 #include <stddef.h>             // size_t
+#include <stdint.h>             // uintptr_t
+#include <stdio.h>              // fprintf/stderr
 #include "_nvwa.h"              // NVWA/NVWA_NAMESPACE_*
-#include "c++_features.h"       // _DELETED/_NOEXCEPT/_NULLPTR/_OVERRIDE
-#include "class_level_lock.h"   // nvwa::class_level_lock
+#include "c++_features.h"       // _DELETED/_NOEXCEPT/_NULLPTR/_OVERRIDE/
+                                // HAVE_CXX11_ATOMIC/HAVE_CXX11_THREAD_LOCAL
+#include "class_level_lock.h"   // nvwa::class_level_lock/_NOTHREADS
 #include "mem_pool_base.h"      // nvwa::mem_pool_base
 
 /* Defines the macro for debugging output */
@@ -64,6 +67,126 @@
         ((void)0)
 # endif
 
+# ifndef _STATIC_MEM_POOL_THREAD_CACHE
+/**
+ * Macro to control whether a per-thread cache (magazine) of free memory
+ * blocks is put in front of the shared free list of each locking
+ * static_mem_pool.  Defining it to a non-zero value will enable the
+ * cache, so that most allocations and deallocations do not need to take
+ * the pool lock, and blocks are moved between the cache and the shared
+ * list in batches.  It has no effect on non-locking pools (when the
+ * group ID is non-negative) or in single-threaded builds.
+ */
+#   define _STATIC_MEM_POOL_THREAD_CACHE 0
+# endif
+
+# ifndef _STATIC_MEM_POOL_MAGAZINE_SIZE
+/**
+ * Maximum number of free memory blocks a thread can cache for one
+ * static_mem_pool.  Half of it is moved in each batch.
+ */
+#   define _STATIC_MEM_POOL_MAGAZINE_SIZE 64
+# endif
+
+# if _STATIC_MEM_POOL_THREAD_CACHE && defined(_NOTHREADS)
+#   undef  _STATIC_MEM_POOL_THREAD_CACHE
+#   define _STATIC_MEM_POOL_THREAD_CACHE 0
+# endif
+
+# if _STATIC_MEM_POOL_THREAD_CACHE && !HAVE_CXX11_THREAD_LOCAL
+#   error "_STATIC_MEM_POOL_THREAD_CACHE requires thread_local support"
+# endif
+
+# ifndef _STATIC_MEM_POOL_CHUNK_SIZE
+/**
+ * Size in bytes of the memory chunks that static_mem_pool requests from
+ * the system when its free list is empty.  A chunk is carved into as
+ * many blocks as it can hold, and all chunks are tracked so that they
+ * can be released when all of their blocks are free.  Defining it to
+ * zero (the default) makes the pool request one block at a time.
+ */
+#   define _STATIC_MEM_POOL_CHUNK_SIZE 0
+# endif
+
+# ifndef _STATIC_MEM_POOL_HUGE_PAGES
+/**
+ * Macro to control whether the chunks of static_mem_pool are backed by
+ * huge pages when possible (see nvwa#huge_page_malloc).  It requires a
+ * non-zero #_STATIC_MEM_POOL_CHUNK_SIZE, which should be at least the
+ * huge page size to be effective, and linking aligned_memory.cpp.
+ */
+#   define _STATIC_MEM_POOL_HUGE_PAGES 0
+# endif
+
+# ifndef _STATIC_MEM_POOL_MAX_IDLE
+/**
+ * Maximum number of idle blocks that each static_mem_pool keeps in its
+ * shared free list.  When it is non-zero, blocks deallocated to a full
+ * list are returned to the system at once, without walking the list.
+ * It has no effect when #_STATIC_MEM_POOL_CHUNK_SIZE is non-zero, as
+ * chunks can only be returned as a whole (by static_mem_pool_set::trim
+ * or recycle).  Nor does it affect the lock-free free lists (see
+ * #_STATIC_MEM_POOL_LOCK_FREE), as another thread may still be reading
+ * a block just taken from them; trim can release their blocks safely.
+ * Zero (the default) means no limit.
+ */
+#   define _STATIC_MEM_POOL_MAX_IDLE 0
+# endif
+
+# if _STATIC_MEM_POOL_HUGE_PAGES && !_STATIC_MEM_POOL_CHUNK_SIZE
+#   error "_STATIC_MEM_POOL_HUGE_PAGES requires _STATIC_MEM_POOL_CHUNK_SIZE"
+# endif
+
+# ifndef _STATIC_MEM_POOL_LOCK_FREE
+/**
+ * Macro to control whether the shared free list of each locking
+ * static_mem_pool is a lock-free stack.  Defining it to a non-zero value
+ * will make allocate and deallocate use compare-and-swap operations on
+ * a tagged pointer (immune to the ABA problem) instead of the pool lock.
+ * The lock is then only used to serialize recycle.  It has no effect on
+ * non-locking pools (when the group ID is non-negative) or in
+ * single-threaded builds.
+ */
+#   define _STATIC_MEM_POOL_LOCK_FREE 0
+# endif
+
+# if _STATIC_MEM_POOL_LOCK_FREE && defined(_NOTHREADS)
+#   undef  _STATIC_MEM_POOL_LOCK_FREE
+#   define _STATIC_MEM_POOL_LOCK_FREE 0
+# endif
+
+# if _STATIC_MEM_POOL_LOCK_FREE
+#   if !HAVE_CXX11_ATOMIC
+#     error "_STATIC_MEM_POOL_LOCK_FREE requires atomic support"
+#   endif
+#   include <atomic>            // std::atomic
+#   include <thread>            // std::this_thread::yield
+# endif
+
+/*
+ * The configuration macros above are put into the name of the namespace
+ * that static_mem_pool is defined in, so that translation units built
+ * with different configurations get distinct pool types (and distinct
+ * pools), instead of conflicting definitions of the same type.  For
+ * this reason, their values shall be plain integer literals.
+ */
+# define _STATIC_MEM_POOL_CONFIG_NAME_(_Tc, _Mag, _Chunk, _Huge, \
+                                       _Idle, _Lf, _Stats) \
+    static_mem_pool_##_Tc##_##_Mag##_##_Chunk##_##_Huge##_##_Idle \
+                    ##_##_Lf##_##_Stats
+# define _STATIC_MEM_POOL_CONFIG_NAME(_Tc, _Mag, _Chunk, _Huge, \
+                                      _Idle, _Lf, _Stats) \
+    _STATIC_MEM_POOL_CONFIG_NAME_(_Tc, _Mag, _Chunk, _Huge, \
+                                  _Idle, _Lf, _Stats)
+# define _STATIC_MEM_POOL_CONFIG_NS \
+    _STATIC_MEM_POOL_CONFIG_NAME(_STATIC_MEM_POOL_THREAD_CACHE, \
+                                 _STATIC_MEM_POOL_MAGAZINE_SIZE, \
+                                 _STATIC_MEM_POOL_CHUNK_SIZE, \
+                                 _STATIC_MEM_POOL_HUGE_PAGES, \
+                                 _STATIC_MEM_POOL_MAX_IDLE, \
+                                 _STATIC_MEM_POOL_LOCK_FREE, \
+                                 _MEM_POOL_STATS)
+
 NVWA_NAMESPACE_BEGIN
 
 /**
@@ -72,10 +195,13 @@ NVWA_NAMESPACE_BEGIN
  */
 class static_mem_pool_set {
 public:
-    typedef class_level_lock<static_mem_pool_set>::lock lock;
+    typedef class_level_lock<static_mem_pool_set, true,
+                             adaptive_fast_mutex>::lock lock;
     static static_mem_pool_set& instance();
     void recycle();
-    void add(mem_pool_base* memory_pool_p);
+    void trim(size_t max_idle);
+    void add(mem_pool_base* memory_pool_p, bool is_locking = false);
+    void get_stats(std::vector<mem_pool_stats>& result);
 
 private:
     static_mem_pool_set();
@@ -83,12 +209,172 @@ private:
 
     typedef std::vector<mem_pool_base*> container_type;
     container_type _M_memory_pool_set;
+    container_type _M_locking_pool_set;
 
     /* Forbid their use */
     static_mem_pool_set(const static_mem_pool_set&);
     const static_mem_pool_set& operator=(const static_mem_pool_set&);
 };
 
+#if _STATIC_MEM_POOL_LOCK_FREE
+/**
+ * Lock-free stack of free memory blocks, used as the shared free list
+ * of static_mem_pool when #_STATIC_MEM_POOL_LOCK_FREE is non-zero.  The
+ * head pointer carries a modification tag, so that a pop cannot succeed
+ * on a head that has been popped and pushed back in the meantime.
+ *
+ * A pop may still read the link of a block that another thread has
+ * just popped, in which case its compare-and-swap fails and the value
+ * read is discarded.  The link of the top block is therefore accessed
+ * with relaxed atomic operations.  The read is harmless as long as the
+ * block is not returned to the system, so the pops in progress are
+ * counted, and take_all waits for those that can be looking at the
+ * blocks it takes.  Pops are counted in one of two counters, selected
+ * by a phase that take_all flips, so that new pops cannot keep it
+ * waiting.
+ */
+class lock_free_block_stack {
+public:
+    typedef mem_pool_base::_Block_list _Block_list;
+
+    lock_free_block_stack() : _M_head(_Tagged_ptr()), _M_phase(0)
+    {
+        _M_pop_cnt[0].store(0, std::memory_order_relaxed);
+        _M_pop_cnt[1].store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Pops a block.
+     *
+     * @return  pointer to the popped block; or null if the stack is empty
+     */
+    _Block_list* pop()
+    {
+        std::atomic<int>& pop_cnt = _M_pop_cnt[_M_phase.load()];
+        pop_cnt.fetch_add(1);
+        _Tagged_ptr head = _M_head.load();
+        _Block_list* block;
+        while ((block = _S_get_ptr(head)) != _NULLPTR) {
+            _Tagged_ptr next = _S_make_next(head, _S_load_next(block));
+            if (_M_head.compare_exchange_weak(head, next)) {
+                break;
+            }
+        }
+        pop_cnt.fetch_sub(1, std::memory_order_release);
+        return block;
+    }
+    /**
+     * Pushes a chain of blocks.
+     *
+     * @param first  the first block in the chain
+     * @param last   the last block in the chain
+     */
+    void push(_Block_list* first, _Block_list* last)
+    {
+        _Tagged_ptr head = _M_head.load(std::memory_order_relaxed);
+        for (;;) {
+            _S_store_next(last, _S_get_ptr(head));
+            if (_M_head.compare_exchange_weak(head,
+                                              _S_make_next(head, first),
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+                break;
+            }
+        }
+    }
+    /**
+     * Takes all blocks out of the stack.  As pops in progress may still
+     * be reading the blocks, it waits for them to finish before
+     * returning, so that the blocks can be safely returned to the
+     * system.  Pops starting after the blocks are taken do not delay
+     * it.  It shall not be called concurrently with itself (the pool
+     * lock serializes the calls).
+     *
+     * @return  pointer to the first block of the chain taken; or null if
+     *          the stack is empty
+     */
+    _Block_list* take_all()
+    {
+        _Tagged_ptr head = _M_head.load();
+        while (!_M_head.compare_exchange_weak(
+                    head, _S_make_next(head, _NULLPTR))) {
+        }
+        _Block_list* first = _S_get_ptr(head);
+        if (first == _NULLPTR) {
+            return _NULLPTR;
+        }
+        // Only the pops counted before the phase is flipped can have
+        // loaded a head in the chain taken.
+        int phase = _M_phase.load();
+        _M_phase.store(phase ^ 1);
+        while (_M_pop_cnt[phase].load() != 0) {
+            std::this_thread::yield();
+        }
+        return first;
+    }
+
+private:
+#   if (defined(__x86_64__) || defined(_M_X64)) && \
+            !defined(_STATIC_MEM_POOL_WIDE_TAG)
+    // User-space addresses on x86-64 fit in 48 bits, so the tag is put
+    // in the upper 16 bits, and a single-word compare-and-swap suffices.
+    typedef uintptr_t _Tagged_ptr;
+    static const uintptr_t _S_ptr_mask = (uintptr_t(1) << 48) - 1;
+
+    static _Block_list* _S_get_ptr(_Tagged_ptr value)
+    {
+        return reinterpret_cast<_Block_list*>(value & _S_ptr_mask);
+    }
+    static _Tagged_ptr _S_make_next(_Tagged_ptr old, _Block_list* ptr)
+    {
+        return ((old + (_S_ptr_mask + 1)) & ~_S_ptr_mask) |
+               reinterpret_cast<uintptr_t>(ptr);
+    }
+#   else
+    // A double-word compare-and-swap is needed for the pointer and the
+    // tag.  It is lock-free on most 32-bit platforms.
+    struct _Tagged_ptr {
+        _Block_list* _M_ptr;
+        uintptr_t    _M_tag;
+    };
+
+    static _Block_list* _S_get_ptr(_Tagged_ptr value)
+    {
+        return value._M_ptr;
+    }
+    static _Tagged_ptr _S_make_next(_Tagged_ptr old, _Block_list* ptr)
+    {
+        _Tagged_ptr result = {ptr, old._M_tag + 1};
+        return result;
+    }
+#   endif
+
+    typedef std::atomic<_Block_list*> _Atomic_link;
+    static_assert(sizeof(_Atomic_link) == sizeof(_Block_list*),
+                  "The link of a block cannot be accessed atomically");
+
+    static _Block_list* _S_load_next(_Block_list* block)
+    {
+        return reinterpret_cast<_Atomic_link*>(&block->_M_next)
+            ->load(std::memory_order_relaxed);
+    }
+    static void _S_store_next(_Block_list* block, _Block_list* next)
+    {
+        reinterpret_cast<_Atomic_link*>(&block->_M_next)
+            ->store(next, std::memory_order_relaxed);
+    }
+
+    std::atomic<_Tagged_ptr> _M_head;
+    std::atomic<int>         _M_phase;
+    std::atomic<int>         _M_pop_cnt[2];
+
+    lock_free_block_stack(const lock_free_block_stack&) _DELETED;
+    lock_free_block_stack& operator=(const lock_free_block_stack&) _DELETED;
+};
+#endif // _STATIC_MEM_POOL_LOCK_FREE
+
+namespace _STATIC_MEM_POOL_CONFIG_NS {
+
 /**
  * Singleton class template to manage the allocation/deallocation of
  * memory blocks of one specific size.
@@ -101,8 +387,22 @@ private:
  */
 template <size_t _Sz, int _Gid = -1>
 class static_mem_pool : public mem_pool_base {
-    typedef typename class_level_lock<static_mem_pool<_Sz, _Gid>, (_Gid < 0)>
-            ::lock lock;
+    typedef typename class_level_lock<static_mem_pool<_Sz, _Gid>, (_Gid < 0),
+                                      adaptive_fast_mutex>::lock lock;
+#   if _STATIC_MEM_POOL_LOCK_FREE
+    typedef typename class_level_lock<static_mem_pool<_Sz, _Gid>, false>
+            ::lock list_lock;
+#   else
+    typedef lock list_lock;
+#   endif
+#   if _MEM_POOL_STATS
+    /** Guard on list_lock that counts its contentions. */
+    struct _List_guard : list_lock {
+        _List_guard() : list_lock(_S_counters.contention_counter()) {}
+    };
+#   else
+    typedef list_lock _List_guard;
+#   endif
 public:
     /**
      * Gets the instance of the static memory pool.  It will create the
@@ -142,15 +442,15 @@ public:
      */
     void* allocate()
     {
-        {
-            lock guard;
-            if (_S_memory_block_p) {
-                void* result = _S_memory_block_p;
-                _S_memory_block_p = _S_memory_block_p->_M_next;
-                return result;
-            }
+#   if _MEM_POOL_STATS
+        void* result = _S_allocate();
+        if (result) {
+            _S_counters.on_allocate();
         }
-        return _S_alloc_sys(_S_align(_Sz));
+        return result;
+#   else
+        return _S_allocate();
+#   endif
     }
     /**
      * Deallocates memory by putting the memory block into the pool.
@@ -160,14 +460,81 @@ public:
     void deallocate(void* ptr)
     {
         assert(ptr != _NULLPTR);
-        lock guard;
-        _Block_list* block = reinterpret_cast<_Block_list*>(ptr);
-        block->_M_next = _S_memory_block_p;
-        _S_memory_block_p = block;
+#   if _MEM_POOL_STATS
+        _S_counters.on_deallocate();
+#   endif
+        _S_deallocate(ptr);
     }
     virtual void recycle() _OVERRIDE;
+    virtual void trim(size_t max_idle) _OVERRIDE;
+    virtual bool get_stats(mem_pool_stats& stats) const _OVERRIDE;
 
 private:
+    static void* _S_allocate()
+    {
+#   if _STATIC_MEM_POOL_THREAD_CACHE
+        if (_Gid < 0) {
+            _Thread_cache& cache = _S_thread_cache;
+            if (_Block_list* block = cache._M_head) {
+                cache._M_head = block->_M_next;
+                --cache._M_count;
+                return block;
+            }
+            if (cache._M_state != _Thread_cache::disabled) {
+                return _S_refill_cache(cache);
+            }
+        }
+#   endif
+        {
+            _List_guard guard;
+            if (_Block_list* block = _S_pop_block()) {
+                return block;
+            }
+        }
+        return _S_alloc_new_block();
+    }
+    static void _S_deallocate(void* ptr)
+    {
+        _Block_list* block = reinterpret_cast<_Block_list*>(ptr);
+#   if _STATIC_MEM_POOL_THREAD_CACHE
+        if (_Gid < 0) {
+            _Thread_cache& cache = _S_thread_cache;
+            if (cache._M_state == _Thread_cache::inactive) {
+                _S_activate_cache(cache);
+            }
+            if (cache._M_state == _Thread_cache::active) {
+                block->_M_next = cache._M_head;
+                cache._M_head = block;
+                if (++cache._M_count > _STATIC_MEM_POOL_MAGAZINE_SIZE) {
+                    _S_drain_cache(cache,
+                                   _STATIC_MEM_POOL_MAGAZINE_SIZE / 2);
+                }
+                return;
+            }
+        }
+#   endif
+#   if _STATIC_MEM_POOL_MAX_IDLE && !_STATIC_MEM_POOL_CHUNK_SIZE
+#     if _STATIC_MEM_POOL_LOCK_FREE
+        // A pop in progress may still read the link of a block taken
+        // from a lock-free list, so only trim can release such blocks.
+        if (_Gid >= 0)
+#     endif
+        {
+            {
+                _List_guard guard;
+                if (_S_idle_count() < _STATIC_MEM_POOL_MAX_IDLE) {
+                    _S_push_blocks(block, block, 1);
+                    return;
+                }
+            }
+            _S_dealloc_sys(block);
+            return;
+        }
+#   endif
+        _List_guard guard;
+        _S_push_blocks(block, block, 1);
+    }
+
     static_mem_pool()
     {
         _STATIC_MEM_POOL_TRACE(true, "static_mem_pool<" << _Sz << ','
@@ -178,13 +545,30 @@ private:
 #   ifdef _DEBUG
         // Empty the pool to avoid false memory leakage alarms.  This is
         // generally not necessary for release binaries.
-        _Block_list* block = _S_memory_block_p;
+#     if _STATIC_MEM_POOL_CHUNK_SIZE
+        // Chunks with blocks still in use are kept, so that objects
+        // leaked or freed late do not refer to freed memory, and they
+        // are reported instead.
+        _S_recycle_chunks();
+        size_t chunk_cnt = 0;
+        for (_Block_list* chunk = _S_chunk_p; chunk;
+                chunk = chunk->_M_next) {
+            ++chunk_cnt;
+        }
+        if (chunk_cnt != 0) {
+            fprintf(stderr, "static_mem_pool<%lu,%d>: %lu chunk(s) still "
+                            "in use on destruction\n",
+                    static_cast<unsigned long>(_Sz), _Gid,
+                    static_cast<unsigned long>(chunk_cnt));
+        }
+#     else
+        _Block_list* block = _S_take_blocks();
         while (block) {
             _Block_list* next = block->_M_next;
-            dealloc_sys(block);
+            _S_dealloc_sys(block);
             block = next;
         }
-        _S_memory_block_p = _NULLPTR;
+#     endif
 #   endif
         _S_instance_p = _NULLPTR;
         _S_destroyed = true;
@@ -195,12 +579,171 @@ private:
     {
         return size >= sizeof(_Block_list) ? size : sizeof(_Block_list);
     }
+    /** Pops a block from the shared list; list_lock must be held. */
+    static _Block_list* _S_pop_block()
+    {
+        _Block_list* block;
+#   if _STATIC_MEM_POOL_LOCK_FREE
+        if (_Gid < 0) {
+            block = _S_free_list.pop();
+        } else
+#   endif
+        {
+            block = _S_memory_block_p;
+            if (block) {
+                _S_memory_block_p = block->_M_next;
+            }
+        }
+        if (block) {
+            _S_adjust_idle_count(-1);
+        }
+        return block;
+    }
+    /**
+     * Pushes a chain of \a count blocks to the shared list; list_lock
+     * must be held.
+     */
+    static void _S_push_blocks(_Block_list* first, _Block_list* last,
+                               size_t count)
+    {
+#   if _STATIC_MEM_POOL_LOCK_FREE
+        if (_Gid < 0) {
+            _S_free_list.push(first, last);
+            _S_adjust_idle_count(static_cast<ptrdiff_t>(count));
+            return;
+        }
+#   endif
+        last->_M_next = _S_memory_block_p;
+        _S_memory_block_p = first;
+        _S_adjust_idle_count(static_cast<ptrdiff_t>(count));
+    }
+    /** Takes all blocks from the shared list; list_lock must be held. */
+    static _Block_list* _S_take_blocks()
+    {
+#   if _STATIC_MEM_POOL_LOCK_FREE
+        if (_Gid < 0) {
+            // Blocks may be pushed concurrently, so only the blocks
+            // actually taken are subtracted from the idle count.
+            _Block_list* first = _S_free_list.take_all();
+            ptrdiff_t count = 0;
+            for (_Block_list* block = first; block; block = block->_M_next) {
+                ++count;
+            }
+            _S_adjust_idle_count(-count);
+            return first;
+        }
+#   endif
+        _Block_list* block = _S_memory_block_p;
+        _S_memory_block_p = _NULLPTR;
+        _S_idle_cnt = 0;
+        return block;
+    }
+    /**
+     * Gets the (approximate, in the lock-free mode) number of blocks in
+     * the shared list.
+     */
+    static size_t _S_idle_count()
+    {
+#   if _STATIC_MEM_POOL_LOCK_FREE
+        ptrdiff_t count = _S_idle_cnt.load(std::memory_order_relaxed);
+        return count > 0 ? static_cast<size_t>(count) : 0;
+#   else
+        return _S_idle_cnt;
+#   endif
+    }
+    static void _S_adjust_idle_count(ptrdiff_t delta)
+    {
+#   if _STATIC_MEM_POOL_LOCK_FREE
+        _S_idle_cnt.fetch_add(delta, std::memory_order_relaxed);
+#   else
+        _S_idle_cnt += delta;
+#   endif
+    }
     static void* _S_alloc_sys(size_t size);
+    static void  _S_dealloc_sys(void* ptr);
+    static void* _S_alloc_new_block();
     static static_mem_pool* _S_create_instance();
 
+#   if _STATIC_MEM_POOL_CHUNK_SIZE
+    // The block size is rounded up to a multiple of the pointer size,
+    // and the blocks start at a max_align_t-aligned offset in a chunk.
+    // So a block is pointer-aligned, and also suitably aligned for any
+    // type of size _Sz that is not over-aligned (its alignment divides
+    // both _Sz and the block size), but it is not aligned to its own
+    // size in general.  The first bytes of a chunk link it into the
+    // chunk list.
+    static const size_t _S_block_size =
+        ((_Sz < sizeof(_Block_list) ? sizeof(_Block_list) : _Sz) +
+         sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    static const size_t _S_chunk_header_size =
+        (sizeof(_Block_list) + alignof(max_align_t) - 1) &
+        ~(alignof(max_align_t) - 1);
+    static const size_t _S_blocks_per_chunk =
+        _STATIC_MEM_POOL_CHUNK_SIZE >= _S_chunk_header_size + _S_block_size
+            ? (_STATIC_MEM_POOL_CHUNK_SIZE - _S_chunk_header_size) /
+              _S_block_size
+            : 1;
+    static const size_t _S_chunk_size =
+        _S_chunk_header_size + _S_blocks_per_chunk * _S_block_size;
+    static const size_t _S_blocks_per_sys_alloc = _S_blocks_per_chunk;
+
+    /** Tag type of the lock that serializes _S_recycle_chunks. */
+    struct _Recycle_tag {};
+    typedef typename class_level_lock<_Recycle_tag, (_Gid < 0),
+                                      adaptive_fast_mutex>::lock
+            recycle_lock;
+
+    static void* _S_alloc_chunk();
+    static void  _S_recycle_chunks();
+
+    static _Block_list* _S_chunk_p;
+#   else
+    static const size_t _S_blocks_per_sys_alloc = 1;
+#   endif
+
+#   if _STATIC_MEM_POOL_THREAD_CACHE
+    /**
+     * Per-thread cache of free memory blocks.  It is trivially
+     * destructible, so that it remains usable (in the disabled state)
+     * after the thread-exit cleanup by _Thread_cache_cleaner.
+     */
+    struct _Thread_cache {
+        enum state_t { inactive, active, disabled };
+        _Block_list* _M_head;   ///< First cached block
+        size_t       _M_count;  ///< Number of cached blocks
+        state_t      _M_state;  ///< Whether the cache can be used
+    };
+    /** Returns the cached blocks to the pool when a thread exits. */
+    struct _Thread_cache_cleaner {
+        ~_Thread_cache_cleaner()
+        {
+            _Thread_cache& cache = _S_thread_cache;
+            if (!_S_destroyed) {
+                _S_drain_cache(cache, 0);
+            }
+            cache._M_state = _Thread_cache::disabled;
+        }
+    };
+    static void  _S_activate_cache(_Thread_cache& cache);
+    static void* _S_refill_cache(_Thread_cache& cache);
+    static void  _S_drain_cache(_Thread_cache& cache, size_t keep);
+
+    static thread_local _Thread_cache _S_thread_cache;
+#   endif
+
+#   if _MEM_POOL_STATS
+    static mem_pool_counters _S_counters;
+#   endif
+
     static bool _S_destroyed;
     static static_mem_pool* _S_instance_p;
     static mem_pool_base::_Block_list* _S_memory_block_p;
+#   if _STATIC_MEM_POOL_LOCK_FREE
+    static lock_free_block_stack _S_free_list;
+    static std::atomic<ptrdiff_t> _S_idle_cnt;
+#   else
+    static size_t _S_idle_cnt;
+#   endif
 
     /* Forbid their use */
     static_mem_pool(const static_mem_pool&) _DELETED;
@@ -211,27 +754,95 @@ template <size_t _Sz, int _Gid> bool
         static_mem_pool<_Sz, _Gid>::_S_destroyed = false;
 template <size_t _Sz, int _Gid> mem_pool_base::_Block_list*
         static_mem_pool<_Sz, _Gid>::_S_memory_block_p = _NULLPTR;
+#if _STATIC_MEM_POOL_CHUNK_SIZE
+template <size_t _Sz, int _Gid> mem_pool_base::_Block_list*
+        static_mem_pool<_Sz, _Gid>::_S_chunk_p = _NULLPTR;
+#endif
 template <size_t _Sz, int _Gid> static_mem_pool<_Sz, _Gid>*
         static_mem_pool<_Sz, _Gid>::_S_instance_p = _S_create_instance();
+#if _STATIC_MEM_POOL_LOCK_FREE
+template <size_t _Sz, int _Gid> lock_free_block_stack
+        static_mem_pool<_Sz, _Gid>::_S_free_list;
+template <size_t _Sz, int _Gid> std::atomic<ptrdiff_t>
+        static_mem_pool<_Sz, _Gid>::_S_idle_cnt(0);
+#else
+template <size_t _Sz, int _Gid> size_t
+        static_mem_pool<_Sz, _Gid>::_S_idle_cnt = 0;
+#endif
+#if _MEM_POOL_STATS
+template <size_t _Sz, int _Gid> mem_pool_counters
+        static_mem_pool<_Sz, _Gid>::_S_counters;
+#endif
+#if _STATIC_MEM_POOL_THREAD_CACHE
+template <size_t _Sz, int _Gid>
+thread_local typename static_mem_pool<_Sz, _Gid>::_Thread_cache
+        static_mem_pool<_Sz, _Gid>::_S_thread_cache = {};
+#endif
 
 /**
  * Recycles half of the free memory blocks in the memory pool to the
  * system.  It is called when a memory request to the system (in other
- * instances of the static memory pool) fails.
+ * instances of the static memory pool) fails.  When memory is obtained
+ * in chunks (#_STATIC_MEM_POOL_CHUNK_SIZE is non-zero), the chunks all
+ * of whose blocks are free are recycled instead.
  */
 template <size_t _Sz, int _Gid>
 void static_mem_pool<_Sz, _Gid>::recycle()
 {
+#   if _STATIC_MEM_POOL_THREAD_CACHE
+    // Blocks cached by other threads cannot be reached here, but those
+    // of the current thread can be given back before recycling.
+    if (_Gid < 0) {
+        _S_drain_cache(_S_thread_cache, 0);
+    }
+#   endif
+
     // Only here the global lock in static_mem_pool_set is obtained
     // before the pool-specific lock.  However, no race conditions are
     // found so far.
+#   if _STATIC_MEM_POOL_CHUNK_SIZE
+    _S_recycle_chunks();
+    _STATIC_MEM_POOL_TRACE(false, "static_mem_pool<" << _Sz << ','
+                                  << _Gid << "> is recycled");
+    return;
+#   endif
     lock guard;
+#   if _STATIC_MEM_POOL_LOCK_FREE
+    // Concurrent allocations and deallocations are not blocked by the
+    // lock, so the blocks are taken out of the shared list first.
+    if (_Gid < 0) {
+        _Block_list* block = _S_take_blocks();
+        _Block_list* first = block;
+        size_t kept = 0;
+        while (block) {
+            ++kept;
+            if (_Block_list* temp = block->_M_next) {
+                _Block_list* next = temp->_M_next;
+                block->_M_next = next;
+                _S_dealloc_sys(temp);
+                if (!next) {
+                    break;
+                }
+                block = next;
+            } else {
+                break;
+            }
+        }
+        if (first) {
+            _S_push_blocks(first, block, kept);
+        }
+        _STATIC_MEM_POOL_TRACE(false, "static_mem_pool<" << _Sz << ','
+                                      << _Gid << "> is recycled");
+        return;
+    }
+#   endif
     _Block_list* block = _S_memory_block_p;
     while (block) {
         if (_Block_list* temp = block->_M_next) {
             _Block_list* next = temp->_M_next;
             block->_M_next = next;
-            dealloc_sys(temp);
+            _S_dealloc_sys(temp);
+            _S_adjust_idle_count(-1);
             block = next;
         } else {
             break;
@@ -241,18 +852,400 @@ void static_mem_pool<_Sz, _Gid>::recycle()
                                   << _Gid << "> is recycled");
 }
 
+/**
+ * Returns idle memory blocks in the shared free list to the system,
+ * until at most \a max_idle of them remain.  Unlike recycle, it takes
+ * the pool lock only for short batches of blocks (except in the
+ * lock-free mode, where all blocks have to be taken out first), so it
+ * can run periodically (say, from a static_mem_pool_reclaimer) without
+ * stalling allocations.  When memory is obtained in chunks, it recycles
+ * the chunks all of whose blocks are free, if there are enough idle
+ * blocks to fill a chunk beyond \a max_idle.  Blocks in thread caches
+ * are not affected.
+ *
+ * @param max_idle  maximum number of idle blocks to keep
+ */
+template <size_t _Sz, int _Gid>
+void static_mem_pool<_Sz, _Gid>::trim(size_t max_idle)
+{
+#   if _STATIC_MEM_POOL_CHUNK_SIZE
+    size_t idle_cnt;
+    {
+        list_lock guard;
+        idle_cnt = _S_idle_count();
+    }
+    if (idle_cnt >= max_idle + _S_blocks_per_chunk) {
+        _S_recycle_chunks();
+    }
+#   else
+#     if _STATIC_MEM_POOL_LOCK_FREE
+    if (_Gid < 0) {
+        lock guard;
+        if (_S_idle_count() <= max_idle) {
+            return;
+        }
+        _Block_list* block = _S_take_blocks();
+        if (block == _NULLPTR) {
+            return;
+        }
+        _Block_list* first = block;
+        _Block_list* last = _NULLPTR;
+        size_t kept = 0;
+        while (kept < max_idle && block) {
+            last = block;
+            block = block->_M_next;
+            ++kept;
+        }
+        if (last) {
+            last->_M_next = _NULLPTR;
+            _S_push_blocks(first, last, kept);
+        }
+        while (block) {
+            _Block_list* next = block->_M_next;
+            _S_dealloc_sys(block);
+            block = next;
+        }
+        return;
+    }
+#     endif
+    const size_t batch_size = 64;
+    size_t count;
+    do {
+        _Block_list* excess = _NULLPTR;
+        count = 0;
+        {
+            list_lock guard;
+            while (count < batch_size && _S_idle_count() > max_idle) {
+                _Block_list* block = _S_pop_block();
+                if (block == _NULLPTR) {
+                    break;
+                }
+                block->_M_next = excess;
+                excess = block;
+                ++count;
+            }
+        }
+        while (excess) {
+            _Block_list* next = excess->_M_next;
+            _S_dealloc_sys(excess);
+            excess = next;
+        }
+    } while (count == batch_size);
+#   endif
+}
+
+/**
+ * Gets the run-time statistics of the memory pool.  Blocks in thread
+ * caches are counted as free blocks.
+ *
+ * @param[out] stats  the statistics, if available
+ * @return            \c true if #_MEM_POOL_STATS is non-zero; \c false
+ *                    otherwise
+ */
+template <size_t _Sz, int _Gid>
+bool static_mem_pool<_Sz, _Gid>::get_stats(mem_pool_stats& stats) const
+{
+#   if _MEM_POOL_STATS
+    _S_counters.get(stats);
+    stats.block_size = _Sz;
+    stats.group_id = _Gid;
+    return true;
+#   else
+    (void)stats;
+    return false;
+#   endif
+}
+
 template <size_t _Sz, int _Gid>
 void* static_mem_pool<_Sz, _Gid>::_S_alloc_sys(size_t size)
 {
+    // The instance must be obtained before locking, as instance() itself
+    // takes the same lock.
+    static_mem_pool_set& pool_set = static_mem_pool_set::instance();
     static_mem_pool_set::lock guard;
-    void* result = mem_pool_base::alloc_sys(size);
+#   if _STATIC_MEM_POOL_HUGE_PAGES
+    void* (*const alloc)(size_t) = &mem_pool_base::alloc_sys_huge;
+#   else
+    void* (*const alloc)(size_t) = &mem_pool_base::alloc_sys;
+#   endif
+    void* result = alloc(size);
     if (!result) {
-        static_mem_pool_set::instance().recycle();
-        result = mem_pool_base::alloc_sys(size);
+        pool_set.recycle();
+        result = alloc(size);
+    }
+#   if _MEM_POOL_STATS
+    if (result) {
+        _S_counters.on_alloc_sys(_S_blocks_per_sys_alloc);
     }
+#   endif
     return result;
 }
 
+/**
+ * Returns to the system memory obtained by _S_alloc_sys, which is a
+ * chunk when #_STATIC_MEM_POOL_CHUNK_SIZE is non-zero, or a block
+ * otherwise.
+ *
+ * @param ptr  pointer to the memory to free
+ */
+template <size_t _Sz, int _Gid>
+inline void static_mem_pool<_Sz, _Gid>::_S_dealloc_sys(void* ptr)
+{
+#   if _MEM_POOL_STATS
+    _S_counters.on_dealloc_sys(_S_blocks_per_sys_alloc);
+#   endif
+#   if _STATIC_MEM_POOL_HUGE_PAGES
+    dealloc_sys_huge(ptr, _S_chunk_size);
+#   else
+    dealloc_sys(ptr);
+#   endif
+}
+
+/**
+ * Gets a new memory block from the system, when there are no free
+ * blocks in the pool.
+ *
+ * @return  pointer to allocated memory if successful; null otherwise
+ */
+template <size_t _Sz, int _Gid>
+void* static_mem_pool<_Sz, _Gid>::_S_alloc_new_block()
+{
+#   if _STATIC_MEM_POOL_CHUNK_SIZE
+    return _S_alloc_chunk();
+#   else
+    return _S_alloc_sys(_S_align(_Sz));
+#   endif
+}
+
+#if _STATIC_MEM_POOL_CHUNK_SIZE
+/**
+ * Gets a new chunk from the system, and carves it into blocks.  All
+ * blocks but the first are put into the shared free list.
+ *
+ * @return  pointer to the first block if successful; null otherwise
+ */
+template <size_t _Sz, int _Gid>
+void* static_mem_pool<_Sz, _Gid>::_S_alloc_chunk()
+{
+    char* chunk = static_cast<char*>(_S_alloc_sys(_S_chunk_size));
+    if (!chunk) {
+        return _NULLPTR;
+    }
+    char* first = chunk + _S_chunk_header_size;
+    _Block_list* last = reinterpret_cast<_Block_list*>(first);
+    for (size_t i = 1; i < _S_blocks_per_chunk; ++i) {
+        _Block_list* next =
+            reinterpret_cast<_Block_list*>(first + i * _S_block_size);
+        last->_M_next = next;
+        last = next;
+    }
+    lock guard;
+    _Block_list* header = reinterpret_cast<_Block_list*>(chunk);
+    header->_M_next = _S_chunk_p;
+    _S_chunk_p = header;
+    if (_S_blocks_per_chunk > 1) {
+        _S_push_blocks(reinterpret_cast<_Block_list*>(first)->_M_next,
+                       last, _S_blocks_per_chunk - 1);
+    }
+    _STATIC_MEM_POOL_TRACE(false, "static_mem_pool<" << _Sz << ','
+                                  << _Gid << "> gets a new chunk");
+    return first;
+}
+
+/**
+ * Returns to the system the chunks all of whose blocks are in the
+ * shared free list.  Both the free blocks and the chunks are sorted by
+ * address, so that a single pass can count the free blocks in each
+ * chunk.  The pool lock is held only to detach the free list and the
+ * chunk list, and to put back what is kept; sorting and counting are
+ * done outside it.  Blocks freed in the meantime go to the (new) free
+ * list, so their chunks are conservatively kept.
+ */
+template <size_t _Sz, int _Gid>
+void static_mem_pool<_Sz, _Gid>::_S_recycle_chunks()
+{
+    recycle_lock recycle_guard;
+    _Block_list* block;
+    _Block_list* chunk;
+    {
+        lock guard;
+        block = _S_take_blocks();
+        chunk = _S_chunk_p;
+        _S_chunk_p = _NULLPTR;
+    }
+    block = sort_blocks(block);
+    chunk = sort_blocks(chunk);
+    _Block_list*  kept_chunks = _NULLPTR;
+    _Block_list** chunk_link = &kept_chunks;
+    _Block_list*  free_chunks = _NULLPTR;
+    _Block_list*  kept_first = _NULLPTR;
+    _Block_list*  kept_last = _NULLPTR;
+    size_t        kept_count = 0;
+    while (chunk) {
+        _Block_list* next_chunk = chunk->_M_next;
+        char* chunk_end = reinterpret_cast<char*>(chunk) + _S_chunk_size;
+        _Block_list* first = block;
+        _Block_list* last = _NULLPTR;
+        size_t count = 0;
+        while (block && reinterpret_cast<char*>(block) < chunk_end) {
+            assert(reinterpret_cast<char*>(block) >
+                   reinterpret_cast<char*>(chunk));
+            last = block;
+            block = block->_M_next;
+            ++count;
+        }
+        if (count == _S_blocks_per_chunk) {
+            chunk->_M_next = free_chunks;
+            free_chunks = chunk;
+        } else {
+            *chunk_link = chunk;
+            chunk_link = &chunk->_M_next;
+            if (last) {
+                if (kept_last) {
+                    kept_last->_M_next = first;
+                } else {
+                    kept_first = first;
+                }
+                kept_last = last;
+                kept_count += count;
+            }
+        }
+        chunk = next_chunk;
+    }
+    assert(block == _NULLPTR);
+    {
+        lock guard;
+        // Chunks may have been added in the meantime
+        *chunk_link = _S_chunk_p;
+        _S_chunk_p = kept_chunks;
+        if (kept_first) {
+            kept_last->_M_next = _NULLPTR;
+            _S_push_blocks(kept_first, kept_last, kept_count);
+        }
+    }
+    while (free_chunks) {
+        _Block_list* next_chunk = free_chunks->_M_next;
+        _S_dealloc_sys(free_chunks);
+        free_chunks = next_chunk;
+    }
+}
+#endif
+
+#if _STATIC_MEM_POOL_THREAD_CACHE
+/**
+ * Makes the thread cache usable, and arranges for the cached blocks to
+ * be returned to the pool when the current thread exits.
+ *
+ * @param cache  the thread cache of the current thread
+ */
+template <size_t _Sz, int _Gid>
+void static_mem_pool<_Sz, _Gid>::_S_activate_cache(_Thread_cache& cache)
+{
+    static thread_local _Thread_cache_cleaner cleaner;
+    (void)cleaner;
+    cache._M_state = _Thread_cache::active;
+}
+
+/**
+ * Refills an empty thread cache from the pool, obtaining a batch of
+ * blocks under one lock, and returns one block from it.
+ *
+ * @param cache  the (empty) thread cache of the current thread
+ * @return       pointer to allocated memory if successful; null
+ *               otherwise
+ */
+template <size_t _Sz, int _Gid>
+void* static_mem_pool<_Sz, _Gid>::_S_refill_cache(_Thread_cache& cache)
+{
+    assert(cache._M_head == _NULLPTR && cache._M_count == 0);
+    if (cache._M_state == _Thread_cache::inactive) {
+        _S_activate_cache(cache);
+    }
+    _Block_list* result;
+    {
+        _List_guard guard;
+        result = _S_pop_block();
+        if (result) {
+            size_t count = 0;
+            _Block_list* last = _NULLPTR;
+            _Block_list* block;
+            while (count < _STATIC_MEM_POOL_MAGAZINE_SIZE / 2 &&
+                   (block = _S_pop_block())) {
+                block->_M_next = _NULLPTR;
+                if (last) {
+                    last->_M_next = block;
+                } else {
+                    cache._M_head = block;
+                }
+                last = block;
+                ++count;
+            }
+            cache._M_count = count;
+        }
+    }
+    if (result) {
+        return result;
+    }
+    return _S_alloc_new_block();
+}
+
+/**
+ * Moves blocks from a thread cache back into the pool under one lock.
+ *
+ * @param cache  the thread cache of the current thread
+ * @param keep   number of blocks to keep in the cache
+ */
+template <size_t _Sz, int _Gid>
+void static_mem_pool<_Sz, _Gid>::_S_drain_cache(_Thread_cache& cache,
+                                                size_t keep)
+{
+    if (cache._M_count <= keep) {
+        return;
+    }
+    size_t count = cache._M_count - keep;
+    _Block_list* first = cache._M_head;
+    _Block_list* last = first;
+    for (size_t i = 1; i < count; ++i) {
+        last = last->_M_next;
+    }
+    cache._M_head = last->_M_next;
+    cache._M_count = keep;
+#   if _STATIC_MEM_POOL_MAX_IDLE && !_STATIC_MEM_POOL_CHUNK_SIZE && \
+        !_STATIC_MEM_POOL_LOCK_FREE
+    // Blocks that do not fit under the idle limit go to the system
+    _Block_list* excess = first;
+    size_t room;
+    {
+        _List_guard guard;
+        size_t idle = _S_idle_count();
+        room = idle < _STATIC_MEM_POOL_MAX_IDLE
+                   ? _STATIC_MEM_POOL_MAX_IDLE - idle
+                   : 0;
+        if (room >= count) {
+            _S_push_blocks(first, last, count);
+            return;
+        }
+        if (room > 0) {
+            last = first;
+            for (size_t i = 1; i < room; ++i) {
+                last = last->_M_next;
+            }
+            excess = last->_M_next;
+            _S_push_blocks(first, last, room);
+        }
+    }
+    for (size_t i = room; i < count; ++i) {
+        _Block_list* next = excess->_M_next;
+        _S_dealloc_sys(excess);
+        excess = next;
+    }
+#   else
+    _List_guard guard;
+    _S_push_blocks(first, last, count);
+#   endif
+}
+#endif
+
 template <size_t _Sz, int _Gid>
 static_mem_pool<_Sz, _Gid>* static_mem_pool<_Sz, _Gid>::_S_create_instance()
 {
@@ -264,7 +1257,7 @@ static_mem_pool<_Sz, _Gid>* static_mem_pool<_Sz, _Gid>::_S_create_instance()
     static_mem_pool* inst_p = new static_mem_pool();
     try
     {
-        static_mem_pool_set::instance().add(inst_p);
+        static_mem_pool_set::instance().add(inst_p, _Gid < 0);
     }
     catch (...)
     {
@@ -277,6 +1270,10 @@ static_mem_pool<_Sz, _Gid>* static_mem_pool<_Sz, _Gid>::_S_create_instance()
     return inst_p;
 }
 
+} /* namespace _STATIC_MEM_POOL_CONFIG_NS */
+
+using _STATIC_MEM_POOL_CONFIG_NS::static_mem_pool;
+
 NVWA_NAMESPACE_END
 
 /**
@@ -0,0 +1,119 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+
+/**
+ * @file  static_mem_pool_reclaimer.h
+ *
+ * A background thread that periodically returns idle memory of the
+ * static memory pools to the system.  Using this file requires a
+ * C++11-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_STATIC_MEM_POOL_RECLAIMER_H
+#define NVWA_STATIC_MEM_POOL_RECLAIMER_H
+
+#include <chrono>               // std::chrono::steady_clock/duration_cast
+#include <condition_variable>   // std::condition_variable
+#include <mutex>                // std::mutex/lock_guard/unique_lock
+#include <thread>               // std::thread
+#include <stddef.h>             // size_t
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "static_mem_pool.h"    // nvwa::static_mem_pool_set
+
+NVWA_NAMESPACE_BEGIN
+
+/**
+ * Class that runs static_mem_pool_set::trim periodically in a
+ * background thread, from its construction to its destruction.  Only
+ * the locking static memory pools (those with a negative group ID) are
+ * trimmed, as the others may only be used by their owning threads.
+ */
+class static_mem_pool_reclaimer {
+public:
+    typedef std::chrono::steady_clock::duration duration;
+
+    /**
+     * Constructor.  It starts the background thread.
+     *
+     * @param max_idle  maximum number of idle blocks to keep in each
+     *                  static_mem_pool
+     * @param interval  interval between runs
+     */
+    template <typename _Rep, typename _Period>
+    static_mem_pool_reclaimer(
+        size_t max_idle, const std::chrono::duration<_Rep, _Period>& interval)
+        : _M_max_idle(max_idle),
+          _M_interval(std::chrono::duration_cast<duration>(interval)),
+          _M_stopped(false),
+          _M_thread(&static_mem_pool_reclaimer::_M_run, this)
+    {
+    }
+    /**
+     * Destructor.  It stops the background thread and waits for it.
+     */
+    ~static_mem_pool_reclaimer()
+    {
+        {
+            std::lock_guard<std::mutex> guard(_M_mutex);
+            _M_stopped = true;
+        }
+        _M_cond.notify_one();
+        _M_thread.join();
+    }
+
+    static_mem_pool_reclaimer(const static_mem_pool_reclaimer&) = delete;
+    static_mem_pool_reclaimer&
+    operator=(const static_mem_pool_reclaimer&) = delete;
+
+private:
+    void _M_run()
+    {
+        static_mem_pool_set& pool_set = static_mem_pool_set::instance();
+        std::unique_lock<std::mutex> guard(_M_mutex);
+        while (!_M_cond.wait_for(guard, _M_interval,
+                                 [this] { return _M_stopped; })) {
+            guard.unlock();
+            pool_set.trim(_M_max_idle);
+            guard.lock();
+        }
+    }
+
+    size_t                  _M_max_idle;
+    duration                _M_interval;
+    bool                    _M_stopped;
+    std::mutex              _M_mutex;
+    std::condition_variable _M_cond;
+    std::thread             _M_thread;  // Must be the last member
+};
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_STATIC_MEM_POOL_RECLAIMER_H
@@ -2,7 +2,7 @@
 // vim:tabstop=4:shiftwidth=4:expandtab:
 
 /*
- * Copyright (C) 2017-2024 Wu Yongwei <wuyongwei at gmail dot com>
+ * Copyright (C) 2017-2026 Wu Yongwei <wuyongwei at gmail dot com>
  *
  * This software is provided 'as-is', without any express or implied
  * warranty.  In no event will the authors be held liable for any
@@ -32,7 +32,7 @@
  * A generic tree class template and the traversal utilities.  Using
  * this file requires a C++11-compliant compiler.
  *
- * @date  2024-05-01
+ * @date  2026-10-14
  */
 
 #ifndef NVWA_TREE_H
@@ -40,11 +40,11 @@
 
 #include <algorithm>            // std::remove_if
 #include <assert.h>             // assert
-#include <stddef.h>             // ptrdiff_t
-#include <iterator>             // std::begin/end/make_move_iterator
-#include <memory>               // std::unique_ptr/shared_ptr
+#include <stddef.h>             // ptrdiff_t/size_t
+#include <iterator>             // std::begin/end/distance/make_move_iterator
+#include <memory>               // std::unique_ptr/shared_ptr/allocator
+#include <new>                  // placement new
 #include <ostream>              // std::ostream
-#include <stack>                // std::stack
 #include <tuple>                // std::tuple/make_tuple
 #include <type_traits>          // std::decay
 #include <utility>              // std::declval/forward/move/pair/...
@@ -58,12 +58,21 @@ NVWA_NAMESPACE_BEGIN
 enum class storage_policy {
     unique,  ///< Members are directly owned
     shared,  ///< Members may be shared and passed around
+    arena,   ///< Members are allocated from a tree_arena
 };
 
 #ifndef NVWA_TREE_DEFAULT_STORAGE_POLICY
 #define NVWA_TREE_DEFAULT_STORAGE_POLICY storage_policy::shared
 #endif
 
+#ifndef NVWA_TREE_ITERATOR_BUFFER_SIZE
+/**
+ * Number of entries that the traversal iterators store in place, before
+ * they need to allocate memory.
+ */
+#define NVWA_TREE_ITERATOR_BUFFER_SIZE 16
+#endif
+
 /** Declaration of policy class to generate the smart pointer type. */
 template <typename _Tp, storage_policy _Policy>
 struct smart_ptr;
@@ -80,6 +89,12 @@ struct smart_ptr<_Tp, storage_policy::shared> {
     typedef std::shared_ptr<_Tp> type;
 };
 
+/** Partial specialization to get a raw pointer into a tree_arena. */
+template <typename _Tp>
+struct smart_ptr<_Tp, storage_policy::arena> {
+    typedef _Tp* type;
+};
+
 /**
  * Basic tree (node) class template that owns all its children.
  */
@@ -319,6 +334,264 @@ private:
     children_type _M_children;
 };
 
+template <typename _Tp>
+class tree_arena;
+
+/**
+ * Tree (node) class template whose nodes are allocated from a
+ * tree_arena.  The children are linked as the first child and its next
+ * siblings, so adding children allocates no memory, and nodes created
+ * one after another are adjacent in memory.  A node does not own its
+ * children, and null children are not supported.
+ */
+template <typename _Tp>
+class tree<_Tp, storage_policy::arena> {
+public:
+    typedef _Tp             value_type;
+    typedef tree*           tree_ptr;
+    typedef tree_arena<_Tp> arena_type;
+
+    /** Iterator over the children of a node. */
+    class const_iterator {
+    public:
+        typedef ptrdiff_t                 difference_type;
+        typedef tree_ptr                  value_type;
+        typedef const tree_ptr*           pointer;
+        typedef const tree_ptr&           reference;
+        typedef std::forward_iterator_tag iterator_category;
+
+        const_iterator() = default;
+        explicit const_iterator(pointer link) : _M_link(link) {}
+
+        reference operator*() const
+        {
+            assert(get() != nullptr);
+            return *_M_link;
+        }
+        pointer operator->() const
+        {
+            assert(get() != nullptr);
+            return _M_link;
+        }
+        const_iterator& operator++()
+        {
+            assert(get() != nullptr);
+            _M_link = &(*_M_link)->_M_next_sibling;
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator temp(*this);
+            ++*this;
+            return temp;
+        }
+        bool operator==(const const_iterator& rhs) const
+        {
+            return get() == rhs.get();
+        }
+        bool operator!=(const const_iterator& rhs) const
+        {
+            return !operator==(rhs);
+        }
+
+    private:
+        tree_ptr get() const
+        {
+            return _M_link ? *_M_link : nullptr;
+        }
+
+        pointer _M_link{};  ///< Link to the current child
+    };
+    typedef const_iterator iterator;
+
+    template <typename _Up,
+              NVWA_CXX11_REQUIRES(!std::is_same_v<std::decay_t<_Up>, tree>)>
+    explicit tree(_Up&& value) : _M_value(std::forward<_Up>(value))
+    {
+    }
+    tree(const tree&) = delete;
+    tree& operator=(const tree&) = delete;
+
+    _Tp& value() &
+    {
+        return _M_value;
+    }
+    const _Tp& value() const &
+    {
+        return _M_value;
+    }
+    _Tp&& value() &&
+    {
+        return std::move(_M_value);
+    }
+    const tree_ptr& child(unsigned index) const
+    {
+        const tree_ptr* link = &_M_first_child;
+        for (; index != 0; --index) {
+            assert(*link != nullptr);
+            link = &(*link)->_M_next_sibling;
+        }
+        assert(*link != nullptr);
+        return *link;
+    }
+    void push_back(tree_ptr ptr)
+    {
+        assert(ptr != nullptr && ptr->_M_next_sibling == nullptr);
+        tree_ptr* link = _M_last_link ? &(*_M_last_link)->_M_next_sibling
+                                      : &_M_first_child;
+        *link = ptr;
+        _M_last_link = link;
+    }
+    const_iterator begin() const
+    {
+        return const_iterator(&_M_first_child);
+    }
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+    const_iterator end() const
+    {
+        return const_iterator();
+    }
+    const_iterator cend() const
+    {
+        return end();
+    }
+    const tree_ptr& front() const
+    {
+        assert(has_child());
+        return _M_first_child;
+    }
+    const tree_ptr& back() const
+    {
+        assert(has_child());
+        return *_M_last_link;
+    }
+    bool has_child() const
+    {
+        return _M_first_child != nullptr;
+    }
+    size_t child_count() const
+    {
+        return static_cast<size_t>(std::distance(begin(), end()));
+    }
+
+    // Unlinks the children, so that they may be added to another node.
+    // Their memory is reclaimed only with the arena.
+    void remove_children()
+    {
+        tree_ptr ptr = _M_first_child;
+        while (ptr) {
+            tree_ptr next = ptr->_M_next_sibling;
+            ptr->_M_next_sibling = nullptr;
+            ptr = next;
+        }
+        _M_first_child = nullptr;
+        _M_last_link = nullptr;
+    }
+
+    template <typename... Args>
+    void set_children(Args... args)
+    {
+        remove_children();
+        (push_back(args), ...);
+    }
+
+    static constexpr tree_ptr null()
+    {
+        return nullptr;
+    }
+
+private:
+    _Tp       _M_value{};
+    tree_ptr  _M_first_child{};
+    tree_ptr  _M_next_sibling{};
+    tree_ptr* _M_last_link{};   ///< Link that points to the last child
+};
+
+/**
+ * Class to allocate tree nodes in blocks of contiguous memory.  The
+ * nodes do not move, and are destroyed only when the arena is cleared
+ * or destroyed, which does not recurse however deep the trees are.
+ *
+ * This class is not thread-safe.
+ *
+ * @param _Tp  the type of values in the tree nodes
+ */
+template <typename _Tp>
+class tree_arena {
+public:
+    typedef tree<_Tp, storage_policy::arena> tree_type;
+    typedef tree_type*                       tree_ptr;
+
+    /**
+     * Constructor.
+     *
+     * @param block_size  number of nodes in each block of memory
+     */
+    explicit tree_arena(size_t block_size = 1024) : _M_block_size(block_size)
+    {
+        assert(block_size != 0);
+    }
+    ~tree_arena()
+    {
+        clear();
+        for (tree_ptr block : _M_blocks) {
+            _M_alloc.deallocate(block, _M_block_size);
+        }
+    }
+
+    tree_arena(const tree_arena&) = delete;
+    tree_arena& operator=(const tree_arena&) = delete;
+
+    /**
+     * Creates a tree node.
+     *
+     * @param value     the value to assign to the tree node
+     * @param children  pointers to nodes, from this arena, to add as
+     *                  children
+     * @return          pointer to the newly created node
+     */
+    template <typename _Up, typename... Args>
+    tree_ptr create(_Up&& value, Args... children)
+    {
+        size_t block_index = _M_size / _M_block_size;
+        if (block_index == _M_blocks.size()) {
+            _M_blocks.reserve(block_index + 1);
+            _M_blocks.push_back(_M_alloc.allocate(_M_block_size));
+        }
+        tree_ptr ptr = _M_blocks[block_index] + _M_size % _M_block_size;
+        ::new (static_cast<void*>(ptr)) tree_type(std::forward<_Up>(value));
+        ++_M_size;
+        (ptr->push_back(children), ...);
+        return ptr;
+    }
+
+    /**
+     * Destroys all nodes.  The memory blocks are kept for reuse.
+     */
+    void clear() noexcept
+    {
+        for (size_t i = 0; i < _M_size; ++i) {
+            (_M_blocks[i / _M_block_size] + i % _M_block_size)->~tree_type();
+        }
+        _M_size = 0;
+    }
+
+    /** Gets the number of nodes created since the last clear. */
+    size_t size() const noexcept
+    {
+        return _M_size;
+    }
+
+private:
+    std::allocator<tree_type> _M_alloc;
+    std::vector<tree_ptr>     _M_blocks;
+    size_t                    _M_block_size;
+    size_t                    _M_size{};
+};
+
 /**
  * Creates a tree without any children.
  *
@@ -383,6 +656,69 @@ auto print_tree(const _TreePtr& ptr, std::ostream& os)
     print_tree<tree_type>(ptr, os, "");
 }
 
+namespace detail {
+
+/**
+ * Sequence that stores the first \a _Nm elements in place, and the rest
+ * in a std::vector.  It serves as the stack or queue of the traversal
+ * iterators, so that traversing small trees does not allocate memory.
+ */
+template <typename _Tp, size_t _Nm>
+class small_vector {
+public:
+    bool empty() const noexcept
+    {
+        return _M_size == 0;
+    }
+    size_t size() const noexcept
+    {
+        return _M_size;
+    }
+    _Tp& operator[](size_t n)
+    {
+        assert(n < _M_size);
+        return n < _Nm ? _M_buffer[n] : _M_overflow[n - _Nm];
+    }
+    const _Tp& operator[](size_t n) const
+    {
+        assert(n < _M_size);
+        return n < _Nm ? _M_buffer[n] : _M_overflow[n - _Nm];
+    }
+    _Tp& back()
+    {
+        return (*this)[_M_size - 1];
+    }
+    void push_back(const _Tp& value)
+    {
+        if (_M_size < _Nm) {
+            _M_buffer[_M_size] = value;
+        } else {
+            _M_overflow.push_back(value);
+        }
+        ++_M_size;
+    }
+    void pop_back()
+    {
+        assert(!empty());
+        if (--_M_size >= _Nm) {
+            _M_overflow.pop_back();
+        }
+    }
+    // Keeps the capacity of the overflow vector
+    void clear() noexcept
+    {
+        _M_overflow.clear();
+        _M_size = 0;
+    }
+
+private:
+    _Tp              _M_buffer[_Nm]{};
+    std::vector<_Tp> _M_overflow;
+    size_t           _M_size{};
+};
+
+} /* namespace detail */
+
 /**
  * Iteration class for breadth-first traversal.  Mutating (adding or
  * removing children) or removing the part of the tree nodes at the
@@ -400,32 +736,34 @@ public:
         typedef std::forward_iterator_tag iterator_category;
 
         iterator() = default;
-        explicit iterator(pointer root) : _M_this_level({root})
+        explicit iterator(pointer root)
         {
-            _M_current = _M_this_level.begin();
+            _M_levels[0].push_back(root);
         }
 
         reference operator*() const
         {
             assert(!empty());
-            return **_M_current;
+            return *_M_levels[_M_level][_M_current];
         }
         pointer operator->() const
         {
             assert(!empty());
-            return &*_M_current;
+            return _M_levels[_M_level][_M_current];
         }
         iterator& operator++()
         {
             assert(!empty());
-            for (auto& child : **_M_current) {
+            auto& next_level = _M_levels[_M_level ^ 1];
+            for (auto& child : **this) {
                 if (child != _Tree::null()) {
-                    _M_next_level.push_back(&*child);
+                    next_level.push_back(&*child);
                 }
             }
-            if (++_M_current == _M_this_level.end()) {
-                _M_this_level = std::move(_M_next_level);
-                _M_current = _M_this_level.begin();
+            if (++_M_current == _M_levels[_M_level].size()) {
+                _M_levels[_M_level].clear();
+                _M_level ^= 1;
+                _M_current = 0;
             }
             return *this;
         }
@@ -437,11 +775,14 @@ public:
         }
         bool empty() const
         {
-            return _M_current == _M_this_level.end();
+            return _M_current == _M_levels[_M_level].size();
         }
         bool operator==(const iterator& rhs) const
         {
-            return (empty() && rhs.empty()) || _M_current == rhs._M_current;
+            if (empty() || rhs.empty()) {
+                return empty() && rhs.empty();
+            }
+            return operator->() == rhs.operator->();
         }
         bool operator!=(const iterator& rhs) const
         {
@@ -449,9 +790,13 @@ public:
         }
 
     private:
-        typename std::vector<pointer>::iterator _M_current;
-        std::vector<pointer>                    _M_this_level;
-        std::vector<pointer>                    _M_next_level;
+        typedef detail::small_vector<pointer,
+                                     NVWA_TREE_ITERATOR_BUFFER_SIZE>
+            level_type;
+
+        level_type _M_levels[2];    ///< Nodes at this and the next level
+        unsigned   _M_level{};      ///< Index of this level in _M_levels
+        size_t     _M_current{};    ///< Index of the current node
     };
 
     explicit breadth_first_iteration(_Tree& root) : _M_root(&root) {}
@@ -501,15 +846,15 @@ public:
         {
             assert(!empty());
             if (_M_current->cbegin() != _M_current->cend()) {
-                _M_stack.push(std::make_pair(_M_current->cbegin(),
-                                             _M_current->cend()));
+                _M_stack.push_back(std::make_pair(_M_current->cbegin(),
+                                                  _M_current->cend()));
             }
             for (;;) {
                 if (_M_stack.empty()) {
                     _M_current = nullptr;
                     break;
                 }
-                auto& top = _M_stack.top();
+                auto& top = _M_stack.back();
                 auto& next_node = top.first;
                 auto& end_node = top.second;
                 if (next_node != end_node) {
@@ -519,7 +864,7 @@ public:
                         break;
                     }
                 } else {
-                    _M_stack.pop();
+                    _M_stack.pop_back();
                 }
             }
             return *this;
@@ -545,8 +890,9 @@ public:
 
     private:
         pointer _M_current;
-        std::stack<std::pair<typename _Tree::const_iterator,
-                             typename _Tree::const_iterator>>
+        detail::small_vector<std::pair<typename _Tree::const_iterator,
+                                       typename _Tree::const_iterator>,
+                             NVWA_TREE_ITERATOR_BUFFER_SIZE>
             _M_stack;
     };
 
@@ -604,7 +950,7 @@ public:
                     _M_current = nullptr;
                     break;
                 }
-                auto& top = _M_stack.top();
+                auto& top = _M_stack.back();
                 auto& curr       = std::get<0>(top);
                 auto& next_child = std::get<1>(top);
                 auto& end_child  = std::get<2>(top);
@@ -621,7 +967,7 @@ public:
                             return *this;
                         }
                     }
-                    _M_stack.pop();
+                    _M_stack.pop_back();
                 }
             }
             return *this;
@@ -660,11 +1006,11 @@ public:
                     ++next_child;
                 }
                 if (*left_child) {
-                    _M_stack.push(
+                    _M_stack.push_back(
                         make_tuple(curr, next_child, curr->cend()));
                     curr = &**left_child;
                 } else {
-                    _M_stack.push(
+                    _M_stack.push_back(
                         make_tuple(nullptr, next_child, curr->cend()));
                     break;
                 }
@@ -672,9 +1018,10 @@ public:
             return curr;
         }
 
-        std::stack<std::tuple<pointer,
-                              typename _Tree::const_iterator,
-                              typename _Tree::const_iterator>>
+        detail::small_vector<std::tuple<pointer,
+                                        typename _Tree::const_iterator,
+                                        typename _Tree::const_iterator>,
+                             NVWA_TREE_ITERATOR_BUFFER_SIZE>
             _M_stack;
         pointer _M_current;
     };
@@ -0,0 +1,333 @@
+// -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*-
+// vim:tabstop=4:shiftwidth=4:expandtab:
+
+/*
+ * Copyright (C) 2026 Wu Yongwei <wuyongwei at gmail dot com>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute
+ * it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ *    not claim that you wrote the original software.  If you use this
+ *    software in a product, an acknowledgement in the product
+ *    documentation would be appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must
+ *    not be misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source
+ *    distribution.
+ *
+ * This file is part of Stones of Nvwa:
+ *      https://github.com/adah1972/nvwa
+ *
+ */
+
+/**
+ * @file  tree_parallel.h
+ *
+ * Parallel traversal and reduction of the trees in tree.h.  Using this
+ * file requires a C++17-compliant compiler.
+ *
+ * @date  2026-10-14
+ */
+
+#ifndef NVWA_TREE_PARALLEL_H
+#define NVWA_TREE_PARALLEL_H
+
+#include <assert.h>             // assert
+#include <atomic>               // std::atomic
+#include <condition_variable>   // std::condition_variable
+#include <exception>            // std::exception_ptr/current_exception/...
+#include <mutex>                // std::mutex/lock_guard/unique_lock
+#include <optional>             // std::optional
+#include <stddef.h>             // size_t
+#include <thread>               // std::thread
+#include <utility>              // std::move
+#include <vector>               // std::vector
+#include "_nvwa.h"              // NVWA_NAMESPACE_*
+#include "tree.h"               // nvwa::tree
+
+NVWA_NAMESPACE_BEGIN
+
+namespace detail {
+
+/**
+ * Class to share the subtrees to visit among threads.  Each thread
+ * visits the nodes depth-first with a private stack, without locking.
+ * Only when some threads have run out of work does a busy thread give
+ * away the subtrees at the bottom of its stack (which are nearest to the
+ * root, and thus probably the largest) to the shared pool, where the
+ * idle threads take them.
+ *
+ * @param _Tree  the tree (node) type
+ */
+template <typename _Tree>
+class tree_work_pool {
+public:
+    typedef _Tree* pointer;
+
+    tree_work_pool(pointer root, unsigned thread_count)
+        : _M_shared{root}, _M_thread_count(thread_count)
+    {
+    }
+
+    /**
+     * Visits nodes until all nodes are visited.  It shall be called by
+     * each of the threads.
+     *
+     * @param visit  function to call for each node
+     */
+    template <typename _Fn>
+    void run(_Fn& visit)
+    {
+        std::vector<pointer> local;
+        pointer node;
+        while (take(node)) {
+            local.push_back(node);
+            do {
+                if (_M_idle.load(std::memory_order_relaxed) != 0 &&
+                    local.size() > 1) {
+                    give(local);
+                }
+                node = local.back();
+                local.pop_back();
+                try {
+                    visit(*node);
+                } catch (...) {
+                    fail(std::current_exception());
+                    local.clear();
+                    break;
+                }
+                for (auto& child : *node) {
+                    if (child != _Tree::null()) {
+                        local.push_back(&*child);
+                    }
+                }
+            } while (!local.empty() &&
+                     !_M_failed.load(std::memory_order_relaxed));
+            local.clear();
+        }
+    }
+
+    /**
+     * Reduces the number of threads that will call #run, when not all
+     * of them can be started.
+     */
+    void set_thread_count(unsigned thread_count)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_M_lock);
+            _M_thread_count = thread_count;
+        }
+        _M_cond.notify_all();
+    }
+
+    /** Rethrows the first exception thrown by the visiting function. */
+    void rethrow_if_failed()
+    {
+        if (_M_exception) {
+            std::rethrow_exception(_M_exception);
+        }
+    }
+
+private:
+    bool take(pointer& node)
+    {
+        std::unique_lock<std::mutex> guard(_M_lock);
+        _M_idle.fetch_add(1, std::memory_order_relaxed);
+        for (;;) {
+            if (_M_failed.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            if (!_M_shared.empty()) {
+                node = _M_shared.back();
+                _M_shared.pop_back();
+                _M_idle.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            // Only busy threads add work, and a thread becomes busy only
+            // here; so nothing is left when all threads are idle
+            if (_M_idle.load(std::memory_order_relaxed) == _M_thread_count) {
+                guard.unlock();
+                _M_cond.notify_all();
+                return false;
+            }
+            _M_cond.wait(guard);
+        }
+    }
+
+    void give(std::vector<pointer>& local)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_M_lock);
+            size_t count = _M_idle.load(std::memory_order_relaxed);
+            if (count > local.size() - 1) {
+                count = local.size() - 1;
+            }
+            _M_shared.insert(_M_shared.end(), local.begin(),
+                             local.begin() + count);
+            local.erase(local.begin(), local.begin() + count);
+        }
+        _M_cond.notify_all();
+    }
+
+    void fail(std::exception_ptr ex)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_M_lock);
+            if (!_M_exception) {
+                _M_exception = std::move(ex);
+            }
+            _M_failed.store(true, std::memory_order_relaxed);
+        }
+        _M_cond.notify_all();
+    }
+
+    std::vector<pointer>    _M_shared;      ///< Subtrees given away
+    unsigned                _M_thread_count;
+    std::atomic<unsigned>   _M_idle{};      ///< Changed only under lock
+    std::atomic<bool>       _M_failed{};
+    std::exception_ptr      _M_exception;
+    std::mutex              _M_lock;
+    std::condition_variable _M_cond;
+};
+
+/**
+ * Gets the number of threads to use.
+ *
+ * @param max_threads  the maximum number of threads (\c 0 for the
+ *                     hardware concurrency)
+ * @return             the number of threads, at least one
+ */
+inline unsigned tree_thread_count(unsigned max_threads)
+{
+    unsigned thread_count = max_threads;
+    if (thread_count == 0) {
+        thread_count = std::thread::hardware_concurrency();
+    }
+    return thread_count != 0 ? thread_count : 1;
+}
+
+/**
+ * Runs the visiting functions on the threads.
+ *
+ * @param root           the root of the tree to visit
+ * @param max_threads    the maximum number of threads (\c 0 for the
+ *                       hardware concurrency)
+ * @param make_visitor   function that, given the index of a thread,
+ *                       returns its visiting function
+ */
+template <typename _Tree, typename _Fn>
+void run_tree_threads(_Tree& root, unsigned max_threads, _Fn make_visitor)
+{
+    unsigned thread_count = tree_thread_count(max_threads);
+    // Visiting a leaf needs no help
+    if (!root.has_child()) {
+        thread_count = 1;
+    }
+
+    tree_work_pool<_Tree> pool(&root, thread_count);
+    std::vector<std::thread> threads;
+    try {
+        threads.reserve(thread_count - 1);
+        for (unsigned i = 1; i < thread_count; ++i) {
+            threads.emplace_back([&pool, &make_visitor, i] {
+                auto&& visit = make_visitor(i);
+                pool.run(visit);
+            });
+        }
+    } catch (...) {
+        // Continues with the threads that have been started
+        pool.set_thread_count(static_cast<unsigned>(threads.size()) + 1);
+    }
+    auto&& visit = make_visitor(0);
+    pool.run(visit);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    pool.rethrow_if_failed();
+}
+
+} /* namespace detail */
+
+/**
+ * Calls a function on each node of a tree, with multiple threads.  The
+ * function may be called concurrently on different nodes, in any order,
+ * except that a node is always visited before its children.  Work is
+ * split at subtrees, and subtrees are handed to threads that become
+ * idle, so unbalanced trees are handled as well as balanced ones.  The
+ * tree is accessed via raw pointers, and ownership is never transferred
+ * or shared, so trees with storage_policy::unique are fine.  The tree
+ * shall not be mutated (by adding or removing children) during the call.
+ *
+ * If the function throws, the remaining nodes may not be visited, and
+ * the first exception is rethrown after all threads have stopped.
+ *
+ * @param root         the root of the tree
+ * @param fn           function to call with a reference to each node
+ * @param max_threads  the maximum number of threads to use, including
+ *                     the calling thread (\c 0 for the hardware
+ *                     concurrency)
+ */
+template <typename _Tree, typename _Fn>
+void parallel_for_each(_Tree& root, _Fn fn, unsigned max_threads = 0)
+{
+    detail::run_tree_threads(root, max_threads,
+                             [&fn](unsigned) -> _Fn& { return fn; });
+}
+
+/**
+ * Maps each node of a tree to a value and combines the values, with
+ * multiple threads.  The traversal is the same as parallel_for_each.
+ * Each thread combines the values of the nodes it visits, and the
+ * results of the threads are combined with \a init at last.  As the
+ * order of combination is unspecified, \a reduce shall be associative
+ * and commutative, as that of \c std::reduce.
+ *
+ * @param root         the root of the tree
+ * @param init         the initial value
+ * @param map          function to map a reference to a node to a value
+ *                     convertible to \a _Result; it may be called
+ *                     concurrently
+ * @param reduce       function to combine two values; it is called
+ *                     concurrently only on different values
+ * @param max_threads  the maximum number of threads to use, including
+ *                     the calling thread (\c 0 for the hardware
+ *                     concurrency)
+ * @return             the combination of \a init and the values of all
+ *                     nodes
+ */
+template <typename _Tree, typename _Result, typename _MapFn,
+          typename _ReduceFn>
+_Result parallel_reduce(_Tree& root, _Result init, _MapFn map,
+                        _ReduceFn reduce, unsigned max_threads = 0)
+{
+    std::vector<std::optional<_Result>> partial_results(
+        detail::tree_thread_count(max_threads));
+    detail::run_tree_threads(
+        root, static_cast<unsigned>(partial_results.size()),
+        [&](unsigned index) {
+            return [&map, &reduce, &result = partial_results[index]](
+                       _Tree& node) {
+                if (result) {
+                    *result = reduce(std::move(*result), map(node));
+                } else {
+                    result.emplace(map(node));
+                }
+            };
+        });
+    for (auto& result : partial_results) {
+        if (result) {
+            init = reduce(std::move(init), std::move(*result));
+        }
+    }
+    return init;
+}
+
+NVWA_NAMESPACE_END
+
+#endif // NVWA_TREE_PARALLEL_H
@@ -0,0 +1,32 @@
+#include "nvwa/aligned_memory.h"
+#include <string.h>
+#include <stdint.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::unit_test_framework;
+
+BOOST_AUTO_TEST_CASE(aligned_memory_test)
+{
+    void* ptr = nvwa::aligned_malloc(100, 256);
+    BOOST_REQUIRE(ptr != nullptr);
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(ptr) % 256, 0U);
+    nvwa::aligned_free(ptr);
+}
+
+BOOST_AUTO_TEST_CASE(huge_page_test)
+{
+    size_t page_size = nvwa::huge_page_size();
+    BOOST_TEST_MESSAGE("Huge page size: " << page_size);
+    size_t sizes[] = {1000, page_size + 1, 3 * page_size};
+    for (size_t size : sizes) {
+        if (size == 0) {
+            continue;
+        }
+        void* ptr = nvwa::huge_page_malloc(size);
+        BOOST_REQUIRE(ptr != nullptr);
+        BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(ptr) % 4096, 0U);
+        memset(ptr, 0x5a, size);
+        nvwa::huge_page_free(ptr, size);
+    }
+    nvwa::huge_page_free(nullptr, 0);
+}
@@ -0,0 +1,86 @@
+#include "nvwa/atomic_bool_array.h"
+#include <stddef.h>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/bool_array.h"
+
+BOOST_AUTO_TEST_CASE(atomic_bool_array_basic_test)
+{
+    nvwa::atomic_bool_array ba(130);
+    BOOST_CHECK_EQUAL(ba.size(), 130U);
+    BOOST_CHECK_EQUAL(ba.count(), 0U);
+    ba.set(0);
+    ba.set(64);
+    ba.set(129, std::memory_order_release);
+    BOOST_CHECK(ba[0]);
+    BOOST_CHECK(!ba[1]);
+    BOOST_CHECK(ba.test(129, std::memory_order_acquire));
+    BOOST_CHECK_EQUAL(ba.count(), 3U);
+    BOOST_CHECK(!ba.test_and_set(1));
+    BOOST_CHECK(ba.test_and_set(1, std::memory_order_acq_rel));
+    BOOST_CHECK(ba.test_and_reset(64));
+    BOOST_CHECK(!ba.test_and_reset(64));
+    ba.reset(0);
+    BOOST_CHECK_EQUAL(ba.count(), 2U);
+    BOOST_CHECK_THROW(ba.at(130), std::out_of_range);
+    BOOST_CHECK_THROW(ba.set(130), std::out_of_range);
+    BOOST_CHECK_THROW(nvwa::atomic_bool_array(0), std::out_of_range);
+
+    nvwa::bool_array copy = ba.snapshot();
+    BOOST_CHECK_EQUAL(copy.size(), 130U);
+    BOOST_CHECK_EQUAL(copy.count(), 2U);
+    BOOST_CHECK(copy[1]);
+    BOOST_CHECK(copy[129]);
+
+    ba.initialize(true);
+    BOOST_CHECK_EQUAL(ba.count(), 130U);
+    ba.initialize(false);
+    BOOST_CHECK_EQUAL(ba.count(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(atomic_bool_array_concurrent_test)
+{
+    const size_t size = 100000;
+    const int thread_cnt = 4;
+    nvwa::atomic_bool_array visited(size);
+    std::atomic<size_t> first_visits{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_cnt; ++i) {
+        threads.emplace_back([&, i] {
+            // All threads visit all elements, in different orders
+            for (size_t j = 0; j < size; ++j) {
+                size_t pos = (j * (2 * i + 1) + i) % size;
+                if (!visited.test_and_set(pos)) {
+                    first_visits.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BOOST_CHECK_EQUAL(first_visits.load(), size);
+    BOOST_CHECK_EQUAL(visited.count(), size);
+}
+
+BOOST_AUTO_TEST_CASE(atomic_bool_array_parallel_count_test)
+{
+    // Large enough to be split among threads
+    const size_t size = 64 * 1024 * 64 * 5 + 7;
+    nvwa::atomic_bool_array ba(size);
+    std::mt19937 gen;
+    size_t expected_cnt = 0;
+    for (size_t i = 0; i < size / 3; ++i) {
+        if (!ba.test_and_set(gen() % size)) {
+            ++expected_cnt;
+        }
+    }
+    BOOST_CHECK_EQUAL(ba.count(1), expected_cnt);
+    BOOST_CHECK_EQUAL(ba.count(4), expected_cnt);
+    BOOST_CHECK_EQUAL(ba.count(), expected_cnt);
+    BOOST_CHECK_EQUAL(ba.snapshot().count(), expected_cnt);
+}
@@ -0,0 +1,114 @@
+#include "nvwa/blocking_fc_queue.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/fc_queue.h"
+#include "nvwa/pctimer.h"
+
+using namespace boost::unit_test_framework;
+
+namespace {
+
+const int THREADS = 3;
+const int LOOPS = 100'000;
+
+template <class _Queue>
+void add_to_blocking_queue(nvwa::blocking_fc_queue<_Queue>& q)
+{
+    for (int i = 0; i < LOOPS; ++i) {
+        q.push_wait(i);
+    }
+}
+
+template <class _Queue>
+void read_from_blocking_queue(nvwa::blocking_fc_queue<_Queue>& q,
+                              long long& sum, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        int value{};
+        q.pop_wait(value);
+        sum += value;
+    }
+}
+
+} /* unnamed namespace */
+
+BOOST_AUTO_TEST_CASE(blocking_fc_queue_test)
+{
+    using namespace std::chrono_literals;
+    nvwa::blocking_fc_queue<nvwa::fc_queue<int>> q(2);
+    BOOST_CHECK_EQUAL(q.capacity(), 2U);
+    BOOST_CHECK(q.empty());
+    int value{};
+    BOOST_CHECK(!q.read(value));
+    auto t1 = nvwa::pctimer();
+    BOOST_CHECK(!q.pop_wait_for(value, 20ms));
+    auto t2 = nvwa::pctimer();
+    BOOST_CHECK(t2 - t1 >= 0.019);
+    BOOST_CHECK(q.write(1));
+    q.push_wait(2);
+    BOOST_CHECK(q.full());
+    BOOST_CHECK(!q.write(3));
+    BOOST_CHECK(!q.push_wait_for(3, 10ms));
+    BOOST_CHECK(q.pop_wait_for(value, 10ms));
+    BOOST_CHECK_EQUAL(value, 1);
+    BOOST_CHECK(q.push_wait_for(3, 10ms));
+    q.pop_wait(value);
+    BOOST_CHECK_EQUAL(value, 2);
+    BOOST_CHECK(q.read(value));
+    BOOST_CHECK_EQUAL(value, 3);
+    BOOST_CHECK(q.empty());
+
+    std::thread producer([&] {
+        std::this_thread::sleep_for(10ms);
+        q.push_wait(4);
+    });
+    BOOST_CHECK(q.pop_wait_for(value, 10s));
+    BOOST_CHECK_EQUAL(value, 4);
+    producer.join();
+}
+
+BOOST_AUTO_TEST_CASE(blocking_fc_queue_parallel_test)
+{
+    nvwa::blocking_fc_queue<nvwa::fc_queue<int>> q(16);
+    long long sum = 0;
+    auto t1 = nvwa::pctimer();
+    std::thread enqueue_thread(add_to_blocking_queue<nvwa::fc_queue<int>>,
+                               std::ref(q));
+    std::thread dequeue_thread(read_from_blocking_queue<nvwa::fc_queue<int>>,
+                               std::ref(q), std::ref(sum), LOOPS);
+    enqueue_thread.join();
+    dequeue_thread.join();
+    BOOST_CHECK_EQUAL(sum, (long long)LOOPS * (LOOPS - 1) / 2);
+    BOOST_CHECK(q.empty());
+    auto t2 = nvwa::pctimer();
+    BOOST_TEST_MESSAGE("Test took " << (t2 - t1) << " seconds");
+}
+
+BOOST_AUTO_TEST_CASE(blocking_mpmc_fc_queue_parallel_test)
+{
+    typedef nvwa::mpmc_fc_queue<int> queue_type;
+    nvwa::blocking_fc_queue<queue_type> q(16);
+    std::vector<long long> sums(THREADS);
+    auto t1 = nvwa::pctimer();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i) {
+        threads.emplace_back(add_to_blocking_queue<queue_type>, std::ref(q));
+        threads.emplace_back(read_from_blocking_queue<queue_type>,
+                             std::ref(q), std::ref(sums[i]), LOOPS);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    long long sum = 0;
+    for (auto value : sums) {
+        sum += value;
+    }
+    BOOST_CHECK_EQUAL(sum, (long long)THREADS * LOOPS * (LOOPS - 1) / 2);
+    BOOST_CHECK(q.empty());
+    auto t2 = nvwa::pctimer();
+    BOOST_TEST_MESSAGE("Test took " << (t2 - t1) << " seconds");
+}
@@ -1,8 +1,10 @@
 #include "nvwa/bool_array.h"
 #include <stddef.h>
+#include <random>
 #include <sstream>
 #include <stdexcept>
 #include <type_traits>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 
 using namespace boost::unit_test_framework;
@@ -78,3 +80,150 @@ BOOST_AUTO_TEST_CASE(bool_array_test)
     BOOST_TEST_MESSAGE("is_nothrow_destructible is "
                 << std::is_nothrow_destructible<nvwa::bool_array>::value);
 }
+
+BOOST_AUTO_TEST_CASE(bool_array_word_test)
+{
+    // Exercises the word-wide kernels against bit-by-bit results
+    std::mt19937 gen(42);
+    for (size_t size : {1U, 63U, 64U, 65U, 1000U, 5000U}) {
+        nvwa::bool_array ba(size);
+        ba.initialize(false);
+        std::vector<bool> bits(size);
+        for (size_t i = 0; i < size / 50 + 1; ++i) {
+            size_t pos = gen() % size;
+            ba.set(pos);
+            bits[pos] = true;
+        }
+        size_t expected = 0;
+        for (bool bit : bits) {
+            expected += bit;
+        }
+        BOOST_CHECK_EQUAL(ba.count(), expected);
+        for (int round = 0; round < 100; ++round) {
+            size_t begin = gen() % size;
+            size_t end = begin + gen() % (size - begin) + 1;
+            size_t cnt = 0;
+            size_t first_true = nvwa::bool_array::npos;
+            for (size_t i = begin; i < end; ++i) {
+                if (bits[i]) {
+                    ++cnt;
+                    if (first_true == nvwa::bool_array::npos) {
+                        first_true = i;
+                    }
+                }
+            }
+            BOOST_CHECK_EQUAL(ba.count(begin, end), cnt);
+            BOOST_CHECK_EQUAL(ba.find_until(true, begin, end), first_true);
+        }
+        ba.flip();
+        for (int round = 0; round < 100; ++round) {
+            size_t begin = gen() % size;
+            size_t first_false = nvwa::bool_array::npos;
+            for (size_t i = begin; i < size; ++i) {
+                if (bits[i]) {
+                    first_false = i;
+                    break;
+                }
+            }
+            BOOST_CHECK_EQUAL(ba.find(false, begin), first_false);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bool_array_merge_test)
+{
+    std::mt19937 gen(7);
+    auto random_array = [&gen](size_t size, std::vector<bool>& bits) {
+        nvwa::bool_array ba(size);
+        bits.assign(size, false);
+        for (size_t i = 0; i < size; ++i) {
+            if (gen() % 3 == 0) {
+                ba[i] = true;
+                bits[i] = true;
+            } else {
+                ba[i] = false;
+            }
+        }
+        return ba;
+    };
+    for (int round = 0; round < 200; ++round) {
+        std::vector<bool> lhs_bits;
+        std::vector<bool> rhs_bits;
+        size_t size = gen() % 300 + 1;
+        nvwa::bool_array lhs = random_array(size, lhs_bits);
+        nvwa::bool_array rhs = random_array(gen() % 300 + 1, rhs_bits);
+        size_t begin = gen() % rhs.size();
+        size_t end = begin + gen() % (rhs.size() - begin) + 1;
+        if (end - begin > size) {
+            end = begin + size;
+        }
+        size_t offset = gen() % (size - (end - begin) + 1);
+
+        size_t expected_cnt = 0;
+        for (size_t i = begin; i < end; ++i) {
+            expected_cnt += lhs_bits[offset + i - begin] && rhs_bits[i];
+        }
+        BOOST_CHECK_EQUAL(lhs.count_and(rhs, begin, end, offset),
+                          expected_cnt);
+
+        auto check = [&](void (nvwa::bool_array::*merge)(
+                             const nvwa::bool_array&, size_t, size_t, size_t),
+                         auto op) {
+            nvwa::bool_array result(lhs);
+            (result.*merge)(rhs, begin, end, offset);
+            for (size_t i = 0; i < size; ++i) {
+                bool expected = lhs_bits[i];
+                if (i >= offset && i < offset + (end - begin)) {
+                    expected = op(expected, bool(rhs_bits[begin + i - offset]));
+                }
+                if (result[i] != expected) {
+                    BOOST_ERROR("Mismatch at " << i << " of " << size
+                                << " for range [" << begin << ", " << end
+                                << ") at " << offset);
+                    return;
+                }
+            }
+        };
+        check(&nvwa::bool_array::merge_and,
+              [](bool x, bool y) { return x && y; });
+        check(&nvwa::bool_array::merge_or,
+              [](bool x, bool y) { return x || y; });
+        check(&nvwa::bool_array::merge_xor,
+              [](bool x, bool y) { return x != y; });
+        check(&nvwa::bool_array::merge_andnot,
+              [](bool x, bool y) { return x && !y; });
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bool_array_bitmap_test)
+{
+    std::mt19937 gen(25);
+    std::vector<unsigned char> bitmap(40);
+    for (auto& byte : bitmap) {
+        byte = static_cast<unsigned char>(gen());
+    }
+    for (size_t size = 1; size <= bitmap.size() * 8; size += 7) {
+        nvwa::bool_array ba(bitmap.data(), size);
+        size_t expected_cnt = 0;
+        for (size_t i = 0; i < size; ++i) {
+            bool expected = (bitmap[i / 8] >> (i % 8)) & 1;
+            expected_cnt += expected;
+            BOOST_REQUIRE_EQUAL(ba[i], expected);
+        }
+        BOOST_CHECK_EQUAL(ba.count(), expected_cnt);
+
+        // Flipping shall not touch the bits beyond the size
+        ba.flip();
+        BOOST_CHECK_EQUAL(ba.count(), size - expected_cnt);
+        ba.flip();
+
+        size_t begin = gen() % size;
+        std::vector<unsigned char> copy(bitmap.size(), 0xFF);
+        ba.copy_to_bitmap(copy.data(), begin);
+        nvwa::bool_array ba2(copy.data(), size - begin);
+        for (size_t i = begin; i < size; ++i) {
+            BOOST_REQUIRE_EQUAL(ba2[i - begin], ba[i]);
+        }
+        BOOST_CHECK_EQUAL(ba2.count(), ba.count(begin));
+    }
+}
@@ -0,0 +1,170 @@
+#include "nvwa/compressed_bool_array.h"
+#include <stddef.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/bool_array.h"
+
+namespace {
+
+void check_equal(const nvwa::compressed_bool_array& cba,
+                 const std::vector<bool>& bits)
+{
+    BOOST_REQUIRE_EQUAL(cba.size(), bits.size());
+    size_t expected_cnt = 0;
+    for (size_t i = 0; i < bits.size(); ++i) {
+        if (cba[i] != bits[i]) {
+            BOOST_ERROR("Mismatch at " << i);
+            return;
+        }
+        expected_cnt += bits[i];
+    }
+    BOOST_CHECK_EQUAL(cba.count(), expected_cnt);
+}
+
+} /* unnamed namespace */
+
+BOOST_AUTO_TEST_CASE(compressed_bool_array_test)
+{
+    nvwa::compressed_bool_array cba(1000000);
+    BOOST_CHECK_EQUAL(cba.count(), 0U);
+    BOOST_CHECK_EQUAL(cba.find(true), nvwa::compressed_bool_array::npos);
+    BOOST_CHECK_EQUAL(cba.find(false, 12345), 12345U);
+    cba.set(3);
+    cba.set(70000);
+    cba.set(999999);
+    BOOST_CHECK(cba.at(3));
+    BOOST_CHECK(!cba.at(4));
+    BOOST_CHECK_EQUAL(cba.count(), 3U);
+    BOOST_CHECK_EQUAL(cba.count(4, 999999), 1U);
+    BOOST_CHECK_EQUAL(cba.find(true, 4), 70000U);
+    BOOST_CHECK_EQUAL(cba.find(true, 70001), 999999U);
+    BOOST_CHECK_EQUAL(cba.find(true, 70001, 100),
+                      nvwa::compressed_bool_array::npos);
+    cba.reset(70000);
+    BOOST_CHECK_EQUAL(cba.find(true, 4), 999999U);
+    BOOST_CHECK_THROW(cba.at(1000000), std::out_of_range);
+    BOOST_CHECK_THROW(cba.set(1000000), std::out_of_range);
+    BOOST_CHECK_THROW(cba.count(5, 1000001), std::out_of_range);
+    BOOST_CHECK_THROW(nvwa::compressed_bool_array(0), std::out_of_range);
+
+    // Sparse content uses far less memory than a bool_array
+    BOOST_CHECK_LT(cba.memory_usage(), 1000000 / 8 / 100);
+
+    cba.initialize(true);
+    BOOST_CHECK_EQUAL(cba.count(), 1000000U);
+    BOOST_CHECK_EQUAL(cba.find(false), nvwa::compressed_bool_array::npos);
+    cba.reset(65536);
+    BOOST_CHECK_EQUAL(cba.find(false), 65536U);
+    BOOST_CHECK_EQUAL(cba.count(), 999999U);
+    BOOST_CHECK_EQUAL(cba.find(true, 65536), 65537U);
+    cba.optimize();
+    BOOST_CHECK_EQUAL(cba.count(65000, 70000), 4999U);
+    BOOST_CHECK_LT(cba.memory_usage(), 2000);
+}
+
+BOOST_AUTO_TEST_CASE(compressed_bool_array_random_test)
+{
+    std::mt19937 gen(27);
+    const size_t size = 65536 * 5 + 1000;
+    std::vector<bool> bits(size);
+    nvwa::compressed_bool_array cba(size);
+
+    // Sparse chunk, dense chunk, clustered chunk, empty chunk, tail
+    for (int i = 0; i < 200; ++i) {
+        size_t pos = gen() % 65536;
+        bits[pos] = true;
+        cba.set(pos);
+    }
+    for (int i = 0; i < 30000; ++i) {
+        size_t pos = 65536 + gen() % 65536;
+        bits[pos] = true;
+        cba.set(pos);
+    }
+    for (size_t begin = 65536 * 2; begin < 65536 * 3; begin += 1000) {
+        size_t len = gen() % 900;
+        for (size_t pos = begin; pos < begin + len; ++pos) {
+            bits[pos] = true;
+            cba.set(pos);
+        }
+    }
+    for (size_t pos = 65536 * 4; pos < size; pos += 3) {
+        bits[pos] = true;
+        cba.set(pos);
+    }
+    check_equal(cba, bits);
+    for (int i = 0; i < 20000; ++i) {
+        size_t pos = 65536 + gen() % 65536;
+        bits[pos] = false;
+        cba.reset(pos);
+    }
+    check_equal(cba, bits);
+    cba.optimize();
+    check_equal(cba, bits);
+
+    for (int i = 0; i < 200; ++i) {
+        size_t begin = gen() % size;
+        size_t end = begin + gen() % (size - begin + 1);
+        size_t expected_cnt = 0;
+        size_t expected_true = nvwa::compressed_bool_array::npos;
+        size_t expected_false = nvwa::compressed_bool_array::npos;
+        for (size_t pos = begin; pos < end; ++pos) {
+            expected_cnt += bits[pos];
+            if (bits[pos] &&
+                    expected_true == nvwa::compressed_bool_array::npos) {
+                expected_true = pos;
+            }
+            if (!bits[pos] &&
+                    expected_false == nvwa::compressed_bool_array::npos) {
+                expected_false = pos;
+            }
+        }
+        BOOST_CHECK_EQUAL(cba.count(begin, end), expected_cnt);
+        BOOST_CHECK_EQUAL(cba.find_until(true, begin, end), expected_true);
+        BOOST_CHECK_EQUAL(cba.find_until(false, begin, end), expected_false);
+    }
+
+    // Conversion both ways
+    nvwa::bool_array ba = cba.to_bool_array();
+    BOOST_CHECK_EQUAL(ba.size(), size);
+    for (size_t pos = 0; pos < size; ++pos) {
+        if (ba[pos] != bits[pos]) {
+            BOOST_ERROR("Mismatch at " << pos);
+            break;
+        }
+    }
+    check_equal(nvwa::compressed_bool_array(ba), bits);
+
+    // Merges
+    std::vector<bool> rhs_bits(size - 500);
+    nvwa::compressed_bool_array rhs(rhs_bits.size());
+    for (int i = 0; i < 100000; ++i) {
+        size_t pos = gen() % rhs_bits.size();
+        rhs_bits[pos] = true;
+        rhs.set(pos);
+    }
+    for (size_t pos = 65536 * 3; pos < 65536 * 3 + 5000; ++pos) {
+        rhs_bits[pos] = true;
+        rhs.set(pos);
+    }
+    rhs.optimize();
+
+    nvwa::compressed_bool_array and_result(cba);
+    and_result.merge_and(rhs);
+    std::vector<bool> and_bits(bits);
+    for (size_t pos = 0; pos < rhs_bits.size(); ++pos) {
+        and_bits[pos] = bits[pos] && rhs_bits[pos];
+    }
+    check_equal(and_result, and_bits);
+
+    nvwa::compressed_bool_array or_result(cba);
+    or_result.merge_or(rhs);
+    std::vector<bool> or_bits(bits);
+    for (size_t pos = 0; pos < rhs_bits.size(); ++pos) {
+        or_bits[pos] = bits[pos] || rhs_bits[pos];
+    }
+    check_equal(or_result, or_bits);
+
+    BOOST_CHECK_THROW(rhs.merge_and(cba), std::out_of_range);
+}
@@ -0,0 +1,115 @@
+#include "nvwa/decompressing_file.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/file_line_reader.h"
+#include "nvwa/istream_line_reader.h"
+
+namespace {
+
+const char plain_path[] = "decompressing_file_test.txt";
+const char gzip_path[] = "decompressing_file_test.txt.gz";
+const char zstd_path[] = "decompressing_file_test.txt.zst";
+
+struct file_remover {
+    ~file_remover()
+    {
+        remove(plain_path);
+        remove(gzip_path);
+        remove(zstd_path);
+    }
+};
+
+std::vector<std::string> make_lines()
+{
+    std::vector<std::string> lines;
+    for (int i = 0; i < 100000; ++i) {
+        lines.push_back("line " + std::to_string(i));
+    }
+    return lines;
+}
+
+std::vector<std::string> read_lines(nvwa::decompressing_file& file)
+{
+    std::vector<std::string> result;
+    nvwa::file_line_reader reader{file.stream()};
+    for (std::string_view line : reader.views()) {
+        result.emplace_back(line);
+    }
+    return result;
+}
+
+} /* unnamed namespace */
+
+BOOST_AUTO_TEST_CASE(decompressing_file_test)
+{
+    file_remover remover;
+    auto lines = make_lines();
+    {
+        std::ofstream ofs(plain_path);
+        for (auto&& line : lines) {
+            ofs << line << '\n';
+        }
+    }
+
+    nvwa::decompressing_file file{plain_path};
+    BOOST_CHECK(file.format() == nvwa::decompressing_file::plain);
+    BOOST_CHECK(read_lines(file) == lines);
+    std::error_code ec;
+    BOOST_CHECK(file.close(ec));
+    BOOST_CHECK(!file.is_open());
+
+    if (system("gzip -c decompressing_file_test.txt > "
+               "decompressing_file_test.txt.gz") == 0) {
+        file.open(gzip_path);
+        BOOST_CHECK(file.format() == nvwa::decompressing_file::gzip);
+        BOOST_CHECK(read_lines(file) == lines);
+        BOOST_CHECK(file.close(ec));
+
+        file.open(gzip_path);
+        std::vector<std::string> result;
+        for (auto& line : nvwa::istream_line_reader(file.istream())) {
+            result.push_back(line);
+        }
+        BOOST_CHECK(result == lines);
+        BOOST_CHECK(file.close(ec));
+
+        // Reading a corrupt file is reported on close
+        std::ofstream(gzip_path, std::ios::app) << "garbage";
+        file.open(gzip_path);
+        read_lines(file);
+        BOOST_CHECK(!file.close(ec));
+        BOOST_CHECK(ec == std::errc::io_error);
+
+#if NVWA_UNIX
+        // So is a failure to wait for the decompressor
+        auto old_handler = signal(SIGCHLD, SIG_IGN);
+        file.open(gzip_path);
+        read_lines(file);
+        BOOST_CHECK(!file.close(ec));
+        BOOST_CHECK(ec == std::errc::no_child_process);
+        signal(SIGCHLD, old_handler);
+#endif
+    } else {
+        BOOST_TEST_MESSAGE("gzip is not available");
+    }
+
+    if (system("zstd -q -c decompressing_file_test.txt > "
+               "decompressing_file_test.txt.zst") == 0) {
+        file.open(zstd_path);
+        BOOST_CHECK(file.format() == nvwa::decompressing_file::zstd);
+        BOOST_CHECK(read_lines(file) == lines);
+        BOOST_CHECK(file.close(ec));
+    } else {
+        BOOST_TEST_MESSAGE("zstd is not available");
+    }
+
+    BOOST_CHECK(!file.open("nonexistent.gz", ec));
+    BOOST_CHECK(ec == std::errc::no_such_file_or_directory);
+}
@@ -0,0 +1,117 @@
+#include "nvwa/fast_mutex.h"
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/class_level_lock.h"
+#include "nvwa/object_level_lock.h"
+
+using namespace nvwa;
+
+namespace /* unnamed */ {
+
+struct counter_host {};
+
+class shared_counter : public object_level_lock<shared_counter,
+                                                fast_shared_mutex> {
+public:
+    void increment()
+    {
+        lock guard(*this);
+        ++_M_value;
+    }
+    int get() const
+    {
+        shared_lock guard(*this);
+        return _M_value;
+    }
+
+private:
+    int _M_value{};
+};
+
+template <typename _Fn>
+void run_threads(int thread_count, _Fn fn)
+{
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        threads.emplace_back(fn);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} /* unnamed namespace */
+
+BOOST_AUTO_TEST_CASE(adaptive_fast_mutex_test)
+{
+    adaptive_fast_mutex mtx;
+    long count = 0;
+    run_threads(4, [&] {
+        for (int i = 0; i < 100000; ++i) {
+            adaptive_fast_mutex_autolock guard(mtx);
+            ++count;
+        }
+    });
+    BOOST_TEST(count == 400000);
+
+    BOOST_TEST(mtx.try_lock());
+    BOOST_TEST(!mtx.try_lock());
+    mtx.unlock();
+
+    typedef class_level_lock<counter_host, true, adaptive_fast_mutex>
+        host_lock;
+    count = 0;
+    run_threads(4, [&] {
+        for (int i = 0; i < 100000; ++i) {
+            host_lock::lock guard;
+            ++count;
+        }
+    });
+    BOOST_TEST(count == 400000);
+}
+
+BOOST_AUTO_TEST_CASE(fast_shared_mutex_test)
+{
+    fast_shared_mutex mtx;
+    mtx.lock_shared();
+    BOOST_TEST(mtx.try_lock_shared());
+    BOOST_TEST(!mtx.try_lock());
+    mtx.unlock_shared();
+    mtx.unlock_shared();
+    BOOST_TEST(mtx.try_lock());
+    bool shared_acquired = true;
+    std::thread([&] { shared_acquired = mtx.try_lock_shared(); }).join();
+    BOOST_TEST(!shared_acquired);
+    mtx.unlock();
+
+    typedef class_level_lock<counter_host, true, fast_shared_mutex>
+        host_lock;
+    int value = 0;
+    run_threads(4, [&] {
+        int last_seen = 0;
+        for (int i = 0; i < 10000; ++i) {
+            if (i % 10 == 0) {
+                host_lock::lock guard;
+                ++value;
+            } else {
+                host_lock::shared_lock guard;
+                last_seen = value;
+            }
+        }
+        (void)last_seen;
+    });
+    BOOST_TEST(value == 4000);
+
+    shared_counter counter;
+    run_threads(4, [&] {
+        for (int i = 0; i < 10000; ++i) {
+            if (i % 10 == 0) {
+                counter.increment();
+            } else {
+                (void)counter.get();
+            }
+        }
+    });
+    BOOST_TEST(counter.get() == 4000);
+}
@@ -2,8 +2,11 @@
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <iterator>
+#include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 #include <boost/core/demangle.hpp>
 #include <boost/test/unit_test.hpp>
 #include "nvwa/pctimer.h"
@@ -93,6 +96,42 @@ void read_and_check_queue2(nvwa::fc_queue<int>& q)
     BOOST_TEST_MESSAGE(stop_count << " stops during dequeueing");
 }
 
+const int MPMC_THREADS = 4;
+const int MPMC_LOOPS = 200'000;
+std::atomic<long long> mpmc_sum{0};
+std::atomic<int> mpmc_read_count{0};
+
+void add_to_mpmc_queue(nvwa::mpmc_fc_queue<int>& q, int id)
+{
+    for (int i = 0; i < MPMC_LOOPS; ++i) {
+        while (!q.write(id * MPMC_LOOPS + i)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void read_and_check_mpmc_queue(nvwa::mpmc_fc_queue<int>& q)
+{
+    std::vector<int> last_values(MPMC_THREADS, -1);
+    while (mpmc_read_count < MPMC_THREADS * MPMC_LOOPS) {
+        int value{};
+        if (!q.read(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ++mpmc_read_count;
+        mpmc_sum += value;
+        int id = value / MPMC_LOOPS;
+        int seq = value % MPMC_LOOPS;
+        if (seq <= last_values[id]) {
+            BOOST_ERROR("Out-of-order read from producer " << id << ": "
+                        << seq << " after " << last_values[id]);
+            parallel_test_failed = true;
+        }
+        last_values[id] = seq;
+    }
+}
+
 } /* unnamed namespace */
 
 BOOST_AUTO_TEST_CASE(fc_queue_test)
@@ -210,6 +249,18 @@ BOOST_AUTO_TEST_CASE(fc_queue_test)
     BOOST_CHECK_EQUAL(s.front(), 5);
     BOOST_CHECK_EQUAL(s.back(), 5);
 
+    int value{};
+    BOOST_CHECK(q.read(value));
+    BOOST_CHECK_EQUAL(value, 1);
+    BOOST_CHECK(s.write(6));
+    BOOST_CHECK(s.write(7));
+    BOOST_CHECK(s.write(8));
+    BOOST_CHECK(!s.write(9));
+    BOOST_CHECK(s.read(value));
+    BOOST_CHECK_EQUAL(value, 5);
+    BOOST_CHECK(s.write(9));
+    BOOST_CHECK(s.full());
+
 #if __has_include(<memory_resource>)
     nvwa::fc_queue<int, std::pmr::polymorphic_allocator<int>> t(4);
     BOOST_CHECK_EQUAL(t.capacity(), 4U);
@@ -228,6 +279,85 @@ BOOST_AUTO_TEST_CASE(fc_queue_test)
 #endif
 }
 
+BOOST_AUTO_TEST_CASE(fc_queue_bulk_test)
+{
+    nvwa::fc_queue<std::string> q(5);
+    std::vector<std::string> input{"a", "b", "c", "d", "e", "f"};
+    BOOST_CHECK_EQUAL(q.write_bulk(input.begin(), input.begin() + 3), 3U);
+    BOOST_CHECK_EQUAL(q.size(), 3U);
+    std::vector<std::string> output;
+    BOOST_CHECK_EQUAL(q.read_bulk(std::back_inserter(output), 2), 2U);
+    BOOST_CHECK(output == (std::vector<std::string>{"a", "b"}));
+    BOOST_CHECK_EQUAL(q.write_bulk(std::make_move_iterator(input.begin()),
+                                   std::make_move_iterator(input.end())),
+                      4U);
+    BOOST_CHECK(q.full());
+    BOOST_CHECK(input[0].empty());
+    BOOST_CHECK_EQUAL(input[4], "e");
+
+    // The storage has six slots, so the last element wraps around
+    auto span = q.peek();
+    BOOST_CHECK_EQUAL(span.size, 4U);
+    BOOST_CHECK_EQUAL(span.data[0], "c");
+    BOOST_CHECK_EQUAL(span.data[3], "c");
+    q.commit_read(3);
+    BOOST_CHECK_EQUAL(q.size(), 2U);
+    span = q.peek();
+    BOOST_CHECK_EQUAL(span.size, 1U);
+    BOOST_CHECK_EQUAL(*span.begin(), "c");
+    q.commit_read(1);
+    span = q.peek();
+    BOOST_CHECK_EQUAL(span.size, 1U);
+    BOOST_CHECK_EQUAL(span.data[0], "d");
+
+    output.clear();
+    BOOST_CHECK_EQUAL(q.read_bulk(std::back_inserter(output), 10), 1U);
+    BOOST_CHECK(output == (std::vector<std::string>{"d"}));
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK(q.peek().empty());
+    BOOST_CHECK_EQUAL(q.read_bulk(std::back_inserter(output), 10), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(fc_queue_mixed_api_test)
+{
+    nvwa::fc_queue<std::string> q(2);
+    std::string s;
+    q.push("a");
+    q.pop();
+    BOOST_CHECK(!q.read(s));
+    BOOST_CHECK(q.peek().empty());
+    BOOST_CHECK(q.write("b"));
+    BOOST_CHECK(q.read(s));
+    BOOST_CHECK_EQUAL(s, "b");
+
+    nvwa::fc_queue<int> r(2);
+    r.push(1);
+    r.push(2);
+    r.push(3);
+    BOOST_CHECK(r.full());
+    BOOST_CHECK(!r.write(4));
+    BOOST_CHECK_EQUAL(r.size(), 2U);
+    int n = 0;
+    std::vector<int> v{5, 6};
+    BOOST_CHECK_EQUAL(r.write_bulk(v.begin(), v.end()), 0U);
+    BOOST_CHECK(r.read(n));
+    BOOST_CHECK_EQUAL(n, 2);
+    r.pop();
+    BOOST_CHECK(!r.read(n));
+    BOOST_CHECK_EQUAL(r.write_bulk(v.begin(), v.end()), 2U);
+    BOOST_CHECK_EQUAL(r.front(), 5);
+    BOOST_CHECK_EQUAL(r.back(), 6);
+
+    nvwa::fc_queue<int> t(r);
+    BOOST_CHECK(!t.write(7));
+    t.pop();
+    BOOST_CHECK(t.read(n));
+    BOOST_CHECK_EQUAL(n, 6);
+    BOOST_CHECK(!t.read(n));
+    BOOST_CHECK(t.write(8));
+    BOOST_CHECK_EQUAL(t.size(), 1U);
+}
+
 BOOST_AUTO_TEST_CASE(fc_queue_parallel_test)
 {
     parallel_test_failed = false;
@@ -255,3 +385,65 @@ BOOST_AUTO_TEST_CASE(fc_queue_parallel_test2)
     auto t2 = nvwa::pctimer();
     BOOST_TEST_MESSAGE("Test took " << (t2 - t1) << " seconds");
 }
+
+BOOST_AUTO_TEST_CASE(mpmc_fc_queue_test)
+{
+    nvwa::mpmc_fc_queue<int, test_alloc> q(3);
+    BOOST_TEST_MESSAGE("sizeof mpmc_fc_queue is " << sizeof q);
+    BOOST_CHECK_EQUAL(q.capacity(), 4U);
+    BOOST_CHECK_EQUAL(q.size(), 0U);
+    BOOST_CHECK(!q.full());
+    BOOST_CHECK(q.empty());
+    int value{};
+    BOOST_CHECK(!q.read(value));
+    for (int i = 1; i <= 4; ++i) {
+        BOOST_CHECK(q.write(i));
+        BOOST_CHECK_EQUAL(q.size(), unsigned(i));
+    }
+    BOOST_CHECK(q.full());
+    BOOST_CHECK(!q.write(5));
+    BOOST_CHECK(q.read(value));
+    BOOST_CHECK_EQUAL(value, 1);
+    BOOST_CHECK(!q.full());
+    BOOST_CHECK(q.write(5));
+    for (int i = 2; i <= 5; ++i) {
+        BOOST_CHECK(q.read(value));
+        BOOST_CHECK_EQUAL(value, i);
+    }
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK(!q.read(value));
+
+    nvwa::mpmc_fc_queue<std::string> r(2);
+    BOOST_CHECK(r.write(3, 'a'));
+    BOOST_CHECK(r.write("bc"));
+    BOOST_CHECK(!r.write("de"));
+    std::string str;
+    BOOST_CHECK(r.read(str));
+    BOOST_CHECK_EQUAL(str, "aaa");
+    BOOST_CHECK(r.write("de"));
+    BOOST_CHECK_EQUAL(r.size(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(mpmc_fc_queue_parallel_test)
+{
+    parallel_test_failed = false;
+    mpmc_sum = 0;
+    mpmc_read_count = 0;
+    nvwa::mpmc_fc_queue<int> q(1024);
+    auto t1 = nvwa::pctimer();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < MPMC_THREADS; ++i) {
+        threads.emplace_back(add_to_mpmc_queue, std::ref(q), i);
+        threads.emplace_back(read_and_check_mpmc_queue, std::ref(q));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    long long n = MPMC_THREADS * MPMC_LOOPS;
+    BOOST_CHECK(!parallel_test_failed);
+    BOOST_CHECK_EQUAL(mpmc_read_count, n);
+    BOOST_CHECK_EQUAL(mpmc_sum, n * (n - 1) / 2);
+    BOOST_CHECK(q.empty());
+    auto t2 = nvwa::pctimer();
+    BOOST_TEST_MESSAGE("Test took " << (t2 - t1) << " seconds");
+}
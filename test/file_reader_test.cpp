@@ -4,15 +4,22 @@
 #include "nvwa/mmap_byte_reader.h"
 #include "nvwa/mmap_line_reader.h"
 #include "nvwa/mmap_line_view.h"
+#include "nvwa/mmap_window_line_reader.h"
 #include <stdio.h>
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iterator>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 #include <boost/test/unit_test.hpp>
 
+#if NVWA_UNIX
+#include <unistd.h>
+#endif
+
 const char* FILE1 = "../LICENCE";
 const char* FILE2 = "../README.md";
 
@@ -86,6 +93,112 @@ BOOST_AUTO_TEST_CASE(file_line_reader_test)
                            get_line_content().begin()));
 }
 
+BOOST_AUTO_TEST_CASE(file_line_reader_view_test)
+{
+    FILE* fp = fopen(FILE1, "r");
+    BOOST_REQUIRE(fp);
+    {
+        nvwa::file_line_reader reader{fp};
+        std::vector<std::string> file_content;
+        for (std::string_view line : reader.views()) {
+            file_content.emplace_back(line);
+        }
+        BOOST_REQUIRE(file_content.size() == get_line_content().size());
+        BOOST_CHECK(std::equal(file_content.begin(), file_content.end(),
+                               get_line_content().begin()));
+    }
+    fclose(fp);
+
+    // Destruction stops the helper thread before the end is reached
+    fp = fopen(FILE1, "r");
+    BOOST_REQUIRE(fp);
+    {
+        nvwa::file_line_reader reader{
+            fp, '\n', nvwa::file_line_reader::strip_delimiter,
+            nvwa::file_line_reader::async_prefetch};
+        BOOST_CHECK(*reader.views().begin() == get_line_content().front());
+    }
+    fclose(fp);
+
+#if NVWA_UNIX
+    // No helper thread is left blocked on a pipe with no data
+    int fds[2];
+    BOOST_REQUIRE(pipe(fds) == 0);
+    fp = fdopen(fds[0], "r");
+    BOOST_REQUIRE(fp);
+    {
+        nvwa::file_line_reader reader{
+            fp, '\n', nvwa::file_line_reader::strip_delimiter,
+            nvwa::file_line_reader::async_prefetch};
+        // Gives a helper thread, if any, time to start reading
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    fclose(fp);
+    close(fds[1]);
+#endif
+
+    // Lines longer than the read buffer, with a custom delimiter
+    const char* path = "file_line_reader_test.txt";
+    std::string long_line(3 * 1024 * 1024 + 1, 'x');
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs << "a;" << long_line << ";b;" << long_line;
+    }
+    for (int i = 0; i < 4; ++i) {
+        bool use_view = i & 1;
+        auto prefetch = i & 2 ? nvwa::file_line_reader::async_prefetch
+                              : nvwa::file_line_reader::no_prefetch;
+        fp = fopen(path, "rb");
+        BOOST_REQUIRE(fp);
+        {
+            nvwa::file_line_reader reader{
+                fp, ';', nvwa::file_line_reader::strip_delimiter, prefetch};
+            std::vector<std::string> file_content;
+            if (use_view) {
+                for (std::string_view line : reader.views()) {
+                    file_content.emplace_back(line);
+                }
+            } else {
+                for (const char* line : reader) {
+                    file_content.emplace_back(line);
+                }
+            }
+            BOOST_REQUIRE_EQUAL(file_content.size(), 4U);
+            BOOST_CHECK_EQUAL(file_content[0], "a");
+            BOOST_CHECK(file_content[1] == long_line);
+            BOOST_CHECK_EQUAL(file_content[2], "b");
+            BOOST_CHECK(file_content[3] == long_line);
+        }
+        fclose(fp);
+    }
+    remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(file_line_reader_stdio_test)
+{
+    // Content already consumed through stdio is taken into account
+    FILE* fp = fopen(FILE1, "r");
+    BOOST_REQUIRE(fp);
+    char header[256];
+    BOOST_REQUIRE(fgets(header, sizeof header, fp));
+    BOOST_CHECK_EQUAL(header, get_line_content().front() + '\n');
+    {
+        nvwa::file_line_reader reader{fp};
+        std::vector<std::string> file_content;
+        for (std::string_view line : reader.views()) {
+            file_content.emplace_back(line);
+        }
+        BOOST_REQUIRE(file_content.size() == get_line_content().size() - 1);
+        BOOST_CHECK(std::equal(file_content.begin(), file_content.end(),
+                               get_line_content().begin() + 1));
+    }
+    BOOST_CHECK(feof(fp));
+    BOOST_CHECK(!ferror(fp));
+    BOOST_CHECK_EQUAL(ftell(fp),
+                      static_cast<long>(get_byte_content().size()));
+    fclose(fp);
+}
+
 BOOST_AUTO_TEST_CASE(mmap_byte_reader_test)
 {
     {
@@ -146,3 +259,135 @@ BOOST_AUTO_TEST_CASE(mmap_line_view_test)
     BOOST_CHECK(std::equal(file_content.begin(), file_content.end(),
                            get_line_content().begin()));
 }
+
+BOOST_AUTO_TEST_CASE(mmap_line_reader_chunks_test)
+{
+    nvwa::mmap_line_reader reader{FILE1};
+    for (size_t n : {1, 2, 3, 7, 1000000}) {
+        auto chunks = reader.chunks(n);
+        BOOST_REQUIRE(!chunks.empty());
+        BOOST_CHECK_LE(chunks.size(), n);
+        BOOST_CHECK_EQUAL(chunks.front().begin_offset(), 0U);
+        std::vector<std::string> file_content;
+        for (auto&& chunk : chunks) {
+            std::copy(chunk.begin(), chunk.end(),
+                      std::back_inserter(file_content));
+        }
+        BOOST_REQUIRE(file_content.size() == get_line_content().size());
+        BOOST_CHECK(std::equal(file_content.begin(), file_content.end(),
+                               get_line_content().begin()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(mmap_line_view_chunks_test)
+{
+    nvwa::mmap_line_view reader{FILE1};
+    for (size_t n : {1, 2, 3, 7, 1000000}) {
+        auto chunks = reader.chunks(n);
+        BOOST_REQUIRE(!chunks.empty());
+        BOOST_CHECK_LE(chunks.size(), n);
+        std::vector<std::string_view> file_content;
+        for (auto&& chunk : chunks) {
+            // Each chunk can be split further
+            for (auto&& sub_chunk : chunk.chunks(2)) {
+                BOOST_CHECK_GE(sub_chunk.begin_offset(),
+                               chunk.begin_offset());
+                BOOST_CHECK_LE(sub_chunk.end_offset(), chunk.end_offset());
+                std::copy(sub_chunk.begin(), sub_chunk.end(),
+                          std::back_inserter(file_content));
+            }
+        }
+        BOOST_REQUIRE(file_content.size() == get_line_content().size());
+        BOOST_CHECK(std::equal(file_content.begin(), file_content.end(),
+                               get_line_content().begin()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(mmap_read_ahead_test)
+{
+    nvwa::mmap_line_reader reader;
+    BOOST_CHECK(reader.advise(nvwa::mmap_reader_base::advise_sequential |
+                              nvwa::mmap_reader_base::advise_populate));
+    reader.open(FILE1);
+    // A window smaller than a page exercises the page rounding
+    for (size_t window_size : {size_t(100), size_t(1) << 20}) {
+        reader.set_read_ahead(window_size, true);
+        std::vector<std::string> file_content;
+        std::copy(reader.begin(), reader.end(),
+                  std::back_inserter(file_content));
+        BOOST_REQUIRE(file_content.size() == get_line_content().size());
+        BOOST_CHECK(std::equal(file_content.begin(), file_content.end(),
+                               get_line_content().begin()));
+    }
+
+    nvwa::mmap_line_view view{FILE1};
+    BOOST_CHECK(view.advise(nvwa::mmap_reader_base::advise_willneed));
+    view.set_read_ahead(100, true);
+    std::vector<std::string_view> file_content;
+    for (auto&& chunk : view.chunks(3)) {
+        std::copy(chunk.begin(), chunk.end(),
+                  std::back_inserter(file_content));
+    }
+    BOOST_REQUIRE(file_content.size() == get_line_content().size());
+    BOOST_CHECK(std::equal(file_content.begin(), file_content.end(),
+                           get_line_content().begin()));
+
+    nvwa::mmap_reader_base base{FILE1};
+    BOOST_CHECK(base.prefetch(0, base.size()));
+    BOOST_CHECK(base.release(0, base.size()));
+    // Released pages are read in again on access
+    BOOST_CHECK_EQUAL(std::string(base.data(), 5),
+                      get_line_content().front().substr(0, 5));
+}
+
+BOOST_AUTO_TEST_CASE(mmap_window_line_reader_test)
+{
+    // Tiny windows make lines cross window boundaries
+    for (size_t window_size :
+         {size_t(1), size_t(100), nvwa::mmap_window_reader_base::
+                                      default_window_size}) {
+        nvwa::mmap_window_line_reader reader{
+            FILE1, '\n', nvwa::mmap_window_line_reader::strip_delimiter,
+            window_size};
+        std::vector<std::string> file_content;
+        std::copy(reader.begin(), reader.end(),
+                  std::back_inserter(file_content));
+        BOOST_REQUIRE(file_content.size() == get_line_content().size());
+        BOOST_CHECK(std::equal(file_content.begin(), file_content.end(),
+                               get_line_content().begin()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(mmap_window_line_reader_follow_test)
+{
+    const char* path = "mmap_window_test.txt";
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << "abc\nde" << std::flush;
+
+    nvwa::mmap_window_line_reader reader{path};
+    std::string line;
+    nvwa::mmap_window_line_reader::offset_type offset = 0;
+    BOOST_CHECK(reader.read(line, offset));
+    BOOST_CHECK_EQUAL(line, "abc");
+    nvwa::mmap_window_line_reader::offset_type saved_offset = offset;
+    BOOST_CHECK(reader.read(line, offset));
+    BOOST_CHECK_EQUAL(line, "de");
+    BOOST_CHECK(!reader.read(line, offset));
+
+    // The unterminated line is incomplete when following
+    reader.set_follow(nvwa::mmap_window_line_reader::follow_tail);
+    offset = saved_offset;
+    BOOST_CHECK(!reader.read(line, offset));
+    BOOST_CHECK_EQUAL(offset, saved_offset);
+    ofs << "f\nghi\n" << std::flush;
+    BOOST_CHECK(reader.read(line, offset));
+    BOOST_CHECK_EQUAL(line, "def");
+    BOOST_CHECK(reader.read(line, offset));
+    BOOST_CHECK_EQUAL(line, "ghi");
+    BOOST_CHECK(!reader.read(line, offset));
+    BOOST_CHECK_EQUAL(offset, reader.size());
+
+    reader.close();
+    ofs.close();
+    std::remove(path);
+}
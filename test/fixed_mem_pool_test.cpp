@@ -1,3 +1,4 @@
+#define _MEM_POOL_STATS 1
 #include "nvwa/fixed_mem_pool.h"
 #include <new>
 #include <boost/test/unit_test.hpp>
@@ -17,10 +18,32 @@ private:
     DECLARE_FIXED_MEM_POOL(Obj)
 };
 
+class GrowingObj {
+public:
+    GrowingObj() {}
+private:
+    char a[20];
+    DECLARE_FIXED_MEM_POOL(GrowingObj)
+};
+
 #ifdef __clang__
 #pragma GCC diagnostic pop
 #endif
 
+namespace nvwa {
+
+template <>
+struct fixed_mem_pool<GrowingObj>::max_arenas {
+    static const size_t value = 3;
+};
+
+template <>
+struct fixed_mem_pool<GrowingObj>::numa_local {
+    static const bool value = true;
+};
+
+} // namespace nvwa
+
 BOOST_AUTO_TEST_CASE(fixed_mem_test)
 {
     BOOST_REQUIRE(nvwa::fixed_mem_pool<Obj>::initialize(4));
@@ -39,3 +62,33 @@ BOOST_AUTO_TEST_CASE(fixed_mem_test)
     delete p4;
     BOOST_CHECK_EQUAL(nvwa::fixed_mem_pool<Obj>::deinitialize(), 0);
 }
+
+BOOST_AUTO_TEST_CASE(fixed_mem_growing_test)
+{
+    typedef nvwa::fixed_mem_pool<GrowingObj> pool;
+    BOOST_REQUIRE(pool::initialize(2));
+    BOOST_CHECK_EQUAL(pool::get_arena_count(), 1U);
+    GrowingObj* objs[6];
+    for (auto& obj : objs) {
+        obj = new GrowingObj();
+    }
+    BOOST_CHECK_EQUAL(pool::get_arena_count(), 3U);
+    BOOST_CHECK_EQUAL(pool::get_alloc_count(), 6);
+    BOOST_CHECK_EQUAL(pool::get_alloc_count(1), 2);
+    nvwa::mem_pool_stats stats;
+    BOOST_REQUIRE(pool::get_stats(stats));
+    BOOST_CHECK_EQUAL(stats.allocated, 6U);
+    BOOST_CHECK_EQUAL(stats.high_water, 6U);
+    BOOST_CHECK_EQUAL(stats.free_blocks, 0U);
+    BOOST_CHECK_EQUAL(stats.sys_allocs, 3U);
+    BOOST_REQUIRE_THROW(new GrowingObj(), std::bad_alloc);
+    delete objs[2];
+    delete objs[3];
+    BOOST_CHECK_EQUAL(pool::get_alloc_count(1), 0);
+    BOOST_CHECK_EQUAL(pool::get_alloc_count(2), 2);
+    for (int i : {0, 1, 4, 5}) {
+        delete objs[i];
+    }
+    BOOST_CHECK_EQUAL(pool::deinitialize(), 0);
+    BOOST_CHECK(!pool::is_initialized());
+}
@@ -7,6 +7,7 @@
 #include <memory>
 #include <ostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -346,3 +347,96 @@ BOOST_AUTO_TEST_CASE(functional_test)
     nvwa::make_curry(test_out3)(oss)("Hello ")("functional ")("world!");
     BOOST_CHECK_EQUAL(oss.str(), "Hello functional world!");
 }
+
+BOOST_AUTO_TEST_CASE(functional_lazy_test)
+{
+    std::vector<int> v{1, 2, 3, 4, 5};
+    auto const odd = [](int x) { return x % 2 != 0; };
+
+    auto squares = nvwa::lazy_fmap(sqr, v);
+    std::vector<int> result(squares.begin(), squares.end());
+    BOOST_TEST(result == (std::vector<int>{1, 4, 9, 16, 25}));
+    v[0] = 6;  // The view refers to v, and sees the change
+    BOOST_CHECK_EQUAL(*squares.begin(), 36);
+    v[0] = 1;
+
+    BOOST_CHECK_EQUAL(
+        nvwa::reduce(std::plus<int>(),
+                     nvwa::lazy_fmap(sqr, nvwa::lazy_filter(odd, v))),
+        35);
+    BOOST_CHECK_EQUAL(
+        nvwa::pipeline(v, nvwa::lazy_filter(odd), nvwa::lazy_fmap(sqr),
+                       [](const auto& x) {
+                           return nvwa::reduce(std::plus<int>(), x);
+                       }),
+        35);
+
+    // A temporary range is moved into the view
+    auto strings = nvwa::lazy_fmap([](int x) { return std::to_string(x); },
+                                   std::vector<int>{7, 8, 9});
+    std::vector<std::string> string_result =
+        nvwa::fmap([](const std::string& s) { return s + "!"; }, strings);
+    BOOST_TEST(string_result == (std::vector<std::string>{"7!", "8!", "9!"}));
+
+    auto empty = nvwa::lazy_filter([](int) { return false; }, v);
+    BOOST_CHECK(empty.begin() == empty.end());
+}
+
+BOOST_AUTO_TEST_CASE(functional_parallel_test)
+{
+    const nvwa::execution::parallel_policy par4(4, 8);
+    for (int size : {0, 1, 7, 100, 1001}) {
+        std::vector<int> v(size);
+        for (int i = 0; i < size; ++i) {
+            v[i] = i;
+        }
+        auto expected = nvwa::fmap(sqr, v);
+        BOOST_TEST(nvwa::par_fmap(par4, sqr, v) == expected);
+        BOOST_TEST(nvwa::par_fmap(nvwa::execution::par, sqr, v) == expected);
+        BOOST_TEST(nvwa::par_fmap(nvwa::execution::seq, sqr, v) == expected);
+        BOOST_TEST(nvwa::par_fmap<std::list>(par4, sqr, v) ==
+                   nvwa::fmap<std::list>(sqr, v));
+
+        long long sum = static_cast<long long>(size) * (size - 1) / 2;
+        auto add = [](long long x, long long y) { return x + y; };
+        BOOST_CHECK_EQUAL(nvwa::par_reduce(par4, add, v, 10LL), sum + 10);
+        BOOST_CHECK_EQUAL(nvwa::par_reduce(nvwa::execution::seq, add, v,
+                                           10LL),
+                          sum + 10);
+        BOOST_CHECK_EQUAL(nvwa::par_reduce(par4, std::plus<int>(), v),
+                          static_cast<int>(sum));
+    }
+
+    // Non-commutative but associative operation keeps the order
+    std::vector<std::string> words(50, "ab");
+    std::string joined = nvwa::par_reduce(
+        par4, std::plus<std::string>(), nvwa::fmap(
+            [](const std::string& s) { return s + "-"; }, words),
+        std::string(">"));
+    std::string expected_joined(">");
+    for (int i = 0; i < 50; ++i) {
+        expected_joined += "ab-";
+    }
+    BOOST_CHECK_EQUAL(joined, expected_joined);
+
+    // Parallel stages over a lazy range
+    std::vector<int> v(100);
+    for (int i = 0; i < 100; ++i) {
+        v[i] = i;
+    }
+    BOOST_CHECK_EQUAL(
+        nvwa::par_reduce(par4, std::plus<int>(), nvwa::lazy_fmap(sqr, v)),
+        328350);
+
+    std::vector<int> bad(100, 1);
+    bad[77] = 0;
+    BOOST_CHECK_THROW(nvwa::par_fmap(par4,
+                                     [](int x) {
+                                         if (x == 0) {
+                                             throw std::domain_error("zero");
+                                         }
+                                         return 1 / x;
+                                     },
+                                     bad),
+                      std::domain_error);
+}
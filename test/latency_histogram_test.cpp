@@ -0,0 +1,126 @@
+#include "nvwa/latency_histogram.h"
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/cycle_clock.h"
+
+using namespace nvwa;
+
+BOOST_AUTO_TEST_CASE(cycle_clock_test)
+{
+    BOOST_TEST(cycle_clock::ticks_per_second() > 0);
+    auto start_time = std::chrono::steady_clock::now();
+    cycle_clock::tick_t start = cycle_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    cycle_clock::tick_t end = cycle_clock::now();
+    auto end_time = std::chrono::steady_clock::now();
+    BOOST_REQUIRE(end >= start);
+
+    double measured = cycle_clock::to_seconds(end - start);
+    double expected =
+        std::chrono::duration<double>(end_time - start_time).count();
+    BOOST_TEST(measured > expected * 0.9);
+    BOOST_TEST(measured < expected * 1.1);
+    BOOST_TEST(cycle_clock::to_nanoseconds(end - start) >= 15000000U);
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram_bucket_test)
+{
+    typedef latency_histogram hist;
+    BOOST_TEST(hist::bucket_index(0) == 0U);
+    BOOST_TEST(hist::bucket_index(63) == 63U);
+    BOOST_TEST(hist::bucket_index(64) == 64U);
+    BOOST_TEST(hist::bucket_index(65) == 64U);
+    BOOST_TEST(hist::bucket_index(UINT64_MAX) == hist::bucket_count - 1);
+    for (size_t i = 0; i < hist::bucket_count; ++i) {
+        uint64_t lower = hist::bucket_lower_bound(i);
+        uint64_t upper = hist::bucket_upper_bound(i);
+        BOOST_REQUIRE(lower <= upper);
+        BOOST_REQUIRE(hist::bucket_index(lower) == i);
+        BOOST_REQUIRE(hist::bucket_index(upper) == i);
+        // Relative width of a bucket is at most 1/32
+        BOOST_REQUIRE((upper - lower) / 32 <= lower / 1024);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram_percentile_test)
+{
+    latency_histogram histogram;
+    BOOST_TEST(histogram.count() == 0U);
+    BOOST_TEST(histogram.percentile(50) == 0U);
+    BOOST_TEST(histogram.min() == 0U);
+
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        histogram.record(i * 1000);
+    }
+    BOOST_TEST(histogram.count() == 1000U);
+    BOOST_TEST(histogram.min() == 1000U);
+    BOOST_TEST(histogram.max() == 1000000U);
+    BOOST_TEST(histogram.mean() == 500500.0);
+    const double pcts[] = {1, 50, 90, 99, 99.9};
+    for (double pct : pcts) {
+        double exact = pct * 10000;
+        double result = static_cast<double>(histogram.percentile(pct));
+        BOOST_TEST(result >= exact);
+        BOOST_TEST(result <= exact * (1 + 1.0 / 32));
+    }
+    BOOST_TEST(histogram.percentile(100) == 1000000U);
+
+    FILE* fp = tmpfile();
+    BOOST_REQUIRE(fp != nullptr);
+    histogram.print("test", fp);
+    rewind(fp);
+    char buffer[256];
+    BOOST_REQUIRE(fgets(buffer, sizeof buffer, fp) != nullptr);
+    fclose(fp);
+    std::string output(buffer);
+    BOOST_TEST(output.find("test: count 1000,") == 0U);
+    BOOST_TEST(output.find("max 1000000") != std::string::npos);
+
+    histogram.reset();
+    BOOST_TEST(histogram.count() == 0U);
+    BOOST_TEST(histogram.max() == 0U);
+    BOOST_TEST(histogram.percentile(99) == 0U);
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram_thread_test)
+{
+    const int thread_count = 4;
+    const int loop_count = 10000;
+    latency_histogram histogram;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&histogram, i] {
+            for (int j = 0; j < loop_count; ++j) {
+                histogram.record(static_cast<uint64_t>(i * loop_count + j));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BOOST_TEST(histogram.count() ==
+               static_cast<uint64_t>(thread_count * loop_count));
+    BOOST_TEST(histogram.min() == 0U);
+    BOOST_TEST(histogram.max() ==
+               static_cast<uint64_t>(thread_count * loop_count - 1));
+}
+
+BOOST_AUTO_TEST_CASE(pctimer_scope_test)
+{
+    latency_histogram histogram;
+    {
+        pctimer_scope scope(histogram);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    {
+        pctimer_scope scope(histogram);
+    }
+    BOOST_TEST(histogram.count() == 2U);
+    BOOST_TEST(histogram.max() >= 1500000U);
+    BOOST_TEST(histogram.min() < 1500000U);
+}
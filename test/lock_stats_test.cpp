@@ -0,0 +1,140 @@
+#define _LOCK_STATS 1
+#include "nvwa/lock_stats.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/class_level_lock.h"
+#include "nvwa/fast_mutex.h"
+#include "nvwa/object_level_lock.h"
+
+using namespace nvwa;
+
+namespace /* unnamed */ {
+
+struct stats_class_host {};
+
+class stats_object_host : public object_level_lock<stats_object_host> {
+public:
+    void increment()
+    {
+        lock guard(*this);
+        ++_M_value;
+    }
+    int get() const
+    {
+        lock guard(*this);
+        return _M_value;
+    }
+
+private:
+    int _M_value{};
+};
+
+bool find_stats(const char* kind, const char* type_name, lock_stats& result)
+{
+    std::vector<lock_stats> all;
+    get_lock_stats(all);
+    for (const lock_stats& stats : all) {
+        if (strcmp(stats.kind, kind) == 0 &&
+            strcmp(stats.host_name, type_name) == 0) {
+            result = stats;
+            return true;
+        }
+    }
+    return false;
+}
+
+} /* unnamed namespace */
+
+BOOST_AUTO_TEST_CASE(lock_stats_class_level_test)
+{
+    typedef class_level_lock<stats_class_host> lock_type;
+    const int thread_count = 4;
+    const int loop_count = 10000;
+    int value = 0;
+    reset_lock_stats();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < loop_count; ++j) {
+                lock_type::lock guard;
+                ++value;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BOOST_TEST(value == thread_count * loop_count);
+
+    lock_stats stats;
+    BOOST_REQUIRE(find_stats("class_level_lock",
+                             typeid(stats_class_host).name(), stats));
+    BOOST_TEST(stats.acquisitions ==
+               static_cast<size_t>(thread_count * loop_count));
+    BOOST_TEST(stats.contentions <= stats.acquisitions);
+    BOOST_TEST(stats.wait_time >= 0.0);
+
+    reset_lock_stats();
+    BOOST_REQUIRE(find_stats("class_level_lock",
+                             typeid(stats_class_host).name(), stats));
+    BOOST_TEST(stats.acquisitions == 0U);
+    BOOST_TEST(stats.contentions == 0U);
+}
+
+BOOST_AUTO_TEST_CASE(lock_stats_contention_test)
+{
+    typedef class_level_lock<stats_class_host> lock_type;
+    reset_lock_stats();
+    std::thread waiter;
+    {
+        lock_type::lock guard;
+        waiter = std::thread([] { lock_type::lock guard; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    waiter.join();
+
+    lock_stats stats;
+    BOOST_REQUIRE(find_stats("class_level_lock",
+                             typeid(stats_class_host).name(), stats));
+    BOOST_TEST(stats.acquisitions == 2U);
+    BOOST_TEST(stats.contentions == 1U);
+    BOOST_TEST(stats.wait_time > 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(lock_stats_object_level_test)
+{
+    reset_lock_stats();
+    stats_object_host host1;
+    stats_object_host host2;
+    for (int i = 0; i < 10; ++i) {
+        host1.increment();
+        host2.increment();
+    }
+    BOOST_TEST(host1.get() + host2.get() == 20);
+
+    lock_stats stats;
+    BOOST_REQUIRE(find_stats("object_level_lock",
+                             typeid(stats_object_host).name(), stats));
+    BOOST_TEST(stats.acquisitions == 22U);
+    BOOST_TEST(stats.contentions == 0U);
+
+    FILE* fp = tmpfile();
+    BOOST_REQUIRE(fp != nullptr);
+    print_lock_stats(fp);
+    rewind(fp);
+    std::string output;
+    char buffer[256];
+    while (fgets(buffer, sizeof buffer, fp)) {
+        output += buffer;
+    }
+    fclose(fp);
+    BOOST_TEST(output.find("object_level_lock<") != std::string::npos);
+    BOOST_TEST(output.find("stats_object_host") != std::string::npos);
+    BOOST_TEST(output.find("22 acquisitions") != std::string::npos);
+}
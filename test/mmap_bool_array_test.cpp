@@ -0,0 +1,93 @@
+#include "nvwa/mmap_bool_array.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/bool_array.h"
+
+namespace {
+
+const char test_path[] = "mmap_bool_array_test.bin";
+
+struct file_remover {
+    ~file_remover()
+    {
+        remove(test_path);
+    }
+};
+
+} /* unnamed namespace */
+
+BOOST_AUTO_TEST_CASE(mmap_bool_array_test)
+{
+    file_remover remover;
+    std::mt19937 gen(29);
+    const size_t size = 100003;
+    nvwa::bool_array ba(size);
+    ba.initialize(false);
+    for (int i = 0; i < 5000; ++i) {
+        ba.set(gen() % size);
+    }
+    ba.set(size - 1);
+    nvwa::mmap_bool_array::save(ba, test_path);
+
+    {
+        nvwa::mmap_bool_array mba(test_path, nvwa::mmap_reader_base::read_only,
+                                  size);
+        BOOST_REQUIRE(mba.is_open());
+        BOOST_CHECK(!mba.is_writable());
+        BOOST_CHECK_EQUAL(mba.size(), size);
+        BOOST_CHECK_EQUAL(mba.array().count(), ba.count());
+        BOOST_CHECK_EQUAL(mba.array().find(true), ba.find(true));
+        for (size_t i = 0; i < size; ++i) {
+            if (mba[i] != ba[i]) {
+                BOOST_ERROR("Mismatch at " << i);
+                break;
+            }
+        }
+        BOOST_CHECK_THROW(mba.set(0), std::system_error);
+        BOOST_CHECK_THROW(mba.at(size), std::out_of_range);
+
+        // Copying gives a normal bool_array
+        nvwa::bool_array copy(mba.array());
+        BOOST_CHECK_EQUAL(copy.count(), ba.count());
+    }
+
+    // Changes in one mapping are seen by another one
+    size_t pos = ba.find(false);
+    {
+        nvwa::mmap_bool_array writer(test_path,
+                                     nvwa::mmap_reader_base::read_write, size);
+        nvwa::mmap_bool_array reader(test_path,
+                                     nvwa::mmap_reader_base::read_only, size);
+        BOOST_CHECK(writer.is_writable());
+        BOOST_CHECK(!reader[pos]);
+        writer.set(pos);
+        BOOST_CHECK(reader[pos]);
+        writer[pos + 1] = !writer[pos + 1];
+        BOOST_CHECK_EQUAL(reader[pos + 1], !ba[pos + 1]);
+        writer.sync();
+    }
+    {
+        nvwa::mmap_bool_array mba(test_path);
+        BOOST_CHECK_EQUAL(mba.size(), nvwa::bool_array::get_num_bytes_from_bits(
+                                          size) * 8);
+        BOOST_CHECK(mba[pos]);
+        BOOST_CHECK_EQUAL(mba[pos + 1], !ba[pos + 1]);
+        mba.close();
+        BOOST_CHECK(!mba.is_open());
+        BOOST_CHECK_EQUAL(mba.size(), 0U);
+    }
+
+    // Bits after the size shall be zero
+    BOOST_CHECK_THROW(nvwa::mmap_bool_array(test_path,
+                                            nvwa::mmap_reader_base::read_only,
+                                            size - 3),
+                      std::system_error);
+    BOOST_CHECK_THROW(nvwa::mmap_bool_array(test_path,
+                                            nvwa::mmap_reader_base::read_only,
+                                            size + 64),
+                      std::out_of_range);
+}
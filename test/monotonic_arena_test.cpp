@@ -0,0 +1,61 @@
+#include "nvwa/monotonic_arena.h"
+#include <memory>
+#include <stdint.h>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/fc_queue.h"
+#include "nvwa/tree.h"
+
+using namespace boost::unit_test_framework;
+
+BOOST_AUTO_TEST_CASE(monotonic_arena_test)
+{
+    nvwa::monotonic_arena arena(1024, 64);
+    BOOST_TEST(arena.bytes_used() == 0U);
+
+    void* ptr1 = arena.allocate(3, 1);
+    void* ptr2 = arena.allocate(8, 64);
+    BOOST_TEST(reinterpret_cast<uintptr_t>(ptr2) % 64 == 0U);
+    BOOST_CHECK(static_cast<char*>(ptr2) >= static_cast<char*>(ptr1) + 3);
+
+    auto m = arena.mark();
+    size_t used = arena.bytes_used();
+    {
+        nvwa::monotonic_arena::scoped_rewind guard(arena);
+        for (int i = 0; i < 100; ++i) {
+            arena.allocate(100);
+        }
+        arena.allocate(5000);   // Larger than the block size
+        BOOST_TEST(arena.bytes_used() >= used + 15000);
+    }
+    BOOST_TEST(arena.bytes_used() == used);
+    void* ptr3 = arena.allocate(16);
+    arena.rewind(m);
+    BOOST_TEST(arena.allocate(16) == ptr3);
+
+    arena.rewind(nvwa::monotonic_arena::marker());
+    BOOST_TEST(arena.bytes_used() == 0U);
+    arena.release();
+    BOOST_TEST(arena.bytes_used() == 0U);
+}
+
+BOOST_AUTO_TEST_CASE(arena_allocator_test)
+{
+    nvwa::monotonic_arena arena;
+    {
+        nvwa::arena_allocator<int> alloc(arena);
+        nvwa::fc_queue<int, nvwa::arena_allocator<int>> q(4, alloc);
+        q.push(1);
+        q.push(2);
+        BOOST_TEST(q.front() == 1);
+        BOOST_CHECK(q.get_allocator() == alloc);
+
+        typedef nvwa::tree<int, nvwa::storage_policy::shared> tree_type;
+        auto root = std::allocate_shared<tree_type>(
+            nvwa::arena_allocator<tree_type>(arena), 1);
+        root->push_back(std::allocate_shared<tree_type>(
+            nvwa::arena_allocator<tree_type>(arena), 2));
+        BOOST_TEST(root->child_count() == 1U);
+        BOOST_TEST(root->front()->value() == 2);
+    }
+    BOOST_TEST(arena.bytes_used() > 0U);
+}
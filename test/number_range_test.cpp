@@ -1,5 +1,12 @@
 #include "nvwa/number_range.h"
+#include <algorithm>
 #include <functional>
+#include <iterator>
+#include <numeric>
+#include <stdint.h>
+#include <thread>
+#include <type_traits>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 #include "nvwa/functional.h"
 #include "nvwa/c++_features.h"
@@ -21,5 +28,127 @@ BOOST_AUTO_TEST_CASE(number_range_test)
 
 #if HAVE_CXX20_RANGES
     static_assert(std::ranges::input_range<decltype(nvwa::number_range(1, 101))>);
+    static_assert(std::ranges::random_access_range<
+                  decltype(nvwa::number_range(1, 101))>);
+    static_assert(std::ranges::sized_range<
+                  decltype(nvwa::number_range(1, 101))>);
 #endif
 }
+
+BOOST_AUTO_TEST_CASE(number_range_random_access_test)
+{
+    typedef nvwa::number_range<int>::iterator iterator;
+    static_assert(std::is_same_v<
+                  std::iterator_traits<iterator>::iterator_category,
+                  std::random_access_iterator_tag>);
+
+    nvwa::number_range r(3, 20, 4);  // 3, 7, 11, 15, 19
+    BOOST_CHECK_EQUAL(r.size(), 5U);
+    BOOST_CHECK_EQUAL(r.end() - r.begin(), 5);
+    BOOST_CHECK_EQUAL(r[0], 3);
+    BOOST_CHECK_EQUAL(r[4], 19);
+    BOOST_CHECK_EQUAL(r.begin()[2], 11);
+    BOOST_CHECK_EQUAL(*(r.end() - 1), 19);
+    BOOST_CHECK_EQUAL(*(2 + r.begin()), 11);
+    BOOST_CHECK(r.begin() < r.end());
+    BOOST_CHECK(r.end() >= r.begin() + 5);
+    std::vector<int> reversed(std::make_reverse_iterator(r.end()),
+                              std::make_reverse_iterator(r.begin()));
+    BOOST_TEST(reversed == (std::vector<int>{19, 15, 11, 7, 3}));
+    BOOST_CHECK(*std::lower_bound(r.begin(), r.end(), 10) == 11);
+    BOOST_CHECK_EQUAL(std::accumulate(r.begin(), r.end(), 0), 55);
+
+    BOOST_CHECK_EQUAL(nvwa::number_range(3, 19, 4).size(), 4U);
+    BOOST_CHECK_EQUAL(nvwa::number_range(5, 5).size(), 0U);
+    BOOST_CHECK_EQUAL(nvwa::number_range(6, 5).size(), 0U);
+    BOOST_CHECK(nvwa::number_range(6, 5).empty());
+    BOOST_CHECK_EQUAL(nvwa::number_range<int>().size(), 0U);
+
+    // Floating-point numbers do not accumulate errors
+    nvwa::number_range f(0.0, 1.0, 0.1);
+    BOOST_CHECK_EQUAL(f.size(), 10U);
+    BOOST_CHECK_EQUAL(f[7], 7 * 0.1);
+    BOOST_CHECK(*(f.end() - 1) < 1.0);
+    BOOST_CHECK_EQUAL(nvwa::number_range(0.5, 2.0, 0.5).size(), 3U);
+
+    // Sentinels are still supported
+    nvwa::number_range<int>::sentinel s(20);
+    BOOST_CHECK(r.begin() + 5 == s);
+    BOOST_CHECK(r.begin() + 4 != s);
+}
+
+BOOST_AUTO_TEST_CASE(number_range_wide_test)
+{
+    // The end index of a narrow type does not wrap around
+    nvwa::number_range<int8_t> r(-100, 100);
+    BOOST_CHECK_EQUAL(r.size(), 200U);
+    BOOST_CHECK_EQUAL(r.end() - r.begin(), 200);
+    BOOST_CHECK_EQUAL(r[199], 99);
+    BOOST_CHECK_EQUAL(std::distance(r.begin(), r.end()), 200);
+    BOOST_CHECK_EQUAL(std::accumulate(r.begin(), r.end(), 0), -100);
+    BOOST_CHECK_EQUAL(nvwa::number_range<int8_t>(-128, 127, 127).size(),
+                      3U);
+    BOOST_CHECK_EQUAL(nvwa::number_range<uint8_t>(0, 255, 2).size(), 128U);
+
+    // Full-width ranges
+    nvwa::number_range<int32_t> w(INT32_MIN, INT32_MAX);
+    BOOST_CHECK_EQUAL(w.size(), 0xFFFFFFFFU);
+    BOOST_CHECK_EQUAL(w.end() - w.begin(), 0xFFFFFFFFLL);
+    BOOST_CHECK_EQUAL(w[0], INT32_MIN);
+    BOOST_CHECK_EQUAL(*(w.end() - 1), INT32_MAX - 1);
+    BOOST_CHECK_EQUAL(w[0x80000000U], 0);
+    nvwa::number_range<int32_t> s(INT32_MIN, INT32_MAX, 0x40000000);
+    BOOST_TEST(std::vector<int32_t>(s.begin(), s.end()) ==
+               (std::vector<int32_t>{INT32_MIN, -0x40000000, 0,
+                                     0x40000000}));
+    nvwa::number_range<int64_t> l(INT64_MIN, INT64_MAX, INT64_MAX);
+    BOOST_CHECK_EQUAL(l.size(), 3U);
+    BOOST_CHECK_EQUAL(l[2], INT64_MAX - 1);
+}
+
+BOOST_AUTO_TEST_CASE(number_range_chunks_test)
+{
+    nvwa::number_range r(0, 1000, 3);
+    auto chunks = r.chunks(7);
+    BOOST_REQUIRE_EQUAL(chunks.size(), 7U);
+    std::vector<int> joined;
+    size_t min_size = r.size();
+    size_t max_size = 0;
+    for (const auto& chunk : chunks) {
+        BOOST_CHECK(!chunk.empty());
+        min_size = std::min(min_size, chunk.size());
+        max_size = std::max(max_size, chunk.size());
+        joined.insert(joined.end(), chunk.begin(), chunk.end());
+    }
+    BOOST_CHECK(max_size - min_size <= 1);
+    BOOST_TEST(joined == std::vector<int>(r.begin(), r.end()));
+
+    // Chunks of chunks
+    auto sub_chunks = chunks[3].chunks(2);
+    BOOST_REQUIRE_EQUAL(sub_chunks.size(), 2U);
+    BOOST_CHECK_EQUAL(sub_chunks[0][0], chunks[3][0]);
+    BOOST_CHECK_EQUAL(sub_chunks[0].size() + sub_chunks[1].size(),
+                      chunks[3].size());
+
+    BOOST_CHECK_EQUAL(nvwa::number_range(0, 3).chunks(8).size(), 3U);
+    BOOST_CHECK_EQUAL(nvwa::number_range(0, 3).chunks(0).size(), 1U);
+    BOOST_CHECK(nvwa::number_range(3, 0).chunks(4).empty());
+
+    // Parallel index loop
+    std::vector<long long> partial_sums(4);
+    std::vector<std::thread> threads;
+    auto parts = nvwa::number_range(1, 100001).chunks(partial_sums.size());
+    for (size_t i = 0; i < parts.size(); ++i) {
+        threads.emplace_back([&partial_sums, &parts, i] {
+            for (int n : parts[i]) {
+                partial_sums[i] += n;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BOOST_CHECK_EQUAL(std::accumulate(partial_sums.begin(),
+                                      partial_sums.end(), 0LL),
+                      5000050000LL);
+}
@@ -0,0 +1,33 @@
+#include "nvwa/pool_allocator.h"
+#include <functional>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::unit_test_framework;
+
+BOOST_AUTO_TEST_CASE(pool_allocator_test)
+{
+    std::map<int, std::string, std::less<int>,
+             nvwa::pool_allocator<std::pair<const int, std::string>>> m;
+    std::list<int, nvwa::pool_allocator<int>> l;
+    for (int i = 0; i < 1000; ++i) {
+        m[i] = std::to_string(i);
+        l.push_back(i);
+    }
+    BOOST_CHECK_EQUAL(m.size(), 1000U);
+    BOOST_CHECK_EQUAL(m[42], "42");
+    BOOST_CHECK_EQUAL(l.size(), 1000U);
+    BOOST_CHECK_EQUAL(l.back(), 999);
+    m.clear();
+    l.clear();
+
+    // Larger than any size class
+    std::vector<int, nvwa::pool_allocator<int>> v(1000, 1);
+    v.resize(100);
+    v.shrink_to_fit();
+    BOOST_CHECK_EQUAL(v.size(), 100U);
+    BOOST_CHECK_EQUAL(v[99], 1);
+}
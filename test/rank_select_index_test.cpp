@@ -0,0 +1,53 @@
+#include "nvwa/rank_select_index.h"
+#include <stddef.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/bool_array.h"
+
+BOOST_AUTO_TEST_CASE(rank_select_index_test)
+{
+    std::mt19937 gen(28);
+    const size_t sizes[] = {1, 63, 64, 2048, 2049, 100000, 1000000};
+    const unsigned densities[] = {0, 1, 50, 999, 1000};   // per mille
+    for (size_t size : sizes) {
+        for (unsigned density : densities) {
+            nvwa::bool_array ba(size);
+            ba.initialize(false);
+            std::vector<size_t> positions;
+            for (size_t i = 0; i < size; ++i) {
+                if (gen() % 1000 < density) {
+                    ba.set(i);
+                    positions.push_back(i);
+                }
+            }
+            nvwa::rank_select_index index(ba);
+            BOOST_REQUIRE_EQUAL(index.count(), positions.size());
+            BOOST_CHECK_EQUAL(index.rank(size), positions.size());
+            BOOST_CHECK_THROW(index.rank(size + 1), std::out_of_range);
+            BOOST_CHECK_EQUAL(index.select(positions.size()),
+                              nvwa::rank_select_index::npos);
+
+            size_t expected_rank = 0;
+            for (size_t pos = 0; pos < size; ++pos) {
+                if (index.rank(pos) != expected_rank) {
+                    BOOST_ERROR("Wrong rank at " << pos << " of " << size);
+                    break;
+                }
+                expected_rank += ba[pos];
+            }
+            for (size_t i = 0; i < positions.size(); ++i) {
+                if (index.select(i) != positions[i]) {
+                    BOOST_ERROR("Wrong select of " << i << " in " << size);
+                    break;
+                }
+            }
+            if (size >= 1000000) {
+                BOOST_CHECK_LT(index.memory_usage(), size / 8 * 5 / 100);
+            }
+        }
+    }
+    BOOST_CHECK_THROW(nvwa::rank_select_index(nvwa::bool_array()),
+                      std::out_of_range);
+}
@@ -0,0 +1,156 @@
+#include "nvwa/segmented_queue.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stddef.h>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/pctimer.h"
+
+using namespace boost::unit_test_framework;
+
+namespace {
+
+const int THREADS = 3;
+const int LOOPS = 200'000;
+std::atomic<int> allocation_count{0};
+
+template <typename _Tp>
+struct counting_allocator : std::allocator<_Tp> {
+    typedef _Tp value_type;
+
+    counting_allocator() = default;
+    template <typename _Up>
+    counting_allocator(const counting_allocator<_Up>&) {}
+
+    template <typename _Up>
+    struct rebind {
+        typedef counting_allocator<_Up> other;
+    };
+
+    _Tp* allocate(size_t n)
+    {
+        ++allocation_count;
+        return std::allocator<_Tp>::allocate(n);
+    }
+};
+
+template <class _Queue>
+void add_to_segmented_queue(_Queue& q, int id)
+{
+    for (int i = 0; i < LOOPS; ++i) {
+        q.write(id * LOOPS + i);
+    }
+}
+
+template <class _Queue>
+void read_and_check_segmented_queue(_Queue& q, int producers, bool& ok)
+{
+    std::vector<int> last_values(producers, -1);
+    for (int i = 0; i < producers * LOOPS; ++i) {
+        int value{};
+        while (!q.read(value)) {
+            std::this_thread::yield();
+        }
+        int id = value / LOOPS;
+        int seq = value % LOOPS;
+        if (seq <= last_values[id]) {
+            ok = false;
+        }
+        last_values[id] = seq;
+    }
+}
+
+} /* unnamed namespace */
+
+BOOST_AUTO_TEST_CASE(segmented_queue_test)
+{
+    nvwa::segmented_queue<std::string> q(3);
+    BOOST_CHECK_EQUAL(q.segment_capacity(), 3U);
+    BOOST_CHECK(q.empty());
+    std::string value;
+    BOOST_CHECK(!q.read(value));
+    for (int i = 0; i < 10; ++i) {
+        q.write(std::to_string(i));
+    }
+    BOOST_CHECK(!q.empty());
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK(q.read(value));
+        BOOST_CHECK_EQUAL(value, std::to_string(i));
+    }
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK(!q.read(value));
+    q.write(2, 'x');
+    BOOST_CHECK(q.read(value));
+    BOOST_CHECK_EQUAL(value, "xx");
+
+    // Elements left in the queue are destroyed with it
+    nvwa::segmented_queue<std::string> r(2);
+    for (int i = 0; i < 5; ++i) {
+        r.write(100, 'a');
+    }
+}
+
+BOOST_AUTO_TEST_CASE(segmented_queue_recycle_test)
+{
+    nvwa::segmented_queue<int, counting_allocator<int>> q(4);
+    int value{};
+    for (int i = 0; i < 6; ++i) {
+        q.write(i);
+    }
+    for (int i = 0; i < 6; ++i) {
+        BOOST_CHECK(q.read(value));
+    }
+    int count = allocation_count;
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 6; ++i) {
+            q.write(i);
+        }
+        for (int i = 0; i < 6; ++i) {
+            BOOST_CHECK(q.read(value));
+            BOOST_CHECK_EQUAL(value, i);
+        }
+    }
+    BOOST_CHECK_EQUAL(allocation_count, count);
+}
+
+BOOST_AUTO_TEST_CASE(segmented_queue_parallel_test)
+{
+    nvwa::segmented_queue<int> q(64);
+    bool ok = true;
+    auto t1 = nvwa::pctimer();
+    std::thread enqueue_thread(add_to_segmented_queue<decltype(q)>,
+                               std::ref(q), 0);
+    std::thread dequeue_thread(read_and_check_segmented_queue<decltype(q)>,
+                               std::ref(q), 1, std::ref(ok));
+    enqueue_thread.join();
+    dequeue_thread.join();
+    BOOST_CHECK(ok);
+    BOOST_CHECK(q.empty());
+    auto t2 = nvwa::pctimer();
+    BOOST_TEST_MESSAGE("Test took " << (t2 - t1) << " seconds");
+}
+
+BOOST_AUTO_TEST_CASE(segmented_queue_mpsc_test)
+{
+    typedef nvwa::segmented_queue<int, std::allocator<int>, true> queue_type;
+    queue_type q(64);
+    bool ok = true;
+    auto t1 = nvwa::pctimer();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i) {
+        threads.emplace_back(add_to_segmented_queue<queue_type>,
+                             std::ref(q), i);
+    }
+    threads.emplace_back(read_and_check_segmented_queue<queue_type>,
+                         std::ref(q), THREADS, std::ref(ok));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BOOST_CHECK(ok);
+    BOOST_CHECK(q.empty());
+    auto t2 = nvwa::pctimer();
+    BOOST_TEST_MESSAGE("Test took " << (t2 - t1) << " seconds");
+}
@@ -0,0 +1,120 @@
+#include "nvwa/set_assign.h"
+#include <deque>
+#include <functional>
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/pool_allocator.h"
+
+using namespace boost::unit_test_framework;
+
+namespace {
+
+const int union_src[] = {0, 2, 3, 3, 8, 10, 11};
+const int diff_src[] = {0, 3, 4, 7, 9, 20};
+
+template <class _Container>
+std::vector<int> to_vector(const _Container& c)
+{
+    return std::vector<int>(c.begin(), c.end());
+}
+
+template <class _Container>
+void check_union_difference()
+{
+    _Container c{1, 3, 5, 7, 9};
+    nvwa::set_assign_union(c, std::begin(union_src), std::end(union_src));
+    std::vector<int> expected_union{0, 1, 2, 3, 3, 5, 7, 8, 9, 10, 11};
+    BOOST_TEST(to_vector(c) == expected_union);
+
+    nvwa::set_assign_difference(c, std::begin(diff_src), std::end(diff_src));
+    std::vector<int> expected_diff{1, 2, 3, 5, 8, 10, 11};
+    BOOST_TEST(to_vector(c) == expected_diff);
+}
+
+} /* unnamed namespace */
+
+BOOST_AUTO_TEST_CASE(set_assign_sequence_test)
+{
+    check_union_difference<std::vector<int>>();
+    check_union_difference<std::deque<int>>();
+    check_union_difference<std::list<int>>();
+
+    static_assert(
+        nvwa::detail::is_random_access_sequence<std::vector<int>>::value,
+        "vector shall take the in-place merge");
+    static_assert(
+        !nvwa::detail::is_random_access_sequence<std::list<int>>::value,
+        "list shall take the element-wise insertion");
+    static_assert(
+        !nvwa::detail::is_random_access_sequence<std::set<int>>::value,
+        "set shall take the element-wise insertion");
+
+    // Storage is reused when the capacity suffices
+    std::vector<int> v{1, 3, 5};
+    v.reserve(16);
+    const int* data = v.data();
+    nvwa::set_assign_union(v, std::begin(union_src), std::end(union_src));
+    BOOST_CHECK(v.data() == data);
+    nvwa::set_assign_difference(v, v.begin(), v.end());
+    BOOST_CHECK(v.empty());
+
+    std::vector<std::string> vs{"a", "c", "e"};
+    std::vector<std::string> src{"b", "c", "d"};
+    nvwa::set_assign_union(vs, src.begin(), src.end());
+    BOOST_TEST(vs == (std::vector<std::string>{"a", "b", "c", "d", "e"}));
+    nvwa::set_assign_difference(vs, src.begin(), src.end());
+    BOOST_TEST(vs == (std::vector<std::string>{"a", "e"}));
+}
+
+BOOST_AUTO_TEST_CASE(set_assign_set_test)
+{
+    std::set<int> s{1, 3, 5, 7, 9};
+    nvwa::set_assign_union(s, std::begin(union_src), std::end(union_src));
+    BOOST_TEST(to_vector(s) ==
+               (std::vector<int>{0, 1, 2, 3, 5, 7, 8, 9, 10, 11}));
+    nvwa::set_assign_difference(s, std::begin(diff_src), std::end(diff_src));
+    BOOST_TEST(to_vector(s) == (std::vector<int>{1, 2, 5, 8, 10, 11}));
+
+    std::multiset<int> ms{1, 3, 5, 7, 9};
+    nvwa::set_assign_union(ms, std::begin(union_src), std::end(union_src));
+    BOOST_TEST(to_vector(ms) ==
+               (std::vector<int>{0, 1, 2, 3, 3, 5, 7, 8, 9, 10, 11}));
+
+    std::set<int, std::less<int>, nvwa::pool_allocator<int>> ps;
+    std::vector<int> evens;
+    std::vector<int> odds;
+    for (int i = 0; i < 1000; ++i) {
+        (i % 2 == 0 ? evens : odds).push_back(i);
+    }
+    nvwa::set_assign_union(ps, evens.begin(), evens.end());
+    nvwa::set_assign_union(ps, odds.begin(), odds.end());
+    BOOST_CHECK_EQUAL(ps.size(), 1000U);
+    BOOST_CHECK_EQUAL(*ps.begin(), 0);
+    BOOST_CHECK_EQUAL(*ps.rbegin(), 999);
+    nvwa::set_assign_difference(ps, evens.begin(), evens.end());
+    BOOST_TEST(to_vector(ps) == odds);
+}
+
+BOOST_AUTO_TEST_CASE(set_assign_compare_test)
+{
+    const int src[] = {11, 10, 8, 3, 2, 0};
+
+    // The associative container uses its own ordering
+    std::set<int, std::greater<int>> s{9, 7, 5, 3, 1};
+    nvwa::set_assign_union(s, std::begin(src), std::end(src));
+    BOOST_TEST(to_vector(s) ==
+               (std::vector<int>{11, 10, 9, 8, 7, 5, 3, 2, 1, 0}));
+    nvwa::set_assign_difference(s, std::begin(src), std::end(src));
+    BOOST_TEST(to_vector(s) == (std::vector<int>{9, 7, 5, 1}));
+
+    std::vector<int> v{9, 7, 5, 3, 1};
+    nvwa::set_assign_union(v, std::begin(src), std::end(src),
+                           std::greater<int>());
+    BOOST_TEST(v == (std::vector<int>{11, 10, 9, 8, 7, 5, 3, 2, 1, 0}));
+    nvwa::set_assign_difference(v, std::begin(src), std::end(src),
+                                std::greater<int>());
+    BOOST_TEST(v == (std::vector<int>{9, 7, 5, 1}));
+}
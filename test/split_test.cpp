@@ -1,6 +1,7 @@
 #include "nvwa/split.h"
 #include <stddef.h>
 #include <array>
+#include <random>
 #include <string>
 #include <string_view>
 #include <system_error>
@@ -82,3 +83,118 @@ BOOST_AUTO_TEST_CASE(split_test)
 #endif
 #endif
 }
+
+namespace {
+
+std::vector<std::string> split_fields_slowly(std::string_view src,
+                                             std::string_view delimiters,
+                                             int quote)
+{
+    std::vector<std::string> result(1);
+    bool inside_quote = false;
+    for (char ch : src) {
+        if (ch == quote) {
+            inside_quote = !inside_quote;
+        }
+        if (!inside_quote &&
+            delimiters.find(ch) != std::string_view::npos) {
+            result.emplace_back();
+        } else {
+            result.back() += ch;
+        }
+    }
+    return result;
+}
+
+} /* unnamed namespace */
+
+BOOST_AUTO_TEST_CASE(split_fields_test)
+{
+    using namespace std::literals;
+
+    auto result = nvwa::split_fields("a,b;;\"c,d\";\"e\"\"f\"", ",;", '"')
+                      .to_vector();
+    std::vector<std::string> expected{"a", "b", "", "\"c,d\"",
+                                      "\"e\"\"f\""};
+    BOOST_TEST(result == expected);
+    BOOST_TEST(nvwa::unquote_field(result[3]) == "c,d");
+    BOOST_TEST(nvwa::unquote_field(result[4]) == "e\"f");
+    BOOST_TEST(nvwa::unquote_field(result[0]) == "a");
+    BOOST_TEST(nvwa::split_fields("", ",").to_vector() ==
+               std::vector<std::string>{""});
+    BOOST_TEST(nvwa::split_fields(str, "&").to_vector() ==
+               split_result_expected);
+
+    // Random records crossing the 64-byte blocks, with up to 4 delimiters
+    // (compared with SIMD) or more (looked up in a table)
+    std::mt19937 gen(37);
+    const char alphabet[] = "abc,;\t|\" ";
+    std::uniform_int_distribution<size_t> char_dist(0, sizeof alphabet - 2);
+    std::uniform_int_distribution<size_t> len_dist(0, 300);
+    for (auto delimiters : {","sv, ",;"sv, ",;\t| "sv}) {
+        for (int quote : {-1, int('"')}) {
+            for (int i = 0; i < 200; ++i) {
+                std::string record(len_dist(gen), ' ');
+                for (auto& ch : record) {
+                    ch = alphabet[char_dist(gen)];
+                }
+                auto fields =
+                    quote < 0
+                        ? nvwa::split_fields(record, delimiters)
+                        : nvwa::split_fields(record, delimiters, '"');
+                BOOST_TEST_REQUIRE(
+                    fields.to_vector() ==
+                    split_fields_slowly(record, delimiters, quote));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(split_into_test)
+{
+    using namespace std::literals;
+
+    std::vector<std::string> result_s;
+    std::vector<std::string_view> result_sv;
+    BOOST_TEST(nvwa::split(str, '&').split_into(result_s) == 4U);
+    BOOST_TEST(result_s == split_result_expected);
+    auto capacity = result_s.capacity();
+    const char* first_data = result_s[1].data();
+    BOOST_TEST(nvwa::split("a&b"sv, '&').split_into(result_s) == 2U);
+    BOOST_TEST(result_s == (std::vector<std::string>{"a", "b"}));
+    BOOST_TEST(result_s.capacity() == capacity);
+    BOOST_TEST(result_s[1].data() == first_data);
+
+    BOOST_TEST(nvwa::split_fields("a,\"b,c\";d", ",;", '"')
+                   .split_into(result_sv) == 3U);
+    BOOST_TEST(result_sv == (std::vector<std::string_view>{
+                                "a", "\"b,c\"", "d"}));
+    BOOST_TEST(nvwa::split_fields("", ",").split_into(result_sv) == 1U);
+    BOOST_TEST(result_sv.size() == 1U);
+    BOOST_TEST(result_sv[0].empty());
+}
+
+BOOST_AUTO_TEST_CASE(split_n_test)
+{
+    using namespace std::literals;
+
+    auto [items, count] = nvwa::split_n<8>(str, '&');
+    BOOST_TEST(count == 4U);
+    BOOST_TEST(items[0].empty());
+    BOOST_TEST(items[3] == "secret=APPSECRET");
+
+    auto result = nvwa::split_n<2>(str, "&"sv);
+    BOOST_TEST(result.size() == 2U);
+    BOOST_TEST(result[0].empty());
+    BOOST_TEST(result[1] ==
+               "grant_type=client_credential&appid=&secret=APPSECRET");
+
+    auto one = nvwa::split_n<1>("a=b=c"sv, '=');
+    BOOST_TEST(one.size() == 1U);
+    BOOST_TEST(one[0] == "a=b=c");
+
+    auto fields = nvwa::split_fields("k;\"x;y\";z;w", ";", '"').split_n<3>();
+    std::vector<std::string_view> field_list(fields.begin(), fields.end());
+    BOOST_TEST(field_list == (std::vector<std::string_view>{
+                                 "k", "\"x;y\"", "z;w"}));
+}
@@ -0,0 +1,71 @@
+#define _STATIC_MEM_POOL_LOCK_FREE 1
+#define _STATIC_MEM_POOL_MAX_IDLE 16
+#include "nvwa/static_mem_pool.h"
+#include <atomic>
+#include <new>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::unit_test_framework;
+
+namespace {
+
+class LfObj {
+public:
+    explicit LfObj(int owner) : _M_owner(owner) {}
+    int owner() const { return _M_owner; }
+private:
+    int  _M_owner;
+    char _M_data[44];
+    DECLARE_STATIC_MEM_POOL(LfObj)
+};
+
+const int THREADS = 4;
+const int OBJECTS = 100;
+const int LOOPS = 20000;
+std::atomic<bool> stop_recycling{false};
+std::atomic<bool> ownership_failed{false};
+
+void alloc_and_check(int owner)
+{
+    std::vector<LfObj*> objs(OBJECTS);
+    for (int i = 0; i < LOOPS; ++i) {
+        for (auto& obj : objs) {
+            obj = new LfObj(owner);
+        }
+        for (auto obj : objs) {
+            if (obj->owner() != owner) {
+                ownership_failed = true;
+            }
+            delete obj;
+        }
+    }
+}
+
+void keep_recycling()
+{
+    nvwa::static_mem_pool_set& pool_set =
+        nvwa::static_mem_pool_set::instance();
+    while (!stop_recycling) {
+        nvwa::static_mem_pool_set::lock guard;
+        pool_set.recycle();
+    }
+}
+
+} // unnamed namespace
+
+BOOST_AUTO_TEST_CASE(static_mem_lock_free_test)
+{
+    std::thread recycle_thread(keep_recycling);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i) {
+        threads.emplace_back(alloc_and_check, i);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    stop_recycling = true;
+    recycle_thread.join();
+    BOOST_CHECK(!ownership_failed);
+}
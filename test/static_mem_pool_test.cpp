@@ -0,0 +1,186 @@
+#define _STATIC_MEM_POOL_THREAD_CACHE 1
+#define _STATIC_MEM_POOL_CHUNK_SIZE 4096
+#define _STATIC_MEM_POOL_HUGE_PAGES 1
+#define _MEM_POOL_STATS 1
+#include "nvwa/static_mem_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::unit_test_framework;
+
+namespace {
+
+class Obj {
+public:
+    Obj() {}
+    void fill(char c) { memset(a, c, sizeof a); }
+    bool check(char c) const
+    {
+        return std::all_of(a, a + sizeof a, [c](char x) { return x == c; });
+    }
+private:
+    char a[40];
+    DECLARE_STATIC_MEM_POOL(Obj)
+};
+
+const int THREADS = 4;
+const int OBJECTS = 1000;
+const int LOOPS = 1000;
+std::atomic<bool> thread_cache_failed{false};
+
+bool are_distinct_and_aligned(std::vector<Obj*> objs)
+{
+    for (auto obj : objs) {
+        if (reinterpret_cast<uintptr_t>(obj) % alignof(void*) != 0) {
+            return false;
+        }
+    }
+    std::sort(objs.begin(), objs.end());
+    return std::adjacent_find(objs.begin(), objs.end()) == objs.end();
+}
+
+void alloc_and_free(char c)
+{
+    std::vector<Obj*> objs(OBJECTS);
+    for (int i = 0; i < LOOPS; ++i) {
+        for (auto& obj : objs) {
+            obj = new Obj();
+            obj->fill(c);
+        }
+        if (i == 0 && !are_distinct_and_aligned(objs)) {
+            thread_cache_failed = true;
+        }
+        for (auto obj : objs) {
+            if (!obj->check(c)) {
+                thread_cache_failed = true;
+            }
+            delete obj;
+        }
+    }
+}
+
+void alloc_for_other_thread(std::vector<Obj*>& objs, char c)
+{
+    for (auto& obj : objs) {
+        obj = new Obj();
+        obj->fill(c);
+    }
+}
+
+// Frees half of the objects allocated by another thread, and checks
+// that reusing their blocks (now in the cache of this thread) does not
+// disturb the other half.
+void free_from_other_thread(std::vector<Obj*>& objs, char c)
+{
+    std::vector<Obj*> new_objs(objs.size() / 2);
+    for (size_t i = 0; i < objs.size(); i += 2) {
+        if (!objs[i]->check(c)) {
+            thread_cache_failed = true;
+        }
+        delete objs[i];
+    }
+    alloc_for_other_thread(new_objs, c + 1);
+    for (size_t i = 1; i < objs.size(); i += 2) {
+        if (!objs[i]->check(c)) {
+            thread_cache_failed = true;
+        }
+        delete objs[i];
+    }
+    for (auto obj : new_objs) {
+        if (!obj->check(c + 1)) {
+            thread_cache_failed = true;
+        }
+        delete obj;
+    }
+}
+
+bool get_obj_stats(nvwa::mem_pool_stats& stats)
+{
+    return nvwa::static_mem_pool<sizeof(Obj)>::instance().get_stats(stats);
+}
+
+} // unnamed namespace
+
+BOOST_AUTO_TEST_CASE(static_mem_test)
+{
+    Obj* p1 = new Obj();
+    Obj* p2 = new Obj();
+    BOOST_CHECK_EQUAL(reinterpret_cast<char*>(p2) -
+                      reinterpret_cast<char*>(p1),
+                      static_cast<std::ptrdiff_t>(sizeof(Obj)));
+    delete p1;
+    delete p2;
+    Obj* p3 = new Obj();
+    BOOST_CHECK_EQUAL(p2, p3);
+    delete p3;
+}
+
+BOOST_AUTO_TEST_CASE(static_mem_thread_cache_test)
+{
+    thread_cache_failed = false;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i) {
+        threads.emplace_back(alloc_and_free, static_cast<char>('a' + i));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BOOST_CHECK(!thread_cache_failed);
+
+    std::vector<Obj*> objs(OBJECTS);
+    std::thread(alloc_for_other_thread, std::ref(objs), 'x').join();
+    BOOST_CHECK(are_distinct_and_aligned(objs));
+    std::thread(free_from_other_thread, std::ref(objs), 'x').join();
+    BOOST_CHECK(!thread_cache_failed);
+
+    // The caches of the exited threads have been drained into the pool,
+    // and recycle drains that of the current thread, so all chunks are
+    // free and can be returned to the system.
+    nvwa::mem_pool_stats stats;
+    BOOST_REQUIRE(get_obj_stats(stats));
+    BOOST_CHECK_EQUAL(stats.allocated, 0U);
+    nvwa::static_mem_pool_set& pool_set =
+        nvwa::static_mem_pool_set::instance();
+    {
+        nvwa::static_mem_pool_set::lock guard;
+        pool_set.recycle();
+    }
+    BOOST_REQUIRE(get_obj_stats(stats));
+    BOOST_CHECK_EQUAL(stats.allocated, 0U);
+    BOOST_CHECK_EQUAL(stats.free_blocks, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(static_mem_stats_test)
+{
+    std::vector<Obj*> objs(100);
+    for (auto& obj : objs) {
+        obj = new Obj();
+    }
+    delete objs[0];
+
+    std::vector<nvwa::mem_pool_stats> all_stats;
+    nvwa::static_mem_pool_set::instance().get_stats(all_stats);
+    const nvwa::mem_pool_stats* stats = nullptr;
+    for (const auto& item : all_stats) {
+        if (item.block_size == sizeof(Obj) && item.group_id == -1) {
+            stats = &item;
+        }
+    }
+    BOOST_REQUIRE(stats != nullptr);
+    BOOST_CHECK_EQUAL(stats->allocated, 99U);
+    BOOST_CHECK_GE(stats->high_water, 100U);
+    BOOST_CHECK_GE(stats->free_blocks, 1U);
+    BOOST_CHECK_GE(stats->sys_allocs, 1U);
+
+    for (size_t i = 1; i < objs.size(); ++i) {
+        delete objs[i];
+    }
+}
@@ -0,0 +1,71 @@
+#define _STATIC_MEM_POOL_MAX_IDLE 16
+#define _MEM_POOL_STATS 1
+#include "nvwa/static_mem_pool.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/static_mem_pool_reclaimer.h"
+
+using namespace boost::unit_test_framework;
+
+namespace {
+
+typedef nvwa::static_mem_pool<72> pool_type;
+
+size_t get_free_blocks()
+{
+    nvwa::mem_pool_stats stats;
+    BOOST_REQUIRE(pool_type::instance().get_stats(stats));
+    return stats.free_blocks;
+}
+
+void alloc_and_free(size_t count)
+{
+    std::vector<void*> blocks(count);
+    for (auto& block : blocks) {
+        block = pool_type::instance().allocate();
+        BOOST_REQUIRE(block != nullptr);
+    }
+    for (auto block : blocks) {
+        pool_type::instance().deallocate(block);
+    }
+}
+
+} // unnamed namespace
+
+BOOST_AUTO_TEST_CASE(static_mem_max_idle_test)
+{
+    alloc_and_free(100);
+    BOOST_CHECK_EQUAL(get_free_blocks(), 16U);
+    nvwa::static_mem_pool_set::instance().trim(4);
+    BOOST_CHECK_EQUAL(get_free_blocks(), 4U);
+}
+
+BOOST_AUTO_TEST_CASE(static_mem_reclaimer_test)
+{
+    alloc_and_free(10);
+    BOOST_CHECK_GE(get_free_blocks(), 10U);
+    {
+        nvwa::static_mem_pool_reclaimer reclaimer(
+            0, std::chrono::milliseconds(5));
+        for (int i = 0; i < 100 && get_free_blocks() != 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    BOOST_CHECK_EQUAL(get_free_blocks(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(static_mem_trim_non_locking_test)
+{
+    typedef nvwa::static_mem_pool<72, 0> local_pool_type;
+    local_pool_type& pool = local_pool_type::instance();
+    pool.deallocate(pool.allocate());
+    nvwa::mem_pool_stats stats;
+    nvwa::static_mem_pool_set::instance().trim(0);
+    BOOST_REQUIRE(pool.get_stats(stats));
+    BOOST_CHECK_EQUAL(stats.free_blocks, 1U);
+    pool.trim(0);
+    BOOST_REQUIRE(pool.get_stats(stats));
+    BOOST_CHECK_EQUAL(stats.free_blocks, 0U);
+}
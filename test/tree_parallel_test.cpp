@@ -0,0 +1,114 @@
+#include "nvwa/tree_parallel.h"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "nvwa/tree.h"
+
+using namespace nvwa;
+
+namespace /* unnamed */ {
+
+typedef tree<int, storage_policy::unique> unique_tree;
+
+// A chain of nodes, each of which also has a few leaves, so that the
+// tree is deep and unbalanced
+unique_tree::tree_ptr make_unbalanced_tree(int length, int& count)
+{
+    auto root = create_tree<storage_policy::unique>(count++);
+    unique_tree* node = root.get();
+    for (int i = 0; i < length; ++i) {
+        auto next = create_tree<storage_policy::unique>(count++);
+        unique_tree* next_node = next.get();
+        node->push_back(std::move(next));
+        for (int j = 0; j < i % 4; ++j) {
+            node->push_back(create_tree<storage_policy::unique>(count++));
+        }
+        node->push_back(unique_tree::null());
+        node = next_node;
+    }
+    return root;
+}
+
+} /* unnamed namespace */
+
+BOOST_AUTO_TEST_CASE(tree_parallel_for_each_test)
+{
+    int count = 0;
+    auto root = make_unbalanced_tree(10000, count);
+    std::vector<std::atomic<int>> visits(count);
+    for (unsigned max_threads : {1U, 2U, 4U, 0U}) {
+        for (auto& visit : visits) {
+            visit.store(0);
+        }
+        std::atomic<bool> parent_first{true};
+        parallel_for_each(
+            *root,
+            [&](unique_tree& node) {
+                visits[node.value()].fetch_add(1);
+                for (auto& child : node) {
+                    if (child && visits[child->value()].load() != 0) {
+                        parent_first = false;
+                    }
+                }
+            },
+            max_threads);
+        bool all_once = true;
+        for (auto& visit : visits) {
+            if (visit.load() != 1) {
+                all_once = false;
+            }
+        }
+        BOOST_TEST(all_once);
+        BOOST_TEST(parent_first.load());
+    }
+    root->remove_children();
+}
+
+BOOST_AUTO_TEST_CASE(tree_parallel_reduce_test)
+{
+    int count = 0;
+    auto root = make_unbalanced_tree(10000, count);
+    long long expected = (long long)count * (count - 1) / 2;
+    for (unsigned max_threads : {1U, 3U, 0U}) {
+        long long sum = parallel_reduce(
+            *root, 0LL, [](const unique_tree& node) { return node.value(); },
+            [](long long x, long long y) { return x + y; }, max_threads);
+        BOOST_TEST(sum == expected);
+    }
+    BOOST_TEST(parallel_reduce(
+                   *root, 100, [](const unique_tree&) { return 1; },
+                   [](int x, int y) { return x + y; }, 4) == count + 100);
+
+    auto leaf = create_tree<storage_policy::unique>(42);
+    BOOST_TEST(parallel_reduce(
+                   *leaf, 0, [](const unique_tree& node) { return node.value(); },
+                   [](int x, int y) { return x + y; }) == 42);
+
+    tree_arena<int> arena;
+    auto arena_root = arena.create(1, arena.create(2, arena.create(3)),
+                                   arena.create(4));
+    BOOST_TEST(parallel_reduce(
+                   *arena_root, 0,
+                   [](const tree<int, storage_policy::arena>& node) {
+                       return node.value();
+                   },
+                   [](int x, int y) { return x + y; }, 2) == 10);
+    root->remove_children();
+}
+
+BOOST_AUTO_TEST_CASE(tree_parallel_exception_test)
+{
+    int count = 0;
+    auto root = make_unbalanced_tree(1000, count);
+    BOOST_CHECK_THROW(parallel_for_each(
+                          *root,
+                          [](unique_tree& node) {
+                              if (node.value() == 500) {
+                                  throw std::runtime_error("node 500");
+                              }
+                          },
+                          4),
+                      std::runtime_error);
+    root->remove_children();
+}
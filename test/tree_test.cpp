@@ -1,6 +1,7 @@
 #include "nvwa/tree.h"
 #include <ostream>
 #include <sstream>
+#include <string>
 #include <utility>
 #include <boost/test/unit_test.hpp>
 
@@ -183,3 +184,133 @@ BOOST_AUTO_TEST_CASE(tree_test)
         BOOST_CHECK_EQUAL(oss.str(), "1 2 3 ");
     }
 }
+
+BOOST_AUTO_TEST_CASE(tree_arena_test)
+{
+    /*****************
+             6
+            / \
+           4   8
+          / \ / \
+         2  5 7  9
+        / \
+       1   3
+     *****************/
+    tree_arena<int> arena(4);
+    auto root =
+        arena.create(6,
+            arena.create(4,
+                arena.create(2, arena.create(1), arena.create(3)),
+                arena.create(5)),
+            arena.create(8, arena.create(7), arena.create(9)));
+    BOOST_CHECK_EQUAL(arena.size(), 9U);
+    BOOST_CHECK_EQUAL(root->child_count(), 2U);
+    BOOST_CHECK_EQUAL(root->child(1)->value(), 8);
+    BOOST_CHECK_EQUAL(root->back()->value(), 8);
+
+    std::ostringstream oss;
+    print_tree(root, oss);
+    BOOST_CHECK_EQUAL(oss.str(), "6\n"
+                                 "├── 4\n"
+                                 "│   ├── 2\n"
+                                 "│   │   ├── 1\n"
+                                 "│   │   └── 3\n"
+                                 "│   └── 5\n"
+                                 "└── 8\n"
+                                 "    ├── 7\n"
+                                 "    └── 9\n");
+
+    oss.str("");
+    for (auto& node : traverse<breadth_first_iteration>(*root)) {
+        oss << node.value() << ' ';
+    }
+    BOOST_CHECK_EQUAL(oss.str(), "6 4 8 2 5 7 9 1 3 ");
+
+    oss.str("");
+    for (auto& node : traverse<depth_first_iteration>(*root)) {
+        oss << node.value() << ' ';
+    }
+    BOOST_CHECK_EQUAL(oss.str(), "6 4 2 1 3 5 8 7 9 ");
+
+    oss.str("");
+    for (auto& node : traverse<in_order_iteration>(*root)) {
+        node.value() *= 2;
+        oss << node.value() << ' ';
+    }
+    BOOST_CHECK_EQUAL(oss.str(), "2 4 6 8 10 12 14 16 18 ");
+
+    auto leaf = root->child(0)->child(1);
+    root->child(0)->remove_children();
+    BOOST_CHECK(!root->child(0)->has_child());
+    root->push_back(leaf);
+    oss.str("");
+    for (auto& node : traverse<breadth_first_iteration>(*root)) {
+        oss << node.value() << ' ';
+    }
+    BOOST_CHECK_EQUAL(oss.str(), "12 8 16 10 14 18 ");
+
+    // Memory of the cleared nodes is reused
+    arena.clear();
+    BOOST_CHECK_EQUAL(arena.size(), 0U);
+    auto node1 = arena.create(1);
+    auto node2 = arena.create(2);
+    BOOST_CHECK(node2 == node1 + 1);
+    node1->set_children(node2);
+    BOOST_CHECK(node1->front() == node2);
+
+    tree_arena<std::string> string_arena(2);
+    auto str_root = string_arena.create(
+        std::string(100, 'a'), string_arena.create(std::string(100, 'b')),
+        string_arena.create("c"));
+    BOOST_CHECK_EQUAL(str_root->back()->value(), "c");
+}
+
+BOOST_AUTO_TEST_CASE(tree_iterator_test)
+{
+    // A chain deeper than the in-place buffers, each node with a leaf
+    const int depth = 3 * NVWA_TREE_ITERATOR_BUFFER_SIZE;
+    tree_arena<int> arena;
+    auto root = arena.create(0);
+    auto node = root;
+    for (int i = 1; i < depth; ++i) {
+        auto child = arena.create(i);
+        node->set_children(child, arena.create(-i));
+        node = child;
+    }
+
+    int count = 0;
+    int sum = 0;
+    for (auto& n : traverse<depth_first_iteration>(*root)) {
+        ++count;
+        sum += n.value();
+    }
+    BOOST_CHECK_EQUAL(count, 2 * depth - 1);
+    BOOST_CHECK_EQUAL(sum, 0);
+
+    std::ostringstream oss;
+    for (auto& n : traverse<in_order_iteration>(*root)) {
+        oss << n.value() << ' ';
+    }
+    BOOST_CHECK(oss.str().compare(0, 13, "47 46 -47 45 ") == 0);
+
+    // A bushy tree, and copies of iterators during traversal
+    auto wide = arena.create(0);
+    for (int i = 1; i <= depth; ++i) {
+        wide->push_back(arena.create(i, arena.create(i + depth)));
+    }
+    auto traverser = traverse<breadth_first_iteration>(*wide);
+    auto it = traverser.begin();
+    for (int i = 0; i < depth; ++i) {
+        ++it;
+    }
+    auto it2 = it;
+    count = 0;
+    for (; it != traverser.end(); ++it) {
+        BOOST_CHECK_EQUAL(it->value(), depth + count);
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, depth + 1);
+    BOOST_CHECK_EQUAL(it2->value(), depth);
+    BOOST_CHECK(++it2 != traverser.end());
+    BOOST_CHECK_EQUAL(it2->value(), depth + 1);
+}